@@ -0,0 +1,25 @@
+#version 450
+
+in vec2 texcoord;
+
+layout(location = 0) out vec4 accumulation;
+layout(location = 1) out float revealage;
+
+#include "MaterialTextures.glh"
+
+layout(binding = 0) uniform MATERIAL_SAMPLER m_texture_diffuse;
+
+// Depth weight from "Weighted Blended Order-Independent Transparency", McGuire & Bavoil 2013 (eq. 10)
+float weight(float alpha)
+{
+    float depthFactor = 1.0f - gl_FragCoord.z * 0.9f;
+    return clamp(pow(min(1.0f, alpha * 10.0f) + 0.01f, 3.0f) * 1e8f * depthFactor * depthFactor * depthFactor, 1e-2f, 3e3f);
+}
+
+void main()
+{
+    vec4 color = MATERIAL_TEXTURE(m_texture_diffuse, texcoord);
+
+    accumulation = vec4(color.rgb * color.a, color.a) * weight(color.a);
+    revealage    = color.a;
+}
@@ -3,9 +3,11 @@
 in vec2 texcoord;
 out vec4 frag_color;
 
-layout(binding = 0) uniform sampler2D m_texture_diffuse;
+#include "MaterialTextures.glh"
+
+layout(binding = 0) uniform MATERIAL_SAMPLER m_texture_diffuse;
 
 void main()
 {
-    frag_color = texture(m_texture_diffuse, texcoord);
+    frag_color = MATERIAL_TEXTURE(m_texture_diffuse, texcoord);
 }
\ No newline at end of file
@@ -9,10 +9,9 @@ uniform float threshold;
 
 float weight[5] = float[] (0.227027, 0.1945946, 0.1216216, 0.054054, 0.016216);
 
-subroutine vec4 bloomRendering();
-layout(location = 0) subroutine uniform bloomRendering bloom_func;
+#pragma multi_compile _ BLOOM_BLUR_HORIZONTAL BLOOM_BLUR_VERTICAL
 
-layout(index = 0) subroutine(bloomRendering) vec4 extractBrightness()
+vec4 extractBrightness()
 {
     vec3 color = texture(srcTexture, texcoord).rgb;
     vec3 luma  = vec3(0.2126, 0.7152, 0.0722);
@@ -23,7 +22,7 @@ layout(index = 0) subroutine(bloomRendering) vec4 extractBrightness()
     return vec4(bright_color, 1.0);
 }
 
-layout(index = 1) subroutine(bloomRendering) vec4 blurGaussianHorizontal()
+vec4 blurGaussianHorizontal()
 {
     vec2 texel_size = 1.0 / textureSize(srcTexture, 0);
     vec3 result = texture(srcTexture, texcoord).rgb * weight[0];
@@ -37,7 +36,7 @@ layout(index = 1) subroutine(bloomRendering) vec4 blurGaussianHorizontal()
     return vec4(result, 1.0);
 }
 
-layout(index = 2) subroutine(bloomRendering) vec4 blurGaussianVertical()
+vec4 blurGaussianVertical()
 {
     vec2 texel_size = 1.0 / textureSize(srcTexture, 0);
     vec3 result = texture(srcTexture, texcoord).rgb * weight[0];
@@ -53,5 +52,11 @@ layout(index = 2) subroutine(bloomRendering) vec4 blurGaussianVertical()
 
 void main()
 {
-    fragColor = bloom_func();
+#if defined(BLOOM_BLUR_HORIZONTAL)
+    fragColor = blurGaussianHorizontal();
+#elif defined(BLOOM_BLUR_VERTICAL)
+    fragColor = blurGaussianVertical();
+#else
+    fragColor = extractBrightness();
+#endif
 }
\ No newline at end of file
@@ -0,0 +1,85 @@
+#version 460 core
+
+layout(location = 0) in vec3 a_position;
+layout(location = 1) in vec2 a_texcoord;
+layout(location = 2) in vec3 a_normal;
+layout(location = 3) in vec3 a_tangent;
+layout(location = 4) in vec4 a_bone_weights;
+layout(location = 5) in vec4 a_bone_ids;
+
+struct CrowdInstance
+{
+    mat4 model;
+    vec4 animation; // first frame, frames count, time offset, speed
+};
+
+layout(std430, binding = 0) readonly buffer CrowdInstances
+{
+    CrowdInstance instances[];
+};
+
+out vec2 texcoord;
+out vec3 world_pos;
+out mat3 tbn;
+
+uniform mat4 g_view;
+uniform mat4 g_projection;
+
+uniform float time;
+uniform float frames_per_second;
+uniform int   instance_offset;
+
+// Every frame is a row, every bone takes three texels with the rows of its 3x4 matrix
+layout(binding = 8) uniform sampler2D bones_texture;
+
+mat4 boneMatrix(int frame, int bone)
+{
+    vec4 row0 = texelFetch(bones_texture, ivec2(bone * 3 + 0, frame), 0);
+    vec4 row1 = texelFetch(bones_texture, ivec2(bone * 3 + 1, frame), 0);
+    vec4 row2 = texelFetch(bones_texture, ivec2(bone * 3 + 2, frame), 0);
+
+    return transpose(mat4(row0, row1, row2, vec4(0.0f, 0.0f, 0.0f, 1.0f)));
+}
+
+mat4 skinMatrix(int frame)
+{
+    ivec4 ids = ivec4(a_bone_ids);
+
+    return boneMatrix(frame, ids.x) * a_bone_weights.x +
+           boneMatrix(frame, ids.y) * a_bone_weights.y +
+           boneMatrix(frame, ids.z) * a_bone_weights.z +
+           boneMatrix(frame, ids.w) * a_bone_weights.w;
+}
+
+void main()
+{
+    CrowdInstance instance = instances[instance_offset + gl_InstanceID];
+
+    /* Loop the clip and blend the two closest frames */
+    float frames_count = instance.animation.y;
+    float frame        = mod((time * instance.animation.w + instance.animation.z) * frames_per_second, frames_count);
+
+    int first_frame = int(instance.animation.x);
+    int frame0      = int(frame);
+    int frame1      = (frame0 + 1) % int(frames_count);
+
+    mat4 skin  = mix(skinMatrix(first_frame + frame0), skinMatrix(first_frame + frame1), fract(frame));
+    mat4 model = instance.model * skin;
+
+    world_pos = (model * vec4(a_position, 1.0f)).xyz;
+    texcoord  = a_texcoord;
+
+    gl_Position = g_projection * g_view * vec4(world_pos, 1.0f);
+
+    // The blended skinning matrices aren't orthonormal
+    mat3 normal_matrix = transpose(inverse(mat3(model)));
+
+    vec3 normal  = normalize(normal_matrix * a_normal);
+    vec3 tangent = normalize(normal_matrix * a_tangent);
+
+    /* Gram-Schmidt process */
+    tangent = normalize(tangent - dot(tangent, normal) * normal);
+
+    vec3 bitangent = cross(tangent, normal);
+    tbn = mat3(tangent, bitangent, normal);
+}
@@ -0,0 +1,10 @@
+#version 450
+
+in vec3 color;
+
+out vec4 frag_color;
+
+void main()
+{
+    frag_color = vec4(color, 1.0);
+}
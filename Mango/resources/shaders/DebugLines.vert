@@ -0,0 +1,14 @@
+#version 450
+
+layout(location = 0) in vec3 a_position;
+layout(location = 1) in vec3 a_color;
+
+uniform mat4 view_projection;
+
+out vec3 color;
+
+void main()
+{
+    color       = a_color;
+    gl_Position = view_projection * vec4(a_position, 1.0f);
+}
@@ -8,10 +8,9 @@ layout(binding = 0) uniform sampler2D filterTexture;
 uniform float nearZ;
 uniform float farZ;
 
-subroutine vec4 debugRendering();
-layout(location = 0) subroutine uniform debugRendering debug_func;
+#pragma multi_compile _ DEBUG_DEPTH_TARGET
 
-layout(index = 0) subroutine(debugRendering) vec4 debugColorTarget()
+vec4 debugColorTarget()
 {
     vec4 color = texture(filterTexture, texcoord);
     return color;
@@ -23,7 +22,7 @@ float linearizeDepth(vec2 uv)
     return (2.0 * nearZ) / (farZ + nearZ - z * (farZ - nearZ));
 }
 
-layout(index = 1) subroutine(debugRendering) vec4 debugDepthTarget()
+vec4 debugDepthTarget()
 {
     float c = linearizeDepth(texcoord);
     vec4 color = vec4(vec3(c), 1.0f);
@@ -32,5 +31,9 @@ layout(index = 1) subroutine(debugRendering) vec4 debugDepthTarget()
 
 void main()
 {
-    fragColor = debug_func();
+#ifdef DEBUG_DEPTH_TARGET
+    fragColor = debugDepthTarget();
+#else
+    fragColor = debugColorTarget();
+#endif
 }
\ No newline at end of file
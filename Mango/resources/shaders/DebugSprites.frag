@@ -3,9 +3,9 @@
 layout(location = 0) out vec4 frag_color;
 
 layout(binding = 0) uniform sampler2D sprite_tex;
-uniform vec3 color;
 
 in vec2 texcoords;
+in vec3 sprite_color;
 
 float rim_thickness = 3.0;
 float rim_intensity = 1.0;
@@ -25,8 +25,8 @@ void main()
           outline *= texture(sprite_tex, texcoords + vec2( 0,      -size.y)).a;
         
     float rim_cap = outline * texel_color.a * rim_intensity;
-    frag_color += rim_cap;    
+    frag_color = vec4(rim_cap);
 
-    frag_color.rgb *= color;
+    frag_color.rgb *= sprite_color;
     frag_color.a = 1;
 }
@@ -0,0 +1,17 @@
+#version 460 core
+
+layout(location = 0) in vec3  a_position;
+layout(location = 1) in float a_half_size;
+layout(location = 2) in vec3  a_color;
+
+uniform mat4 view;
+
+out float half_size_vs;
+out vec3  sprite_color_vs;
+
+void main()
+{
+    half_size_vs    = a_half_size;
+    sprite_color_vs = a_color;
+    gl_Position     = view * vec4(a_position, 1.0);
+}
@@ -5,33 +5,24 @@ out vec4 frag_color;
 in vec3 world_pos;
 in vec3 world_normal;
 
-layout(binding = 0) uniform samplerCube skybox;
+layout(binding = 0) uniform samplerCube skybox; // or the nearest reflection probe for the dynamic enviro mapped entities
 uniform vec3 g_cam_pos;
 
-subroutine vec4 enviroMapping();
-layout(location = 0) subroutine uniform enviroMapping enviro_func;
+#pragma multi_compile _ ENVIRO_REFRACTION
 
-layout(index = 0) subroutine(enviroMapping) vec4 reflection()
+void main()
 {
-    vec3 i = normalize(world_pos - g_cam_pos);
-    vec3 r = reflect(i, normalize(world_normal));
-
+    vec3  i     = normalize(world_pos - g_cam_pos);
     float ratio = 1.0f / 1.52f;
-    vec3 r_r = refract(i, normalize(world_normal), ratio);
 
-    return mix(vec4(texture(skybox, r).rgb, 1.0f), vec4(texture(skybox, r_r).rgb, 1.0f), 0.1);
-}
-
-layout(index = 1) subroutine(enviroMapping) vec4 refraction()
-{
-    float ratio = 1.0f / 1.52f;
-    vec3 i = normalize(world_pos - g_cam_pos);
+#ifdef ENVIRO_REFRACTION
     vec3 r = refract(i, normalize(world_normal), ratio);
 
-    return vec4(texture(skybox, r).rgb, 1.0f);
-}
+    frag_color = vec4(texture(skybox, r).rgb, 1.0f);
+#else
+    vec3 r   = reflect(i, normalize(world_normal));
+    vec3 r_r = refract(i, normalize(world_normal), ratio);
 
-void main()
-{
-    frag_color = enviro_func();
+    frag_color = mix(vec4(texture(skybox, r).rgb, 1.0f), vec4(texture(skybox, r_r).rgb, 1.0f), 0.1);
+#endif
 }
\ No newline at end of file
@@ -2,8 +2,12 @@
 
 layout(location = 0) out vec2 texcoord;
 
+// Fraction of the source textures that holds the image (dynamic resolution)
+uniform vec2 uv_scale = vec2(1.0f);
+
 void main()
 {
 	texcoord    = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
 	gl_Position = vec4(texcoord * 2.0f - 1.0f, 0.0f, 1.0f);
-}
\ No newline at end of file
+	texcoord   *= uv_scale;
+}
@@ -0,0 +1,70 @@
+#version 460 core
+
+layout(location = 0) in vec3 a_position;
+layout(location = 1) in vec2 a_texcoord;
+layout(location = 2) in vec3 a_normal;
+layout(location = 3) in vec3 a_tangent;
+
+struct FoliageInstance
+{
+    vec4 position_scale; // world space position of the base, scale
+    vec4 rotation_fade;  // cosine and sine of the yaw, fade threshold
+};
+
+layout(std430, binding = 0) readonly buffer FoliageInstances
+{
+    FoliageInstance instances[];
+};
+
+out vec2 texcoord;
+out vec3 world_pos;
+out mat3 tbn;
+
+uniform mat4 g_view;
+uniform mat4 g_projection;
+uniform vec3 g_cam_pos;
+
+uniform vec2 fade_distances; // start, end
+
+void main()
+{
+    // Every cell is a separate draw, its first instance is the base instance
+    FoliageInstance instance = instances[gl_BaseInstance + gl_InstanceID];
+
+    vec3  position = instance.position_scale.xyz;
+    float scale    = instance.position_scale.w;
+
+    /* Thin out the instances between the fade distances, every instance has its own threshold */
+    if (fade_distances.y > 0.0f)
+    {
+        float fade = 1.0f - smoothstep(fade_distances.x, fade_distances.y, distance(g_cam_pos, position));
+        if (instance.rotation_fade.z >= fade)
+        {
+            // All of the vertices of the instance collapse, so its triangles are degenerate
+            gl_Position = vec4(0.0f, 0.0f, 0.0f, 1.0f);
+            return;
+        }
+    }
+
+    float c = instance.rotation_fade.x;
+    float s = instance.rotation_fade.y;
+
+    mat3 rotation = mat3(c,    0.0f, -s,
+                         0.0f, 1.0f, 0.0f,
+                         s,    0.0f, c);
+
+    world_pos = position + rotation * (a_position * scale);
+    texcoord  = a_texcoord;
+
+    gl_Position = g_projection * g_view * vec4(world_pos, 1.0f);
+
+    // The scale is uniform, so the rotation is the normal matrix
+    vec3 normal  = normalize(rotation * a_normal);
+    vec3 tangent = normalize(rotation * a_tangent);
+
+    /* Gram-Schmidt process */
+    tangent = normalize(tangent - dot(tangent, normal) * normal);
+
+    vec3 bitangent = cross(tangent, normal);
+    tbn = mat3(tangent, bitangent, normal);
+}
@@ -7,8 +7,10 @@ in mat3 tbn;
 
 out vec4 frag_color;
 
-layout(binding = 0) uniform sampler2D m_texture_diffuse;
-layout(binding = 4) uniform sampler2D m_texture_depth;
+#include "MaterialTextures.glh"
+
+layout(binding = 0) uniform MATERIAL_SAMPLER m_texture_diffuse;
+layout(binding = 4) uniform MATERIAL_SAMPLER m_texture_depth;
 
 uniform vec3 s_scene_ambient;
 uniform vec3 g_cam_pos;
@@ -20,7 +22,7 @@ void main()
 {
     vec3 dir_to_eye = normalize(g_cam_pos - world_pos) * tbn;
     vec2 parallax_texcoord = parallaxMapping(dir_to_eye);
-	vec4 texture_color = texture(m_texture_diffuse, parallax_texcoord);
+	vec4 texture_color = MATERIAL_TEXTURE(m_texture_diffuse, parallax_texcoord);
 
 	if(texture_color.a < alpha_cutoff)
 	{
@@ -42,10 +42,10 @@ void main()
     vec3 dir_to_eye = normalize(g_cam_pos - world_pos) * tbn;
     parallax_texcoord = parallaxMapping(dir_to_eye);
 
-    vec4 diffuse_tex_color = texture(m_texture_diffuse, parallax_texcoord);
+    vec4 diffuse_tex_color = MATERIAL_TEXTURE(m_texture_diffuse, parallax_texcoord);
 
-    vec3 normal = texture(m_texture_normal, parallax_texcoord).rgb;
-    normal = normalize(tbn * (normal * 2.0f - 1.0f));
+    vec3 normal = unpackNormal(MATERIAL_TEXTURE(m_texture_normal, parallax_texcoord));
+    normal = normalize(tbn * normal);
 
     float shadow = shadowCalculation(frag_pos_light_space, normal);
 
@@ -7,11 +7,13 @@ in mat3 tbn;
 uniform vec3 g_cam_pos;
 uniform float alpha_cutoff;
 
-layout(binding = 0) uniform sampler2D m_texture_diffuse;
-layout(binding = 1) uniform sampler2D m_texture_specular;
-layout(binding = 2) uniform sampler2D m_texture_normal;
-layout(binding = 3) uniform sampler2D m_texture_emission;
-layout(binding = 4) uniform sampler2D m_texture_depth;
+#include "MaterialTextures.glh"
+
+layout(binding = 0) uniform MATERIAL_SAMPLER m_texture_diffuse;
+layout(binding = 1) uniform MATERIAL_SAMPLER m_texture_specular;
+layout(binding = 2) uniform MATERIAL_SAMPLER m_texture_normal;
+layout(binding = 3) uniform MATERIAL_SAMPLER m_texture_emission;
+layout(binding = 4) uniform MATERIAL_SAMPLER m_texture_depth;
 
 vec2 parallax_texcoord;
 
@@ -26,18 +28,18 @@ void main()
     vec3 dir_to_eye = normalize(g_cam_pos - world_pos) * tbn;
     parallax_texcoord = parallaxMapping(dir_to_eye);
 
-    vec4 diffuse_tex_color = texture(m_texture_diffuse, parallax_texcoord);
+    vec4 diffuse_tex_color = MATERIAL_TEXTURE(m_texture_diffuse, parallax_texcoord);
 
     if(diffuse_tex_color.a < alpha_cutoff)
     {
         discard;
     }
 
-    vec3 normal = texture(m_texture_normal, parallax_texcoord).rgb;
-    normal = normalize(tbn * (normal * 2.0f - 1.0f));
+    vec3 normal = unpackNormal(MATERIAL_TEXTURE(m_texture_normal, parallax_texcoord));
+    normal = normalize(tbn * normal);
 
     positions           = world_pos;
     normals             = normal;
     albedo_specular.rgb = diffuse_tex_color.rgb;
-    albedo_specular.a   = texture(m_texture_specular, parallax_texcoord).r;
+    albedo_specular.a   = MATERIAL_TEXTURE(m_texture_specular, parallax_texcoord).r;
 }
\ No newline at end of file
@@ -0,0 +1,25 @@
+#version 460 core
+
+in vec2 texcoord;
+in vec3 normal;
+
+uniform float alpha_cutoff;
+
+layout(binding = 0) uniform sampler2D m_texture_diffuse;
+
+layout (location = 0) out vec4 albedo;
+layout (location = 1) out vec4 normal_depth;
+
+void main()
+{
+    vec4 diffuse_tex_color = texture(m_texture_diffuse, texcoord);
+
+    if(diffuse_tex_color.a < alpha_cutoff)
+    {
+        discard;
+    }
+
+    // Alpha marks the covered texels, the depth is used to reconstruct the positions of the billboard texels
+    albedo       = vec4(diffuse_tex_color.rgb, 1.0f);
+    normal_depth = vec4(normalize(normal) * 0.5f + 0.5f, gl_FragCoord.z);
+}
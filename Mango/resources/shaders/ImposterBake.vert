@@ -0,0 +1,18 @@
+#version 460 core
+
+layout(location = 0) in vec3 a_position;
+layout(location = 1) in vec2 a_texcoord;
+layout(location = 2) in vec3 a_normal;
+
+out vec2 texcoord;
+out vec3 normal;
+
+uniform mat4 view_projection;
+
+void main()
+{
+    texcoord = a_texcoord;
+    normal   = a_normal;
+
+    gl_Position = view_projection * vec4(a_position, 1.0f);
+}
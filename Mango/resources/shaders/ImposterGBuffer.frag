@@ -0,0 +1,37 @@
+#version 460 core
+
+in vec2 texcoord;
+in vec3 object_pos;
+
+flat in vec3 frame_dir;
+flat in mat4 model;
+flat in mat3 normal_matrix;
+
+uniform vec4 bounds;
+
+layout(binding = 0) uniform sampler2D imposter_albedo;
+layout(binding = 1) uniform sampler2D imposter_normal_depth;
+
+layout (location = 0) out vec3 positions;
+layout (location = 1) out vec3 normals;
+layout (location = 2) out vec4 albedo_specular;
+
+void main()
+{
+    vec4 albedo = texture(imposter_albedo, texcoord);
+
+    if(albedo.a < 0.5f)
+    {
+        discard;
+    }
+
+    vec4 normal_depth = texture(imposter_normal_depth, texcoord);
+
+    // The frame was captured by an orthographic camera on the bounding sphere, looking at its center with the far plane at its diameter
+    vec3 position = object_pos + frame_dir * bounds.w * (1.0f - 2.0f * normal_depth.a);
+
+    positions           = (model * vec4(position, 1.0f)).xyz;
+    normals             = normalize(normal_matrix * (normal_depth.rgb * 2.0f - 1.0f));
+    albedo_specular.rgb = albedo.rgb;
+    albedo_specular.a   = 0.0f; // the specular isn't baked, the distant props are lit diffuse only
+}
@@ -0,0 +1,41 @@
+#version 460 core
+
+layout(location = 0) in vec2 a_corner;
+layout(location = 4) in mat4 a_model;
+
+out vec2 texcoord;
+out vec3 object_pos;
+
+flat out vec3 frame_dir;
+flat out mat4 model;
+flat out mat3 normal_matrix;
+
+uniform mat4  view_projection;
+uniform vec3  cam_pos;
+uniform vec4  bounds; // object space bounding sphere of the mesh
+uniform float frames; // the atlas is a grid of frames x frames views
+
+#include "Imposter.glh"
+
+void main()
+{
+    model         = a_model;
+    normal_matrix = transpose(inverse(mat3(a_model)));
+
+    // Pick the frame captured from the direction closest to the camera
+    vec3 world_center = (a_model * vec4(bounds.xyz, 1.0f)).xyz;
+    vec3 view_dir     = normalize(inverse(mat3(a_model)) * (cam_pos - world_center));
+
+    vec2 cell = clamp(floor((octahedronEncode(view_dir) * 0.5f + 0.5f) * frames), 0.0f, frames - 1.0f);
+    frame_dir = octahedronDecode((cell + 0.5f) / frames * 2.0f - 1.0f);
+
+    // Same basis as the baking camera, so the billboard matches the frame
+    vec3 up    = abs(frame_dir.y) > 0.99f ? vec3(0.0f, 0.0f, 1.0f) : vec3(0.0f, 1.0f, 0.0f);
+    vec3 right = normalize(cross(up, frame_dir));
+         up    = cross(frame_dir, right);
+
+    object_pos = bounds.xyz + (right * a_corner.x + up * a_corner.y) * bounds.w;
+    texcoord   = (cell + a_corner * 0.5f + 0.5f) / frames;
+
+    gl_Position = view_projection * a_model * vec4(object_pos, 1.0f);
+}
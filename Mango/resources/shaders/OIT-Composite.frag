@@ -0,0 +1,32 @@
+#version 450
+
+out vec4 fragColor;
+
+layout(binding = 0) uniform sampler2D accumulationTexture;
+layout(binding = 1) uniform sampler2D revealageTexture;
+
+void main()
+{
+    // Both targets share the scaled viewport with the scene, so fetch the texels directly
+    ivec2 coords    = ivec2(gl_FragCoord.xy);
+    float revealage = texelFetch(revealageTexture, coords, 0).r;
+
+    // Nothing transparent was drawn here
+    if (revealage >= 1.0f)
+    {
+        discard;
+    }
+
+    vec4 accumulation = texelFetch(accumulationTexture, coords, 0);
+
+    // Avoid overflow of the 16-bit float accumulation
+    if (isinf(max(max(abs(accumulation.r), abs(accumulation.g)), abs(accumulation.b))))
+    {
+        accumulation.rgb = vec3(accumulation.a);
+    }
+
+    vec3 averageColor = accumulation.rgb / max(accumulation.a, 1e-5f);
+
+    // Blended with glBlendFunc(GL_ONE_MINUS_SRC_ALPHA, GL_SRC_ALPHA)
+    fragColor = vec4(averageColor, revealage);
+}
@@ -0,0 +1,96 @@
+#version 460 core
+
+layout(location = 0) in vec2 texcoord;
+layout(location = 0) out vec4 frag_color;
+
+layout(binding = 0) uniform samplerCube source; // captured faces with their box filtered mips
+
+uniform int   face;              // GL_TEXTURE_CUBE_MAP_POSITIVE_X + face
+uniform float roughness;         // of the prefiltered mip
+uniform float source_resolution; // size of a face of the mip 0
+
+const uint  SAMPLES_COUNT = 32u;
+const float PI            = 3.14159265359f;
+
+vec3 faceDirection(vec2 uv)
+{
+    vec2 st = uv * 2.0f - 1.0f;
+
+    switch (face)
+    {
+        case 0:  return vec3( 1.0f,  -st.y, -st.x);
+        case 1:  return vec3(-1.0f,  -st.y,  st.x);
+        case 2:  return vec3( st.x,   1.0f,  st.y);
+        case 3:  return vec3( st.x,  -1.0f, -st.y);
+        case 4:  return vec3( st.x,  -st.y,  1.0f);
+        default: return vec3(-st.x,  -st.y, -1.0f);
+    }
+}
+
+vec2 hammersley(uint i)
+{
+    uint bits = i;
+    bits = (bits << 16u) | (bits >> 16u);
+    bits = ((bits & 0x55555555u) << 1u) | ((bits & 0xAAAAAAAAu) >> 1u);
+    bits = ((bits & 0x33333333u) << 2u) | ((bits & 0xCCCCCCCCu) >> 2u);
+    bits = ((bits & 0x0F0F0F0Fu) << 4u) | ((bits & 0xF0F0F0F0u) >> 4u);
+    bits = ((bits & 0x00FF00FFu) << 8u) | ((bits & 0xFF00FF00u) >> 8u);
+
+    return vec2(float(i) / float(SAMPLES_COUNT), float(bits) * 2.3283064365386963e-10f);
+}
+
+// Half vector around the normal, distributed by the GGX NDF
+vec3 importanceSampleGGX(vec2 xi, vec3 n, float alpha)
+{
+    float phi      = 2.0f * PI * xi.x;
+    float cosTheta = sqrt((1.0f - xi.y) / (1.0f + (alpha * alpha - 1.0f) * xi.y));
+    float sinTheta = sqrt(1.0f - cosTheta * cosTheta);
+
+    vec3 up        = abs(n.z) < 0.999f ? vec3(0.0f, 0.0f, 1.0f) : vec3(1.0f, 0.0f, 0.0f);
+    vec3 tangent   = normalize(cross(up, n));
+    vec3 bitangent = cross(n, tangent);
+
+    return normalize(tangent * (sinTheta * cos(phi)) + bitangent * (sinTheta * sin(phi)) + n * cosTheta);
+}
+
+float distributionGGX(float nDotH, float alpha)
+{
+    float alpha2 = alpha * alpha;
+    float d      = nDotH * nDotH * (alpha2 - 1.0f) + 1.0f;
+
+    return alpha2 / (PI * d * d);
+}
+
+void main()
+{
+    /* The view and the reflection are the normal (split sum approximation) */
+    vec3  n     = normalize(faceDirection(texcoord));
+    float alpha = max(roughness * roughness, 0.0001f);
+
+    // Solid angle of a texel of the mip 0, the samples read the mip with the texels as large as their part of the lobe
+    float texelSolidAngle = 4.0f * PI / (6.0f * source_resolution * source_resolution);
+
+    vec3  color  = vec3(0.0f);
+    float weight = 0.0f;
+
+    for (uint i = 0u; i < SAMPLES_COUNT; ++i)
+    {
+        vec3 h = importanceSampleGGX(hammersley(i), n, alpha);
+        vec3 l = normalize(2.0f * dot(n, h) * h - n);
+
+        float nDotL = dot(n, l);
+        if (nDotL > 0.0f)
+        {
+            float nDotH = max(dot(n, h), 0.0f);
+            float pdf   = distributionGGX(nDotH, alpha) * 0.25f;
+
+            float sampleSolidAngle = 1.0f / (float(SAMPLES_COUNT) * pdf + 0.0001f);
+            float lod              = max(0.5f * log2(sampleSolidAngle / texelSolidAngle) + 1.0f, 0.0f);
+
+            color  += textureLod(source, l, lod).rgb * nDotL;
+            weight += nDotL;
+        }
+    }
+
+    frag_color = vec4(color / max(weight, 0.0001f), 1.0f);
+}
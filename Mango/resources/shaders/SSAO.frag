@@ -17,10 +17,12 @@ uniform float radius;
 uniform float bias;
 uniform float power;
 
-subroutine float ssaoRendering();
-layout(location = 0) subroutine uniform ssaoRendering ssao_func;
+// Fraction of the G-buffer that holds the image (dynamic resolution), shared with FSQ.vert
+uniform vec2 uv_scale = vec2(1.0f);
 
-layout(index = 0) subroutine(ssaoRendering) float calcSSAO()
+#pragma multi_compile _ SSAO_BLUR
+
+float calcSSAO()
 {
     vec2 gbuffer_size   = textureSize(gbuffer_positions, 0);
     vec2 noise_tex_size = textureSize(noise_texture, 0);
@@ -47,6 +49,7 @@ layout(index = 0) subroutine(ssaoRendering) float calcSSAO()
         offset = projection * offset; // from view to clip-space
         offset.xyz /= offset.w; // perspective divide
         offset.xyz = offset.xyz * 0.5 + 0.5; // transform to range 0.0 - 1.0
+        offset.xy  = clamp(offset.xy, 0.0, 1.0) * uv_scale; // to the rendered sub-rect of the G-buffer
 
         // get sample depth
         float sample_depth = (view * texture(gbuffer_positions, offset.xy)).z; // get depth value of kernel sample
@@ -59,7 +62,7 @@ layout(index = 0) subroutine(ssaoRendering) float calcSSAO()
     return pow(1.0 - (occlusion / kernel_size), power);
 }
 
-layout(index = 1) subroutine(ssaoRendering) float blurSSAO()
+float blurSSAO()
 {
     vec2 texel_size = 1.0 / vec2(textureSize(src_texture, 0));
     float result = 0.0;
@@ -78,5 +81,9 @@ layout(index = 1) subroutine(ssaoRendering) float blurSSAO()
 
 void main()
 {
-    fragColor = ssao_func();
+#ifdef SSAO_BLUR
+    fragColor = blurSSAO();
+#else
+    fragColor = calcSSAO();
+#endif
 }
\ No newline at end of file
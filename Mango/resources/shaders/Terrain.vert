@@ -0,0 +1,88 @@
+#version 460 core
+
+layout(location = 0) in vec3 a_position; // [0, 1] over the node, the z is 1 for the vertices of the skirts
+
+const float GRID_SIZE      = 32.0f;
+const float TILE_SIZE      = 256.0f;
+const float OVERVIEW_SIZE  = 256.0f;
+
+struct TerrainNode
+{
+    vec4 node;   // world space corner x and z, size, depth of the skirts
+    vec4 morph;  // distances where the morph to the next level starts and ends
+    vec4 source; // world space corner x and z, size and the layer of the sampled tile, -1 for the overview
+};
+
+layout(std430, binding = 0) readonly buffer TerrainNodes
+{
+    TerrainNode nodes[];
+};
+
+out vec2 texcoord;
+out vec3 world_pos;
+out mat3 tbn;
+
+uniform mat4 g_view;
+uniform mat4 g_projection;
+uniform vec3 g_cam_pos;
+
+uniform vec2  terrain_height; // world height of the zero and the range of the samples
+uniform float texture_tiling;
+
+layout(binding = 9)  uniform sampler2D      overview_texture;
+layout(binding = 10) uniform sampler2DArray tiles_texture;
+
+float sampleHeight(vec2 xz, vec4 source)
+{
+    // The samples are at the edges of the covered area, not at the texel centers
+    vec2 uv = clamp((xz - source.xy) / source.z, 0.0f, 1.0f);
+
+    float height;
+    if (source.w < 0.0f)
+    {
+        height = textureLod(overview_texture, (uv * OVERVIEW_SIZE + 0.5f) / (OVERVIEW_SIZE + 1.0f), 0.0f).r;
+    }
+    else
+    {
+        height = textureLod(tiles_texture, vec3((uv * TILE_SIZE + 0.5f) / (TILE_SIZE + 1.0f), source.w), 0.0f).r;
+    }
+
+    return terrain_height.x + height * terrain_height.y;
+}
+
+void main()
+{
+    TerrainNode node = nodes[gl_BaseInstance + gl_InstanceID];
+
+    vec2 grid_pos = a_position.xy;
+    vec2 xz       = node.node.xy + grid_pos * node.node.z;
+
+    /* Morph the odd vertices into the ones of the next level towards the end of the range */
+    float distance_to_camera = distance(g_cam_pos, vec3(xz.x, sampleHeight(xz, node.source), xz.y));
+    float morph              = clamp((distance_to_camera - node.morph.x) / max(node.morph.y - node.morph.x, 0.0001f), 0.0f, 1.0f);
+
+    grid_pos -= fract(grid_pos * GRID_SIZE * 0.5f) * 2.0f / GRID_SIZE * morph;
+    xz        = node.node.xy + grid_pos * node.node.z;
+
+    world_pos = vec3(xz.x, sampleHeight(xz, node.source) - a_position.z * node.node.w, xz.y);
+    texcoord  = xz / texture_tiling;
+
+    gl_Position = g_projection * g_view * vec4(world_pos, 1.0f);
+
+    /* Normal from the central differences of the sampled source */
+    float texel_size = node.source.z / (node.source.w < 0.0f ? OVERVIEW_SIZE : TILE_SIZE);
+
+    float left  = sampleHeight(xz - vec2(texel_size, 0.0f), node.source);
+    float right = sampleHeight(xz + vec2(texel_size, 0.0f), node.source);
+    float back  = sampleHeight(xz - vec2(0.0f, texel_size), node.source);
+    float front = sampleHeight(xz + vec2(0.0f, texel_size), node.source);
+
+    vec3 normal  = normalize(vec3(left - right, 2.0f * texel_size, back - front));
+    vec3 tangent = normalize(vec3(2.0f * texel_size, right - left, 0.0f));
+
+    /* Gram-Schmidt process */
+    tangent = normalize(tangent - dot(tangent, normal) * normal);
+
+    vec3 bitangent = cross(tangent, normal);
+    tbn = mat3(tangent, bitangent, normal);
+}
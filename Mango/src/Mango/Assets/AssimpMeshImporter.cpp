@@ -2,27 +2,264 @@
 
 #include "AssimpMeshImporter.h"
 #include "Mango/Core/AssetManager.h"
+#include "Mango/Core/Jobs.h"
 #include "Mango/Core/Services.h"
+#include "Mango/Project/Project.h"
+#include "Mango/Utils/Hash.h"
 
 #include <assimp/Importer.hpp>
 #include <assimp/postprocess.h>
+#include <glm/gtc/matrix_access.hpp>
+
+#include <fstream>
 
 namespace mango
 {
+    namespace
+    {
+        // Keys around the time and the interpolation factor between them
+        template<typename Key>
+        float findKeys(const Key* keys, uint32_t count, double ticks, uint32_t& index, uint32_t& next)
+        {
+            auto it = std::upper_bound(keys, keys + count, ticks, [](double t, const Key& key) { return t < key.mTime; });
+
+            index = it == keys ? 0 : uint32_t(it - keys) - 1;
+            next  = glm::min(index + 1, count - 1);
+
+            double delta = keys[next].mTime - keys[index].mTime;
+            return delta > 0.0 ? float(glm::clamp((ticks - keys[index].mTime) / delta, 0.0, 1.0)) : 0.0f;
+        }
+
+        const uint32_t IMPORT_FLAGS = aiProcess_Triangulate              |
+                                      aiProcess_GenSmoothNormals         |
+                                      aiProcess_CalcTangentSpace         |
+                                      aiProcess_PreTransformVertices     |
+                                      aiProcess_RemoveRedundantMaterials |
+                                      aiProcess_ImproveCacheLocality     |
+                                      aiProcess_JoinIdenticalVertices    |
+                                      aiProcess_GenBoundingBoxes;
+
+        const uint32_t COOKED_MAGIC   = 0x534D474D; // "MGMS"
+        const uint32_t COOKED_VERSION = 2;
+
+        // The mapped file starts at a page boundary, so the sections are aligned in memory too
+        const uint64_t SECTION_ALIGNMENT = 64;
+
+        struct CookedHeader
+        {
+            uint32_t  magic           = COOKED_MAGIC;
+            uint32_t  version         = COOKED_VERSION;
+            uint64_t  cookedKey       = 0;
+            uint32_t  verticesCount   = 0;
+            uint32_t  indicesCount    = 0;
+            uint32_t  submeshesCount  = 0;
+            uint32_t  meshletsCount   = 0;
+            uint32_t  materialsCount  = 0;
+            uint32_t  hasTangents     = 0;
+            float     unitScale       = 1.0f;
+            float     boundsRadius    = 0.0f;
+            glm::vec3 boundsMin       = glm::vec3(0.0f);
+            glm::vec3 boundsMax       = glm::vec3(0.0f);
+            glm::vec3 boundsCenter    = glm::vec3(0.0f);
+            float     uvDensity       = 0.0f;
+            uint64_t  verticesOffset  = 0; // the positions, texcoords, normals and tangents one after another, as in the VBO
+            uint64_t  indicesOffset   = 0;
+            uint64_t  submeshesOffset = 0;
+            uint64_t  meshletsOffset  = 0;
+            uint64_t  materialsOffset = 0;
+            uint64_t  fileSize        = 0;
+        };
+
+        uint64_t cookedVertexSize(bool hasTangents)
+        {
+            return sizeof(glm::vec3) + sizeof(glm::vec2) + sizeof(glm::vec3) + (hasTangents ? sizeof(glm::vec3) : 0);
+        }
+
+        // Bounds checked reads of the variable sized records of the cooked file
+        struct CookedReader
+        {
+            const uint8_t* cursor;
+            const uint8_t* end;
+
+            template<typename T>
+            bool read(T& value)
+            {
+                if (uint64_t(end - cursor) < sizeof(T))
+                {
+                    return false;
+                }
+
+                std::memcpy(&value, cursor, sizeof(T));
+                cursor += sizeof(T);
+
+                return true;
+            }
+
+            bool read(std::string& value)
+            {
+                uint32_t size;
+                if (!read(size) || uint64_t(end - cursor) < size)
+                {
+                    return false;
+                }
+
+                value.assign(reinterpret_cast<const char*>(cursor), size);
+                cursor += size;
+
+                return true;
+            }
+
+            bool read(std::vector<uint8_t>& value)
+            {
+                uint32_t size;
+                if (!read(size) || uint64_t(end - cursor) < size)
+                {
+                    return false;
+                }
+
+                value.assign(cursor, cursor + size);
+                cursor += size;
+
+                return true;
+            }
+        };
+    }
+
     ref<Mesh> AssimpMeshImporter::load(const std::string& filename)
     {
         MG_PROFILE_ZONE_SCOPED;
 
+        ImportedMesh imported;
+        if (!import(filename, imported))
+        {
+            return nullptr;
+        }
+
         ref<Mesh> loadedMesh = createRef<Mesh>(filename);
 
+        if (!finishLoad(loadedMesh, imported, false))
+        {
+            return nullptr;
+        }
+
+        return loadedMesh;
+    }
+
+    bool AssimpMeshImporter::import(const std::string& filename, ImportedMesh& imported)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
         auto filepath = VFI::getFilepath(filename);
 
+        imported.parentDirectory = std::filesystem::path(filename).parent_path();
+
+        /* The cooked mesh is keyed by the content of the source and the importer flags */
+        MappedFile source;
+        if (source.open(filepath))
+        {
+            std::string hashedBytes = std::to_string(fnvHash1a64(reinterpret_cast<const char*>(source.getData()), source.getSize())) + "|" + std::to_string(IMPORT_FLAGS);
+
+            imported.cookedKey  = fnvHash1a64(hashedBytes.data(), hashedBytes.size());
+            imported.cookedPath = getCookedPath(filename);
+
+            source.close();
+        }
+
+        if (!imported.cookedPath.empty() && readCooked(imported.cookedPath, imported.cookedKey, imported))
+        {
+            return true;
+        }
+
         /* Load model */
         Assimp::Importer importer;
+        const aiScene* scene = importer.ReadFile(filepath.string(), IMPORT_FLAGS);
+
+        if (!scene || scene->mFlags == AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
+        {
+            MG_CORE_ERROR("AssimpMeshImporter: error while loading mesh {}\n Error: {}", filepath.string(), importer.GetErrorString());
+            return false;
+        }
+
+        parseScene(scene, imported);
+        return true;
+    }
+
+    bool AssimpMeshImporter::finishLoad(ref<Mesh>& mesh, ImportedMesh& imported, bool asyncTextures)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        // The placeholder of the asynchronous load
+        if (mesh->m_vaoName)
+        {
+            mesh->release();
+        }
+
+        mesh->m_submeshes  = imported.submeshes;
+        mesh->m_unitScale  = imported.unitScale;
+        mesh->m_contentKey = imported.cookedKey; // 0 if the source can't be read, then the vertex data is hashed
+
+        /* Load materials. */
+        if (!createMaterials(mesh, imported, asyncTextures))
+        {
+            MG_CORE_ERROR("AssimpMeshImporter: error while loading mesh {}\n Error: Could not load the materials.", (imported.parentDirectory / mesh->getName()).string());
+            return false;
+        }
+
+        /* Populate buffers on the GPU with the model's data. */
+        if (imported.cookedFile)
+        {
+            mesh->createBuffers(imported.cookedVertices, imported.verticesCount, imported.hasTangents, imported.cookedIndices, imported.indicesCount);
+
+            mesh->m_meshlets     = imported.meshlets;
+            mesh->m_boundsMin    = imported.boundsMin;
+            mesh->m_boundsMax    = imported.boundsMax;
+            mesh->m_boundsCenter = imported.boundsCenter;
+            mesh->m_boundsRadius = imported.boundsRadius;
+            mesh->m_uvDensity    = imported.uvDensity;
+
+            imported.cookedFile = nullptr;
+            return true;
+        }
+
+        mesh->createBuffers(imported.vertexData);
+        mesh->buildMeshlets(imported.vertexData);
+
+        if (!imported.cookedPath.empty())
+        {
+            // The vertex data is moved to the cooking job, which writes the file on the worker threads
+            auto cooked = createRef<ImportedMesh>();
+
+            cooked->submeshes    = mesh->m_submeshes;
+            cooked->meshlets     = mesh->m_meshlets;
+            cooked->materials    = imported.materials;
+            cooked->vertexData   = std::move(imported.vertexData);
+            cooked->unitScale    = imported.unitScale;
+            cooked->boundsMin    = mesh->m_boundsMin;
+            cooked->boundsMax    = mesh->m_boundsMax;
+            cooked->boundsCenter = mesh->m_boundsCenter;
+            cooked->boundsRadius = mesh->m_boundsRadius;
+            cooked->uvDensity    = mesh->m_uvDensity;
+            cooked->cookedPath   = imported.cookedPath;
+            cooked->cookedKey    = imported.cookedKey;
+
+            Jobs::executor.silent_async([cooked]() { cook(*cooked); });
+        }
+
+        return true;
+    }
+
+    ref<VertexAnimation> AssimpMeshImporter::loadVertexAnimation(const std::string& filename)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        auto filepath = VFI::getFilepath(filename);
+
+        /* Load model, the vertices are kept in the bind pose of their meshes */
+        Assimp::Importer importer;
         const aiScene* scene = importer.ReadFile(filepath.string(), aiProcess_Triangulate              |
                                                                     aiProcess_GenSmoothNormals         |
                                                                     aiProcess_CalcTangentSpace         |
-                                                                    aiProcess_PreTransformVertices     |
+                                                                    aiProcess_LimitBoneWeights         |
                                                                     aiProcess_RemoveRedundantMaterials |
                                                                     aiProcess_ImproveCacheLocality     |
                                                                     aiProcess_JoinIdenticalVertices    |
@@ -34,35 +271,74 @@ namespace mango
             return nullptr;
         }
 
-        auto parentDirectory = std::filesystem::path(filename).parent_path();
+        if (!scene->HasAnimations())
+        {
+            MG_CORE_ERROR("AssimpMeshImporter: mesh {} has no animations to bake.", filepath.string());
+            return nullptr;
+        }
+
+        auto animation    = createRef<VertexAnimation>(filename);
+        animation->m_mesh = createRef<Mesh>(filename);
 
-        if (!parseScene(loadedMesh, scene, parentDirectory))
+        ImportedMesh imported;
+        imported.parentDirectory = std::filesystem::path(filename).parent_path();
+
+        parseScene(scene, imported);
+
+        if (!finishLoad(animation->m_mesh, imported, false))
         {
             return nullptr;
         }
 
-        return loadedMesh;
+        // The bounds of the bones need the vertices
+        Skeleton skeleton;
+        loadSkeleton(animation->m_mesh, scene, imported.vertexData, skeleton);
+
+        if (!bakeClips(animation, scene, skeleton))
+        {
+            return nullptr;
+        }
+
+        /* Bone weights and indices */
+        const GLsizeiptr attributesSize = GLsizeiptr(skeleton.weights.size() * sizeof(glm::vec4));
+
+        glCreateBuffers     (1, &animation->m_boneWeightsVbo);
+        glNamedBufferStorage(animation->m_boneWeightsVbo, attributesSize, skeleton.weights.data(), 0);
+
+        glCreateBuffers     (1, &animation->m_boneIndicesVbo);
+        glNamedBufferStorage(animation->m_boneIndicesVbo, attributesSize, skeleton.indices.data(), 0);
+
+        MG_RENDER_STATS_ADD(bytesUploaded, 2 * attributesSize);
+
+        animation->m_mesh->addAttributeBuffer(4, 4, 4, GL_FLOAT, animation->m_boneWeightsVbo, sizeof(glm::vec4));
+        animation->m_mesh->addAttributeBuffer(5, 5, 4, GL_FLOAT, animation->m_boneIndicesVbo, sizeof(glm::vec4));
+
+        MG_CORE_INFO("AssimpMeshImporter: baked {} clips ({} frames, {} bones) of {}.", animation->m_clips.size(), animation->m_framesCount, animation->m_bonesCount, filename);
+
+        return animation;
     }
 
-    bool AssimpMeshImporter::parseScene(ref<Mesh>& mesh, const aiScene* scene, const std::filesystem::path& parentDirectory)
+    void AssimpMeshImporter::parseScene(const aiScene* scene, ImportedMesh& imported)
     {
         MG_PROFILE_ZONE_SCOPED;
-        mesh->m_submeshes.resize(scene->mNumMeshes);
+        auto& submeshes  = imported.submeshes;
+        auto& vertexData = imported.vertexData;
 
-        VertexData vertexData;
-        uint32_t   verticesCount = 0;
-        uint32_t   indicesCount  = 0;
+        submeshes.resize(scene->mNumMeshes);
+
+        uint32_t verticesCount = 0;
+        uint32_t indicesCount  = 0;
 
         /* Count the number of vertices and indices. */
-        for (uint32_t i = 0; i < mesh->m_submeshes.size(); ++i)
+        for (uint32_t i = 0; i < submeshes.size(); ++i)
         {
-            mesh->m_submeshes[i].materialIndex = scene->mNumMaterials > 0 ? scene->mMeshes[i]->mMaterialIndex : 0;
-            mesh->m_submeshes[i].indicesCount  = scene->mMeshes[i]->mNumFaces * 3;
-            mesh->m_submeshes[i].baseVertex    = verticesCount;
-            mesh->m_submeshes[i].baseIndex     = indicesCount;
+            submeshes[i].materialIndex = scene->mNumMaterials > 0 ? scene->mMeshes[i]->mMaterialIndex : 0;
+            submeshes[i].indicesCount  = scene->mMeshes[i]->mNumFaces * 3;
+            submeshes[i].baseVertex    = verticesCount;
+            submeshes[i].baseIndex     = indicesCount;
 
             verticesCount += scene->mMeshes[i]->mNumVertices;
-            indicesCount  += mesh->m_submeshes[i].indicesCount;
+            indicesCount  += submeshes[i].indicesCount;
         }
 
         /* Reserve space in the vectors for the vertex attributes and indices. */
@@ -76,7 +352,7 @@ namespace mango
         glm::vec3 min = glm::vec3(std::numeric_limits<float>::max());
         glm::vec3 max = -min;
 
-        for (uint32_t i = 0; i < mesh->m_submeshes.size(); ++i)
+        for (uint32_t i = 0; i < submeshes.size(); ++i)
         {
             auto mesh = scene->mMeshes[i];
             loadMeshPart(mesh, vertexData);
@@ -85,19 +361,9 @@ namespace mango
             max = glm::max(max, vec3_cast(mesh->mAABB.mMax));
         }
 
-        mesh->m_unitScale = 1.0f / glm::compMax(max - min);
-
-        /* Load materials. */
-        if (!loadMaterials(mesh, scene, parentDirectory))
-        {
-            MG_CORE_ERROR("AssimpMeshImporter: error while loading mesh {}\n Error: Could not load the materials.", (parentDirectory / mesh->getName()).string());
-            return false;
-        }
-
-        /* Populate buffers on the GPU with the model's data. */
-        mesh->createBuffers(vertexData);
+        imported.unitScale = 1.0f / glm::compMax(max - min);
 
-        return true;
+        readMaterials(scene, imported);
     }
 
     void AssimpMeshImporter::loadMeshPart(const aiMesh* mesh, VertexData& vertexData)
@@ -128,43 +394,35 @@ namespace mango
         }
     }
 
-    bool AssimpMeshImporter::loadMaterials(ref<Mesh>& mesh, const aiScene* scene, const std::filesystem::path& parentDirectory)
+    void AssimpMeshImporter::readMaterials(const aiScene* scene, ImportedMesh& imported)
     {
         MG_PROFILE_ZONE_SCOPED;
-        bool ret = true;
 
         if (!scene->HasMaterials())
         {
-            return ret;
+            return;
         }
 
-        if (!mesh->m_materialTable.empty()) mesh->m_materialTable.clear();
-
-        mesh->m_materialTable.resize(scene->mNumMaterials);
+        imported.materials.resize(scene->mNumMaterials);
 
         for (uint32_t i = 0; i < scene->mNumMaterials; ++i)
         {
-            auto        pMaterial    = scene->mMaterials[i];
-            std::string materialName = pMaterial->GetName().C_Str();
+            auto  pMaterial        = scene->mMaterials[i];
+            auto& importedMaterial = imported.materials[i];
 
-            if (materialName.empty())
-            {
-                materialName = std::filesystem::path(mesh->getName()).stem().string() + "_" + std::to_string(i+1);
-            }
-
-            auto mangoMaterial = AssetManager::createMaterial(materialName);
+            importedMaterial.name = pMaterial->GetName().C_Str();
 
             // NOTE(TG): Leaving parts of code commented as we'll need it when moving to PBR workflow
             
-            //ret |= loadMaterialTextures(scene, pMaterial, aiTextureType_BASE_COLOR,        Material::TextureType::ALBEDO,    dir);
-            ret |= loadMaterialTextures(scene, pMaterial, mangoMaterial, aiTextureType_DIFFUSE,      Material::TextureType::DIFFUSE,      parentDirectory);
-            ret |= loadMaterialTextures(scene, pMaterial, mangoMaterial, aiTextureType_SPECULAR,     Material::TextureType::SPECULAR,     parentDirectory);
-            ret |= loadMaterialTextures(scene, pMaterial, mangoMaterial, aiTextureType_NORMALS,      Material::TextureType::NORMAL,       parentDirectory);
-            ret |= loadMaterialTextures(scene, pMaterial, mangoMaterial, aiTextureType_EMISSIVE,     Material::TextureType::EMISSION,     parentDirectory);
-            ret |= loadMaterialTextures(scene, pMaterial, mangoMaterial, aiTextureType_DISPLACEMENT, Material::TextureType::DISPLACEMENT, parentDirectory);
-            //ret |= loadMaterialTextures(scene, pMaterial, aiTextureType_AMBIENT_OCCLUSION, Material::TextureType::AO,        dir);
-            //ret |= loadMaterialTextures(scene, pMaterial, aiTextureType_DIFFUSE_ROUGHNESS, Material::TextureType::ROUGHNESS, dir);
-            //ret |= loadMaterialTextures(scene, pMaterial, aiTextureType_METALNESS,         Material::TextureType::METALLIC,  dir);
+            //readMaterialTexture(scene, pMaterial, aiTextureType_BASE_COLOR,        Material::TextureType::ALBEDO,    importedMaterial);
+            readMaterialTexture(scene, pMaterial, aiTextureType_DIFFUSE,      Material::TextureType::DIFFUSE,      importedMaterial);
+            readMaterialTexture(scene, pMaterial, aiTextureType_SPECULAR,     Material::TextureType::SPECULAR,     importedMaterial);
+            readMaterialTexture(scene, pMaterial, aiTextureType_NORMALS,      Material::TextureType::NORMAL,       importedMaterial);
+            readMaterialTexture(scene, pMaterial, aiTextureType_EMISSIVE,     Material::TextureType::EMISSION,     importedMaterial);
+            readMaterialTexture(scene, pMaterial, aiTextureType_DISPLACEMENT, Material::TextureType::DISPLACEMENT, importedMaterial);
+            //readMaterialTexture(scene, pMaterial, aiTextureType_AMBIENT_OCCLUSION, Material::TextureType::AO,        importedMaterial);
+            //readMaterialTexture(scene, pMaterial, aiTextureType_DIFFUSE_ROUGHNESS, Material::TextureType::ROUGHNESS, importedMaterial);
+            //readMaterialTexture(scene, pMaterial, aiTextureType_METALNESS,         Material::TextureType::METALLIC,  importedMaterial);
 
             /* Load material parameters */
             // aiColor3D colorRgb;
@@ -194,30 +452,25 @@ namespace mango
 
             if (AI_SUCCESS == pMaterial->Get(AI_MATKEY_SHININESS, value))
             {
-                mangoMaterial->addFloat("specular_power", value);
+                importedMaterial.floats.emplace_back("specular_power", value);
             }
             if (AI_SUCCESS == pMaterial->Get(AI_MATKEY_SHININESS_STRENGTH, value))
             {
-                mangoMaterial->addFloat("specular_intensity", value);
+                importedMaterial.floats.emplace_back("specular_intensity", value);
             }
             if (AI_SUCCESS == pMaterial->Get(AI_MATKEY_OPACITY, value))
             {
                 if (value != 1.0f)
                 {
-                    mangoMaterial->setRenderQueue(Material::RenderQueue::RQ_TRANSPARENT);
-                    mangoMaterial->addFloat("alpha", value);
+                    importedMaterial.isTransparent = true;
+                    importedMaterial.floats.emplace_back("alpha", value);
                 }
             }
-
-            mesh->m_materialTable[i] = mangoMaterial;
         }
-
-        return ret;
     }
 
-    bool AssimpMeshImporter::loadMaterialTextures(const aiScene* scene, const aiMaterial* material, ref<Material>& mangoMaterial, aiTextureType aiType, Material::TextureType textureType, const std::filesystem::path& parentDirectory)
+    void AssimpMeshImporter::readMaterialTexture(const aiScene* scene, const aiMaterial* material, aiTextureType aiType, Material::TextureType textureType, ImportedMaterial& importedMaterial)
     {
-        MG_PROFILE_ZONE_SCOPED;
         if (material->GetTextureCount(aiType) > 0)
         {
             aiString path;
@@ -226,53 +479,649 @@ namespace mango
             // Only one texture of a given type is being loaded
             if (material->GetTexture(aiType, 0, &path, NULL, NULL, NULL, NULL, textureMapMode) == AI_SUCCESS)
             {
-                bool isSrgb = (aiType == aiTextureType_DIFFUSE) || (aiType == aiTextureType_EMISSIVE) || (aiType == aiTextureType_BASE_COLOR);
-
-                      ref<Texture> texture    = createRef<Texture>();
-                const aiTexture*   paiTexture = scene->GetEmbeddedTexture(path.C_Str());
+                ImportedTexture importedTexture;
+                importedTexture.type     = textureType;
+                importedTexture.isSrgb   = (aiType == aiTextureType_DIFFUSE) || (aiType == aiTextureType_EMISSIVE) || (aiType == aiTextureType_BASE_COLOR);
+                importedTexture.isRepeat = textureMapMode[0] == aiTextureMapMode_Wrap;
 
-                if (paiTexture)
+                if (const aiTexture* paiTexture = scene->GetEmbeddedTexture(path.C_Str()))
                 {
-                    // Load embedded
+                    // The file data of the embedded texture, it's decoded when the material is created
                     uint32_t dataSize = paiTexture->mHeight > 0 ? paiTexture->mWidth * paiTexture->mHeight : paiTexture->mWidth;
-                    
-                    if (texture->createTexture2dFromMemory(reinterpret_cast<unsigned char*>(paiTexture->pcData), dataSize, isSrgb))
-                    {
-                        mangoMaterial->addTexture(textureType, texture);
+                    auto     data     = reinterpret_cast<const uint8_t*>(paiTexture->pcData);
 
-                        if (textureMapMode[0] == aiTextureMapMode_Wrap)
-                        {
-                            texture->setWraping(TextureWrapingCoordinate::S, TextureWrapingParam::REPEAT);
-                            texture->setWraping(TextureWrapingCoordinate::T, TextureWrapingParam::REPEAT);
-                        }
-                    }
-                    else
-                    {
-                        MG_CORE_ERROR("AssimpMeshImporter: error while loading embedded texture for the model {}.", path.C_Str());
-                        return false;
-                    }
+                    importedTexture.embedded.assign(data, data + dataSize);
                 }
                 else
                 {
-                    // Load from file
-                    auto fullPath = parentDirectory / path.C_Str();
-                    if (!texture->createTexture2d(fullPath.string(), isSrgb))
-                    {
-                        MG_CORE_ERROR("AssimpMeshImporter: error while loading texture {}.", fullPath);
-                        return false;
-                    }
+                    importedTexture.path = path.C_Str();
+                }
 
-                    mangoMaterial->addTexture(textureType, texture);
+                importedMaterial.textures.push_back(std::move(importedTexture));
+            }
+        }
+    }
+
+    bool AssimpMeshImporter::createMaterials(ref<Mesh>& mesh, const ImportedMesh& imported, bool asyncTextures)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+        bool ret = true;
+
+        if (imported.materials.empty())
+        {
+            return ret;
+        }
+
+        if (!mesh->m_materialTable.empty()) mesh->m_materialTable.clear();
+
+        mesh->m_materialTable.resize(imported.materials.size());
+
+        for (uint32_t i = 0; i < imported.materials.size(); ++i)
+        {
+            auto&       importedMaterial = imported.materials[i];
+            std::string materialName     = importedMaterial.name;
+
+            if (materialName.empty())
+            {
+                materialName = std::filesystem::path(mesh->getName()).stem().string() + "_" + std::to_string(i+1);
+            }
+
+            auto mangoMaterial = AssetManager::createMaterial(materialName);
+
+            for (auto& importedTexture : importedMaterial.textures)
+            {
+                ret |= createMaterialTexture(mangoMaterial, importedTexture, imported.parentDirectory, asyncTextures);
+            }
+
+            for (auto& [uniformName, value] : importedMaterial.floats)
+            {
+                mangoMaterial->addFloat(uniformName, value);
+            }
+
+            if (importedMaterial.isTransparent)
+            {
+                mangoMaterial->setRenderQueue(Material::RenderQueue::RQ_TRANSPARENT);
+            }
+
+            mesh->m_materialTable[i] = mangoMaterial;
+        }
+
+        return ret;
+    }
+
+    bool AssimpMeshImporter::createMaterialTexture(ref<Material>& mangoMaterial, const ImportedTexture& importedTexture, const std::filesystem::path& parentDirectory, bool asyncTextures)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        ref<Texture> texture = createRef<Texture>();
+
+        if (!importedTexture.embedded.empty())
+        {
+            // Load embedded
+            if (!texture->createTexture2dFromMemory(const_cast<uint8_t*>(importedTexture.embedded.data()), importedTexture.embedded.size(), importedTexture.isSrgb))
+            {
+                MG_CORE_ERROR("AssimpMeshImporter: error while loading embedded texture for the model in {}.", parentDirectory.string());
+                return false;
+            }
+        }
+        else if (asyncTextures)
+        {
+            // The placeholder is replaced when the file is decoded, an error is only logged
+            auto fullPath = parentDirectory / importedTexture.path;
+            mangoMaterial->addTexture(importedTexture.type, AssetManager::createTexture2DAsync(fullPath.string(), importedTexture.isSrgb, 0));
+
+            return true;
+        }
+        else
+        {
+            // Load from file
+            auto fullPath = parentDirectory / importedTexture.path;
+            if (!texture->createTexture2d(fullPath.string(), importedTexture.isSrgb))
+            {
+                MG_CORE_ERROR("AssimpMeshImporter: error while loading texture {}.", fullPath);
+                return false;
+            }
+        }
+
+        mangoMaterial->addTexture(importedTexture.type, texture);
+
+        if (importedTexture.isRepeat)
+        {
+            texture->setWraping(TextureWrapingCoordinate::S, TextureWrapingParam::REPEAT);
+            texture->setWraping(TextureWrapingCoordinate::T, TextureWrapingParam::REPEAT);
+        }
+
+        return true;
+    }
+
+    std::filesystem::path AssimpMeshImporter::getCookedPath(const std::string& filename)
+    {
+        std::filesystem::path cacheDirectory;
 
-                    if (textureMapMode[0] == aiTextureMapMode_Wrap)
+        if (Project::getActive())
+        {
+            cacheDirectory = Project::getProjectDirectory() / "cache" / "meshes";
+        }
+        else if (auto writeDir = VFI::getWriteDir(); !writeDir.empty())
+        {
+            cacheDirectory = writeDir / "meshcache";
+        }
+        else
+        {
+            return {};
+        }
+
+        // Named after the source, the key in the header tells if it's still up to date
+        char cookedName[32];
+        snprintf(cookedName, sizeof(cookedName), "%016llx.mgmesh", (unsigned long long)fnvHash1a64(filename.data(), filename.size()));
+
+        return cacheDirectory / cookedName;
+    }
+
+    bool AssimpMeshImporter::readCooked(const std::filesystem::path& cookedPath, uint64_t cookedKey, ImportedMesh& imported)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        auto cookedFile = createRef<MappedFile>();
+        if (!cookedFile->open(cookedPath) || cookedFile->getSize() < sizeof(CookedHeader))
+        {
+            return false;
+        }
+
+        const uint8_t* data = cookedFile->getData();
+        const uint64_t size = cookedFile->getSize();
+
+        CookedHeader header;
+        std::memcpy(&header, data, sizeof(header));
+
+        const uint64_t verticesSize  = uint64_t(header.verticesCount)  * cookedVertexSize(header.hasTangents);
+        const uint64_t indicesSize   = uint64_t(header.indicesCount)   * sizeof(uint32_t);
+        const uint64_t submeshesSize = uint64_t(header.submeshesCount) * sizeof(Submesh);
+        const uint64_t meshletsSize  = uint64_t(header.meshletsCount)  * sizeof(Meshlet);
+
+        if (header.magic                            != COOKED_MAGIC   ||
+            header.version                          != COOKED_VERSION ||
+            header.cookedKey                        != cookedKey      ||
+            header.fileSize                         != size           ||
+            header.verticesOffset  + verticesSize   >  size           ||
+            header.indicesOffset   + indicesSize    >  size           ||
+            header.submeshesOffset + submeshesSize  >  size           ||
+            header.meshletsOffset  + meshletsSize   >  size           ||
+            header.materialsOffset                  >  size)
+        {
+            return false;
+        }
+
+        /* Materials */
+        CookedReader reader { data + header.materialsOffset, data + size };
+
+        std::vector<ImportedMaterial> materials(header.materialsCount);
+        for (auto& material : materials)
+        {
+            uint32_t texturesCount = 0, floatsCount = 0;
+            uint8_t  isTransparent = 0;
+
+            if (!reader.read(material.name) || !reader.read(texturesCount))
+            {
+                return false;
+            }
+
+            material.textures.resize(texturesCount);
+            for (auto& texture : material.textures)
+            {
+                uint32_t type     = 0;
+                uint8_t  isSrgb   = 0;
+                uint8_t  isRepeat = 0;
+
+                if (!reader.read(type) || !reader.read(isSrgb) || !reader.read(isRepeat) || !reader.read(texture.path) || !reader.read(texture.embedded))
+                {
+                    return false;
+                }
+
+                texture.type     = Material::TextureType(type);
+                texture.isSrgb   = isSrgb   != 0;
+                texture.isRepeat = isRepeat != 0;
+            }
+
+            if (!reader.read(floatsCount))
+            {
+                return false;
+            }
+
+            material.floats.resize(floatsCount);
+            for (auto& [uniformName, value] : material.floats)
+            {
+                if (!reader.read(uniformName) || !reader.read(value))
+                {
+                    return false;
+                }
+            }
+
+            if (!reader.read(isTransparent))
+            {
+                return false;
+            }
+
+            material.isTransparent = isTransparent != 0;
+        }
+
+        /* The submeshes and the meshlets are small, the buffers stay in the mapped file until they are uploaded */
+        imported.submeshes.resize(header.submeshesCount);
+        std::memcpy(imported.submeshes.data(), data + header.submeshesOffset, submeshesSize);
+
+        imported.meshlets.resize(header.meshletsCount);
+        std::memcpy(imported.meshlets.data(), data + header.meshletsOffset, meshletsSize);
+
+        imported.materials      = std::move(materials);
+        imported.unitScale      = header.unitScale;
+        imported.verticesCount  = header.verticesCount;
+        imported.indicesCount   = header.indicesCount;
+        imported.hasTangents    = header.hasTangents != 0;
+        imported.boundsMin      = header.boundsMin;
+        imported.boundsMax      = header.boundsMax;
+        imported.boundsCenter   = header.boundsCenter;
+        imported.boundsRadius   = header.boundsRadius;
+        imported.uvDensity      = header.uvDensity;
+        imported.cookedVertices = data + header.verticesOffset;
+        imported.cookedIndices  = reinterpret_cast<const uint32_t*>(data + header.indicesOffset);
+        imported.cookedFile     = cookedFile;
+
+        return true;
+    }
+
+    bool AssimpMeshImporter::cook(const ImportedMesh& imported)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        MG_CORE_INFO("Cooking the mesh {}...", imported.cookedPath.string());
+
+        auto& vertexData  = imported.vertexData;
+        bool  hasTangents = !vertexData.tangents.empty();
+
+        std::error_code error;
+        std::filesystem::create_directories(imported.cookedPath.parent_path(), error);
+
+        // Renamed when it's complete, so a half written file is never mapped
+        auto tempPath = imported.cookedPath;
+        tempPath += ".tmp";
+
+        std::ofstream file(tempPath, std::ios::binary);
+        if (!file.is_open())
+        {
+            MG_CORE_WARN("Can't save the cooked mesh {}.", imported.cookedPath.string());
+            return false;
+        }
+
+        auto write = [&file](const void* data, uint64_t sizeBytes)
+        {
+            file.write(reinterpret_cast<const char*>(data), std::streamsize(sizeBytes));
+        };
+
+        auto writeString = [&write](const std::string& value)
+        {
+            uint32_t size = uint32_t(value.size());
+
+            write(&size, sizeof(size));
+            write(value.data(), size);
+        };
+
+        auto alignSection = [&file, &write]() -> uint64_t
+        {
+            static const char zeros[SECTION_ALIGNMENT] = {};
+
+            uint64_t offset  = uint64_t(file.tellp());
+            uint64_t padding = (SECTION_ALIGNMENT - offset % SECTION_ALIGNMENT) % SECTION_ALIGNMENT;
+
+            write(zeros, padding);
+            return offset + padding;
+        };
+
+        CookedHeader header;
+        header.cookedKey      = imported.cookedKey;
+        header.verticesCount  = uint32_t(vertexData.positions.size());
+        header.indicesCount   = uint32_t(vertexData.indices.size());
+        header.submeshesCount = uint32_t(imported.submeshes.size());
+        header.meshletsCount  = uint32_t(imported.meshlets.size());
+        header.materialsCount = uint32_t(imported.materials.size());
+        header.hasTangents    = hasTangents ? 1 : 0;
+        header.unitScale      = imported.unitScale;
+        header.boundsMin      = imported.boundsMin;
+        header.boundsMax      = imported.boundsMax;
+        header.boundsCenter   = imported.boundsCenter;
+        header.boundsRadius   = imported.boundsRadius;
+        header.uvDensity      = imported.uvDensity;
+
+        write(&header, sizeof(header));
+
+        header.verticesOffset = alignSection();
+        write(vertexData.positions.data(), vertexData.positions.size() * sizeof(vertexData.positions[0]));
+        write(vertexData.texcoords.data(), vertexData.texcoords.size() * sizeof(vertexData.texcoords[0]));
+        write(vertexData.normals  .data(), vertexData.normals  .size() * sizeof(vertexData.normals  [0]));
+        if (hasTangents)
+        {
+            write(vertexData.tangents.data(), vertexData.tangents.size() * sizeof(vertexData.tangents[0]));
+        }
+
+        header.indicesOffset = alignSection();
+        write(vertexData.indices.data(), vertexData.indices.size() * sizeof(vertexData.indices[0]));
+
+        header.submeshesOffset = alignSection();
+        write(imported.submeshes.data(), imported.submeshes.size() * sizeof(Submesh));
+
+        header.meshletsOffset = alignSection();
+        write(imported.meshlets.data(), imported.meshlets.size() * sizeof(Meshlet));
+
+        header.materialsOffset = alignSection();
+        for (auto& material : imported.materials)
+        {
+            uint32_t texturesCount = uint32_t(material.textures.size());
+            uint32_t floatsCount   = uint32_t(material.floats.size());
+            uint8_t  isTransparent = material.isTransparent ? 1 : 0;
+
+            writeString(material.name);
+            write(&texturesCount, sizeof(texturesCount));
+
+            for (auto& texture : material.textures)
+            {
+                uint32_t type         = uint32_t(texture.type);
+                uint8_t  isSrgb       = texture.isSrgb   ? 1 : 0;
+                uint8_t  isRepeat     = texture.isRepeat ? 1 : 0;
+                uint32_t embeddedSize = uint32_t(texture.embedded.size());
+
+                write(&type,     sizeof(type));
+                write(&isSrgb,   sizeof(isSrgb));
+                write(&isRepeat, sizeof(isRepeat));
+                writeString(texture.path);
+                write(&embeddedSize, sizeof(embeddedSize));
+                write(texture.embedded.data(), embeddedSize);
+            }
+
+            write(&floatsCount, sizeof(floatsCount));
+            for (auto& [uniformName, value] : material.floats)
+            {
+                writeString(uniformName);
+                write(&value, sizeof(value));
+            }
+
+            write(&isTransparent, sizeof(isTransparent));
+        }
+
+        header.fileSize = uint64_t(file.tellp());
+
+        file.seekp(0);
+        write(&header, sizeof(header));
+        file.close();
+
+        if (!file)
+        {
+            MG_CORE_WARN("Can't save the cooked mesh {}.", imported.cookedPath.string());
+            std::filesystem::remove(tempPath, error);
+
+            return false;
+        }
+
+        std::filesystem::rename(tempPath, imported.cookedPath, error);
+        return !error;
+    }
+
+    void AssimpMeshImporter::flattenNodes(const aiNode* node, int32_t parent, std::vector<SkeletonNode>& nodes)
+    {
+        int32_t index = int32_t(nodes.size());
+        nodes.push_back({ node, node->mName.C_Str(), parent, mat4_cast(node->mTransformation) });
+
+        for (uint32_t i = 0; i < node->mNumChildren; ++i)
+        {
+            flattenNodes(node->mChildren[i], index, nodes);
+        }
+    }
+
+    void AssimpMeshImporter::loadSkeleton(ref<Mesh>& mesh, const aiScene* scene, const VertexData& vertexData, Skeleton& skeleton)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        flattenNodes(scene->mRootNode, -1, skeleton.nodes);
+
+        std::unordered_map<std::string, uint32_t> nodesIndices;
+        for (uint32_t i = 0; i < skeleton.nodes.size(); ++i)
+        {
+            nodesIndices.emplace(skeleton.nodes[i].name, i);
+        }
+
+        std::unordered_map<std::string, uint32_t> bonesIndices;
+        auto addBone = [&](const std::string& key, uint32_t node, const glm::mat4& offset)
+        {
+            auto [it, inserted] = bonesIndices.emplace(key, uint32_t(skeleton.boneNodes.size()));
+            if (inserted)
+            {
+                skeleton.boneNodes  .push_back(node);
+                skeleton.boneOffsets.push_back(offset);
+            }
+
+            return it->second;
+        };
+
+        skeleton.weights.assign(vertexData.positions.size(), glm::vec4(0.0f));
+        skeleton.indices.assign(vertexData.positions.size(), glm::vec4(0.0f));
+
+        auto addWeight = [&](uint32_t vertex, uint32_t bone, float weight)
+        {
+            for (uint32_t i = 0; i < VertexAnimation::MAX_BONES_PER_VERTEX; ++i)
+            {
+                if (skeleton.weights[vertex][i] == 0.0f)
+                {
+                    skeleton.weights[vertex][i] = weight;
+                    skeleton.indices[vertex][i] = float(bone);
+                    return;
+                }
+            }
+        };
+
+        auto& submeshes = mesh->getSubmeshes();
+        for (uint32_t i = 0; i < scene->mNumMeshes; ++i)
+        {
+            const aiMesh* part       = scene->mMeshes[i];
+            uint32_t      baseVertex = submeshes[i].baseVertex;
+
+            if (part->mNumBones == 0)
+            {
+                // A rigid part (e.g. a prop held in the hand) follows the node which references it
+                uint32_t node = 0;
+                for (uint32_t n = 0; n < skeleton.nodes.size(); ++n)
+                {
+                    auto* meshes = skeleton.nodes[n].node->mMeshes;
+                    if (std::find(meshes, meshes + skeleton.nodes[n].node->mNumMeshes, i) != meshes + skeleton.nodes[n].node->mNumMeshes)
                     {
-                        texture->setWraping(TextureWrapingCoordinate::S, TextureWrapingParam::REPEAT);
-                        texture->setWraping(TextureWrapingCoordinate::T, TextureWrapingParam::REPEAT);
+                        node = n;
+                        break;
                     }
-                    
+                }
+
+                uint32_t bone = addBone("rigid:" + skeleton.nodes[node].name, node, glm::mat4(1.0f));
+                for (uint32_t v = 0; v < part->mNumVertices; ++v)
+                {
+                    addWeight(baseVertex + v, bone, 1.0f);
+                }
+
+                continue;
+            }
+
+            for (uint32_t b = 0; b < part->mNumBones; ++b)
+            {
+                const aiBone* skinBone = part->mBones[b];
+                std::string   name     = skinBone->mName.C_Str();
+
+                auto nodeIt = nodesIndices.find(name);
+                if (nodeIt == nodesIndices.end())
+                {
+                    MG_CORE_WARN("AssimpMeshImporter: bone {} has no node, it follows the root.", name);
+                }
+
+                uint32_t bone = addBone(name, nodeIt != nodesIndices.end() ? nodeIt->second : 0, mat4_cast(skinBone->mOffsetMatrix));
+                for (uint32_t w = 0; w < skinBone->mNumWeights; ++w)
+                {
+                    addWeight(baseVertex + skinBone->mWeights[w].mVertexId, bone, skinBone->mWeights[w].mWeight);
+                }
+            }
+        }
+
+        /* Normalized weights and the bone space bounds of the influenced vertices */
+        std::vector<glm::vec3> boundsMin(skeleton.boneNodes.size(), glm::vec3( std::numeric_limits<float>::max()));
+        std::vector<glm::vec3> boundsMax(skeleton.boneNodes.size(), glm::vec3(-std::numeric_limits<float>::max()));
+
+        for (uint32_t v = 0; v < skeleton.weights.size(); ++v)
+        {
+            auto& weights = skeleton.weights[v];
+
+            float sum = weights.x + weights.y + weights.z + weights.w;
+            weights   = sum > 0.0f ? weights / sum : glm::vec4(1.0f, 0.0f, 0.0f, 0.0f);
+
+            for (uint32_t i = 0; i < VertexAnimation::MAX_BONES_PER_VERTEX; ++i)
+            {
+                if (weights[i] == 0.0f || skeleton.boneNodes.empty()) continue;
+
+                uint32_t  bone     = uint32_t(skeleton.indices[v][i]);
+                glm::vec3 position = skeleton.boneOffsets[bone] * glm::vec4(vertexData.positions[v], 1.0f);
+
+                boundsMin[bone] = glm::min(boundsMin[bone], position);
+                boundsMax[bone] = glm::max(boundsMax[bone], position);
+            }
+        }
+
+        skeleton.boneSpheres.resize(skeleton.boneNodes.size());
+        for (uint32_t b = 0; b < skeleton.boneNodes.size(); ++b)
+        {
+            bool hasVertices = boundsMin[b].x <= boundsMax[b].x;
+
+            skeleton.boneSpheres[b] = hasVertices ? glm::vec4(0.5f * (boundsMin[b] + boundsMax[b]), 0.5f * glm::length(boundsMax[b] - boundsMin[b]))
+                                                  : glm::vec4(0.0f, 0.0f, 0.0f, -1.0f);
+        }
+    }
+
+    bool AssimpMeshImporter::bakeClips(ref<VertexAnimation>& animation, const aiScene* scene, const Skeleton& skeleton)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        const uint32_t  bonesCount    = uint32_t(skeleton.boneNodes.size());
+        const glm::mat4 globalInverse = glm::inverse(skeleton.nodes[0].transform);
+
+        if (bonesCount == 0)
+        {
+            MG_CORE_ERROR("AssimpMeshImporter: mesh {} has no bones to bake.", animation->m_filename);
+            return false;
+        }
+
+        std::unordered_map<std::string, uint32_t> nodesIndices;
+        for (uint32_t i = 0; i < skeleton.nodes.size(); ++i)
+        {
+            nodesIndices.emplace(skeleton.nodes[i].name, i);
+        }
+
+        std::vector<glm::vec4>         texels;
+        std::vector<glm::mat4>         globals (skeleton.nodes.size());
+        std::vector<const aiNodeAnim*> channels(skeleton.nodes.size());
+
+        glm::vec3 boundsMin = glm::vec3( std::numeric_limits<float>::max());
+        glm::vec3 boundsMax = glm::vec3(-std::numeric_limits<float>::max());
+
+        for (uint32_t a = 0; a < scene->mNumAnimations; ++a)
+        {
+            const aiAnimation* clipAnimation = scene->mAnimations[a];
+
+            double ticksPerSecond = clipAnimation->mTicksPerSecond != 0.0 ? clipAnimation->mTicksPerSecond : 25.0;
+            double duration       = clipAnimation->mDuration;
+
+            VertexAnimation::Clip clip;
+            clip.name        = clipAnimation->mName.length > 0 ? clipAnimation->mName.C_Str() : "Clip " + std::to_string(a);
+            clip.firstFrame  = animation->m_framesCount;
+            clip.framesCount = glm::max(1u, uint32_t(std::round(duration / ticksPerSecond * VertexAnimation::FRAMES_PER_SECOND)));
+
+            std::fill(channels.begin(), channels.end(), nullptr);
+            for (uint32_t c = 0; c < clipAnimation->mNumChannels; ++c)
+            {
+                auto it = nodesIndices.find(clipAnimation->mChannels[c]->mNodeName.C_Str());
+                if (it != nodesIndices.end())
+                {
+                    channels[it->second] = clipAnimation->mChannels[c];
+                }
+            }
+
+            // The last frame isn't sampled, the clips loop back to the first one
+            for (uint32_t f = 0; f < clip.framesCount; ++f)
+            {
+                double ticks = glm::min(double(f) / VertexAnimation::FRAMES_PER_SECOND * ticksPerSecond, duration);
+
+                for (uint32_t n = 0; n < skeleton.nodes.size(); ++n)
+                {
+                    auto&     node  = skeleton.nodes[n];
+                    glm::mat4 local = channels[n] ? sampleNodeAnim(channels[n], ticks) : node.transform;
+
+                    globals[n] = node.parent >= 0 ? globals[node.parent] * local : local;
+                }
+
+                for (uint32_t b = 0; b < bonesCount; ++b)
+                {
+                    glm::mat4 bone = globalInverse * globals[skeleton.boneNodes[b]] * skeleton.boneOffsets[b];
+
+                    texels.push_back(glm::row(bone, 0));
+                    texels.push_back(glm::row(bone, 1));
+                    texels.push_back(glm::row(bone, 2));
+
+                    auto& sphere = skeleton.boneSpheres[b];
+                    if (sphere.w < 0.0f) continue;
+
+                    float     scale  = glm::max(glm::length(glm::vec3(bone[0])), glm::max(glm::length(glm::vec3(bone[1])), glm::length(glm::vec3(bone[2]))));
+                    glm::vec3 center = bone * glm::vec4(glm::vec3(sphere), 1.0f);
+
+                    boundsMin = glm::min(boundsMin, center - sphere.w * scale);
+                    boundsMax = glm::max(boundsMax, center + sphere.w * scale);
                 }
             }
+
+            animation->m_framesCount += clip.framesCount;
+            animation->m_clips.push_back(clip);
         }
+
+        animation->m_bonesCount   = bonesCount;
+        animation->m_boundsCenter = boundsMin.x <= boundsMax.x ? 0.5f * (boundsMin + boundsMax) : animation->m_mesh->getBoundsCenter();
+        animation->m_boundsRadius = boundsMin.x <= boundsMax.x ? 0.5f * glm::length(boundsMax - boundsMin) : animation->m_mesh->getBoundsRadius();
+
+        /* Bones texture */
+        GLint maxTextureSize = 0;
+        glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize);
+
+        const GLsizei width  = GLsizei(bonesCount * 3);
+        const GLsizei height = GLsizei(animation->m_framesCount);
+
+        if (width > maxTextureSize || height > maxTextureSize)
+        {
+            MG_CORE_ERROR("AssimpMeshImporter: baked animation of {} doesn't fit in a texture ({}x{}).", animation->m_filename, width, height);
+            return false;
+        }
+
+        glCreateTextures   (GL_TEXTURE_2D, 1, &animation->m_bonesTexture);
+        glTextureStorage2D (animation->m_bonesTexture, 1, GL_RGBA32F, width, height);
+        glTextureSubImage2D(animation->m_bonesTexture, 0, 0, 0, width, height, GL_RGBA, GL_FLOAT, texels.data());
+        glTextureParameteri(animation->m_bonesTexture, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTextureParameteri(animation->m_bonesTexture, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+        MG_RENDER_STATS_ADD(bytesUploaded, texels.size() * sizeof(glm::vec4));
+
         return true;
     }
-}
\ No newline at end of file
+
+    glm::mat4 AssimpMeshImporter::sampleNodeAnim(const aiNodeAnim* channel, double ticks)
+    {
+        uint32_t index, next;
+
+        float     factor   = findKeys(channel->mPositionKeys, channel->mNumPositionKeys, ticks, index, next);
+        glm::vec3 position = glm::mix(vec3_cast(channel->mPositionKeys[index].mValue), vec3_cast(channel->mPositionKeys[next].mValue), factor);
+
+                  factor   = findKeys(channel->mRotationKeys, channel->mNumRotationKeys, ticks, index, next);
+        glm::quat rotation = glm::slerp(quat_cast(channel->mRotationKeys[index].mValue), quat_cast(channel->mRotationKeys[next].mValue), factor);
+
+                  factor   = findKeys(channel->mScalingKeys, channel->mNumScalingKeys, ticks, index, next);
+        glm::vec3 scaling  = glm::mix(vec3_cast(channel->mScalingKeys[index].mValue), vec3_cast(channel->mScalingKeys[next].mValue), factor);
+
+        return glm::translate(glm::mat4(1.0f), position) * glm::mat4_cast(glm::normalize(rotation)) * glm::scale(glm::mat4(1.0f), scaling);
+    }
+}
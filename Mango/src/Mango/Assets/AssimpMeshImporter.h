@@ -2,6 +2,8 @@
 
 #include "Mango/Core/Base.h"
 #include "Mango/Rendering/Mesh.h"
+#include "Mango/Rendering/VertexAnimation.h"
+#include "Mango/Utils/MappedFile.h"
 
 #include <filesystem>
 
@@ -11,6 +13,11 @@
 #include <glm/gtc/quaternion.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+namespace Assimp
+{
+    class Importer;
+}
+
 namespace mango
 {
     class AssimpMeshImporter
@@ -19,19 +26,107 @@ namespace mango
         AssimpMeshImporter()  = delete;
         ~AssimpMeshImporter() = delete;
 
+        // Texture of an imported material, an embedded one keeps its file data
+        struct ImportedTexture
+        {
+            Material::TextureType type     = Material::TextureType::DIFFUSE;
+            std::string           path;     // relative to the directory of the mesh, empty if embedded
+            std::vector<uint8_t>  embedded;
+            bool                  isSrgb   = false;
+            bool                  isRepeat = false;
+        };
+
+        struct ImportedMaterial
+        {
+            std::string                                name; // empty if the source has none
+            std::vector<ImportedTexture>               textures;
+            std::vector<std::pair<std::string, float>> floats;
+            bool                                       isTransparent = false;
+        };
+
+        // Result of import, either the parsed Assimp scene or the memory mapped cooked mesh
+        struct ImportedMesh
+        {
+            std::vector<Submesh>          submeshes;
+            std::vector<Meshlet>          meshlets;  // only from the cooked mesh, built by finishLoad otherwise
+            std::vector<ImportedMaterial> materials;
+            VertexData                    vertexData;
+            float                         unitScale = 1.0f;
+            std::filesystem::path         parentDirectory;
+
+            // The buffers of the cooked mesh are uploaded straight from the mapped file
+            ref<MappedFile> cookedFile;
+            const void*     cookedVertices = nullptr;
+            const uint32_t* cookedIndices  = nullptr;
+            uint32_t        verticesCount  = 0;
+            uint32_t        indicesCount   = 0;
+            bool            hasTangents    = false;
+            glm::vec3       boundsMin      = glm::vec3(0.0f);
+            glm::vec3       boundsMax      = glm::vec3(0.0f);
+            glm::vec3       boundsCenter   = glm::vec3(0.0f);
+            float           boundsRadius   = 0.0f;
+            float           uvDensity      = 0.0f;
+
+            // Where finishLoad cooks the parsed scene to, empty if it isn't cooked
+            std::filesystem::path cookedPath;
+            uint64_t              cookedKey = 0;
+        };
+
         static ref<Mesh> load(const std::string& filename);
 
+        /* The load split for AssetManager::createMeshFromFileAsync: import makes no GL calls, so it runs on the worker threads,
+           finishLoad creates the materials and the buffers of the mesh on the main thread.
+           Assimp parses the source only if there isn't a cooked .mgmesh of it, keyed by the source content and the importer flags.
+           finishLoad cooks the parsed mesh on the worker threads, so the next import maps the cooked file instead. */
+        static bool import    (const std::string& filename, ImportedMesh& imported);
+        static bool finishLoad(ref<Mesh>& mesh, ImportedMesh& imported, bool asyncTextures);
+
+        // Loads a skinned model and bakes all of its animation clips into a bones texture
+        static ref<VertexAnimation> loadVertexAnimation(const std::string& filename);
+
     protected:
-        static bool parseScene   (      ref<Mesh>& mesh, const aiScene*    scene,  const std::filesystem::path& parentDirectory);
-        static void loadMeshPart (const aiMesh*    mesh,       VertexData& vertexData);
-        static bool loadMaterials(      ref<Mesh>& mesh, const aiScene*    scene, const std::filesystem::path& parentDirectory);
-
-        static bool loadMaterialTextures(const aiScene*               scene, 
-                                         const aiMaterial*            material, 
-                                               ref<Material>&         mangoMaterial, 
-                                               aiTextureType          aiType, 
-                                               Material::TextureType  textureType, 
-                                         const std::filesystem::path& parentDirectory);
+        // Node of the flattened hierarchy, the parents go before their children
+        struct SkeletonNode
+        {
+            const aiNode* node;
+            std::string   name;
+            int32_t       parent;
+            glm::mat4     transform;
+        };
+
+        struct Skeleton
+        {
+            std::vector<SkeletonNode> nodes;
+            std::vector<uint32_t>     boneNodes;   // node which drives the bone
+            std::vector<glm::mat4>    boneOffsets; // mesh space to the bone space
+            std::vector<glm::vec4>    boneSpheres; // bone space bounds of the influenced vertices, negative radius if there are none
+            std::vector<glm::vec4>    weights;     // per vertex
+            std::vector<glm::vec4>    indices;     // per vertex, stored as floats
+        };
+
+        static void parseScene   (const aiScene*    scene,       ImportedMesh& imported);
+        static void loadMeshPart (const aiMesh*     mesh,        VertexData&   vertexData);
+        static void readMaterials(const aiScene*    scene,       ImportedMesh& imported);
+
+        static void readMaterialTexture(const aiScene*              scene,
+                                        const aiMaterial*           material,
+                                              aiTextureType         aiType,
+                                              Material::TextureType textureType,
+                                              ImportedMaterial&     importedMaterial);
+
+        static bool createMaterials      (ref<Mesh>& mesh, const ImportedMesh& imported, bool asyncTextures);
+        static bool createMaterialTexture(ref<Material>& mangoMaterial, const ImportedTexture& importedTexture, const std::filesystem::path& parentDirectory, bool asyncTextures);
+
+        // Empty if there's neither an active project nor the write directory to keep the cooked meshes in
+        static std::filesystem::path getCookedPath(const std::string& filename);
+
+        static bool readCooked(const std::filesystem::path& cookedPath, uint64_t cookedKey, ImportedMesh& imported);
+        static bool cook      (const ImportedMesh& imported);
+
+        static void      flattenNodes  (const aiNode* node, int32_t parent, std::vector<SkeletonNode>& nodes);
+        static void      loadSkeleton  (ref<Mesh>& mesh, const aiScene* scene, const VertexData& vertexData, Skeleton& skeleton);
+        static bool      bakeClips     (ref<VertexAnimation>& animation, const aiScene* scene, const Skeleton& skeleton);
+        static glm::mat4 sampleNodeAnim(const aiNodeAnim* channel, double ticks);
 
         // For converting between ASSIMP and glm
         static inline glm::vec3 vec3_cast(const aiVector3D&   v) { return glm::vec3(v.x, v.y, v.z); }
@@ -0,0 +1,982 @@
+#include "mgpch.h"
+
+#include "TextureCooker.h"
+#include "Mango/Core/Jobs.h"
+#include "Mango/Rendering/Texture.h"
+
+#include "stb_image.h"
+
+#define STB_DXT_IMPLEMENTATION
+#include "stb_dxt.h"
+
+#include <array>
+#include <atomic>
+#include <cctype>
+#include <fstream>
+#include <limits>
+
+namespace mango
+{
+    namespace
+    {
+        const uint32_t DDS_MAGIC   = 0x20534444; // "DDS "
+        const uint32_t DX10_FOURCC = 0x30315844; // "DX10"
+
+        struct DDSPixelFormat
+        {
+            uint32_t size        = sizeof(DDSPixelFormat);
+            uint32_t flags       = 0x4; // DDPF_FOURCC
+            uint32_t fourCC      = DX10_FOURCC;
+            uint32_t rgbBitCount = 0;
+            uint32_t rBitMask    = 0;
+            uint32_t gBitMask    = 0;
+            uint32_t bBitMask    = 0;
+            uint32_t aBitMask    = 0;
+        };
+
+        struct DDSHeader
+        {
+            uint32_t       size              = sizeof(DDSHeader);
+            uint32_t       flags             = 0x1 | 0x2 | 0x4 | 0x1000 | 0x20000 | 0x80000; // CAPS, HEIGHT, WIDTH, PIXELFORMAT, MIPMAPCOUNT, LINEARSIZE
+            uint32_t       height            = 0;
+            uint32_t       width             = 0;
+            uint32_t       pitchOrLinearSize = 0;
+            uint32_t       depth             = 0;
+            uint32_t       mipMapCount       = 0;
+            uint32_t       reserved1[11]     = {};
+            DDSPixelFormat pixelFormat;
+            uint32_t       caps              = 0x1000 | 0x400000 | 0x8; // TEXTURE, MIPMAP, COMPLEX
+            uint32_t       caps2             = 0;
+            uint32_t       caps3             = 0;
+            uint32_t       caps4             = 0;
+            uint32_t       reserved2         = 0;
+        };
+
+        struct DDSHeaderDX10
+        {
+            uint32_t dxgiFormat        = 0;
+            uint32_t resourceDimension = 3; // D3D10_RESOURCE_DIMENSION_TEXTURE2D
+            uint32_t miscFlag          = 0;
+            uint32_t arraySize         = 1;
+            uint32_t miscFlags2        = 0;
+        };
+
+        uint32_t dxgiFormat(TextureCooker::Format format, bool isSrgb)
+        {
+            switch (format)
+            {
+                case TextureCooker::Format::BC1: return isSrgb ? 72 : 71;
+                case TextureCooker::Format::BC3: return isSrgb ? 78 : 77;
+                case TextureCooker::Format::BC4: return 80;
+                case TextureCooker::Format::BC5: return 83;
+                case TextureCooker::Format::BC7: return isSrgb ? 99 : 98;
+            }
+
+            return 0;
+        }
+
+        const char* formatName(TextureCooker::Format format)
+        {
+            switch (format)
+            {
+                case TextureCooker::Format::BC1: return "BC1";
+                case TextureCooker::Format::BC3: return "BC3";
+                case TextureCooker::Format::BC4: return "BC4";
+                case TextureCooker::Format::BC5: return "BC5";
+                case TextureCooker::Format::BC7: return "BC7";
+            }
+
+            return "";
+        }
+
+        uint32_t blockSize(TextureCooker::Format format)
+        {
+            return (format == TextureCooker::Format::BC1 || format == TextureCooker::Format::BC4) ? 8 : 16;
+        }
+
+        const char* cookedSuffix(bool isSrgb)
+        {
+            return isSrgb ? ".srgb.dds" : ".dds";
+        }
+
+        // Last part of the file name, e.g. "ddn" of sponza_thorn_ddn.tga
+        std::string nameSuffix(const std::filesystem::path & sourcePath)
+        {
+            std::string stem = sourcePath.stem().string();
+            std::transform(stem.begin(), stem.end(), stem.begin(), [](unsigned char c) { return char(std::tolower(c)); });
+
+            size_t separator = stem.find_last_of("_- .");
+            return separator == std::string::npos ? stem : stem.substr(separator + 1);
+        }
+
+        bool isUpToDate(const std::filesystem::path & sourcePath, const std::filesystem::path & cookedPath)
+        {
+            std::error_code sourceError, cookedError;
+
+            auto sourceTime = std::filesystem::last_write_time(sourcePath, sourceError);
+            auto cookedTime = std::filesystem::last_write_time(cookedPath, cookedError);
+
+            return !sourceError && !cookedError && cookedTime >= sourceTime;
+        }
+
+        struct Image
+        {
+            uint32_t             width  = 0;
+            uint32_t             height = 0;
+            std::vector<uint8_t> rgba;
+        };
+
+        float linearToSrgb(float value)
+        {
+            value = glm::clamp(value, 0.0f, 1.0f);
+            return value <= 0.0031308f ? value * 12.92f : 1.055f * glm::pow(value, 1.0f / 2.4f) - 0.055f;
+        }
+
+        const float* srgbToLinearTable()
+        {
+            static const auto table = []
+            {
+                std::array<float, 256> values;
+                for (uint32_t i = 0; i < 256; ++i)
+                {
+                    float value = float(i) / 255.0f;
+                    values[i] = value <= 0.04045f ? value / 12.92f : glm::pow((value + 0.055f) / 1.055f, 2.4f);
+                }
+
+                return values;
+            }();
+
+            return table.data();
+        }
+
+        const float KAISER_RADIUS = 2.0f; // in the destination texels, 8 taps of the 2:1 reduction
+        const float KAISER_ALPHA  = 4.0f;
+
+        // Modified Bessel function of the first kind, the power series converges quickly for the arguments of the window
+        float besselI0(float x)
+        {
+            float sum  = 1.0f;
+            float term = 1.0f;
+            for (uint32_t k = 1; k < 16; ++k)
+            {
+                float factor = x / (2.0f * float(k));
+
+                term *= factor * factor;
+                sum  += term;
+            }
+
+            return sum;
+        }
+
+        // x in the destination texels
+        float kaiserSinc(float x)
+        {
+            if (glm::abs(x) >= KAISER_RADIUS)
+            {
+                return 0.0f;
+            }
+
+            float sinc   = x == 0.0f ? 1.0f : glm::sin(glm::pi<float>() * x) / (glm::pi<float>() * x);
+            float ratio  = x / KAISER_RADIUS;
+            float window = besselI0(KAISER_ALPHA * glm::sqrt(1.0f - ratio * ratio)) / besselI0(KAISER_ALPHA);
+
+            return sinc * window;
+        }
+
+        // Normalized taps of every destination texel along one axis, the taps past the edges repeat the edge texels
+        struct AxisFilter
+        {
+            uint32_t              tapsCount = 0;
+            std::vector<uint32_t> sources;
+            std::vector<float>    weights;
+        };
+
+        AxisFilter makeAxisFilter(uint32_t sourceSize, uint32_t destinationSize)
+        {
+            const float scale  = float(sourceSize) / float(destinationSize);
+            const float radius = KAISER_RADIUS * scale;
+
+            AxisFilter filter;
+            filter.tapsCount = uint32_t(glm::ceil(2.0f * radius)) + 1;
+            filter.sources.resize(destinationSize * filter.tapsCount);
+            filter.weights.resize(destinationSize * filter.tapsCount);
+
+            for (uint32_t x = 0; x < destinationSize; ++x)
+            {
+                float   center = (float(x) + 0.5f) * scale;
+                int32_t first  = int32_t(glm::floor(center - 0.5f - radius));
+
+                float sum = 0.0f;
+                for (uint32_t t = 0; t < filter.tapsCount; ++t)
+                {
+                    int32_t source = first + int32_t(t);
+                    float   weight = kaiserSinc((float(source) + 0.5f - center) / scale);
+
+                    filter.sources[x * filter.tapsCount + t] = uint32_t(glm::clamp(source, 0, int32_t(sourceSize) - 1));
+                    filter.weights[x * filter.tapsCount + t] = weight;
+                    sum += weight;
+                }
+
+                for (uint32_t t = 0; t < filter.tapsCount; ++t)
+                {
+                    filter.weights[x * filter.tapsCount + t] /= sum;
+                }
+            }
+
+            return filter;
+        }
+
+        /* Separable Kaiser windowed sinc filter, sharper than the box filter without its aliasing. The colors of the sRGB textures
+           are filtered in the linear space, the normals are filtered as vectors and renormalized. The overshoot of the negative lobes
+           is clamped. */
+        void downsample(const Image & source, Image & destination, bool isSrgb, bool isNormalMap)
+        {
+            MG_PROFILE_ZONE_SCOPED;
+
+            const float* toLinear = srgbToLinearTable();
+
+            destination.width  = glm::max(source.width  / 2, 1u);
+            destination.height = glm::max(source.height / 2, 1u);
+            destination.rgba.resize(destination.width * destination.height * 4);
+
+            std::vector<glm::vec4> texels(source.width * source.height);
+            for (uint32_t i = 0; i < texels.size(); ++i)
+            {
+                const uint8_t* texel = &source.rgba[i * 4];
+
+                if (isSrgb)
+                {
+                    texels[i] = glm::vec4(toLinear[texel[0]], toLinear[texel[1]], toLinear[texel[2]], float(texel[3]) / 255.0f);
+                }
+                else if (isNormalMap)
+                {
+                    texels[i] = glm::vec4(glm::vec3(texel[0], texel[1], texel[2]) / 127.5f - 1.0f, float(texel[3]) / 255.0f);
+                }
+                else
+                {
+                    texels[i] = glm::vec4(texel[0], texel[1], texel[2], texel[3]) / 255.0f;
+                }
+            }
+
+            const AxisFilter horizontal = makeAxisFilter(source.width,  destination.width);
+            const AxisFilter vertical   = makeAxisFilter(source.height, destination.height);
+
+            // Rows of the source filtered horizontally
+            std::vector<glm::vec4> rows(destination.width * source.height);
+            for (uint32_t y = 0; y < source.height; ++y)
+            {
+                for (uint32_t x = 0; x < destination.width; ++x)
+                {
+                    glm::vec4 sum(0.0f);
+                    for (uint32_t t = 0; t < horizontal.tapsCount; ++t)
+                    {
+                        uint32_t tap = x * horizontal.tapsCount + t;
+                        sum += texels[y * source.width + horizontal.sources[tap]] * horizontal.weights[tap];
+                    }
+
+                    rows[y * destination.width + x] = sum;
+                }
+            }
+
+            for (uint32_t y = 0; y < destination.height; ++y)
+            {
+                for (uint32_t x = 0; x < destination.width; ++x)
+                {
+                    glm::vec4 filtered(0.0f);
+                    for (uint32_t t = 0; t < vertical.tapsCount; ++t)
+                    {
+                        uint32_t tap = y * vertical.tapsCount + t;
+                        filtered += rows[vertical.sources[tap] * destination.width + x] * vertical.weights[tap];
+                    }
+
+                    if (isSrgb)
+                    {
+                        filtered = glm::vec4(linearToSrgb(filtered.r), linearToSrgb(filtered.g), linearToSrgb(filtered.b), filtered.a);
+                    }
+                    else if (isNormalMap)
+                    {
+                        glm::vec3 normal = glm::length(glm::vec3(filtered)) > 0.0f ? glm::normalize(glm::vec3(filtered)) : glm::vec3(0.0f, 0.0f, 1.0f);
+                        filtered = glm::vec4(normal * 0.5f + 0.5f, filtered.a);
+                    }
+
+                    uint8_t* destinationTexel = &destination.rgba[(y * destination.width + x) * 4];
+                    for (uint32_t c = 0; c < 4; ++c)
+                    {
+                        destinationTexel[c] = uint8_t(glm::clamp(filtered[c] * 255.0f + 0.5f, 0.0f, 255.0f));
+                    }
+                }
+            }
+        }
+
+        // Writes the bits from the least significant one, as the BC7 blocks are laid out
+        struct BitWriter
+        {
+            uint8_t* bytes;
+            uint32_t position = 0;
+
+            void write(uint32_t value, uint32_t bitsCount)
+            {
+                for (uint32_t i = 0; i < bitsCount; ++i, ++position)
+                {
+                    bytes[position / 8] |= uint8_t(((value >> i) & 1u) << (position % 8));
+                }
+            }
+        };
+
+        /* BC7 mode 6 block: one subset, 7.7.7.7 RGBA endpoints with a p-bit each and 4 bit indices. The endpoints are the extremes
+           of the texels along the principal axis of their colors, every combination of the p-bits is tried. */
+        void encodeBC7Block(const uint8_t* texels, uint8_t* block)
+        {
+            static const uint32_t WEIGHTS[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+            glm::vec4 mean(0.0f);
+            for (uint32_t i = 0; i < 16; ++i)
+            {
+                mean += glm::vec4(texels[i * 4 + 0], texels[i * 4 + 1], texels[i * 4 + 2], texels[i * 4 + 3]);
+            }
+            mean /= 16.0f;
+
+            glm::mat4 covariance(0.0f);
+            for (uint32_t i = 0; i < 16; ++i)
+            {
+                glm::vec4 delta = glm::vec4(texels[i * 4 + 0], texels[i * 4 + 1], texels[i * 4 + 2], texels[i * 4 + 3]) - mean;
+                covariance += glm::outerProduct(delta, delta);
+            }
+
+            // Power iterations converge to the principal axis
+            glm::vec4 axis(0.5f);
+            for (uint32_t i = 0; i < 8; ++i)
+            {
+                glm::vec4 next = covariance * axis;
+                float     len  = glm::length(next);
+
+                if (len < 1e-6f)
+                {
+                    break;
+                }
+
+                axis = next / len;
+            }
+
+            float minProjection = std::numeric_limits<float>::max();
+            float maxProjection = std::numeric_limits<float>::lowest();
+            for (uint32_t i = 0; i < 16; ++i)
+            {
+                float projection = glm::dot(glm::vec4(texels[i * 4 + 0], texels[i * 4 + 1], texels[i * 4 + 2], texels[i * 4 + 3]) - mean, axis);
+
+                minProjection = glm::min(minProjection, projection);
+                maxProjection = glm::max(maxProjection, projection);
+            }
+
+            glm::vec4 endpoints[2] = { glm::clamp(mean + axis * minProjection, 0.0f, 255.0f),
+                                       glm::clamp(mean + axis * maxProjection, 0.0f, 255.0f) };
+
+            uint32_t bestError = std::numeric_limits<uint32_t>::max();
+            uint8_t  bestQuantized[2][4];
+            uint8_t  bestIndices[16];
+            uint32_t bestPBits[2];
+
+            for (uint32_t pBits = 0; pBits < 4; ++pBits)
+            {
+                uint32_t pBit[2] = { pBits & 1u, pBits >> 1 };
+
+                // 7 bit values, the p-bit is the lowest bit of the 8 bit endpoint
+                uint8_t  quantized[2][4];
+                uint32_t palette[16][4];
+                for (uint32_t e = 0; e < 2; ++e)
+                {
+                    for (uint32_t c = 0; c < 4; ++c)
+                    {
+                        quantized[e][c] = uint8_t(glm::clamp(int((endpoints[e][c] - float(pBit[e])) / 2.0f + 0.5f), 0, 127));
+                    }
+                }
+
+                for (uint32_t w = 0; w < 16; ++w)
+                {
+                    for (uint32_t c = 0; c < 4; ++c)
+                    {
+                        uint32_t e0 = (uint32_t(quantized[0][c]) << 1) | pBit[0];
+                        uint32_t e1 = (uint32_t(quantized[1][c]) << 1) | pBit[1];
+
+                        palette[w][c] = ((64 - WEIGHTS[w]) * e0 + WEIGHTS[w] * e1 + 32) >> 6;
+                    }
+                }
+
+                uint32_t error = 0;
+                uint8_t  indices[16];
+                for (uint32_t i = 0; i < 16; ++i)
+                {
+                    uint32_t bestTexelError = std::numeric_limits<uint32_t>::max();
+                    for (uint32_t w = 0; w < 16; ++w)
+                    {
+                        uint32_t texelError = 0;
+                        for (uint32_t c = 0; c < 4; ++c)
+                        {
+                            int32_t delta = int32_t(texels[i * 4 + c]) - int32_t(palette[w][c]);
+                            texelError += uint32_t(delta * delta);
+                        }
+
+                        if (texelError < bestTexelError)
+                        {
+                            bestTexelError = texelError;
+                            indices[i]     = uint8_t(w);
+                        }
+                    }
+
+                    error += bestTexelError;
+                }
+
+                if (error < bestError)
+                {
+                    bestError    = error;
+                    bestPBits[0] = pBit[0];
+                    bestPBits[1] = pBit[1];
+
+                    std::memcpy(bestQuantized, quantized, sizeof(quantized));
+                    std::memcpy(bestIndices,   indices,   sizeof(indices));
+                }
+            }
+
+            // The highest bit of the first index is implied to be 0, the endpoints are swapped if it isn't
+            if (bestIndices[0] & 8)
+            {
+                for (uint32_t c = 0; c < 4; ++c)
+                {
+                    std::swap(bestQuantized[0][c], bestQuantized[1][c]);
+                }
+                std::swap(bestPBits[0], bestPBits[1]);
+
+                for (auto& index : bestIndices)
+                {
+                    index = uint8_t(15 - index);
+                }
+            }
+
+            std::memset(block, 0, 16);
+
+            BitWriter writer { block };
+            writer.write(1u << 6, 7); // mode 6
+
+            for (uint32_t c = 0; c < 4; ++c)
+            {
+                writer.write(bestQuantized[0][c], 7);
+                writer.write(bestQuantized[1][c], 7);
+            }
+
+            writer.write(bestPBits[0], 1);
+            writer.write(bestPBits[1], 1);
+
+            writer.write(bestIndices[0], 3);
+            for (uint32_t i = 1; i < 16; ++i)
+            {
+                writer.write(bestIndices[i], 4);
+            }
+        }
+
+        // Blocks of the level row by row, the blocks at the right and top edges repeat the last texels
+        void encodeLevel(const Image & image, TextureCooker::Format format, std::vector<uint8_t> & blocks)
+        {
+            MG_PROFILE_ZONE_SCOPED;
+
+            const uint32_t blocksX = (image.width  + 3) / 4;
+            const uint32_t blocksY = (image.height + 3) / 4;
+            const uint32_t size    = blockSize(format);
+
+            blocks.assign(size_t(blocksX) * blocksY * size, 0);
+
+            uint8_t texels[16 * 4];
+            uint8_t channels[16 * 2];
+
+            for (uint32_t by = 0; by < blocksY; ++by)
+            {
+                for (uint32_t bx = 0; bx < blocksX; ++bx)
+                {
+                    for (uint32_t i = 0; i < 16; ++i)
+                    {
+                        uint32_t x = glm::min(bx * 4 + i % 4, image.width  - 1);
+                        uint32_t y = glm::min(by * 4 + i / 4, image.height - 1);
+
+                        std::memcpy(&texels[i * 4], &image.rgba[(y * image.width + x) * 4], 4);
+                    }
+
+                    uint8_t* block = &blocks[(size_t(by) * blocksX + bx) * size];
+
+                    switch (format)
+                    {
+                        case TextureCooker::Format::BC1:
+                            stb_compress_dxt_block(block, texels, 0, STB_DXT_HIGHQUAL);
+                            break;
+                        case TextureCooker::Format::BC3:
+                            stb_compress_dxt_block(block, texels, 1, STB_DXT_HIGHQUAL);
+                            break;
+                        case TextureCooker::Format::BC4:
+                            for (uint32_t i = 0; i < 16; ++i) channels[i] = texels[i * 4];
+                            stb_compress_bc4_block(block, channels);
+                            break;
+                        case TextureCooker::Format::BC5:
+                            for (uint32_t i = 0; i < 16; ++i)
+                            {
+                                channels[i * 2 + 0] = texels[i * 4 + 0];
+                                channels[i * 2 + 1] = texels[i * 4 + 1];
+                            }
+                            stb_compress_bc5_block(block, channels);
+                            break;
+                        case TextureCooker::Format::BC7:
+                            encodeBC7Block(texels, block);
+                            break;
+                    }
+                }
+            }
+        }
+        // The decoders of the blocks, for the round-trip of TextureCooker::selfTest. The texels are written as RGBA
+        struct BitReader
+        {
+            const uint8_t* bytes;
+            uint32_t       position = 0;
+
+            uint32_t read(uint32_t bitsCount)
+            {
+                uint32_t value = 0;
+                for (uint32_t i = 0; i < bitsCount; ++i, ++position)
+                {
+                    value |= uint32_t((bytes[position / 8] >> (position % 8)) & 1u) << i;
+                }
+
+                return value;
+            }
+        };
+
+        // 8 values if the first endpoint is the larger one, 6 values with 0 and 255 otherwise
+        void decodeBC4Block(const uint8_t* block, uint8_t* texels, uint32_t channel)
+        {
+            uint32_t endpoints[2] = { block[0], block[1] };
+            uint32_t palette[8]   = { endpoints[0], endpoints[1] };
+
+            if (endpoints[0] > endpoints[1])
+            {
+                for (uint32_t i = 1; i < 7; ++i) palette[i + 1] = ((7 - i) * endpoints[0] + i * endpoints[1]) / 7;
+            }
+            else
+            {
+                for (uint32_t i = 1; i < 5; ++i) palette[i + 1] = ((5 - i) * endpoints[0] + i * endpoints[1]) / 5;
+                palette[6] = 0;
+                palette[7] = 255;
+            }
+
+            BitReader reader { block + 2 };
+            for (uint32_t i = 0; i < 16; ++i)
+            {
+                texels[i * 4 + channel] = uint8_t(palette[reader.read(3)]);
+            }
+        }
+
+        // 4 colors if the first endpoint is the larger one, 3 colors with the transparent black otherwise. The color block of BC3 has always 4 colors
+        void decodeBC1Block(const uint8_t* block, uint8_t* texels, bool isBC3)
+        {
+            uint32_t endpoints[2] = { uint32_t(block[0] | (block[1] << 8)), uint32_t(block[2] | (block[3] << 8)) };
+            uint32_t palette[4][4];
+
+            for (uint32_t e = 0; e < 2; ++e)
+            {
+                uint32_t r = (endpoints[e] >> 11) & 31;
+                uint32_t g = (endpoints[e] >> 5)  & 63;
+                uint32_t b =  endpoints[e]        & 31;
+
+                palette[e][0] = (r << 3) | (r >> 2);
+                palette[e][1] = (g << 2) | (g >> 4);
+                palette[e][2] = (b << 3) | (b >> 2);
+                palette[e][3] = 255;
+            }
+
+            for (uint32_t c = 0; c < 4; ++c)
+            {
+                if (isBC3 || endpoints[0] > endpoints[1])
+                {
+                    palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+                    palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+                }
+                else
+                {
+                    palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+                    palette[3][c] = 0;
+                }
+            }
+
+            BitReader reader { block + 4 };
+            for (uint32_t i = 0; i < 16; ++i)
+            {
+                uint32_t index = reader.read(2);
+                for (uint32_t c = 0; c < 4; ++c)
+                {
+                    texels[i * 4 + c] = uint8_t(palette[index][c]);
+                }
+            }
+        }
+
+        void decodeBC7Block(const uint8_t* block, uint8_t* texels)
+        {
+            static const uint32_t WEIGHTS[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+            BitReader reader { block };
+            if (reader.read(7) != (1u << 6))
+            {
+                std::memset(texels, 0, 16 * 4); // only the mode 6 is encoded
+                return;
+            }
+
+            uint32_t endpoints[2][4];
+            for (uint32_t c = 0; c < 4; ++c)
+            {
+                endpoints[0][c] = reader.read(7) << 1;
+                endpoints[1][c] = reader.read(7) << 1;
+            }
+
+            uint32_t pBits[2] = { reader.read(1), reader.read(1) };
+            for (uint32_t c = 0; c < 4; ++c)
+            {
+                endpoints[0][c] |= pBits[0];
+                endpoints[1][c] |= pBits[1];
+            }
+
+            for (uint32_t i = 0; i < 16; ++i)
+            {
+                uint32_t index = reader.read(i == 0 ? 3 : 4);
+                for (uint32_t c = 0; c < 4; ++c)
+                {
+                    texels[i * 4 + c] = uint8_t(((64 - WEIGHTS[index]) * endpoints[0][c] + WEIGHTS[index] * endpoints[1][c] + 32) >> 6);
+                }
+            }
+        }
+
+        void decodeBlock(const uint8_t* block, TextureCooker::Format format, uint8_t* texels)
+        {
+            std::memset(texels, 255, 16 * 4);
+
+            switch (format)
+            {
+                case TextureCooker::Format::BC1:
+                    decodeBC1Block(block, texels, false);
+                    break;
+                case TextureCooker::Format::BC3:
+                    decodeBC1Block(block + 8, texels, true);
+                    decodeBC4Block(block, texels, 3);
+                    break;
+                case TextureCooker::Format::BC4:
+                    decodeBC4Block(block, texels, 0);
+                    break;
+                case TextureCooker::Format::BC5:
+                    decodeBC4Block(block,     texels, 0);
+                    decodeBC4Block(block + 8, texels, 1);
+                    break;
+                case TextureCooker::Format::BC7:
+                    decodeBC7Block(block, texels);
+                    break;
+            }
+        }
+    }
+
+    TextureCooker::Statistics TextureCooker::cookDirectory(const std::filesystem::path & directory, const Options & options)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        std::vector<std::filesystem::path> sourcePaths;
+
+        std::error_code error;
+        for (auto it = std::filesystem::recursive_directory_iterator(directory, std::filesystem::directory_options::skip_permission_denied, error);
+             it != std::filesystem::recursive_directory_iterator(); it.increment(error))
+        {
+            if (error)
+            {
+                break;
+            }
+
+            if (it->is_regular_file(error) && isSupported(it->path()))
+            {
+                sourcePaths.push_back(it->path());
+            }
+        }
+
+        if (error)
+        {
+            MG_CORE_ERROR("Can't list the textures of {}: {}", directory.string(), error.message());
+        }
+
+        std::atomic<uint32_t> cookedCount   = 0;
+        std::atomic<uint32_t> upToDateCount = 0;
+        std::atomic<uint32_t> failedCount   = 0;
+
+        tf::Taskflow taskflow;
+        taskflow.for_each_index(size_t(0), sourcePaths.size(), size_t(1), [&](size_t i)
+        {
+            auto& sourcePath = sourcePaths[i];
+            auto  cookedPath = getCookedPath(sourcePath, isSrgb(sourcePath));
+
+            if (!options.force && isUpToDate(sourcePath, cookedPath))
+            {
+                ++upToDateCount;
+            }
+            else if (cook(sourcePath, options))
+            {
+                ++cookedCount;
+            }
+            else
+            {
+                ++failedCount;
+            }
+        });
+
+        Jobs::executor.run(taskflow).wait();
+
+        Statistics statistics;
+        statistics.cookedCount   = cookedCount;
+        statistics.upToDateCount = upToDateCount;
+        statistics.failedCount   = failedCount;
+
+        return statistics;
+    }
+
+    bool TextureCooker::cook(const std::filesystem::path & sourcePath, const Options & options)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        int width, height, channelsCount;
+        uint8_t* data = stbi_load(sourcePath.string().c_str(), &width, &height, &channelsCount, 4);
+
+        if (!data)
+        {
+            MG_CORE_ERROR("Can't load the texture {}.", sourcePath.string());
+            return false;
+        }
+
+        const bool normalMap = isNormalMap(sourcePath);
+        const bool srgb      = isSrgb(sourcePath);
+
+        // Bottom-up like the GL textures, so the cooked file isn't flipped when it's loaded
+        Image level;
+        level.width  = uint32_t(width);
+        level.height = uint32_t(height);
+        level.rgba.resize(size_t(width) * height * 4);
+
+        const size_t rowSize = size_t(width) * 4;
+        for (uint32_t y = 0; y < level.height; ++y)
+        {
+            std::memcpy(&level.rgba[y * rowSize], data + (level.height - 1 - y) * rowSize, rowSize);
+        }
+
+        stbi_image_free(data);
+
+        bool hasAlpha    = false;
+        bool isGrayscale = true;
+        for (size_t i = 0; i < level.rgba.size(); i += 4)
+        {
+            hasAlpha    |= level.rgba[i + 3] != 255;
+            isGrayscale &= level.rgba[i] == level.rgba[i + 1] && level.rgba[i] == level.rgba[i + 2];
+        }
+
+        Format format;
+        if      (normalMap)                          format = Format::BC5;
+        else if (!srgb && isGrayscale && !hasAlpha)  format = Format::BC4; // sampled as (r, r, r, 1), no sRGB variant
+        else if (options.useBC7)                     format = Format::BC7;
+        else if (hasAlpha)                           format = Format::BC3;
+        else                                         format = Format::BC1;
+
+        const uint32_t mipsCount = Texture::calcMaxMipMapsLevels(level.width, level.height, 1);
+
+        DDSHeader header;
+        header.width             = level.width;
+        header.height            = level.height;
+        header.mipMapCount       = mipsCount;
+        header.pitchOrLinearSize = ((level.width + 3) / 4) * ((level.height + 3) / 4) * blockSize(format);
+
+        DDSHeaderDX10 headerDX10;
+        headerDX10.dxgiFormat = dxgiFormat(format, srgb);
+
+        // Renamed when it's complete, so a half written file is never loaded
+        auto cookedPath = getCookedPath(sourcePath, srgb);
+        auto tempPath   = cookedPath;
+        tempPath += ".tmp";
+
+        std::ofstream file(tempPath, std::ios::binary);
+        if (!file.is_open())
+        {
+            MG_CORE_ERROR("Can't save the cooked texture {}.", cookedPath.string());
+            return false;
+        }
+
+        file.write(reinterpret_cast<const char*>(&DDS_MAGIC),  sizeof(DDS_MAGIC));
+        file.write(reinterpret_cast<const char*>(&header),     sizeof(header));
+        file.write(reinterpret_cast<const char*>(&headerDX10), sizeof(headerDX10));
+
+        std::vector<uint8_t> blocks;
+        Image                nextLevel;
+
+        for (uint32_t mip = 0; mip < mipsCount; ++mip)
+        {
+            encodeLevel(level, format, blocks);
+            file.write(reinterpret_cast<const char*>(blocks.data()), std::streamsize(blocks.size()));
+
+            if (mip + 1 < mipsCount)
+            {
+                downsample(level, nextLevel, srgb, normalMap);
+                std::swap(level, nextLevel);
+            }
+        }
+
+        file.close();
+
+        std::error_code error;
+        if (!file)
+        {
+            MG_CORE_ERROR("Can't save the cooked texture {}.", cookedPath.string());
+            std::filesystem::remove(tempPath, error);
+
+            return false;
+        }
+
+        std::filesystem::rename(tempPath, cookedPath, error);
+        if (error)
+        {
+            MG_CORE_ERROR("Can't save the cooked texture {}: {}", cookedPath.string(), error.message());
+            return false;
+        }
+
+        MG_CORE_INFO("Cooked the texture {} ({}{}, {} mips).", sourcePath.string(), formatName(format), srgb ? " sRGB" : "", mipsCount);
+        return true;
+    }
+
+    std::string TextureCooker::findCooked(const std::string & filename, bool isSrgb)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        std::string cookedName = filename + cookedSuffix(isSrgb);
+
+        if (!VFI::exists(cookedName))
+        {
+            // The cooker guesses the color space from the file name, the material may load the texture in the other one
+            if (VFI::exists(filename + cookedSuffix(!isSrgb)))
+            {
+                MG_CORE_WARN("TextureCooker: {} is cooked as {}, but it's loaded as {}. It's loaded uncompressed, rename the source to match its color space.",
+                             filename, isSrgb ? "linear" : "sRGB", isSrgb ? "sRGB" : "linear");
+            }
+
+            return {};
+        }
+
+        // The cooked textures may be shipped without their sources
+        if (!VFI::exists(filename))
+        {
+            return cookedName;
+        }
+
+        return isUpToDate(VFI::getFilepath(filename), VFI::getFilepath(cookedName)) ? cookedName : std::string();
+    }
+
+    std::filesystem::path TextureCooker::getCookedPath(const std::filesystem::path & sourcePath, bool isSrgb)
+    {
+        auto cookedPath = sourcePath;
+        cookedPath += cookedSuffix(isSrgb);
+
+        return cookedPath;
+    }
+
+    bool TextureCooker::isNormalMap(const std::filesystem::path & sourcePath)
+    {
+        static const std::unordered_set<std::string> suffixes = { "n", "nm", "nrm", "nor", "norm", "normal", "normals", "ddn" };
+        return suffixes.contains(nameSuffix(sourcePath));
+    }
+
+    bool TextureCooker::isSrgb(const std::filesystem::path & sourcePath)
+    {
+        static const std::unordered_set<std::string> linearSuffixes = { "s", "spec", "specular", "gloss", "r", "rough", "roughness",
+                                                                        "m", "metal", "metallic", "metalness", "ao", "occlusion",
+                                                                        "h", "height", "disp", "displacement", "bump", "mask" };
+
+        return !isNormalMap(sourcePath) && !linearSuffixes.contains(nameSuffix(sourcePath));
+    }
+
+    bool TextureCooker::isSupported(const std::filesystem::path & sourcePath)
+    {
+        static const std::unordered_set<std::string> extensions = { ".png", ".jpg", ".jpeg", ".tga", ".bmp", ".psd", ".gif" };
+
+        std::string extension = sourcePath.extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return char(std::tolower(c)); });
+
+        return extensions.contains(extension);
+    }
+
+    bool TextureCooker::selfTest()
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        struct TestBlock
+        {
+            const char* name;
+            uint8_t     texels[16 * 4];
+        };
+
+        TestBlock testBlocks[4] = { { "solid", {} }, { "ascending gradient", {} }, { "descending gradient", {} }, { "checker", {} } };
+
+        for (uint32_t i = 0; i < 16; ++i)
+        {
+            const uint8_t solid[4]    = { 200, 90, 30, 255 };
+            const uint8_t gradient[4] = { uint8_t(60 + 3 * i), uint8_t(180 - 3 * i), uint8_t(100 + 2 * i), uint8_t(255 - 4 * i) };
+            const uint8_t checker     = ((i % 4) + (i / 4)) % 2 ? 255 : 0;
+
+            for (uint32_t c = 0; c < 4; ++c)
+            {
+                testBlocks[0].texels[i * 4 + c]        = solid[c];
+                testBlocks[1].texels[i * 4 + c]        = gradient[c];
+                testBlocks[2].texels[(15 - i) * 4 + c] = gradient[c]; // the first index of BC7 points at the second endpoint
+                testBlocks[3].texels[i * 4 + c]        = checker;
+            }
+        }
+
+        struct TestFormat
+        {
+            Format   format;
+            uint32_t channelsCount; // compared from the red one
+            float    maxError;      // root mean square of the channels
+        };
+
+        const TestFormat testFormats[] = { { Format::BC1, 3, 8.0f }, { Format::BC3, 4, 8.0f }, { Format::BC4, 1, 4.0f },
+                                           { Format::BC5, 2, 4.0f }, { Format::BC7, 4, 4.0f } };
+
+        bool passed = true;
+        for (auto& testFormat : testFormats)
+        {
+            for (auto& testBlock : testBlocks)
+            {
+                Image image;
+                image.width  = 4;
+                image.height = 4;
+                image.rgba.assign(testBlock.texels, testBlock.texels + 16 * 4);
+
+                std::vector<uint8_t> blocks;
+                encodeLevel(image, testFormat.format, blocks);
+
+                uint8_t decoded[16 * 4];
+                decodeBlock(blocks.data(), testFormat.format, decoded);
+
+                float squaredError = 0.0f;
+                for (uint32_t i = 0; i < 16; ++i)
+                {
+                    for (uint32_t c = 0; c < testFormat.channelsCount; ++c)
+                    {
+                        float delta   = float(decoded[i * 4 + c]) - float(image.rgba[i * 4 + c]);
+                        squaredError += delta * delta;
+                    }
+                }
+
+                float error = glm::sqrt(squaredError / float(16 * testFormat.channelsCount));
+                if (error > testFormat.maxError)
+                {
+                    MG_CORE_ERROR("TextureCooker: the {} block of {} has the error {:.2f}, more than {:.2f}.",
+                                  testBlock.name, formatName(testFormat.format), error, testFormat.maxError);
+                    passed = false;
+                }
+            }
+        }
+
+        return passed;
+    }
+}
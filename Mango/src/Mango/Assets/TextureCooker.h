@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+namespace mango
+{
+    /*
+     * Offline (no GL calls) cooking of the textures into the block compressed DDS files with the whole mip chains.
+     * The cooked file is kept next to the source, e.g. wall.png -> wall.png.srgb.dds, and it's stored bottom-up like the GL textures.
+     * The mips are filtered with a Kaiser windowed sinc, in the linear space of the sRGB textures, and the normal maps are renormalized.
+     * The format is picked from the file name and the pixels: BC5 for the normal maps, BC4 for the grayscale linear textures, BC1 or BC3 (with alpha)
+     * for the rest, or BC7 if the options ask for it. AssetManager::createTexture2D prefers the cooked file if it's up to date.
+     * MangoCooker runs it from the command line, e.g. as a build step.
+     */
+    class TextureCooker final
+    {
+    public:
+        enum class Format { BC1, BC3, BC4, BC5, BC7 };
+
+        struct Options
+        {
+            bool useBC7 = false; // for the color textures, instead of BC1 and BC3
+            bool force  = false; // cooks also the textures that are up to date
+        };
+
+        struct Statistics
+        {
+            uint32_t cookedCount   = 0;
+            uint32_t upToDateCount = 0;
+            uint32_t failedCount   = 0;
+        };
+
+        TextureCooker() = delete;
+
+        // Cooks the textures of the directory and of its subdirectories, in parallel on Jobs::executor
+        static Statistics cookDirectory(const std::filesystem::path & directory, const Options & options = {});
+
+        static bool cook(const std::filesystem::path & sourcePath, const Options & options = {});
+
+        // VFI name of the cooked texture, empty if there isn't one or the source was saved after it. A texture cooked in the other color space is logged
+        static std::string findCooked(const std::string & filename, bool isSrgb);
+
+        // Encodes the test blocks with every format and decodes them back on the CPU, false if any error is over its tolerance.
+        // MangoCooker --self-test runs it
+        static bool selfTest();
+
+        static std::filesystem::path getCookedPath(const std::filesystem::path & sourcePath, bool isSrgb);
+
+        // Guessed from the file name, e.g. wall_normal.png or wall_ddn.tga
+        static bool isNormalMap(const std::filesystem::path & sourcePath);
+        static bool isSrgb     (const std::filesystem::path & sourcePath);
+        static bool isSupported(const std::filesystem::path & sourcePath);
+    };
+}
@@ -2,6 +2,9 @@
 
 #include "Application.h"
 #include "CVars.h"
+#include "Mango/Profiling/GPUProfiler.h"
+#include "Mango/Rendering/GPUUploads.h"
+#include "Mango/Rendering/TextureStreaming.h"
 #include "Mango/Scene/SceneManager.h"
 #include "Mango/Scene/SelectionManager.h"
 #include "Mango/Systems/AudioSystem.h"
@@ -28,6 +31,9 @@ namespace mango
         // Set CVars
         CVarFloat CVarCameraRotationSpeed("camera.rotationSpeed", "rotation speed of the camera", 0.2f);
         CVarFloat CVarCameraMoveSpeed    ("camera.moveSpeed",     "movement speed of the camera", 10.0f);
+        CVarFloat CVarIdleFramerate      ("app.idleFramerate",    "tick rate when the renderer is idle (see renderer.renderOnDemand)", 10.0f);
+        CVarFloat CVarAsyncLoadsBudget   ("assets.asyncLoadsBudgetMs", "main thread time per frame for finishing the asynchronous asset loads", 4.0f);
+        CVarInt   CVarAsyncLoading       ("assets.asyncLoading",  "load the textures and meshes of the opened scenes on the worker threads", 1, CVarFlags::EditCheckbox);
 
         // Parse command line args. 
         // TODO: replace with CLI11
@@ -121,6 +127,7 @@ namespace mango
         mango::VFI::addToSearchPath(rootDir / "Mango/resources/shaders");
 
         // Init core services
+        GPUUploads::init();
         AssetManager::initDefaultAssets();
 
         m_eventBus     = new EventBus();
@@ -157,6 +164,7 @@ namespace mango
         delete m_sceneManager;
         delete m_eventBus;
 
+        GPUUploads::shutdown();
         VFI::deinit();
     }
 
@@ -165,6 +173,8 @@ namespace mango
         MG_PROFILE_ZONE_SCOPED;
         m_runtimeSystems.add(system);
         system->onInit();
+
+        m_hasClientSystems = true;
     }
 
     void Application::addEditorSystem(System* system)
@@ -237,12 +247,24 @@ namespace mango
                     {
                         m_physicsSystem->onUpdate(physicsDeltaTime);
                         physicsFreq = 0.0f;
+
+                        // The simulated bodies move the entities
+                        if (m_physicsSystem->isRunning())
+                        {
+                            Services::renderer()->requestRedraw();
+                        }
                     }
                 }
 
                 if (!m_isPaused || m_stepFrames-- > 0)
                 {
                     m_runtimeSystems.updateAll(m_frameTime);
+
+                    // The scripts of the client can change the scene on any update
+                    if (m_hasClientSystems)
+                    {
+                        Services::renderer()->requestRedraw();
+                    }
                 }
 
                 m_editorSystems.updateAll(m_frameTime);
@@ -259,6 +281,20 @@ namespace mango
             if (shouldRender)
             {
                 MG_PROFILE_ZONE_NAMED_N(zone3, "Game Loop Render", true);
+
+                // Before the rendering, so the finished assets are drawn in this frame
+                if (AssetManager::hasAsyncLoads())
+                {
+                    AssetManager::finishAsyncLoads(float(*CVarSystem::get()->getFloatCVar("assets.asyncLoadsBudgetMs")));
+                    Services::renderer()->requestRedraw();
+                }
+
+                // With the mip requests of the previous frame
+                if (TextureStreaming::update())
+                {
+                    Services::renderer()->requestRedraw();
+                }
+
                 m_renderingSystems.updateAll(m_frameTime);
 
                 m_imGuiSystem->being();
@@ -274,8 +310,27 @@ namespace mango
                 }
                 m_imGuiSystem->end();
 
+                Services::renderer()->getGPUProfiler()->endFrame();
+                GPUUploads::endFrame();
+                MG_RENDER_STATS_END_FRAME;
+
                 m_window->endFrame();
                 frames++;
+
+                // Nothing to render: sleep until the input arrives or the idle tick, instead of spinning.
+                // The asynchronous loads and the streamed mips keep the loop running, so they are finished as soon as they are read
+                if (Services::renderer()->isIdle() && !AssetManager::hasAsyncLoads() && !TextureStreaming::hasPendingLoads())
+                {
+                    double idleFramerate = glm::max(double(*CVarSystem::get()->getFloatCVar("app.idleFramerate")), 1.0);
+                    m_window->waitEvents(1.0 / idleFramerate);
+
+                    // Run a single update after waking up rather than catching up with all of the skipped ticks
+                    double now = Timer::getTime();
+
+                    frameCounter   += now - lastTime;
+                    lastTime        = now;
+                    unprocessedTime = m_frameTime;
+                }
             }
 
             MG_PROFILE_FRAME_MARK;
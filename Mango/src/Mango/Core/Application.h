@@ -84,6 +84,7 @@ namespace mango
         int    m_stepFrames       = 0;
         bool   m_isRunning        = true;
         bool   m_isPaused         = false;
+        bool   m_hasClientSystems = false; // added with addRuntimeSystem, e.g. the game scripts
     };
 
     // Client must define this function
@@ -1,16 +1,82 @@
 #include "mgpch.h"
 #include "AssetManager.h"
 
+#include "Jobs.h"
+#include "Services.h"
+#include "Timer.h"
 #include "Mango/Assets/AssimpMeshImporter.h"
+#include "Mango/Assets/TextureCooker.h"
+#include "Mango/Events/AssetEvents.h"
+#include "Mango/Rendering/ShaderPreprocessor.h"
+#include "Mango/Rendering/TextureStreaming.h"
+
+#include <deque>
+#include <limits>
+#include <mutex>
+#include <thread>
 
 namespace mango
 {
+    namespace
+    {
+        // Decoded on a worker thread, the callback creates the GL objects on the main thread
+        struct DecodedLoad
+        {
+            std::string           name;
+            std::function<void()> finish;
+        };
+
+        struct AsyncLoads
+        {
+            std::mutex              mutex;
+            std::deque<DecodedLoad> decoded;
+
+            AssetManager::AsyncLoadsProgress                              progress;
+            std::function<void(const AssetManager::AsyncLoadsProgress &)> callback;
+        };
+
+        AsyncLoads & asyncLoads()
+        {
+            static AsyncLoads s;
+            return s;
+        }
+
+        // decode runs on a worker thread and returns the callback that finishes the load
+        void requestAsyncLoad(const std::string & name, std::function<std::function<void()>()> decode)
+        {
+            auto & loads = asyncLoads();
+            if (loads.progress.finishedCount == loads.progress.requestedCount)
+            {
+                loads.progress = {};
+            }
+            ++loads.progress.requestedCount;
+
+            Jobs::executor.silent_async([name, decode = std::move(decode)]()
+            {
+                auto finish = decode();
+
+                auto & loads = asyncLoads();
+                std::lock_guard<std::mutex> lock(loads.mutex);
+                loads.decoded.push_back({ name, std::move(finish) });
+            });
+        }
+
+        // The placeholder textures: mid gray for the colors, the flat normal for the linear data
+        glm::uvec4 placeholderColor(bool isSrgb)
+        {
+            return isSrgb ? glm::uvec4(128, 128, 128, 255) : glm::uvec4(128, 128, 255, 255);
+        }
+    }
+
     std::unordered_map<std::string, ref<Font>>       AssetManager::m_loadedFonts;
     std::unordered_map<std::string, ref<Material>>   AssetManager::m_loadedMaterials;
     std::unordered_map<std::string, ref<Shader>>     AssetManager::m_loadedShaders;
     std::unordered_map<std::string, ref<Mesh>>       AssetManager::m_loadedStaticMeshes;
     std::unordered_map<std::string, ref<Texture>>    AssetManager::m_loadedTextures;
 
+    std::unordered_map<std::string, ref<VertexAnimation>>  AssetManager::m_loadedVertexAnimations;
+    std::unordered_map<std::string, ref<TerrainHeightmap>> AssetManager::m_loadedTerrainHeightmaps;
+
     ref<Font> AssetManager::createFont(const std::string & fontNname, const std::string& filename, GLuint fontHeight)
     {
         MG_PROFILE_ZONE_SCOPED;
@@ -39,6 +105,20 @@ namespace mango
         return material;
     }
 
+    ref<Material> AssetManager::createMaterialInstance(const std::string& instanceName, const ref<Material>& parent)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+        if (m_loadedMaterials.contains(instanceName))
+        {
+            return m_loadedMaterials[instanceName];
+        }
+
+        auto instance = createRef<MaterialInstance>(parent, instanceName);
+        m_loadedMaterials[instanceName] = instance;
+
+        return instance;
+    }
+
     ref<Texture> AssetManager::createTexture2D(const std::string& filename, bool isSrgb /*= false*/, GLint numMipmaps /*= 1*/)
     {
         MG_PROFILE_ZONE_SCOPED;
@@ -56,6 +136,16 @@ namespace mango
         {
             texture2D->createTextureDDS(filename);
         }
+        else if (auto cookedName = TextureCooker::findCooked(filename, isSrgb); !cookedName.empty())
+        {
+            // Block compressed with the whole mip chain, the large ones are streamed. The source keeps naming the texture
+            auto isStreaming = CVarSystem::get()->getIntCVar("renderer.textureStreaming");
+            if (!((!isStreaming || *isStreaming) && TextureStreaming::createTexture(texture2D, cookedName)))
+            {
+                texture2D->createTextureDDS(cookedName, false);
+            }
+            texture2D->setName(filename);
+        }
         else
         {
             texture2D->createTexture2d(filename, isSrgb, numMipmaps);
@@ -131,6 +221,237 @@ namespace mango
         return staticMesh;
     }
 
+    ref<Texture> AssetManager::createTexture2DAsync(const std::string& filename, bool isSrgb /*= false*/, GLint numMipmaps /*= 1*/)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        // DDS files (also the cooked ones) are copied as they are, there is nothing to decode
+        if (m_loadedTextures.contains(filename) || std::filesystem::path(filename).extension() == ".dds" || !TextureCooker::findCooked(filename, isSrgb).empty())
+        {
+            return createTexture2D(filename, isSrgb, numMipmaps);
+        }
+
+        auto texture2D = createRef<Texture>();
+        texture2D->createTexture2d1x1(placeholderColor(isSrgb));
+        texture2D->setName(filename);
+        m_loadedTextures[filename] = texture2D;
+
+        requestAsyncLoad(filename, [texture2D, filename, isSrgb, numMipmaps]() -> std::function<void()>
+        {
+            auto image   = createRef<TextureImage>();
+            bool decoded = Texture::decodeImage(filename, *image);
+
+            return [texture2D, image, decoded, filename, isSrgb, numMipmaps]()
+            {
+                Texture loaded;
+                if (!decoded || !loaded.createTexture2d(*image, isSrgb, numMipmaps))
+                {
+                    MG_CORE_ERROR("Texture failed to load at path: {}", VFI::getFilepath(filename));
+                    return;
+                }
+
+                *texture2D = std::move(loaded);
+            };
+        });
+
+        return texture2D;
+    }
+
+    ref<Texture> AssetManager::createCubeMapTextureAsync(const std::string* filenames, bool isSrgb /*= false*/, GLint numMipmaps /*= 1*/)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        auto filepath = VFI::getFilepath(filenames[0]);
+        std::string filepathString = filepath.parent_path().string();
+
+        if (m_loadedTextures.contains(filepathString))
+        {
+            return m_loadedTextures[filepathString];
+        }
+
+        TextureImage placeholderImages[Texture::CUBE_MAP_FACES_COUNT];
+        for (auto & image : placeholderImages)
+        {
+            auto color = placeholderColor(isSrgb);
+
+            image.pixels        = { uint8_t(color.r), uint8_t(color.g), uint8_t(color.b), uint8_t(color.a) };
+            image.width         = 1;
+            image.height        = 1;
+            image.channelsCount = 4;
+        }
+
+        auto textureCube = createRef<Texture>();
+        textureCube->createTextureCubeMap(placeholderImages, false, 1);
+        m_loadedTextures[filepathString] = textureCube;
+
+        std::vector<std::string> faces(filenames, filenames + Texture::CUBE_MAP_FACES_COUNT);
+
+        requestAsyncLoad(filepathString, [textureCube, faces, isSrgb, numMipmaps]() -> std::function<void()>
+        {
+            auto images  = createRef<std::vector<TextureImage>>(Texture::CUBE_MAP_FACES_COUNT);
+            bool decoded = true;
+
+            for (uint32_t i = 0; i < Texture::CUBE_MAP_FACES_COUNT && decoded; ++i)
+            {
+                decoded = Texture::decodeImage(faces[i], (*images)[i], false);
+            }
+
+            return [textureCube, images, decoded, faces, isSrgb, numMipmaps]()
+            {
+                Texture loaded;
+                if (!decoded || !loaded.createTextureCubeMap(images->data(), isSrgb, numMipmaps))
+                {
+                    MG_CORE_ERROR("Cube map failed to load at path: {}", VFI::getFilepath(faces[0]).parent_path());
+                    return;
+                }
+
+                *textureCube = std::move(loaded);
+            };
+        });
+
+        return textureCube;
+    }
+
+    ref<Mesh> AssetManager::createMeshFromFileAsync(const std::string & filename)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        if (m_loadedStaticMeshes.contains(filename))
+        {
+            return m_loadedStaticMeshes[filename];
+        }
+
+        auto staticMesh = createRef<Mesh>(filename);
+        staticMesh->genCube(1.0f);
+        m_loadedStaticMeshes[filename] = staticMesh;
+
+        // The components copy the material table of the placeholder. Its own unlisted instance of the default material marks
+        // the slots that weren't set, so they get the materials of the loaded mesh (see RenderingSystem::receive(MeshLoadedEvent))
+        MaterialTable placeholderMaterials = { createRef<MaterialInstance>(getMaterial("DefaultMaterial"), filename) };
+        staticMesh->m_materialTable = placeholderMaterials;
+
+        requestAsyncLoad(filename, [staticMesh, filename, placeholderMaterials]() -> std::function<void()>
+        {
+            auto imported = createRef<AssimpMeshImporter::ImportedMesh>();
+            bool decoded  = AssimpMeshImporter::import(filename, *imported);
+
+            return [staticMesh, imported, decoded, placeholderMaterials]() mutable
+            {
+                if (!decoded || !AssimpMeshImporter::finishLoad(staticMesh, *imported, true))
+                {
+                    return;
+                }
+
+                Services::eventBus()->emit(MeshLoadedEvent(staticMesh, placeholderMaterials));
+            };
+        });
+
+        return staticMesh;
+    }
+
+    void AssetManager::finishAsyncLoads(float budgetMs)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        auto & loads = asyncLoads();
+
+        Timer timer;
+        do
+        {
+            DecodedLoad load;
+            {
+                std::lock_guard<std::mutex> lock(loads.mutex);
+                if (loads.decoded.empty()) break;
+
+                load = std::move(loads.decoded.front());
+                loads.decoded.pop_front();
+            }
+
+            load.finish();
+
+            ++loads.progress.finishedCount;
+            loads.progress.lastFinished = load.name;
+
+            if (loads.callback)
+            {
+                loads.callback(loads.progress);
+            }
+        }
+        while (timer.elapsedMs() < budgetMs);
+    }
+
+    void AssetManager::waitForAsyncLoads()
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        // The finished meshes can request the loads of their textures
+        while (hasAsyncLoads())
+        {
+            finishAsyncLoads(std::numeric_limits<float>::max());
+            std::this_thread::yield();
+        }
+    }
+
+    bool AssetManager::hasAsyncLoads()
+    {
+        auto & progress = asyncLoads().progress;
+        return progress.finishedCount < progress.requestedCount;
+    }
+
+    AssetManager::AsyncLoadsProgress AssetManager::getAsyncLoadsProgress()
+    {
+        return asyncLoads().progress;
+    }
+
+    void AssetManager::setAsyncLoadsCallback(const std::function<void(const AsyncLoadsProgress &)> & callback)
+    {
+        asyncLoads().callback = callback;
+    }
+
+    ref<VertexAnimation> AssetManager::createVertexAnimationFromFile(const std::string & filename)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        if (m_loadedVertexAnimations.contains(filename))
+        {
+            return m_loadedVertexAnimations[filename];
+        }
+
+        auto vertexAnimation = AssimpMeshImporter::loadVertexAnimation(filename);
+        if (vertexAnimation)
+        {
+            m_loadedVertexAnimations[filename] = vertexAnimation;
+        }
+
+        return vertexAnimation;
+    }
+
+    ref<TerrainHeightmap> AssetManager::createTerrainHeightmapFromFile(const std::string & filename)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        if (m_loadedTerrainHeightmaps.contains(filename))
+        {
+            return m_loadedTerrainHeightmaps[filename];
+        }
+
+        auto heightmap = createRef<TerrainHeightmap>(filename);
+        m_loadedTerrainHeightmaps[filename] = heightmap;
+
+        // Cooking the tiles of a large image takes seconds, it's done on a worker thread like the decoding of the async loads
+        requestAsyncLoad(filename, [heightmap]() -> std::function<void()>
+        {
+            bool isLoaded = heightmap->load();
+
+            return [heightmap, isLoaded]()
+            {
+                heightmap->m_isLoaded = isLoaded;
+            };
+        });
+
+        return heightmap;
+    }
+
     ref<Shader> AssetManager::createShader(const std::string & shaderName,
                                            const std::string & computeShaderFilename)
     {
@@ -141,6 +462,7 @@ namespace mango
         }
 
         auto shader = createRef<Shader>(computeShaderFilename);
+        shader->m_name              = shaderName;
         m_loadedShaders[shaderName] = shader;
 
         return shader;
@@ -157,6 +479,7 @@ namespace mango
         }
 
         auto shader = createRef<Shader>(vertexShaderFilename, fragmentShaderFilename);
+        shader->m_name              = shaderName;
         m_loadedShaders[shaderName] = shader;
 
         return shader;
@@ -176,6 +499,7 @@ namespace mango
         auto shader = createRef<Shader>(vertexShaderFilename, 
                                         fragmentShaderFilename, 
                                         geometryShaderFilename);
+        shader->m_name              = shaderName;
         m_loadedShaders[shaderName] = shader;
 
         return shader;
@@ -197,6 +521,7 @@ namespace mango
                                         fragmentShaderFilename,
                                         tessellationControlShaderFilename,
                                         tessellationEvaluationShaderFilename);
+        shader->m_name              = shaderName;
         m_loadedShaders[shaderName] = shader;
 
         return shader;
@@ -220,11 +545,82 @@ namespace mango
                                         geometryShaderFilename,
                                         tessellationControlShaderFilename,
                                         tessellationEvaluationShaderFilename);
+        shader->m_name              = shaderName;
         m_loadedShaders[shaderName] = shader;
 
         return shader;
     }
 
+    void AssetManager::linkPendingShaders()
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        linkShaders(false);
+    }
+
+    uint32_t AssetManager::linkCompletedShaders()
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        return linkShaders(true);
+    }
+
+    uint32_t AssetManager::linkShaders(bool onlyCompleted)
+    {
+        Timer timer;
+
+        uint32_t linkedCount = 0;
+        auto linkPending = [&linkedCount, onlyCompleted](const ref<Shader> & shader)
+        {
+            if (shader->isLinkPending() && (!onlyCompleted || shader->isLinkCompleted()))
+            {
+                shader->link();
+                ++linkedCount;
+            }
+        };
+
+        for (auto & [name, shader] : m_loadedShaders)
+        {
+            linkPending(shader);
+
+            for (auto & [mask, variant] : shader->m_variants)
+            {
+                linkPending(variant);
+            }
+        }
+
+        if (linkedCount > 0)
+        {
+            MG_CORE_INFO("Linked {} shader programs in {:.2f} ms.", linkedCount, timer.elapsedMs());
+        }
+
+        return linkedCount;
+    }
+
+    uint32_t AssetManager::reloadChangedShaders()
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        auto changedFiles = ShaderPreprocessor::collectChangedFiles();
+        if (changedFiles.empty())
+        {
+            return 0;
+        }
+
+        uint32_t reloadedCount = 0;
+        for (auto & [name, shader] : m_loadedShaders)
+        {
+            if (shader->dependsOn(changedFiles))
+            {
+                MG_CORE_INFO("Reloading shader program {}...", name);
+
+                reloadedCount += shader->reload() ? 1 : 0;
+            }
+        }
+
+        return reloadedCount;
+    }
+
     ref<Font> AssetManager::getFont(const std::string& fontName)
     {
         MG_PROFILE_ZONE_SCOPED;
@@ -352,6 +748,11 @@ namespace mango
         m_loadedShaders.clear();
         m_loadedStaticMeshes.clear();
         m_loadedTextures.clear();
+        m_loadedVertexAnimations.clear();
+        m_loadedTerrainHeightmaps.clear();
+
+        TextureStreaming::clear();
+        ShaderPreprocessor::clear();
 
         initDefaultAssets();
     }
@@ -1,10 +1,13 @@
 #pragma once
+#include <functional>
 #include <unordered_map>
 
 #include "Mango/Rendering/Font.h"
 #include "Mango/Rendering/Material.h"
 #include "Mango/Rendering/Mesh.h"
+#include "Mango/Rendering/TerrainHeightmap.h"
 #include "Mango/Rendering/Texture.h"
+#include "Mango/Rendering/VertexAnimation.h"
 
 namespace mango
 {
@@ -13,12 +16,45 @@ namespace mango
     public:
         static ref<Font>       createFont          (const std::string & fontName, const std::string& filename, GLuint fontHeight);
         static ref<Material>   createMaterial      (const std::string & materialName);
+        static ref<Material>   createMaterialInstance(const std::string & instanceName, const ref<Material> & parent);
         static ref<Mesh>       createMesh          (const std::string & meshName);
         static ref<Mesh>       createMeshFromFile  (const std::string & filename);
         static ref<Texture>    createTexture2D     (const std::string & filename, bool isSrgb = false, GLint numMipmaps = 1);
         static ref<Texture>    createTexture2D1x1  (const std::string & textureName, const glm::uvec4 & color);
         static ref<Texture>    createCubeMapTexture(const std::string * filenames, bool isSrgb = false, GLint numMipmaps = 1);
 
+        /*
+         * Return the placeholders at once: the files are read and decoded on the worker threads of Jobs::executor, then
+         * finishAsyncLoads creates the GL objects on the main thread and swaps them into the returned handles. A texture is
+         * a 1x1 placeholder until then, a mesh is a unit cube (MeshLoadedEvent is emitted when it's replaced).
+         */
+        static ref<Texture>    createTexture2DAsync     (const std::string & filename, bool isSrgb = false, GLint numMipmaps = 1);
+        static ref<Texture>    createCubeMapTextureAsync(const std::string * filenames, bool isSrgb = false, GLint numMipmaps = 1);
+        static ref<Mesh>       createMeshFromFileAsync  (const std::string & filename);
+
+        struct AsyncLoadsProgress
+        {
+            uint32_t    requestedCount = 0; // since the previous loads were all finished
+            uint32_t    finishedCount  = 0;
+            std::string lastFinished;
+        };
+
+        // Finishes the decoded loads until the budget runs out, at least one per call. Called once per frame by the Application
+        static void finishAsyncLoads(float budgetMs);
+
+        // Finishes all of the requested loads, it waits for the decoding
+        static void waitForAsyncLoads();
+
+        static bool               hasAsyncLoads();
+        static AsyncLoadsProgress getAsyncLoadsProgress();
+
+        // Called on the main thread after every finished load, e.g. for the loading screens
+        static void setAsyncLoadsCallback(const std::function<void(const AsyncLoadsProgress &)> & callback);
+
+        static ref<VertexAnimation>  createVertexAnimationFromFile (const std::string & filename);
+        // Returns at once, the heightmap is cooked and read on a worker thread and isn't used until it's loaded (see TerrainHeightmap::isLoaded)
+        static ref<TerrainHeightmap> createTerrainHeightmapFromFile(const std::string & filename);
+
         static ref<Shader> createShader(const std::string & shaderName,
                                         const std::string & computeShaderFilename);
 
@@ -44,6 +80,15 @@ namespace mango
                                         const std::string & tessellationControlShaderFilename,
                                         const std::string & tessellationEvaluationShaderFilename);
 
+        // Waits for the links requested by Shader::requestLink(), the driver compiles the requested programs in parallel
+        static void linkPendingShaders();
+
+        // Finishes only the links that the driver has already completed, so the frame doesn't wait for them. Returns how many were linked
+        static uint32_t linkCompletedShaders();
+
+        // Reloads the programs that depend on the shader files saved since the last call, returns how many were reloaded
+        static uint32_t reloadChangedShaders();
+
         static ref<Font>       getFont      (const std::string & fontName);
         static ref<Material>   getMaterial  (const std::string & materialName);
         static ref<Shader>     getShader    (const std::string & shaderName);
@@ -56,14 +101,22 @@ namespace mango
         static std::unordered_map<std::string, ref<Material>>& getMaterialList()   { return m_loadedMaterials; }
         static std::unordered_map<std::string, ref<Mesh>>&     getStaticMeshList() { return m_loadedStaticMeshes; }
 
+        static std::unordered_map<std::string, ref<VertexAnimation>>&  getVertexAnimationList()  { return m_loadedVertexAnimations;  }
+        static std::unordered_map<std::string, ref<TerrainHeightmap>>& getTerrainHeightmapList() { return m_loadedTerrainHeightmaps; }
+
     private:
         AssetManager() {}
         ~AssetManager() {}
 
+        static uint32_t linkShaders(bool onlyCompleted);
+
         static std::unordered_map<std::string, ref<Font>>     m_loadedFonts;
         static std::unordered_map<std::string, ref<Material>> m_loadedMaterials;
         static std::unordered_map<std::string, ref<Shader>>   m_loadedShaders;
         static std::unordered_map<std::string, ref<Mesh>>     m_loadedStaticMeshes;
         static std::unordered_map<std::string, ref<Texture>>  m_loadedTextures;
+
+        static std::unordered_map<std::string, ref<VertexAnimation>>  m_loadedVertexAnimations;
+        static std::unordered_map<std::string, ref<TerrainHeightmap>> m_loadedTerrainHeightmaps;
     };
 }
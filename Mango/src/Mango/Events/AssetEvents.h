@@ -0,0 +1,20 @@
+#pragma once
+
+#include "Event.h"
+#include "Mango/Core/Base.h"
+#include "Mango/Rendering/Material.h"
+
+namespace mango
+{
+    class Mesh;
+
+    // The asynchronous load of the mesh has replaced its placeholder (see AssetManager::createMeshFromFileAsync)
+    struct MeshLoadedEvent : Event
+    {
+        MeshLoadedEvent(const ref<Mesh>& mesh, const MaterialTable& placeholderMaterials)
+            : mesh(mesh), placeholderMaterials(placeholderMaterials) {}
+
+        ref<Mesh>     mesh;
+        MaterialTable placeholderMaterials; // the components still holding them get the materials of the loaded mesh
+    };
+}
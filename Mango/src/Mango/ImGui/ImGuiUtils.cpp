@@ -179,6 +179,17 @@ namespace ImGui::Utils
         return ret;
     }
 
+    bool TableDragFloat2(const char* label, float v[2], float v_speed /*= 1.0f*/, float v_min /*= 0.0f*/, float v_max /*= 0.0f*/, const char* format /*= "%.3f"*/, ImGuiSliderFlags flags /*= 0*/)
+    {
+        TableDrawLabelAlignedLeft(label);
+
+        ImGui::PushID(label);
+        bool ret = ImGui::DragFloat2("##", v, v_speed, v_min, v_max, format, flags);
+        ImGui::PopID();
+
+        return ret;
+    }
+
     bool TableDragFloat3(const char* label, float v[3], float v_speed /*= 1.0f*/, float v_min /*= 0.0f*/, float v_max /*= 0.0f*/, const char* format /*= "%.3f"*/, ImGuiSliderFlags flags /*= 0*/)
     {
         TableDrawLabelAlignedLeft(label);
@@ -189,4 +200,26 @@ namespace ImGui::Utils
 
         return ret;
     }
+
+    bool TableDragFloat4(const char* label, float v[4], float v_speed /*= 1.0f*/, float v_min /*= 0.0f*/, float v_max /*= 0.0f*/, const char* format /*= "%.3f"*/, ImGuiSliderFlags flags /*= 0*/)
+    {
+        TableDrawLabelAlignedLeft(label);
+
+        ImGui::PushID(label);
+        bool ret = ImGui::DragFloat4("##", v, v_speed, v_min, v_max, format, flags);
+        ImGui::PopID();
+
+        return ret;
+    }
+
+    bool TableDragUint(const char* label, uint32_t* v, float v_speed /*= 1.0f*/, uint32_t v_min /*= 0*/, uint32_t v_max /*= 0*/, const char* format /*= "%u"*/, ImGuiSliderFlags flags /*= 0*/)
+    {
+        TableDrawLabelAlignedLeft(label);
+
+        ImGui::PushID(label);
+        bool ret = ImGui::DragScalar("##", ImGuiDataType_U32, v, v_speed, &v_min, &v_max, format, flags);
+        ImGui::PopID();
+
+        return ret;
+    }
 }
\ No newline at end of file
@@ -0,0 +1,213 @@
+#include "mgpch.h"
+
+#include "GPUProfiler.h"
+
+namespace mango
+{
+    GPUProfiler::~GPUProfiler()
+    {
+        for (auto & frame : m_frames)
+        {
+            if (!frame.queriesPool.empty())
+            {
+                glDeleteQueries(GLsizei(frame.queriesPool.size()), frame.queriesPool.data());
+            }
+        }
+    }
+
+    void GPUProfiler::init()
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        m_frameTiming.name = "Frame";
+
+        for (auto & frame : m_frames)
+        {
+            frame.queriesPool.resize(64);
+            glCreateQueries(GL_TIMESTAMP, GLsizei(frame.queriesPool.size()), frame.queriesPool.data());
+        }
+    }
+
+    void GPUProfiler::beginFrame()
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        if (!*CVarSystem::get()->getIntCVar("renderer.gpuProfiler"))
+        {
+            return;
+        }
+
+        MG_CORE_ASSERT_MSG(!m_frameStarted, "GPUProfiler::beginFrame called twice without GPUProfiler::endFrame!");
+
+        auto & frame = m_frames[m_currentFrame];
+
+        frame.usedQueriesCount = 0;
+        frame.passes.clear();
+        frame.beginQuery = acquireQuery(frame);
+
+        glQueryCounter(frame.beginQuery, GL_TIMESTAMP);
+
+        m_frameStarted = true;
+    }
+
+    void GPUProfiler::endFrame()
+    {
+        MG_PROFILE_ZONE_SCOPED;
+        MG_PROFILE_GL_ZONE("GPUProfiler::endFrame");
+
+        if (!m_frameStarted)
+        {
+            return;
+        }
+
+        MG_CORE_ASSERT_MSG(m_openPasses.empty(), "Not all GPU passes were ended!");
+
+        auto & frame = m_frames[m_currentFrame];
+
+        frame.endQuery = acquireQuery(frame);
+        glQueryCounter(frame.endQuery, GL_TIMESTAMP);
+
+        frame.issued   = true;
+        m_frameStarted = false;
+
+        // The oldest frame in flight will be reused by the next beginFrame(), so read it now (if the GPU is done with it)
+        m_currentFrame = (m_currentFrame + 1) % FRAMES_IN_FLIGHT;
+
+        if (m_frames[m_currentFrame].issued)
+        {
+            resolveFrame(m_frames[m_currentFrame]);
+        }
+    }
+
+    void GPUProfiler::beginPass(const std::string & name)
+    {
+        if (!m_frameStarted)
+        {
+            return;
+        }
+
+        auto & frame = m_frames[m_currentFrame];
+
+        if (!m_passIndices.contains(name))
+        {
+            m_passIndices[name] = uint32_t(m_passTimings.size());
+
+            GPUPassTiming timing;
+            timing.name  = name;
+            timing.depth = uint32_t(m_openPasses.size());
+
+            m_passTimings  .push_back(timing);
+            m_passHistories.push_back({});
+        }
+
+        PassQueries pass;
+        pass.timingIndex = m_passIndices[name];
+        pass.beginQuery  = acquireQuery(frame);
+
+        glQueryCounter(pass.beginQuery, GL_TIMESTAMP);
+
+        m_openPasses.push_back(uint32_t(frame.passes.size()));
+        frame.passes.push_back(pass);
+    }
+
+    void GPUProfiler::endPass()
+    {
+        if (!m_frameStarted || m_openPasses.empty())
+        {
+            return;
+        }
+
+        auto & frame = m_frames[m_currentFrame];
+        auto & pass  = frame.passes[m_openPasses.back()];
+
+        pass.endQuery = acquireQuery(frame);
+        glQueryCounter(pass.endQuery, GL_TIMESTAMP);
+
+        m_openPasses.pop_back();
+    }
+
+    const GPUPassTiming * GPUProfiler::getPassTiming(const std::string & name) const
+    {
+        auto it = m_passIndices.find(name);
+        return it != m_passIndices.end() ? &m_passTimings[it->second] : nullptr;
+    }
+
+    GLuint GPUProfiler::acquireQuery(FrameQueries & frame)
+    {
+        if (frame.usedQueriesCount == frame.queriesPool.size())
+        {
+            auto oldSize = frame.queriesPool.size();
+
+            frame.queriesPool.resize(oldSize * 2);
+            glCreateQueries(GL_TIMESTAMP, GLsizei(oldSize), frame.queriesPool.data() + oldSize);
+        }
+
+        return frame.queriesPool[frame.usedQueriesCount++];
+    }
+
+    void GPUProfiler::resolveFrame(FrameQueries & frame)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        frame.issued = false;
+
+        // Queries complete in order, so if the last one is ready, all of them are
+        GLint available = 0;
+        glGetQueryObjectiv(frame.endQuery, GL_QUERY_RESULT_AVAILABLE, &available);
+
+        if (!available)
+        {
+            return;
+        }
+
+        auto getTimestamp = [](GLuint query)
+        {
+            GLuint64 timestamp = 0;
+            glGetQueryObjectui64v(query, GL_QUERY_RESULT, &timestamp);
+            return timestamp;
+        };
+
+        // The same pass might have been issued many times in the frame
+        std::vector<float> passesMs(m_passTimings.size(), -1.0f);
+
+        for (auto & pass : frame.passes)
+        {
+            float ms = float(getTimestamp(pass.endQuery) - getTimestamp(pass.beginQuery)) / 1000000.0f;
+
+            auto & passMs = passesMs[pass.timingIndex];
+            passMs = (passMs < 0.0f) ? ms : passMs + ms;
+        }
+
+        for (uint32_t i = 0; i < passesMs.size(); ++i)
+        {
+            if (passesMs[i] >= 0.0f)
+            {
+                addSample(m_passTimings[i], m_passHistories[i], passesMs[i]);
+            }
+        }
+
+        addSample(m_frameTiming, m_frameHistory, float(getTimestamp(frame.endQuery) - getTimestamp(frame.beginQuery)) / 1000000.0f);
+    }
+
+    void GPUProfiler::addSample(GPUPassTiming & timing, TimingHistory & history, float ms)
+    {
+        const uint32_t historySize = std::size(history.samples);
+
+        history.samples[history.next] = ms;
+        history.next  = (history.next + 1) % historySize;
+        history.count = glm::min(history.count + 1, historySize);
+
+        float sum = 0.0f, max = 0.0f;
+        for (uint32_t i = 0; i < history.count; ++i)
+        {
+            sum += history.samples[i];
+            max  = glm::max(max, history.samples[i]);
+        }
+
+        timing.lastMs    = ms;
+        timing.averageMs = sum / float(history.count);
+        timing.maxMs     = max;
+
+        ++timing.samplesCount;
+    }
+}
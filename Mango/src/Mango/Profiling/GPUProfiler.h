@@ -0,0 +1,118 @@
+#pragma once
+#include "glad/glad.h"
+#include "RenderStats.h"
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace mango
+{
+    struct GPUPassTiming
+    {
+        std::string name         = "";
+        uint32_t    depth        = 0; // nesting level of the pass
+        float       lastMs       = 0.0f;
+        float       averageMs    = 0.0f;
+        float       maxMs        = 0.0f;
+        uint32_t    samplesCount = 0; // resolved so far, changes when a new result arrives
+    };
+
+    /*
+     * Measures GPU time of the render passes with GL_TIMESTAMP queries, independently of Tracy.
+     * Queries are triple-buffered and read only when their results are available, so reading never stalls the CPU.
+     * Passes can be nested and the same pass can be issued many times per frame (its times are summed).
+     */
+    class GPUProfiler
+    {
+    public:
+        GPUProfiler() = default;
+        ~GPUProfiler();
+
+        void init();
+
+        void beginFrame();
+        void endFrame();
+
+        void beginPass(const std::string & name);
+        void endPass();
+
+        const std::vector<GPUPassTiming> & getPassTimings() const { return m_passTimings; }
+        const GPUPassTiming              & getFrameTiming() const { return m_frameTiming; }
+
+        // Nullptr if the pass hasn't been issued yet
+        const GPUPassTiming * getPassTiming(const std::string & name) const;
+
+    private:
+        struct PassQueries
+        {
+            uint32_t timingIndex;
+            GLuint   beginQuery;
+            GLuint   endQuery = 0;
+        };
+
+        struct FrameQueries
+        {
+            std::vector<GLuint>      queriesPool;
+            uint32_t                 usedQueriesCount = 0;
+            std::vector<PassQueries> passes;
+            GLuint                   beginQuery       = 0;
+            GLuint                   endQuery         = 0;
+            bool                     issued           = false;
+        };
+
+        struct TimingHistory
+        {
+            float    samples[64] = {};
+            uint32_t next        = 0;
+            uint32_t count       = 0;
+        };
+
+        GLuint acquireQuery(FrameQueries & frame);
+        void   resolveFrame(FrameQueries & frame);
+
+        static void addSample(GPUPassTiming & timing, TimingHistory & history, float ms);
+
+    private:
+        static const uint32_t FRAMES_IN_FLIGHT = 3;
+
+        FrameQueries m_frames[FRAMES_IN_FLIGHT];
+        uint32_t     m_currentFrame = 0;
+        bool         m_frameStarted = false;
+
+        std::vector<uint32_t> m_openPasses; // indices into m_frames[m_currentFrame].passes
+
+        std::unordered_map<std::string, uint32_t> m_passIndices;
+        std::vector<GPUPassTiming>                m_passTimings;
+        std::vector<TimingHistory>                m_passHistories;
+
+        GPUPassTiming m_frameTiming;
+        TimingHistory m_frameHistory;
+    };
+
+    class GPUProfilerScope
+    {
+    public:
+        GPUProfilerScope(GPUProfiler * profiler, const char * name)
+            : m_profiler(profiler)
+        {
+            m_profiler->beginPass(name);
+            MG_RENDER_STATS_BEGIN_PASS(name);
+        }
+
+        ~GPUProfilerScope()
+        {
+            m_profiler->endPass();
+            MG_RENDER_STATS_END_PASS;
+        }
+
+    private:
+        GPUProfiler * m_profiler;
+    };
+}
+
+#define MG_GPU_PASS_CONCAT_IMPL(a, b) a##b
+#define MG_GPU_PASS_CONCAT(a, b)      MG_GPU_PASS_CONCAT_IMPL(a, b)
+
+// Measures the GPU time of the enclosing scope and attributes its render stats to the pass
+#define MG_GPU_PASS(profiler, name) ::mango::GPUProfilerScope MG_GPU_PASS_CONCAT(gpuPassScope, __LINE__)(profiler, name)
@@ -0,0 +1,177 @@
+#include "mgpch.h"
+
+#include "RenderStats.h"
+
+namespace mango
+{
+    namespace
+    {
+        struct RenderStatsState
+        {
+            RenderStatsState()
+            {
+                passes.push_back({ "Other", 0, {} });
+            }
+
+            std::unordered_map<std::string, uint32_t> passIndices;
+            std::vector<RenderPassCounters>           passes;     // passes[0] collects the work done outside of any pass
+            std::vector<uint32_t>                     openPasses; // indices into passes
+
+            uint32_t visibleEntities = 0;
+            uint32_t culledEntities  = 0;
+            uint32_t visibleMeshlets = 0;
+            uint32_t culledMeshlets  = 0;
+
+            RenderFrameStats lastFrame;
+        };
+
+        RenderStatsState & state()
+        {
+            static RenderStatsState s;
+            return s;
+        }
+    }
+
+    RenderCounters & RenderCounters::operator+=(const RenderCounters & rhs)
+    {
+        drawCalls     += rhs.drawCalls;
+        instances     += rhs.instances;
+        triangles     += rhs.triangles;
+        vertices      += rhs.vertices;
+        programBinds  += rhs.programBinds;
+        vaoBinds      += rhs.vaoBinds;
+        textureBinds  += rhs.textureBinds;
+        uniformCalls  += rhs.uniformCalls;
+        bytesUploaded += rhs.bytesUploaded;
+
+        return *this;
+    }
+
+    void RenderStats::endFrame()
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        auto & s = state();
+
+        MG_CORE_ASSERT_MSG(s.openPasses.empty(), "Not all render stats passes were ended!");
+        s.openPasses.clear();
+
+        auto & frame = s.lastFrame;
+
+        frame.total           = {};
+        frame.passes          = s.passes;
+        frame.visibleEntities = s.visibleEntities;
+        frame.culledEntities  = s.culledEntities;
+        frame.visibleMeshlets = s.visibleMeshlets;
+        frame.culledMeshlets  = s.culledMeshlets;
+
+        for (auto & pass : s.passes)
+        {
+            frame.total += pass.counters;
+            pass.counters = {};
+        }
+
+        s.visibleEntities = 0;
+        s.culledEntities  = 0;
+        s.visibleMeshlets = 0;
+        s.culledMeshlets  = 0;
+
+        MG_PROGILE_PLOT_VALUE("Draw Calls",       int64_t(frame.total.drawCalls));
+        MG_PROGILE_PLOT_VALUE("Instances",        int64_t(frame.total.instances));
+        MG_PROGILE_PLOT_VALUE("Triangles",        int64_t(frame.total.triangles));
+        MG_PROGILE_PLOT_VALUE("Vertices",         int64_t(frame.total.vertices));
+        MG_PROGILE_PLOT_VALUE("Program Binds",    int64_t(frame.total.programBinds));
+        MG_PROGILE_PLOT_VALUE("VAO Binds",        int64_t(frame.total.vaoBinds));
+        MG_PROGILE_PLOT_VALUE("Texture Binds",    int64_t(frame.total.textureBinds));
+        MG_PROGILE_PLOT_VALUE("Uniform Calls",    int64_t(frame.total.uniformCalls));
+        MG_PROGILE_PLOT_VALUE("Bytes Uploaded",   int64_t(frame.total.bytesUploaded));
+        MG_PROGILE_PLOT_VALUE("Visible Entities", int64_t(frame.visibleEntities));
+        MG_PROGILE_PLOT_VALUE("Culled Entities",  int64_t(frame.culledEntities));
+        MG_PROGILE_PLOT_VALUE("Visible Meshlets", int64_t(frame.visibleMeshlets));
+        MG_PROGILE_PLOT_VALUE("Culled Meshlets",  int64_t(frame.culledMeshlets));
+    }
+
+    void RenderStats::beginPass(const char * name)
+    {
+        auto & s = state();
+
+        auto it = s.passIndices.find(name);
+        if (it == s.passIndices.end())
+        {
+            RenderPassCounters pass;
+            pass.name  = name;
+            pass.depth = uint32_t(s.openPasses.size());
+
+            it = s.passIndices.emplace(name, uint32_t(s.passes.size())).first;
+            s.passes.push_back(pass);
+        }
+
+        s.openPasses.push_back(it->second);
+    }
+
+    void RenderStats::endPass()
+    {
+        auto & s = state();
+
+        if (!s.openPasses.empty())
+        {
+            s.openPasses.pop_back();
+        }
+    }
+
+    void RenderStats::draw(GLenum mode, uint32_t verticesCount, uint32_t instancesCount)
+    {
+        // Non-instanced draws are reported with 0 instances
+        instancesCount = glm::max(instancesCount, 1u);
+
+        uint64_t triangles = 0;
+        switch (mode)
+        {
+            case GL_TRIANGLES:
+                triangles = verticesCount / 3;
+                break;
+            case GL_TRIANGLE_STRIP:
+            case GL_TRIANGLE_FAN:
+                triangles = verticesCount > 2 ? verticesCount - 2 : 0;
+                break;
+            case GL_TRIANGLES_ADJACENCY:
+                triangles = verticesCount / 6;
+                break;
+        }
+
+        auto & counters = current();
+
+        counters.drawCalls += 1;
+        counters.instances += instancesCount;
+        counters.triangles += triangles     * instancesCount;
+        counters.vertices  += verticesCount * uint64_t(instancesCount);
+    }
+
+    void RenderStats::addEntities(uint32_t visible, uint32_t culled)
+    {
+        auto & s = state();
+
+        s.visibleEntities += visible;
+        s.culledEntities  += culled;
+    }
+
+    void RenderStats::addMeshlets(uint32_t visible, uint32_t culled)
+    {
+        auto & s = state();
+
+        s.visibleMeshlets += visible;
+        s.culledMeshlets  += culled;
+    }
+
+    RenderCounters & RenderStats::current()
+    {
+        auto & s = state();
+
+        return s.passes[s.openPasses.empty() ? 0 : s.openPasses.back()].counters;
+    }
+
+    const RenderFrameStats & RenderStats::getLastFrame()
+    {
+        return state().lastFrame;
+    }
+}
@@ -0,0 +1,87 @@
+#pragma once
+#include "glad/glad.h"
+
+#include <string>
+#include <vector>
+
+namespace mango
+{
+    struct RenderCounters
+    {
+        uint32_t drawCalls     = 0;
+        uint32_t instances     = 0;
+        uint64_t triangles     = 0;
+        uint64_t vertices      = 0;
+        uint32_t programBinds  = 0;
+        uint32_t vaoBinds      = 0;
+        uint32_t textureBinds  = 0;
+        uint32_t uniformCalls  = 0;
+        uint64_t bytesUploaded = 0;
+
+        RenderCounters & operator+=(const RenderCounters & rhs);
+    };
+
+    struct RenderPassCounters
+    {
+        std::string    name     = "";
+        uint32_t       depth    = 0; // nesting level of the pass
+        RenderCounters counters = {};
+    };
+
+    struct RenderFrameStats
+    {
+        RenderCounters                  total           = {};
+        std::vector<RenderPassCounters> passes;
+        uint32_t                        visibleEntities = 0;
+        uint32_t                        culledEntities  = 0;
+        uint32_t                        visibleMeshlets = 0;
+        uint32_t                        culledMeshlets  = 0;
+    };
+
+    /*
+     * Counts the work submitted to the driver during a frame. Counters are attributed to the innermost open pass
+     * (passes are opened by MG_GPU_PASS), work submitted outside of any pass lands in the "Other" pass.
+     * Use the MG_RENDER_STATS_* macros below, so the counting compiles out when MG_ENABLE_RENDER_STATS is not defined.
+     */
+    class RenderStats
+    {
+    public:
+        RenderStats() = delete;
+
+        // Publishes the counters collected since the previous call and resets them
+        static void endFrame();
+
+        static void beginPass(const char * name);
+        static void endPass();
+
+        static void draw(GLenum mode, uint32_t verticesCount, uint32_t instancesCount);
+        static void addEntities(uint32_t visible, uint32_t culled);
+        static void addMeshlets(uint32_t visible, uint32_t culled);
+
+        // Counters of the innermost open pass
+        static RenderCounters & current();
+
+        // Stats of the last finished frame
+        static const RenderFrameStats & getLastFrame();
+    };
+}
+
+#ifdef MG_ENABLE_RENDER_STATS
+    #define MG_RENDER_STATS_END_FRAME                     ::mango::RenderStats::endFrame()
+    #define MG_RENDER_STATS_BEGIN_PASS(name)              ::mango::RenderStats::beginPass(name)
+    #define MG_RENDER_STATS_END_PASS                      ::mango::RenderStats::endPass()
+    #define MG_RENDER_STATS_DRAW(mode, count, instances)  ::mango::RenderStats::draw(mode, count, instances)
+    #define MG_RENDER_STATS_ENTITIES(visible, culled)     ::mango::RenderStats::addEntities(visible, culled)
+    #define MG_RENDER_STATS_MESHLETS(visible, culled)     ::mango::RenderStats::addMeshlets(visible, culled)
+    #define MG_RENDER_STATS_INC(counter)                  ++::mango::RenderStats::current().counter
+    #define MG_RENDER_STATS_ADD(counter, value)           ::mango::RenderStats::current().counter += (value)
+#else
+    #define MG_RENDER_STATS_END_FRAME
+    #define MG_RENDER_STATS_BEGIN_PASS(name)
+    #define MG_RENDER_STATS_END_PASS
+    #define MG_RENDER_STATS_DRAW(mode, count, instances)
+    #define MG_RENDER_STATS_ENTITIES(visible, culled)
+    #define MG_RENDER_STATS_MESHLETS(visible, culled)
+    #define MG_RENDER_STATS_INC(counter)
+    #define MG_RENDER_STATS_ADD(counter, value)
+#endif
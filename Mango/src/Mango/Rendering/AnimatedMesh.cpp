@@ -2,6 +2,7 @@
 #include "mgpch.h"
 
 #include "AnimatedMesh.h"
+#include "GPUUploads.h"
 
 #include <glm/gtc/matrix_transform.hpp>
 #include <assimp/postprocess.h>
@@ -413,6 +414,9 @@ namespace mango
         bool hasTangents  = !vertexData.tangents.empty();
         bool hasBonesData = !bonesData.empty();
 
+        // Bind pose bounds
+        calcBounds(vertexData);
+
         std::vector<float> boneWeights; 
         boneWeights.reserve(bonesData.size() * NUM_BONES_PER_VERTEX);
 
@@ -452,31 +456,34 @@ namespace mango
         glNamedBufferStorage(m_vboName, totalSizeBytes, nullptr, GL_DYNAMIC_STORAGE_BIT);
 
         uint64_t offset = 0;
-        glNamedBufferSubData(m_vboName, offset, positionsSizeBytes, vertexData.positions.data());
+        GPUUploads::uploadBuffer(m_vboName, offset, positionsSizeBytes, vertexData.positions.data());
         
         offset += positionsSizeBytes;
-        glNamedBufferSubData(m_vboName, offset, texcoordsSizeBytes, vertexData.texcoords.data());
+        GPUUploads::uploadBuffer(m_vboName, offset, texcoordsSizeBytes, vertexData.texcoords.data());
         
         offset += texcoordsSizeBytes;
-        glNamedBufferSubData(m_vboName, offset, normalsSizeBytes, vertexData.normals.data());
+        GPUUploads::uploadBuffer(m_vboName, offset, normalsSizeBytes, vertexData.normals.data());
         
         if (hasTangents)
         {
             offset += normalsSizeBytes;
-            glNamedBufferSubData(m_vboName, offset, tangentsSizeBytes, vertexData.tangents.data());
+            GPUUploads::uploadBuffer(m_vboName, offset, tangentsSizeBytes, vertexData.tangents.data());
             offset += tangentsSizeBytes;
         }
 
         if (hasBonesData)
         {
-            glNamedBufferSubData(m_vboName, offset, boneWeightsSizeBytes, boneWeights.data());
+            GPUUploads::uploadBuffer(m_vboName, offset, boneWeightsSizeBytes, boneWeights.data());
             offset += boneWeightsSizeBytes;
 
-            glNamedBufferSubData(m_vboName, offset, boneIDsSizeBytes, boneIDs.data());
+            GPUUploads::uploadBuffer(m_vboName, offset, boneIDsSizeBytes, boneIDs.data());
         }
 
-        glCreateBuffers     (1, &m_iboName);
-        glNamedBufferStorage(m_iboName, sizeof(vertexData.indices[0]) * vertexData.indices.size(), vertexData.indices.data(), GL_DYNAMIC_STORAGE_BIT);
+        const GLsizei indicesSizeBytes = vertexData.indices.size() * sizeof(vertexData.indices[0]);
+
+        glCreateBuffers         (1, &m_iboName);
+        glNamedBufferStorage    (m_iboName, indicesSizeBytes, nullptr, GL_DYNAMIC_STORAGE_BIT);
+        GPUUploads::uploadBuffer(m_iboName, 0, indicesSizeBytes, vertexData.indices.data());
 
         glCreateVertexArrays(1, &m_vaoName);
 
@@ -5,6 +5,17 @@
 
 namespace mango
 {
+    void BloomPS::init(const std::string & filterName, const std::string & fragmentShaderFilename)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        PostprocessEffect::init(filterName, fragmentShaderFilename);
+
+        // The brightness is extracted by the shader without keywords
+        m_blurHorizontalShader = m_postprocess->getVariant(Shader::getKeywordMask("BLOOM_BLUR_HORIZONTAL"));
+        m_blurVerticalShader   = m_postprocess->getVariant(Shader::getKeywordMask("BLOOM_BLUR_VERTICAL"));
+    }
+
     void BloomPS::create(int width, int height)
     {
         MG_PROFILE_ZONE_SCOPED;
@@ -12,9 +23,11 @@ namespace mango
 
         m_brightnessBuffer = createRef<RenderTarget>();
         m_brightnessBuffer->create(width, height, RenderTarget::ColorInternalFormat::RGB16F, RenderTarget::DepthInternalFormat::NoDepth);
+        m_brightnessBuffer->setDynamicScaling(true);
 
         m_blurredBuffer = createRef<RenderTarget>();
         m_blurredBuffer->create(width, height, RenderTarget::ColorInternalFormat::RGB16F, RenderTarget::DepthInternalFormat::NoDepth);
+        m_blurredBuffer->setDynamicScaling(true);
     }
 
     void BloomPS::clear()
@@ -48,7 +61,6 @@ namespace mango
         MG_PROFILE_GL_ZONE("BloomPS::extractBrightness");
 
         m_postprocess->bind();
-        m_postprocess->setSubroutine(Shader::Type::FRAGMENT, "extractBrightness");
         m_postprocess->setUniform("threshold", threshold);
 
         m_brightnessBuffer->bind();
@@ -64,17 +76,15 @@ namespace mango
         MG_PROFILE_ZONE_SCOPED;
         MG_PROFILE_GL_ZONE("BloomPS::blurGaussian");
 
-        m_postprocess->bind();
-
         for(unsigned i = 0; i < iterations; ++i)
         {
-            m_postprocess->setSubroutine(Shader::Type::FRAGMENT, "blurGaussianHorizontal");
+            m_blurHorizontalShader->bind();
             m_blurredBuffer->bind();
             glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
             bindBrightnessTexture(0);
             render();
 
-            m_postprocess->setSubroutine(Shader::Type::FRAGMENT, "blurGaussianVertical");
+            m_blurVerticalShader->bind();
             m_brightnessBuffer->bind();
             glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
             bindBlurredTexture(0);
@@ -93,4 +103,11 @@ namespace mango
         glBindFramebuffer(GL_FRAMEBUFFER, 0);
     }
 
+    void BloomPS::setUVScale(const glm::vec2 & uvScale)
+    {
+        m_postprocess         ->setUniform("uv_scale", uvScale);
+        m_blurHorizontalShader->setUniform("uv_scale", uvScale);
+        m_blurVerticalShader  ->setUniform("uv_scale", uvScale);
+    }
+
 }
\ No newline at end of file
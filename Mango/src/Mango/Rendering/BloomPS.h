@@ -12,6 +12,7 @@ namespace mango
 
         BloomPS() = default;
 
+        void init(const std::string & filterName, const std::string & fragmentShaderFilename) override;
         void create(int width, int height);
         void clear();
 
@@ -23,7 +24,13 @@ namespace mango
 
         void clearBuffers();
 
+        // Of the brightness extraction and both of the blurs, they're separate programs
+        void setUVScale(const glm::vec2 & uvScale);
+
     private:
+        ref<Shader> m_blurHorizontalShader;
+        ref<Shader> m_blurVerticalShader;
+
         ref<RenderTarget> m_brightnessBuffer;
         ref<RenderTarget> m_blurredBuffer;
     };
@@ -322,6 +322,9 @@ namespace mango
         //shader->setUniform1f("material.shininess", m_material.m_shininess);
         //shader->setUniform3fv("material.diffuseColor", m_material.m_diffuse_color);
 
+        MG_RENDER_STATS_INC(vaoBinds);
+        MG_RENDER_STATS_DRAW(GL_TRIANGLE_STRIP, m_numElements, 0);
+
         glBindVertexArray(m_vao);
         glDrawElements(GL_TRIANGLE_STRIP, m_numElements, GL_UNSIGNED_INT, NULL);
     }
@@ -0,0 +1,104 @@
+#include "mgpch.h"
+
+#include "Crowds.h"
+#include "Mango/Core/AssetManager.h"
+#include "Mango/Rendering/Shader.h"
+#include "Mango/Rendering/VertexAnimation.h"
+
+namespace mango
+{
+    Crowds::~Crowds()
+    {
+        glDeleteBuffers(1, &m_instancesSsbo);
+    }
+
+    void Crowds::init()
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        m_shader = AssetManager::createShader("Crowd", "Crowd.vert", "GBuffer.frag");
+        m_shader->requestLink();
+
+        glCreateBuffers(1, &m_instancesSsbo);
+    }
+
+    void Crowds::clear()
+    {
+        m_groups.clear();
+        m_instancesCount = 0;
+    }
+
+    void Crowds::addInstance(const ref<VertexAnimation> & animation, const glm::mat4 & model, uint32_t clip, float timeOffset, float speed)
+    {
+        auto & clips = animation->getClips();
+        auto & group = m_groups[animation.get()];
+
+        group.animation = animation;
+
+        auto & selectedClip = clips[glm::min(clip, uint32_t(clips.size()) - 1)];
+        group.instances.push_back({ model, glm::vec4(float(selectedClip.firstFrame), float(selectedClip.framesCount), timeOffset, speed) });
+    }
+
+    void Crowds::render(float time, const std::function<void(ref<Shader> &, const ref<Material> &)> & bindMaterial)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+        MG_PROFILE_GL_ZONE("Crowds::render");
+
+        m_instancesUpload.clear();
+        for (auto & [key, group] : m_groups)
+        {
+            m_instancesUpload.insert(m_instancesUpload.end(), group.instances.begin(), group.instances.end());
+        }
+
+        m_instancesCount = uint32_t(m_instancesUpload.size());
+
+        if (m_instancesUpload.empty()) return;
+
+        GLsizeiptr size = GLsizeiptr(m_instancesUpload.size() * sizeof(Instance));
+
+        // Orphan the buffer of the previous view instead of waiting for it
+        glNamedBufferData(m_instancesSsbo, size, m_instancesUpload.data(), GL_STREAM_DRAW);
+        MG_RENDER_STATS_ADD(bytesUploaded, size);
+
+        // The view and projection are the only globals used, they don't depend on the transform
+        static const TransformComponent identityTransform;
+
+        m_shader->bind();
+        m_shader->updateGlobalUniforms(identityTransform);
+        m_shader->setUniform("time",              time);
+        m_shader->setUniform("frames_per_second", VertexAnimation::FRAMES_PER_SECOND);
+
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, m_instancesSsbo);
+
+        int32_t instanceOffset = 0;
+        for (auto & [key, group] : m_groups)
+        {
+            if (group.instances.empty()) continue;
+
+            auto & mesh      = group.animation->getMesh();
+            auto   materials = mesh->getMaterials();
+
+            m_shader->setUniform("instance_offset", instanceOffset);
+
+            glBindTextureUnit(8, group.animation->getBonesTexture());
+            MG_RENDER_STATS_INC(textureBinds);
+
+            mesh->bind();
+
+            auto & submeshes = mesh->getSubmeshes();
+            for (uint32_t submeshIndex = 0; submeshIndex < submeshes.size(); ++submeshIndex)
+            {
+                auto materialIndex = submeshes[submeshIndex].materialIndex;
+                if (materialIndex >= 0 && materialIndex < int32_t(materials.size()))
+                {
+                    bindMaterial(m_shader, materials[materialIndex]);
+                }
+
+                mesh->render(submeshIndex, uint32_t(group.instances.size()));
+            }
+
+            instanceOffset += int32_t(group.instances.size());
+            group.instances.clear();
+        }
+    }
+}
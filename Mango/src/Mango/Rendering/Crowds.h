@@ -0,0 +1,65 @@
+#pragma once
+#include "glad/glad.h"
+#include "Mango/Core/Base.h"
+#include "Mango/Rendering/Material.h"
+
+#include <functional>
+#include <glm/glm.hpp>
+#include <map>
+#include <vector>
+
+namespace mango
+{
+    class Shader;
+    class VertexAnimation;
+
+    /*
+     * Instanced rendering of the characters played from the baked vertex animations (see CrowdComponent).
+     * The instances of all of the animations are uploaded to one storage buffer, then every submesh of an animation
+     * is drawn with one instanced draw. The clip, its time offset and speed are per instance, the frames are picked
+     * and skinned in Crowd.vert, so no bones are evaluated on the CPU.
+     */
+    class Crowds
+    {
+    public:
+        Crowds() = default;
+        ~Crowds();
+
+        Crowds(const Crowds &)             = delete;
+        Crowds & operator=(const Crowds &) = delete;
+
+        void init();
+        void clear();
+
+        // Queues an instance for the next render
+        void addInstance(const ref<VertexAnimation> & animation, const glm::mat4 & model, uint32_t clip, float timeOffset, float speed);
+
+        // Draws the queued instances into the bound GBuffer and clears the queues, the materials are bound by the caller
+        void render(float time, const std::function<void(ref<Shader> &, const ref<Material> &)> & bindMaterial);
+
+        uint32_t getInstancesCount() const { return m_instancesCount; }
+
+    private:
+        struct Instance
+        {
+            glm::mat4 model;
+            glm::vec4 animation; // first frame, frames count, time offset, speed
+        };
+
+        struct Group
+        {
+            ref<VertexAnimation>  animation;
+            std::vector<Instance> instances;
+        };
+
+    private:
+        std::map<VertexAnimation*, Group> m_groups;
+
+        ref<Shader> m_shader;
+        GLuint      m_instancesSsbo  = 0;
+        uint32_t    m_instancesCount = 0;
+
+        // Staging of the instances of all of the groups, so they are uploaded at once
+        std::vector<Instance> m_instancesUpload;
+    };
+}
@@ -0,0 +1,288 @@
+#include "mgpch.h"
+
+#include "DebugDraw.h"
+#include "DebugMesh.h"
+#include "Mango/Core/AssetManager.h"
+#include "Mango/Rendering/Shader.h"
+#include "Mango/Rendering/Texture.h"
+
+#include <mutex>
+
+namespace mango
+{
+    namespace
+    {
+        struct LineVertex
+        {
+            glm::vec3 position;
+            glm::vec3 color;
+        };
+
+        struct SpriteVertex
+        {
+            glm::vec3 position;
+            float     halfSize;
+            glm::vec3 color;
+        };
+
+        struct SpriteBatch
+        {
+            ref<Texture>              texture;
+            std::vector<SpriteVertex> sprites;
+        };
+
+        struct DebugDrawState
+        {
+            std::mutex mutex; // guards the accumulated geometry
+
+            std::vector<LineVertex>  lines;
+            std::vector<SpriteBatch> spriteBatches; // one per texture
+
+            // Line list (pairs of points) of every shape
+            std::vector<glm::vec3> shapes[size_t(DebugDraw::Shape::COUNT)];
+
+            ref<Shader> linesShader;
+            ref<Shader> spritesShader;
+
+            GLuint linesVao   = 0;
+            GLuint linesVbo   = 0;
+            GLuint spritesVao = 0;
+            GLuint spritesVbo = 0;
+
+            // Staging of the sprites vertices, so all of the batches are uploaded at once
+            std::vector<SpriteVertex> spritesUpload;
+        };
+
+        DebugDrawState & state()
+        {
+            static DebugDrawState s;
+            return s;
+        }
+
+        std::vector<glm::vec3> toLineList(const VertexData & data)
+        {
+            std::vector<glm::vec3> lineList;
+            lineList.reserve(data.indices.size());
+
+            for (auto index : data.indices)
+            {
+                lineList.push_back(data.positions[index]);
+            }
+
+            return lineList;
+        }
+    }
+
+    void DebugDraw::init()
+    {
+        MG_PROFILE_ZONE_SCOPED;
+        MG_PROFILE_GL_ZONE("DebugDraw::init");
+
+        auto & s = state();
+
+        s.shapes[size_t(Shape::BOX)]            = toLineList(DebugMesh::createDebugBoxData());
+        s.shapes[size_t(Shape::CAPSULE)]        = toLineList(DebugMesh::createDebugCapsuleData());
+        s.shapes[size_t(Shape::SPHERE)]         = toLineList(DebugMesh::createDebugSphereData());
+        s.shapes[size_t(Shape::CONE)]           = toLineList(DebugMesh::createDebugConeData());
+        s.shapes[size_t(Shape::DIR_LIGHT)]      = toLineList(DebugMesh::createDebugDirLightData());
+        s.shapes[size_t(Shape::CAMERA_FRUSTUM)] = toLineList(DebugMesh::createDebugCameraFrustumData());
+
+        s.linesShader = AssetManager::createShader("DebugLines", "DebugLines.vert", "DebugLines.frag");
+        s.linesShader->requestLink();
+
+        s.spritesShader = AssetManager::createShader("DebugSprites", "DebugSprites.vert", "DebugSprites.frag", "DebugSprites.geom");
+        s.spritesShader->requestLink();
+
+        /* Lines: position, color */
+        glCreateBuffers     (1, &s.linesVbo);
+        glCreateVertexArrays(1, &s.linesVao);
+
+        glVertexArrayVertexBuffer (s.linesVao, 0, s.linesVbo, 0, sizeof(LineVertex));
+        glEnableVertexArrayAttrib (s.linesVao, 0);
+        glEnableVertexArrayAttrib (s.linesVao, 1);
+        glVertexArrayAttribFormat (s.linesVao, 0, 3, GL_FLOAT, GL_FALSE, offsetof(LineVertex, position));
+        glVertexArrayAttribFormat (s.linesVao, 1, 3, GL_FLOAT, GL_FALSE, offsetof(LineVertex, color));
+        glVertexArrayAttribBinding(s.linesVao, 0, 0);
+        glVertexArrayAttribBinding(s.linesVao, 1, 0);
+
+        /* Sprites: position, half size, color */
+        glCreateBuffers     (1, &s.spritesVbo);
+        glCreateVertexArrays(1, &s.spritesVao);
+
+        glVertexArrayVertexBuffer (s.spritesVao, 0, s.spritesVbo, 0, sizeof(SpriteVertex));
+        glEnableVertexArrayAttrib (s.spritesVao, 0);
+        glEnableVertexArrayAttrib (s.spritesVao, 1);
+        glEnableVertexArrayAttrib (s.spritesVao, 2);
+        glVertexArrayAttribFormat (s.spritesVao, 0, 3, GL_FLOAT, GL_FALSE, offsetof(SpriteVertex, position));
+        glVertexArrayAttribFormat (s.spritesVao, 1, 1, GL_FLOAT, GL_FALSE, offsetof(SpriteVertex, halfSize));
+        glVertexArrayAttribFormat (s.spritesVao, 2, 3, GL_FLOAT, GL_FALSE, offsetof(SpriteVertex, color));
+        glVertexArrayAttribBinding(s.spritesVao, 0, 0);
+        glVertexArrayAttribBinding(s.spritesVao, 1, 0);
+        glVertexArrayAttribBinding(s.spritesVao, 2, 0);
+    }
+
+    void DebugDraw::shutdown()
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        auto & s = state();
+
+        s.lines.clear();
+        s.spriteBatches.clear();
+        s.linesShader   = nullptr;
+        s.spritesShader = nullptr;
+
+        glDeleteVertexArrays(1, &s.linesVao);
+        glDeleteVertexArrays(1, &s.spritesVao);
+        glDeleteBuffers     (1, &s.linesVbo);
+        glDeleteBuffers     (1, &s.spritesVbo);
+
+        s.linesVao   = 0;
+        s.spritesVao = 0;
+        s.linesVbo   = 0;
+        s.spritesVbo = 0;
+    }
+
+    void DebugDraw::line(const glm::vec3 & from, const glm::vec3 & to, const glm::vec3 & color)
+    {
+        auto & s = state();
+
+        std::lock_guard lock(s.mutex);
+
+        s.lines.push_back({ from, color });
+        s.lines.push_back({ to,   color });
+    }
+
+    void DebugDraw::wireShape(Shape shape, const glm::mat4 & model, const glm::vec3 & color)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        auto & s        = state();
+        auto & lineList = s.shapes[size_t(shape)];
+
+        // Shapes are projective (the camera frustum is transformed with an inverse projection)
+        auto transform = [&model](const glm::vec3 & p)
+        {
+            glm::vec4 transformed = model * glm::vec4(p, 1.0f);
+            return glm::vec3(transformed) / transformed.w;
+        };
+
+        std::lock_guard lock(s.mutex);
+
+        for (auto & point : lineList)
+        {
+            s.lines.push_back({ transform(point), color });
+        }
+    }
+
+    void DebugDraw::sprite(const ref<Texture> & texture, const glm::vec3 & position, const glm::vec3 & color, float halfSize)
+    {
+        auto & s = state();
+
+        std::lock_guard lock(s.mutex);
+
+        auto batch = std::find_if(s.spriteBatches.begin(), s.spriteBatches.end(), [&texture](const SpriteBatch & b) { return b.texture == texture; });
+        if (batch == s.spriteBatches.end())
+        {
+            batch = s.spriteBatches.insert(s.spriteBatches.end(), { texture, {} });
+        }
+
+        batch->sprites.push_back({ position, halfSize, color });
+    }
+
+    void DebugDraw::flush(const glm::mat4 & view, const glm::mat4 & projection)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+        MG_PROFILE_GL_ZONE("DebugDraw::flush");
+
+        auto & s = state();
+
+        std::lock_guard lock(s.mutex);
+
+        /* Lines */
+        if (!s.lines.empty())
+        {
+            GLsizeiptr size = GLsizeiptr(s.lines.size() * sizeof(LineVertex));
+
+            // Orphan the buffer of the previous frame instead of waiting for it
+            glNamedBufferData(s.linesVbo, size, s.lines.data(), GL_STREAM_DRAW);
+            MG_RENDER_STATS_ADD(bytesUploaded, size);
+
+            glDisable(GL_BLEND);
+
+            s.linesShader->bind();
+            s.linesShader->setUniform("view_projection", projection * view);
+
+            glBindVertexArray(s.linesVao);
+            MG_RENDER_STATS_INC(vaoBinds);
+
+            MG_RENDER_STATS_DRAW(GL_LINES, uint32_t(s.lines.size()), 0);
+            glDrawArrays(GL_LINES, 0, GLsizei(s.lines.size()));
+        }
+
+        /* Sprites */
+        s.spritesUpload.clear();
+        for (auto & batch : s.spriteBatches)
+        {
+            s.spritesUpload.insert(s.spritesUpload.end(), batch.sprites.begin(), batch.sprites.end());
+        }
+
+        if (!s.spritesUpload.empty())
+        {
+            GLsizeiptr size = GLsizeiptr(s.spritesUpload.size() * sizeof(SpriteVertex));
+
+            glNamedBufferData(s.spritesVbo, size, s.spritesUpload.data(), GL_STREAM_DRAW);
+            MG_RENDER_STATS_ADD(bytesUploaded, size);
+
+            glEnable(GL_BLEND);
+            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+            s.spritesShader->bind();
+            s.spritesShader->setUniform("view",       view);
+            s.spritesShader->setUniform("projection", projection);
+
+            glBindVertexArray(s.spritesVao);
+            MG_RENDER_STATS_INC(vaoBinds);
+
+            GLint first = 0;
+            for (auto & batch : s.spriteBatches)
+            {
+                if (batch.sprites.empty()) continue;
+
+                batch.texture->bind(0);
+
+                MG_RENDER_STATS_DRAW(GL_POINTS, uint32_t(batch.sprites.size()), 0);
+                glDrawArrays(GL_POINTS, first, GLsizei(batch.sprites.size()));
+
+                first += GLint(batch.sprites.size());
+            }
+
+            glDisable(GL_BLEND);
+        }
+
+        glBindVertexArray(0);
+
+        s.lines.clear();
+
+        // Keep the batches (and their memory), there is a handful of the sprite textures
+        for (auto & batch : s.spriteBatches)
+        {
+            batch.sprites.clear();
+        }
+    }
+
+    void DebugDraw::clear()
+    {
+        auto & s = state();
+
+        std::lock_guard lock(s.mutex);
+
+        s.lines.clear();
+
+        // Keep the batches (and their memory), there is a handful of the sprite textures
+        for (auto & batch : s.spriteBatches)
+        {
+            batch.sprites.clear();
+        }
+    }
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include "Mango/Core/Base.h"
+
+#include <glm/glm.hpp>
+
+namespace mango
+{
+    class Texture;
+
+    /*
+     * Immediate mode debug drawing. Lines, wire shapes and sprites can be added from any thread during the frame,
+     * they are accumulated into per-frame vertex buffers and drawn by flush() with one draw call for all of the lines
+     * and one draw call per sprite texture.
+     */
+    class DebugDraw
+    {
+    public:
+        // Unit shapes of DebugMesh
+        enum class Shape { BOX, CAPSULE, SPHERE, CONE, DIR_LIGHT, CAMERA_FRUSTUM, COUNT };
+
+        DebugDraw() = delete;
+
+        static void init();
+        static void shutdown();
+
+        static void line     (const glm::vec3 & from, const glm::vec3 & to, const glm::vec3 & color);
+        static void wireShape(Shape shape, const glm::mat4 & model, const glm::vec3 & color);
+
+        // Camera facing quad with the given half width in view space
+        static void sprite(const ref<Texture> & texture, const glm::vec3 & position, const glm::vec3 & color, float halfSize = 0.5f);
+
+        // Draws and clears everything that was added since the previous flush. Expects the target framebuffer to be bound.
+        static void flush(const glm::mat4 & view, const glm::mat4 & projection);
+        static void clear();
+    };
+}
@@ -12,8 +12,18 @@ namespace mango
             return s_debugBox;
         }
 
+        auto data = createDebugBoxData();
+
         s_debugBox = createRef<Mesh>();
-        
+        s_debugBox->build(data, Mesh::DrawMode::LINES);
+
+        return s_debugBox;
+    }
+
+    VertexData DebugMesh::createDebugBoxData()
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
         VertexData data;
         data.positions.resize(8);
         data.indices.resize(12);
@@ -49,9 +59,7 @@ namespace mango
             3, 7
         };
 
-        s_debugBox->build(data, Mesh::DrawMode::LINES);
-
-        return s_debugBox;
+        return data;
     }
 
     ref<Mesh> DebugMesh::createDebugCapsule()
@@ -63,7 +71,18 @@ namespace mango
             return s_debugCapsule;
         }
 
+        auto data = createDebugCapsuleData();
+
         s_debugCapsule = createRef<Mesh>();
+        s_debugCapsule->build(data, Mesh::DrawMode::LINES);
+
+        return s_debugCapsule;
+    }
+
+    VertexData DebugMesh::createDebugCapsuleData()
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
         VertexData capsuleColliderData;
 
         float radius             = 0.5f;
@@ -174,10 +193,7 @@ namespace mango
             capsuleColliderData.indices.emplace_back(endLineIndex2);
         }
 
-        // Build the mesh
-        s_debugCapsule->build(capsuleColliderData, Mesh::DrawMode::LINES);
-
-        return s_debugCapsule;
+        return capsuleColliderData;
     }
 
     ref<Mesh> DebugMesh::createDebugSphere()
@@ -189,7 +205,17 @@ namespace mango
             return s_debugSphere;
         }
 
+        auto data = createDebugSphereData();
+
         s_debugSphere = createRef<Mesh>();
+        s_debugSphere->build(data, Mesh::DrawMode::LINES);
+
+        return s_debugSphere;
+    }
+
+    VertexData DebugMesh::createDebugSphereData()
+    {
+        MG_PROFILE_ZONE_SCOPED;
 
         VertexData sphereColliderData;
         
@@ -241,9 +267,7 @@ namespace mango
             currentEndIndex   += samples;
         }
 
-        s_debugSphere->build(sphereColliderData, Mesh::DrawMode::LINES);
-
-        return s_debugSphere;
+        return sphereColliderData;
     }
 
     ref<Mesh> DebugMesh::createDebugCone()
@@ -255,7 +279,17 @@ namespace mango
             return s_debugCone;
         }
 
+        auto data = createDebugConeData();
+
         s_debugCone = createRef<Mesh>();
+        s_debugCone->build(data, Mesh::DrawMode::LINES);
+
+        return s_debugCone;
+    }
+
+    VertexData DebugMesh::createDebugConeData()
+    {
+        MG_PROFILE_ZONE_SCOPED;
 
         VertexData data;
 
@@ -301,9 +335,7 @@ namespace mango
             data.indices.emplace_back(currentBeginIndex + i + 1);
         }
 
-        s_debugCone->build(data, Mesh::DrawMode::LINES);
-
-        return s_debugCone;
+        return data;
     }
 
     ref<Mesh> DebugMesh::createDebugDirLight()
@@ -315,7 +347,17 @@ namespace mango
             return s_debugDirLight;
         }
 
+        auto data = createDebugDirLightData();
+
         s_debugDirLight = createRef<Mesh>();
+        s_debugDirLight->build(data, Mesh::DrawMode::LINES);
+
+        return s_debugDirLight;
+    }
+
+    VertexData DebugMesh::createDebugDirLightData()
+    {
+        MG_PROFILE_ZONE_SCOPED;
 
         VertexData data;
 
@@ -364,9 +406,7 @@ namespace mango
             data.indices.emplace_back(i);
         }
 
-        s_debugDirLight->build(data, Mesh::DrawMode::LINES);
-
-        return s_debugDirLight;
+        return data;
     }
 
     ref<Mesh> DebugMesh::createDebugSpotLight()
@@ -442,7 +482,17 @@ namespace mango
             return s_debugCameraFrustum;
         }
 
+        auto data = createDebugCameraFrustumData();
+
         s_debugCameraFrustum = createRef<Mesh>();
+        s_debugCameraFrustum->build(data, Mesh::DrawMode::LINES);
+
+        return s_debugCameraFrustum;
+    }
+
+    VertexData DebugMesh::createDebugCameraFrustumData()
+    {
+        MG_PROFILE_ZONE_SCOPED;
 
         VertexData data;
 
@@ -463,9 +513,7 @@ namespace mango
                 0, 4, 1, 5, 3, 7, 2, 6
         };
 
-        s_debugCameraFrustum->build(data, Mesh::DrawMode::LINES);
-
-        return s_debugCameraFrustum;
+        return data;
     }
 
 }
\ No newline at end of file
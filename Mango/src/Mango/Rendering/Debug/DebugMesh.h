@@ -15,6 +15,14 @@ namespace mango
         static ref<Mesh> createDebugSpotLight();
         static ref<Mesh> createDebugCameraFrustum();
 
+        // Indexed line lists of the shapes above, e.g. for DebugDraw
+        static VertexData createDebugBoxData();
+        static VertexData createDebugCapsuleData();
+        static VertexData createDebugSphereData();
+        static VertexData createDebugConeData();
+        static VertexData createDebugDirLightData();
+        static VertexData createDebugCameraFrustumData();
+
     private:
         inline static ref<Mesh> s_debugBox           = nullptr;
         inline static ref<Mesh> s_debugCapsule       = nullptr;
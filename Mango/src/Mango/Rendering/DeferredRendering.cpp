@@ -13,7 +13,7 @@ namespace mango
         MG_PROFILE_GL_ZONE("DeferredRendering::init");
 
         m_postprocess = AssetManager::createShader("GBuffer", "GBuffer.vert", "GBuffer.frag");
-        m_postprocess->link();
+        m_postprocess->requestLink();
     }
 
     void DeferredRendering::createGBuffer(int width, int height)
@@ -29,6 +29,7 @@ namespace mango
 
         m_gbuffer = createRef<RenderTarget>();
         m_gbuffer->createMRT(mrtEntries, width, height);
+        m_gbuffer->setDynamicScaling(true);
 
         Services::renderer()->addDebugTexture("GBuffer_Position",       m_gbuffer->getTexture((GLuint)DeferredRendering::GBufferPropertyName::POSITION));
         Services::renderer()->addDebugTexture("GBuffer_Normal",         m_gbuffer->getTexture((GLuint)DeferredRendering::GBufferPropertyName::NORMAL));
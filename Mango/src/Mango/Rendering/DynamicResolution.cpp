@@ -0,0 +1,50 @@
+#include "mgpch.h"
+
+#include "DynamicResolution.h"
+
+namespace mango
+{
+    void DynamicResolution::update(float gpuFrameTimeMs)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        m_accumulatedGpuTimeMs += gpuFrameTimeMs;
+        m_accumulatedFramesCount++;
+
+        if (m_accumulatedFramesCount >= ADJUST_INTERVAL)
+        {
+            updateScale();
+        }
+    }
+
+    void DynamicResolution::updateScale()
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        float averageGpuTimeMs = m_accumulatedGpuTimeMs / float(m_accumulatedFramesCount);
+
+        m_accumulatedGpuTimeMs   = 0.0f;
+        m_accumulatedFramesCount = 0;
+
+        if (!*CVarSystem::get()->getIntCVar("renderer.dynamicResolution"))
+        {
+            m_scale = 1.0f;
+            return;
+        }
+
+        float targetFrameTimeMs = *CVarSystem::get()->getFloatCVar("renderer.targetFrameTime");
+        float minScale          = *CVarSystem::get()->getFloatCVar("renderer.minRenderScale");
+        float maxScale          = *CVarSystem::get()->getFloatCVar("renderer.maxRenderScale");
+
+        // Keep some headroom and don't go up again until there is plenty of it, so the scale doesn't oscillate
+        if (averageGpuTimeMs > targetFrameTimeMs * 0.95f || averageGpuTimeMs < targetFrameTimeMs * 0.8f)
+        {
+            // GPU time is roughly proportional to the number of pixels, i.e. to scale^2
+            float newScale = m_scale * glm::sqrt(targetFrameTimeMs * 0.9f / glm::max(averageGpuTimeMs, 0.001f));
+
+            // Limit the step to avoid visible pumping
+            newScale = glm::clamp(newScale, m_scale - 0.1f, m_scale + 0.05f);
+            m_scale  = glm::clamp(newScale, minScale, maxScale);
+        }
+    }
+}
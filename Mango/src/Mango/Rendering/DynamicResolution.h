@@ -0,0 +1,29 @@
+#pragma once
+
+namespace mango
+{
+    /*
+     * Picks the render scale of the scene targets (main, GBuffer, SSAO, bloom) from the GPU time of the passes drawn into them.
+     * Tunables are exposed as CVars: renderer.dynamicResolution, renderer.targetFrameTime, renderer.minRenderScale, renderer.maxRenderScale.
+     */
+    class DynamicResolution
+    {
+    public:
+        DynamicResolution() = default;
+
+        // Expects the GPU time of the scaled scene passes, once per new result of GPUProfiler
+        void update(float gpuFrameTimeMs);
+
+        float getScale() const { return m_scale; }
+
+    private:
+        void updateScale();
+
+    private:
+        static const uint32_t ADJUST_INTERVAL = 8; // in frames
+
+        float    m_scale                  = 1.0f;
+        float    m_accumulatedGpuTimeMs   = 0.0f;
+        uint32_t m_accumulatedFramesCount = 0;
+    };
+}
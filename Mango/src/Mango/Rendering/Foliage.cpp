@@ -0,0 +1,387 @@
+#include "mgpch.h"
+
+#include "Foliage.h"
+#include "Mango/Core/AssetManager.h"
+#include "Mango/Rendering/Mesh.h"
+#include "Mango/Rendering/Shader.h"
+#include "Mango/Rendering/TextureStreaming.h"
+#include "Mango/Scene/Components.h"
+#include "Mango/Scene/Scene.h"
+#include "Mango/Utils/Hash.h"
+
+#include <glm/gtc/constants.hpp>
+#include <limits>
+
+namespace mango
+{
+    namespace
+    {
+        template<typename T>
+        void appendBytes(std::string & bytes, const T & value)
+        {
+            bytes.append(reinterpret_cast<const char*>(&value), sizeof(T));
+        }
+    }
+
+    Foliage::~Foliage()
+    {
+        clear();
+
+        glDeleteBuffers(1, &m_commandsBuffer);
+    }
+
+    void Foliage::init()
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        m_shader = AssetManager::createShader("Foliage", "Foliage.vert", "GBuffer.frag");
+        m_shader->requestLink();
+
+        glCreateBuffers(1, &m_commandsBuffer);
+    }
+
+    void Foliage::clear()
+    {
+        for (auto & [entity, field] : m_fields)
+        {
+            release(field);
+        }
+
+        m_fields.clear();
+        m_commands.clear();
+
+        m_instancesCount    = 0;
+        m_visibleCellsCount = 0;
+    }
+
+    void Foliage::update(Scene * scene)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+        MG_PROFILE_GL_ZONE("Foliage::update");
+
+        auto view = scene->getEntitiesWithComponent<TransformComponent, FoliageComponent>();
+
+        for (auto it = m_fields.begin(); it != m_fields.end();)
+        {
+            if (!view.contains(it->first))
+            {
+                release(it->second);
+                it = m_fields.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+
+        m_instancesCount = 0;
+
+        std::string hashedBytes;
+        for (auto e : view)
+        {
+            auto [tc, fc] = view.get<TransformComponent, FoliageComponent>(e);
+
+            if (!fc.mesh || fc.mesh->getDrawMode() != Mesh::DrawMode::TRIANGLES)
+            {
+                auto it = m_fields.find(e);
+                if (it != m_fields.end())
+                {
+                    release(it->second);
+                    m_fields.erase(it);
+                }
+
+                continue;
+            }
+
+            /* Everything that changes the placement of the instances */
+            glm::mat4 world = tc.getWorldMatrix();
+
+            hashedBytes.clear();
+            appendBytes(hashedBytes, fc.mesh.get());
+            appendBytes(hashedBytes, fc.extents);
+            appendBytes(hashedBytes, fc.count);
+            appendBytes(hashedBytes, fc.seed);
+            appendBytes(hashedBytes, fc.cellSize);
+            appendBytes(hashedBytes, fc.scaleRange);
+            appendBytes(hashedBytes, world);
+
+            uint64_t hash = fnvHash1a64(hashedBytes.data(), hashedBytes.size());
+
+            auto & field = m_fields[e];
+            if (field.hash != hash)
+            {
+                build(field, fc, world);
+                field.hash = hash;
+            }
+
+            Entity entity = { e, scene };
+
+            field.materials = fc.materials;
+            field.layers    = entity.hasComponent<LayerComponent>() ? entity.getComponent<LayerComponent>().layers : 1u;
+            field.fadeStart = fc.fadeStart;
+            field.fadeEnd   = fc.fadeEnd;
+
+            m_instancesCount += field.instancesCount;
+        }
+    }
+
+    void Foliage::cull(const glm::vec4 * frustumPlanes, const glm::vec3 & viewPosition, uint32_t layerMask)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        m_commands.clear();
+        m_visibleCellsCount = 0;
+
+        std::vector<uint32_t> visibleCells;
+
+        for (auto & [entity, field] : m_fields)
+        {
+            field.firstCommand      = uint32_t(m_commands.size());
+            field.visibleCellsCount = 0;
+
+            if ((field.layers & layerMask) == 0 || field.instancesCount == 0) continue;
+
+            visibleCells.clear();
+
+            float nearestDistanceSq = std::numeric_limits<float>::max();
+            for (uint32_t i = 0; i < field.cells.size(); ++i)
+            {
+                auto & cell = field.cells[i];
+
+                // The corner of the box furthest along the plane normal
+                bool visible = true;
+                for (uint32_t p = 0; p < 6 && visible; ++p)
+                {
+                    glm::vec3 normal = glm::vec3(frustumPlanes[p]);
+                    glm::vec3 corner = glm::mix(cell.min, cell.max, glm::greaterThanEqual(normal, glm::vec3(0.0f)));
+
+                    visible = glm::dot(normal, corner) + frustumPlanes[p].w >= 0.0f;
+                }
+
+                if (!visible) continue;
+
+                // The cells beyond the fade are empty anyway
+                glm::vec3 toCell     = glm::max(glm::max(cell.min - viewPosition, viewPosition - cell.max), glm::vec3(0.0f));
+                float     distanceSq = glm::dot(toCell, toCell);
+
+                if (field.fadeEnd > 0.0f && distanceSq > field.fadeEnd * field.fadeEnd) continue;
+
+                if (distanceSq < nearestDistanceSq)
+                {
+                    nearestDistanceSq        = distanceSq;
+                    field.nearestVisibleCell = i;
+                }
+
+                visibleCells.push_back(i);
+            }
+
+            field.visibleCellsCount = uint32_t(visibleCells.size());
+            m_visibleCellsCount    += field.visibleCellsCount;
+
+            for (auto & submesh : field.mesh->getSubmeshes())
+            {
+                for (auto cellIndex : visibleCells)
+                {
+                    auto & cell = field.cells[cellIndex];
+
+                    DrawElementsIndirectCommand command;
+                    command.count         = submesh.indicesCount;
+                    command.instanceCount = cell.instancesCount;
+                    command.firstIndex    = submesh.baseIndex;
+                    command.baseVertex    = int32_t(submesh.baseVertex);
+                    command.baseInstance  = cell.firstInstance;
+
+                    m_commands.push_back(command);
+                }
+            }
+        }
+
+        if (m_commands.empty()) return;
+
+        GLsizeiptr size = GLsizeiptr(m_commands.size() * sizeof(DrawElementsIndirectCommand));
+
+        // Orphan the commands of the previous view instead of waiting for them
+        glNamedBufferData(m_commandsBuffer, size, m_commands.data(), GL_STREAM_DRAW);
+        MG_RENDER_STATS_ADD(bytesUploaded, size);
+    }
+
+    void Foliage::render(const std::function<void(ref<Shader> &, const ref<Material> &)> & bindMaterial)
+    {
+        if (m_commands.empty()) return;
+
+        MG_PROFILE_ZONE_SCOPED;
+        MG_PROFILE_GL_ZONE("Foliage::render");
+
+        // The view and projection are the only globals used, they don't depend on the transform
+        static const TransformComponent identityTransform;
+
+        m_shader->bind();
+        m_shader->updateGlobalUniforms(identityTransform);
+
+        // The meshlet commands stay bound for the rest of the frame
+        GLint previousCommandsBuffer = 0;
+        glGetIntegerv(GL_DRAW_INDIRECT_BUFFER_BINDING, &previousCommandsBuffer);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_commandsBuffer);
+
+        for (auto & [entity, field] : m_fields)
+        {
+            if (field.visibleCellsCount == 0) continue;
+
+            uint32_t visibleInstances = 0;
+            for (uint32_t i = 0; i < field.visibleCellsCount; ++i)
+            {
+                visibleInstances += m_commands[field.firstCommand + i].instanceCount;
+            }
+
+            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, field.instancesBuffer);
+            m_shader->setUniform("fade_distances", glm::vec2(field.fadeStart, field.fadeEnd));
+
+            field.mesh->bind();
+
+            auto & submeshes = field.mesh->getSubmeshes();
+            for (uint32_t submeshIndex = 0; submeshIndex < submeshes.size(); ++submeshIndex)
+            {
+                auto materialIndex = submeshes[submeshIndex].materialIndex;
+                if (materialIndex >= 0 && materialIndex < int32_t(field.materials.size()))
+                {
+                    bindMaterial(m_shader, field.materials[materialIndex]);
+                }
+
+                uint64_t commandsOffset = uint64_t(field.firstCommand + submeshIndex * field.visibleCellsCount) * sizeof(DrawElementsIndirectCommand);
+                field.mesh->renderIndirect(commandsOffset, field.visibleCellsCount, submeshes[submeshIndex].indicesCount * visibleInstances);
+            }
+        }
+
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, GLuint(previousCommandsBuffer));
+    }
+
+    void Foliage::requestTextureMips(const std::function<float(const glm::vec3 &, float, float)> & pixelsPerUV) const
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        for (auto & [entity, field] : m_fields)
+        {
+            if (field.visibleCellsCount == 0) continue;
+
+            auto & cell = field.cells[field.nearestVisibleCell];
+
+            // The instances are scaled around 1, the density of the mesh is good enough for all of them
+            float uvDensity = field.mesh->getUVDensity();
+            if (uvDensity <= 0.0f)
+            {
+                uvDensity = 0.5f / glm::max(field.mesh->getBoundsRadius(), 0.001f);
+            }
+
+            float pixels = pixelsPerUV(0.5f * (cell.min + cell.max), 0.5f * glm::length(cell.max - cell.min), uvDensity);
+            for (auto & material : field.materials)
+            {
+                if (material)
+                {
+                    TextureStreaming::requestMips(*material, pixels);
+                }
+            }
+        }
+    }
+
+    void Foliage::build(Field & field, const FoliageComponent & component, const glm::mat4 & world)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+        MG_PROFILE_GL_ZONE("Foliage::build");
+
+        release(field);
+
+        field.mesh = component.mesh;
+
+        const uint32_t   count      = glm::min(component.count, MAX_INSTANCES);
+        const float      cellSize   = glm::max(component.cellSize, 1.0f);
+        const glm::vec2  extents    = glm::max(component.extents, glm::vec2(0.0f));
+        const glm::uvec2 cellsCount = glm::max(glm::uvec2(glm::ceil(2.0f * extents / cellSize)), glm::uvec2(1u));
+
+        if (count == 0) return;
+
+        // The instances stay upright, only the scale of the entity is applied to them
+        const float entityScale = glm::max(glm::length(glm::vec3(world[0])), glm::max(glm::length(glm::vec3(world[1])), glm::length(glm::vec3(world[2]))));
+        const float baseOffset  = -component.mesh->getBoundsMin().y; // the bottom of the mesh rests on the plane
+        const float meshExtent  = glm::length(component.mesh->getBoundsCenter()) + component.mesh->getBoundsRadius();
+
+        /* Scatter the instances, the same seed gives the same field on every platform */
+        std::mt19937 rng(component.seed);
+        auto random = [&rng]() { return float(rng() >> 8) * (1.0f / 16777216.0f); };
+
+        std::vector<Instance> instances    (count);
+        std::vector<uint32_t> instanceCells(count);
+        std::vector<uint32_t> cellsCounts  (cellsCount.x * cellsCount.y, 0);
+
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            glm::vec2 local = (glm::vec2(random(), random()) * 2.0f - 1.0f) * extents;
+            float     scale = glm::mix(component.scaleRange.x, component.scaleRange.y, random()) * entityScale;
+            float     yaw   = random() * glm::two_pi<float>();
+
+            glm::vec3 position = glm::vec3(world * glm::vec4(local.x, 0.0f, local.y, 1.0f));
+            position.y += baseOffset * scale;
+
+            instances[i] = { glm::vec4(position, scale), glm::vec4(glm::cos(yaw), glm::sin(yaw), random(), 0.0f) };
+
+            glm::uvec2 cell  = glm::min(glm::uvec2((local + extents) / cellSize), cellsCount - 1u);
+            instanceCells[i] = cell.y * cellsCount.x + cell.x;
+
+            ++cellsCounts[instanceCells[i]];
+        }
+
+        /* Sort the instances by cell (counting sort), so every cell is one range of instances */
+        std::vector<uint32_t> cellsOffsets(cellsCounts.size(), 0);
+        for (uint32_t c = 1; c < cellsCounts.size(); ++c)
+        {
+            cellsOffsets[c] = cellsOffsets[c - 1] + cellsCounts[c - 1];
+        }
+
+        std::vector<Instance> sortedInstances(count);
+        std::vector<uint32_t> cursors = cellsOffsets;
+
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            sortedInstances[cursors[instanceCells[i]]++] = instances[i];
+        }
+
+        /* World space bounds of the non-empty cells */
+        for (uint32_t c = 0; c < cellsCounts.size(); ++c)
+        {
+            if (cellsCounts[c] == 0) continue;
+
+            Cell cell;
+            cell.min            = glm::vec3( std::numeric_limits<float>::max());
+            cell.max            = glm::vec3(-std::numeric_limits<float>::max());
+            cell.firstInstance  = cellsOffsets[c];
+            cell.instancesCount = cellsCounts[c];
+
+            for (uint32_t i = cell.firstInstance; i < cell.firstInstance + cell.instancesCount; ++i)
+            {
+                glm::vec3 position = glm::vec3(sortedInstances[i].positionScale);
+                float     radius   = meshExtent * sortedInstances[i].positionScale.w;
+
+                cell.min = glm::min(cell.min, position - radius);
+                cell.max = glm::max(cell.max, position + radius);
+            }
+
+            field.cells.push_back(cell);
+        }
+
+        GLsizeiptr size = GLsizeiptr(sortedInstances.size() * sizeof(Instance));
+
+        glCreateBuffers     (1, &field.instancesBuffer);
+        glNamedBufferStorage(field.instancesBuffer, size, sortedInstances.data(), 0);
+        MG_RENDER_STATS_ADD(bytesUploaded, size);
+
+        field.instancesCount = count;
+    }
+
+    void Foliage::release(Field & field)
+    {
+        glDeleteBuffers(1, &field.instancesBuffer);
+
+        field.instancesBuffer = 0;
+        field.instancesCount  = 0;
+        field.cells.clear();
+    }
+}
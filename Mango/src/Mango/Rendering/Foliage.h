@@ -0,0 +1,104 @@
+#pragma once
+#include "glad/glad.h"
+#include "Mango/Core/Base.h"
+#include "Mango/Rendering/Material.h"
+#include "Mango/Rendering/Meshlets.h"
+
+#include <entt.hpp>
+#include <functional>
+#include <glm/glm.hpp>
+#include <unordered_map>
+#include <vector>
+
+namespace mango
+{
+    class Mesh;
+    class Scene;
+    class Shader;
+    struct FoliageComponent;
+
+    /*
+     * Scattered instances of the foliage fields (see FoliageComponent), kept out of the registry.
+     * A field is generated from its component and the world transform of the entity, sorted into the cells of a grid
+     * and uploaded once into an immutable storage buffer. It's generated again only when the component or the transform changes.
+     * Every view culls the cells against the frustum and the fade distance, the surviving instance ranges of a field are drawn
+     * with one multi draw indirect per submesh. The instances between the fade distances are thinned out in Foliage.vert.
+     */
+    class Foliage
+    {
+    public:
+        static const uint32_t MAX_INSTANCES = 1u << 22;
+
+        Foliage() = default;
+        ~Foliage();
+
+        Foliage(const Foliage &)             = delete;
+        Foliage & operator=(const Foliage &) = delete;
+
+        void init();
+        void clear();
+
+        // Generates the new and the changed fields of the scene, releases the fields of the removed components
+        void update(Scene * scene);
+
+        // Culls the cells for the view and uploads the draw commands of the visible ones
+        void cull(const glm::vec4 * frustumPlanes, const glm::vec3 & viewPosition, uint32_t layerMask);
+
+        // Draws the culled cells into the bound GBuffer, the materials are bound by the caller
+        void render(const std::function<void(ref<Shader> &, const ref<Material> &)> & bindMaterial);
+
+        // Requests the streamed mips of the materials of the culled fields (see TextureStreaming) for their nearest visible cell.
+        // pixelsPerUV takes the world space bounding sphere and the texture coordinate units per world unit
+        void requestTextureMips(const std::function<float(const glm::vec3 &, float, float)> & pixelsPerUV) const;
+
+        uint32_t getInstancesCount()    const { return m_instancesCount; }
+        uint32_t getVisibleCellsCount() const { return m_visibleCellsCount; }
+
+    private:
+        struct Instance
+        {
+            glm::vec4 positionScale; // world space position of the base, scale
+            glm::vec4 rotationFade;  // cosine and sine of the yaw, fade threshold
+        };
+
+        struct Cell
+        {
+            glm::vec3 min;
+            glm::vec3 max;
+            uint32_t  firstInstance  = 0;
+            uint32_t  instancesCount = 0;
+        };
+
+        struct Field
+        {
+            uint64_t          hash = 0;
+            ref<Mesh>         mesh;
+            MaterialTable     materials;
+            std::vector<Cell> cells;
+            GLuint            instancesBuffer = 0;
+            uint32_t          instancesCount  = 0;
+            uint32_t          layers          = 1;
+            float             fadeStart       = 0.0f;
+            float             fadeEnd         = 0.0f;
+
+            // Draws of the last cull, the commands of the submesh i start at firstCommand + i * visibleCellsCount
+            uint32_t firstCommand       = 0;
+            uint32_t visibleCellsCount  = 0;
+            uint32_t nearestVisibleCell = 0;
+        };
+
+        static void build(Field & field, const FoliageComponent & component, const glm::mat4 & world);
+        static void release(Field & field);
+
+    private:
+        std::unordered_map<entt::entity, Field> m_fields;
+
+        ref<Shader> m_shader;
+
+        std::vector<DrawElementsIndirectCommand> m_commands;
+        GLuint                                   m_commandsBuffer = 0;
+
+        uint32_t m_instancesCount    = 0;
+        uint32_t m_visibleCellsCount = 0;
+    };
+}
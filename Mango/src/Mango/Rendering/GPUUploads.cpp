@@ -0,0 +1,310 @@
+#include "mgpch.h"
+
+#include "GPUUploads.h"
+#include "Mango/Core/Timer.h"
+
+#include <deque>
+
+namespace mango
+{
+    namespace
+    {
+        const uint64_t DEFAULT_BUDGET_BYTES = 16 * 1024 * 1024;
+
+        // Data written between two fences
+        struct Region
+        {
+            GLsync   fence = nullptr;
+            uint64_t size  = 0; // with the alignment and the skipped end of the ring
+        };
+
+        struct GPUUploadsState
+        {
+            GLuint    buffer    = 0;
+            uint8_t * mapped    = nullptr;
+            uint64_t  alignment = 16;
+
+            uint64_t           head       = 0; // next free byte
+            uint64_t           inFlight   = 0; // bytes of the fenced regions and of the open one
+            uint64_t           openRegion = 0;
+            std::deque<Region> regions;
+
+            uint64_t budget = DEFAULT_BUDGET_BYTES;
+
+            GPUUploads::Statistics current;
+            GPUUploads::Statistics last;
+        };
+
+        GPUUploadsState & state()
+        {
+            static GPUUploadsState s;
+            return s;
+        }
+
+        void closeRegion()
+        {
+            auto & s = state();
+            if (s.openRegion == 0) return;
+
+            s.regions.push_back({ glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0), s.openRegion });
+            s.openRegion = 0;
+        }
+
+        void retireOldestRegion(bool wait)
+        {
+            auto & s      = state();
+            auto & region = s.regions.front();
+
+            if (wait)
+            {
+                MG_PROFILE_ZONE_SCOPED;
+
+                Timer timer;
+
+                while (glClientWaitSync(region.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED) {}
+
+                ++s.current.stallsCount;
+                s.current.stallsMs += timer.elapsedMs();
+            }
+
+            glDeleteSync(region.fence);
+            s.inFlight -= region.size;
+            s.regions.pop_front();
+        }
+
+        // Pointer into the ring, nullptr if it can't hold the size
+        uint8_t * allocate(uint64_t size, uint64_t & offset)
+        {
+            auto & s = state();
+            if (!s.mapped || size > RING_SIZE) return nullptr;
+
+            auto place = [&s, size](uint64_t & start) -> uint64_t
+            {
+                start = (s.head + s.alignment - 1) / s.alignment * s.alignment;
+                if (start + size > GPUUploads::RING_SIZE)
+                {
+                    // The end of the ring is skipped
+                    start = 0;
+                    return GPUUploads::RING_SIZE - s.head + size;
+                }
+                return start - s.head + size;
+            };
+
+            uint64_t start    = 0;
+            uint64_t consumed = place(start);
+
+            /* Wait for the GPU to read the oldest regions until there is enough space */
+            while (s.inFlight + consumed > RING_SIZE)
+            {
+                if (s.regions.empty())
+                {
+                    if (s.openRegion == 0)
+                    {
+                        // Nothing is in use, the ring starts over
+                        s.head   = 0;
+                        consumed = place(start);
+                        break;
+                    }
+
+                    closeRegion();
+                }
+
+                retireOldestRegion(true);
+            }
+
+            s.head        = start + size;
+            s.inFlight   += consumed;
+            s.openRegion += consumed;
+
+            s.current.stagedBytes += size;
+            s.current.inFlightBytes = s.inFlight;
+
+            offset = start;
+            return s.mapped + start;
+        }
+
+        // Calls upload with the client memory, or with the offset into the ring bound as the pixel unpack buffer
+        void uploadPixels(const void * data, uint64_t size, const std::function<void(const void *)> & upload)
+        {
+            MG_RENDER_STATS_ADD(bytesUploaded, size);
+
+            auto & s = state();
+            ++s.current.uploadsCount;
+
+            uint64_t ringOffset = 0;
+
+            auto staging = allocate(size, ringOffset);
+            if (!staging)
+            {
+                upload(data);
+                ++s.current.directUploads;
+                return;
+            }
+
+            std::memcpy(staging, data, size);
+
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, s.buffer);
+            upload(reinterpret_cast<const void *>(ringOffset));
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        }
+    }
+
+    void GPUUploads::init()
+    {
+        MG_PROFILE_ZONE_SCOPED;
+        MG_PROFILE_GL_ZONE("GPUUploads::init");
+
+        auto & s = state();
+
+        GLint storageAlignment = 0;
+        glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &storageAlignment);
+        s.alignment = std::max<uint64_t>(s.alignment, uint64_t(storageAlignment));
+
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+        glCreateBuffers     (1, &s.buffer);
+        glNamedBufferStorage(s.buffer, RING_SIZE, nullptr, flags);
+
+        s.mapped = static_cast<uint8_t *>(glMapNamedBufferRange(s.buffer, 0, RING_SIZE, flags));
+        if (!s.mapped)
+        {
+            MG_CORE_ERROR("Could not map the staging ring buffer, the uploads go directly.");
+        }
+    }
+
+    void GPUUploads::shutdown()
+    {
+        auto & s = state();
+
+        while (!s.regions.empty())
+        {
+            retireOldestRegion(false);
+        }
+
+        if (s.mapped)
+        {
+            glUnmapNamedBuffer(s.buffer);
+        }
+        glDeleteBuffers(1, &s.buffer);
+
+        s = {};
+    }
+
+    void GPUUploads::endFrame()
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        auto & s = state();
+
+        closeRegion();
+
+        // The regions that the GPU has finished with are freed without waiting
+        while (!s.regions.empty() && glClientWaitSync(s.regions.front().fence, 0, 0) != GL_TIMEOUT_EXPIRED)
+        {
+            retireOldestRegion(false);
+        }
+
+        s.current.inFlightBytes = s.inFlight;
+        s.last    = s.current;
+        s.current = {};
+
+        if (auto budgetKB = CVarSystem::get()->getIntCVar("renderer.uploadBudgetKB"))
+        {
+            s.budget = uint64_t(std::max(*budgetKB, 0)) * 1024;
+        }
+
+        MG_PROGILE_PLOT_VALUE("Staged Bytes", int64_t(s.last.stagedBytes));
+    }
+
+    void GPUUploads::uploadBuffer(GLuint buffer, uint64_t offset, uint64_t size, const void * data)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+        MG_RENDER_STATS_ADD(bytesUploaded, size);
+
+        auto & s = state();
+        ++s.current.uploadsCount;
+
+        /* The large buffers are staged in parts, so they don't wait for the whole ring */
+        const uint64_t maxPartSize = RING_SIZE / 4;
+
+        for (uint64_t partOffset = 0; partOffset < size; partOffset += maxPartSize)
+        {
+            uint64_t partSize = std::min(size - partOffset, maxPartSize);
+            uint64_t ringOffset = 0;
+
+            auto staging = allocate(partSize, ringOffset);
+            if (!staging)
+            {
+                glNamedBufferSubData(buffer, offset + partOffset, partSize, static_cast<const uint8_t *>(data) + partOffset);
+                ++s.current.directUploads;
+                continue;
+            }
+
+            std::memcpy(staging, static_cast<const uint8_t *>(data) + partOffset, partSize);
+            glCopyNamedBufferSubData(s.buffer, buffer, ringOffset, offset + partOffset, partSize);
+        }
+    }
+
+    void GPUUploads::uploadTexture2D(GLuint texture, GLint level, GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, const void * data, uint64_t size)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        uploadPixels(data, size, [&](const void * pixels)
+        {
+            glTextureSubImage2D(texture, level, x, y, width, height, format, type, pixels);
+        });
+    }
+
+    void GPUUploads::uploadTexture3D(GLuint texture, GLint level, GLint x, GLint y, GLint z, GLsizei width, GLsizei height, GLsizei depth, GLenum format, GLenum type, const void * data, uint64_t size)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        uploadPixels(data, size, [&](const void * pixels)
+        {
+            glTextureSubImage3D(texture, level, x, y, z, width, height, depth, format, type, pixels);
+        });
+    }
+
+    void GPUUploads::uploadCompressedTexture2D(GLuint texture, GLint level, GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, const void * data, uint64_t size)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        uploadPixels(data, size, [&](const void * pixels)
+        {
+            glCompressedTextureSubImage2D(texture, level, x, y, width, height, format, GLsizei(size), pixels);
+        });
+    }
+
+    GPUUploads::Allocation GPUUploads::stream(const void * data, uint64_t size, GLuint fallbackBuffer)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+        MG_RENDER_STATS_ADD(bytesUploaded, size);
+
+        auto & s = state();
+        ++s.current.uploadsCount;
+
+        uint64_t ringOffset = 0;
+
+        auto staging = allocate(size, ringOffset);
+        if (!staging)
+        {
+            glNamedBufferData(fallbackBuffer, GLsizeiptr(size), data, GL_STREAM_DRAW);
+            ++s.current.directUploads;
+            return { fallbackBuffer, 0 };
+        }
+
+        std::memcpy(staging, data, size);
+        return { s.buffer, ringOffset };
+    }
+
+    uint64_t GPUUploads::getRemainingBudget()
+    {
+        auto & s = state();
+        return s.budget > s.current.stagedBytes ? s.budget - s.current.stagedBytes : 0;
+    }
+
+    const GPUUploads::Statistics & GPUUploads::getStatistics()
+    {
+        return state().last;
+    }
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include "glad/glad.h"
+
+#include <cstdint>
+
+namespace mango
+{
+    /*
+     * Uploads of the buffers, the textures and the per-frame data through one persistently mapped, coherent staging ring buffer.
+     * The data is copied into the ring and the GPU copies it from there with glCopyNamedBufferSubData or from the ring bound as
+     * the pixel unpack buffer, so the driver doesn't copy the client memory synchronously. The per-frame data is read by the GPU
+     * straight from the ring (see stream).
+     * The regions written since the previous endFrame() are protected by a fence, the ring waits for the oldest fences only when
+     * it runs out of space. The streaming (e.g. of the terrain tiles) keeps within the per-frame budget (renderer.uploadBudgetKB)
+     * and leaves the rest for the next frames. The uploads before init() and the ones larger than the ring go directly.
+     */
+    class GPUUploads
+    {
+    public:
+        struct Statistics
+        {
+            uint64_t stagedBytes   = 0;
+            uint32_t uploadsCount  = 0;
+            uint32_t directUploads = 0; // without the ring
+            uint32_t stallsCount   = 0; // waits for the fences of the regions still in use
+            float    stallsMs      = 0.0f;
+            uint64_t inFlightBytes = 0; // written, but the GPU may still read them
+        };
+
+        // Range of the ring, or of the buffer that took the data when the ring couldn't
+        struct Allocation
+        {
+            GLuint   buffer = 0;
+            uint64_t offset = 0;
+        };
+
+        static constexpr uint64_t RING_SIZE = 64 * 1024 * 1024;
+
+        GPUUploads() = delete;
+
+        static void init();
+        static void shutdown();
+
+        // Fences the data written during the frame and publishes the statistics
+        static void endFrame();
+
+        static void uploadBuffer   (GLuint buffer,  uint64_t offset, uint64_t size, const void * data);
+        static void uploadTexture2D(GLuint texture, GLint level, GLint x, GLint y,          GLsizei width, GLsizei height,                GLenum format, GLenum type, const void * data, uint64_t size);
+        static void uploadTexture3D(GLuint texture, GLint level, GLint x, GLint y, GLint z, GLsizei width, GLsizei height, GLsizei depth, GLenum format, GLenum type, const void * data, uint64_t size);
+        static void uploadCompressedTexture2D(GLuint texture, GLint level, GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, const void * data, uint64_t size);
+
+        // Per-frame data read by the GPU from the ring until the end of the frame, the offset is aligned for the storage buffers.
+        // Falls back to orphaning the storage of fallbackBuffer
+        static Allocation stream(const void * data, uint64_t size, GLuint fallbackBuffer);
+
+        // Bytes that the streaming can still upload this frame
+        static uint64_t getRemainingBudget();
+
+        // Of the last finished frame
+        static const Statistics & getStatistics();
+    };
+}
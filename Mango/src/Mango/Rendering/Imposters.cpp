@@ -0,0 +1,263 @@
+#include "mgpch.h"
+
+#include "Imposters.h"
+#include "Mango/Core/AssetManager.h"
+#include "Mango/Rendering/Mesh.h"
+#include "Mango/Rendering/Shader.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+namespace mango
+{
+    Imposters::~Imposters()
+    {
+        clear();
+
+        glDeleteVertexArrays (1, &m_quadVao);
+        glDeleteBuffers      (1, &m_quadVbo);
+        glDeleteBuffers      (1, &m_instancesVbo);
+        glDeleteFramebuffers (1, &m_bakeFbo);
+        glDeleteRenderbuffers(1, &m_bakeDepth);
+    }
+
+    void Imposters::init()
+    {
+        MG_PROFILE_ZONE_SCOPED;
+        MG_PROFILE_GL_ZONE("Imposters::init");
+
+        m_bakeShader = AssetManager::createShader("ImposterBake", "ImposterBake.vert", "ImposterBake.frag");
+        m_bakeShader->requestLink();
+
+        m_gbufferShader = AssetManager::createShader("ImposterGBuffer", "ImposterGBuffer.vert", "ImposterGBuffer.frag");
+        m_gbufferShader->requestLink();
+
+        /* Billboard corners (triangle strip) and the per-instance model matrices */
+        const glm::vec2 corners[4] = { { -1.0f, -1.0f }, { 1.0f, -1.0f }, { -1.0f, 1.0f }, { 1.0f, 1.0f } };
+
+        glCreateBuffers     (1, &m_quadVbo);
+        glNamedBufferStorage(m_quadVbo, sizeof(corners), corners, 0);
+
+        glCreateBuffers     (1, &m_instancesVbo);
+        glCreateVertexArrays(1, &m_quadVao);
+
+        glVertexArrayVertexBuffer (m_quadVao, 0, m_quadVbo, 0, sizeof(glm::vec2));
+        glEnableVertexArrayAttrib (m_quadVao, 0);
+        glVertexArrayAttribFormat (m_quadVao, 0, 2, GL_FLOAT, GL_FALSE, 0);
+        glVertexArrayAttribBinding(m_quadVao, 0, 0);
+
+        glVertexArrayVertexBuffer  (m_quadVao, 1, m_instancesVbo, 0, sizeof(glm::mat4));
+        glVertexArrayBindingDivisor(m_quadVao, 1, 1);
+        for (GLuint column = 0; column < 4; ++column)
+        {
+            glEnableVertexArrayAttrib (m_quadVao, 4 + column);
+            glVertexArrayAttribFormat (m_quadVao, 4 + column, 4, GL_FLOAT, GL_FALSE, column * sizeof(glm::vec4));
+            glVertexArrayAttribBinding(m_quadVao, 4 + column, 1);
+        }
+
+        /* Baking framebuffer, the atlases are attached when they are baked */
+        const GLsizei atlasSize = FRAMES * FRAME_RESOLUTION;
+
+        glCreateRenderbuffers     (1, &m_bakeDepth);
+        glNamedRenderbufferStorage(m_bakeDepth, GL_DEPTH_COMPONENT24, atlasSize, atlasSize);
+
+        glCreateFramebuffers          (1, &m_bakeFbo);
+        glNamedFramebufferRenderbuffer(m_bakeFbo, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, m_bakeDepth);
+
+        const GLenum drawBuffers[2] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+        glNamedFramebufferDrawBuffers(m_bakeFbo, 2, drawBuffers);
+    }
+
+    void Imposters::clear()
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        for (auto & [key, atlas] : m_atlases)
+        {
+            glDeleteTextures(1, &atlas.albedo);
+            glDeleteTextures(1, &atlas.normalDepth);
+        }
+
+        m_atlases.clear();
+    }
+
+    void Imposters::addInstance(const ref<Mesh> & mesh, const MaterialTable & materials, const glm::mat4 & model)
+    {
+        auto & material = materials[mesh->getSubmesh()->materialIndex];
+        auto & atlas    = m_atlases[{ mesh.get(), material.get() }];
+
+        if (!atlas.mesh)
+        {
+            atlas.mesh     = mesh;
+            atlas.material = material;
+
+            bake(atlas, materials);
+        }
+
+        atlas.instances.push_back(model);
+    }
+
+    void Imposters::render(const glm::mat4 & viewProjection, const glm::vec3 & cameraPosition)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+        MG_PROFILE_GL_ZONE("Imposters::render");
+
+        m_instancesUpload.clear();
+        for (auto & [key, atlas] : m_atlases)
+        {
+            m_instancesUpload.insert(m_instancesUpload.end(), atlas.instances.begin(), atlas.instances.end());
+        }
+
+        if (m_instancesUpload.empty()) return;
+
+        GLsizeiptr size = GLsizeiptr(m_instancesUpload.size() * sizeof(glm::mat4));
+
+        // Orphan the buffer of the previous view instead of waiting for it
+        glNamedBufferData(m_instancesVbo, size, m_instancesUpload.data(), GL_STREAM_DRAW);
+        MG_RENDER_STATS_ADD(bytesUploaded, size);
+
+        m_gbufferShader->bind();
+        m_gbufferShader->setUniform("view_projection", viewProjection);
+        m_gbufferShader->setUniform("cam_pos",         cameraPosition);
+        m_gbufferShader->setUniform("frames",          float(FRAMES));
+
+        glBindVertexArray(m_quadVao);
+        MG_RENDER_STATS_INC(vaoBinds);
+
+        GLuint firstInstance = 0;
+        for (auto & [key, atlas] : m_atlases)
+        {
+            if (atlas.instances.empty()) continue;
+
+            m_gbufferShader->setUniform("bounds", atlas.bounds);
+
+            glBindTextureUnit(0, atlas.albedo);
+            glBindTextureUnit(1, atlas.normalDepth);
+            MG_RENDER_STATS_ADD(textureBinds, 2);
+
+            MG_RENDER_STATS_DRAW(GL_TRIANGLE_STRIP, 4, uint32_t(atlas.instances.size()));
+            glDrawArraysInstancedBaseInstance(GL_TRIANGLE_STRIP, 0, 4, GLsizei(atlas.instances.size()), firstInstance);
+
+            firstInstance += GLuint(atlas.instances.size());
+            atlas.instances.clear();
+        }
+
+        glBindVertexArray(0);
+    }
+
+    glm::vec3 Imposters::octahedronDecode(const glm::vec2 & e)
+    {
+        glm::vec3 n = glm::vec3(e, 1.0f - glm::abs(e.x) - glm::abs(e.y));
+
+        if (n.z < 0.0f)
+        {
+            glm::vec2 signNotZero = { n.x >= 0.0f ? 1.0f : -1.0f, n.y >= 0.0f ? 1.0f : -1.0f };
+            glm::vec2 folded      = (1.0f - glm::abs(glm::vec2(n.y, n.x))) * signNotZero;
+
+            n.x = folded.x;
+            n.y = folded.y;
+        }
+
+        return glm::normalize(n);
+    }
+
+    void Imposters::bake(Atlas & atlas, const MaterialTable & materials)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+        MG_PROFILE_GL_ZONE("Imposters::bake");
+
+        auto & mesh = atlas.mesh;
+
+        const GLsizei atlasSize = FRAMES * FRAME_RESOLUTION;
+
+        // A few mips are enough for the distant billboards, the lower ones would blend the neighbouring frames
+        const GLsizei mipLevels = 4;
+
+        for (GLuint* texture : { &atlas.albedo, &atlas.normalDepth })
+        {
+            glCreateTextures   (GL_TEXTURE_2D, 1, texture);
+            glTextureStorage2D (*texture, mipLevels, GL_RGBA8, atlasSize, atlasSize);
+            glTextureParameteri(*texture, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+            glTextureParameteri(*texture, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTextureParameteri(*texture, GL_TEXTURE_WRAP_S,     GL_CLAMP_TO_EDGE);
+            glTextureParameteri(*texture, GL_TEXTURE_WRAP_T,     GL_CLAMP_TO_EDGE);
+        }
+
+        glNamedFramebufferTexture(m_bakeFbo, GL_COLOR_ATTACHMENT0, atlas.albedo,      0);
+        glNamedFramebufferTexture(m_bakeFbo, GL_COLOR_ATTACHMENT1, atlas.normalDepth, 0);
+
+        if (glCheckNamedFramebufferStatus(m_bakeFbo, GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        {
+            MG_CORE_ERROR("Imposter framebuffer is not complete.");
+        }
+
+        /* Render the frames */
+        GLint viewport[4];
+        glGetIntegerv(GL_VIEWPORT, viewport);
+
+        GLint framebuffer = 0;
+        glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &framebuffer);
+
+        const float zeros[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+        const float depth    = 1.0f;
+
+        // The depth mask applies to the clears as well
+        glDisable(GL_BLEND);
+        glEnable(GL_DEPTH_TEST);
+        glDepthMask(GL_TRUE);
+
+        glClearNamedFramebufferfv(m_bakeFbo, GL_COLOR, 0, zeros);
+        glClearNamedFramebufferfv(m_bakeFbo, GL_COLOR, 1, zeros);
+        glClearNamedFramebufferfv(m_bakeFbo, GL_DEPTH, 0, &depth);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, m_bakeFbo);
+
+        const glm::vec3 center = mesh->getBoundsCenter();
+        const float     radius = glm::max(mesh->getBoundsRadius(), 0.001f);
+
+        atlas.bounds = glm::vec4(center, radius);
+
+        const glm::mat4 projection = glm::ortho(-radius, radius, -radius, radius, 0.0f, 2.0f * radius);
+
+        m_bakeShader->bind();
+        mesh->bind();
+
+        auto & submeshes = mesh->getSubmeshes();
+        for (uint32_t y = 0; y < FRAMES; ++y)
+        {
+            for (uint32_t x = 0; x < FRAMES; ++x)
+            {
+                glViewport(x * FRAME_RESOLUTION, y * FRAME_RESOLUTION, FRAME_RESOLUTION, FRAME_RESOLUTION);
+
+                // Direction from the center to the camera, the up vector has to match ImposterGBuffer.vert
+                glm::vec3 direction = octahedronDecode((glm::vec2(x, y) + 0.5f) / float(FRAMES) * 2.0f - 1.0f);
+                glm::vec3 up        = glm::abs(direction.y) > 0.99f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+
+                m_bakeShader->setUniform("view_projection", projection * glm::lookAt(center + direction * radius, center, up));
+
+                for (uint32_t submeshIndex = 0; submeshIndex < submeshes.size(); ++submeshIndex)
+                {
+                    auto & material = materials[submeshes[submeshIndex].materialIndex];
+                    if (material)
+                    {
+                        auto & textures = material->getTextureMap();
+                        auto   diffuse  = textures.find(Material::TextureType::DIFFUSE);
+                        if (diffuse != textures.end())
+                        {
+                            diffuse->second->bind(0);
+                        }
+
+                        m_bakeShader->setUniform("alpha_cutoff", material->getFloat("alpha_cutoff"));
+                    }
+
+                    mesh->render(submeshIndex);
+                }
+            }
+        }
+
+        glGenerateTextureMipmap(atlas.albedo);
+        glGenerateTextureMipmap(atlas.normalDepth);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+    }
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include "glad/glad.h"
+#include "Mango/Core/Base.h"
+#include "Mango/Rendering/Material.h"
+
+#include <glm/glm.hpp>
+#include <map>
+#include <vector>
+
+namespace mango
+{
+    class Mesh;
+    class Shader;
+
+    /*
+     * Octahedral imposters of the distant static meshes (see ImposterComponent).
+     * A mesh is baked once, the first time it's needed: it's rendered by an orthographic camera from FRAMES x FRAMES directions
+     * spread over the sphere with the octahedral mapping, into an albedo atlas and a normal + depth atlas.
+     * Each frame the queued instances are drawn into the GBuffer as camera facing billboards showing the closest captured direction,
+     * with one instanced draw per atlas.
+     */
+    class Imposters
+    {
+    public:
+        static const uint32_t FRAMES           = 8;
+        static const uint32_t FRAME_RESOLUTION = 128;
+
+        Imposters() = default;
+        ~Imposters();
+
+        Imposters(const Imposters &)             = delete;
+        Imposters & operator=(const Imposters &) = delete;
+
+        void init();
+        void clear();
+
+        // Queues an instance of the mesh for the next render, bakes the mesh if it has no atlas yet
+        void addInstance(const ref<Mesh> & mesh, const MaterialTable & materials, const glm::mat4 & model);
+
+        // Draws the queued instances into the bound GBuffer and clears the queues
+        void render(const glm::mat4 & viewProjection, const glm::vec3 & cameraPosition);
+
+        uint32_t getAtlasesCount() const { return uint32_t(m_atlases.size()); }
+
+        // Inverse of the octahedral mapping of the unit sphere to [-1, 1]^2
+        static glm::vec3 octahedronDecode(const glm::vec2 & e);
+
+    private:
+        struct Atlas
+        {
+            ref<Mesh>     mesh;     // kept alive, so the key of the atlas can't be reused by another mesh
+            ref<Material> material;
+            GLuint        albedo      = 0;
+            GLuint        normalDepth = 0;
+            glm::vec4     bounds      = glm::vec4(0.0f); // object space bounding sphere of the mesh
+
+            std::vector<glm::mat4> instances;
+        };
+
+        void bake(Atlas & atlas, const MaterialTable & materials);
+
+    private:
+        // The atlas depends on the mesh and the material of its first submesh
+        std::map<std::pair<Mesh*, Material*>, Atlas> m_atlases;
+
+        ref<Shader> m_bakeShader;
+        ref<Shader> m_gbufferShader;
+
+        GLuint m_quadVao      = 0;
+        GLuint m_quadVbo      = 0;
+        GLuint m_instancesVbo = 0;
+        GLuint m_bakeFbo      = 0;
+        GLuint m_bakeDepth    = 0;
+
+        // Staging of the instances of all of the atlases, so they are uploaded at once
+        std::vector<glm::mat4> m_instancesUpload;
+    };
+}
@@ -19,10 +19,10 @@ namespace mango
         resize(width, height);
 
         m_stencilFillShader = AssetManager::createShader("JfaStencilFill", "jfaOutline/JumpFloodMaskFill.vert", "jfaOutline/JumpFloodStencilFill.frag");
-        m_stencilFillShader->link();
+        m_stencilFillShader->requestLink();
 
         m_maskFillShader = AssetManager::createShader("JfaMaskFill", "jfaOutline/JumpFloodMaskFill.vert", "jfaOutline/JumpFloodMaskFill.frag");
-        m_maskFillShader->link();
+        m_maskFillShader->requestLink();
 
         m_jumpFloodInitPS = createRef<PostprocessEffect>();
         m_jumpFloodInitPS->init("JfaInit", "jfaOutline/JumpFloodInit.frag");
@@ -1,10 +1,20 @@
 #include "mgpch.h"
 
 #include "Material.h"
+#include "Shader.h"
+#include "Mango/Core/Services.h"
 #include "Mango/Systems/RenderingSystem.h"
 
 namespace mango
 {
+    namespace
+    {
+        struct OverrideNameLess
+        {
+            bool operator()(const MaterialInstance::Override& o, const std::string& name) const { return o.name < name; }
+        };
+    }
+
     Material::Material(const std::string& name) 
         : name(name)
     {
@@ -24,6 +34,12 @@ namespace mango
     }
 
 
+    Material::Material(const std::string& name, const ref<Material>& parent)
+        : name(name),
+          m_parent(parent)
+    {
+    }
+
     Material::~Material()
     {
     }
@@ -32,7 +48,7 @@ namespace mango
     {
         MG_PROFILE_ZONE_SCOPED;
 
-        m_textureMap[textureType] = texture;
+        getTextureMap()[textureType] = texture;
     }
 
     void Material::addVector3(const std::string & uniformName, const glm::vec3 & vec)
@@ -55,13 +71,45 @@ namespace mango
         m_boolMap[uniformName] = value;
     }
 
+    void Material::setKeyword(const std::string & keyword, bool isEnabled)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        auto& keywords = getBase()->m_keywords;
+        auto  it       = std::find(keywords.begin(), keywords.end(), keyword);
+
+        if (isEnabled && it == keywords.end())
+        {
+            keywords.push_back(keyword);
+        }
+        else if (!isEnabled && it != keywords.end())
+        {
+            keywords.erase(it);
+        }
+
+        getBase()->m_keywordsMask = Shader::getKeywordsMask(keywords);
+
+        // Link the variant before the material is drawn with it
+        if (Services::renderer())
+        {
+            Services::renderer()->requestMaterialVariants(*this);
+        }
+    }
+
+    bool Material::hasKeyword(const std::string & keyword) const
+    {
+        auto& keywords = getBase()->m_keywords;
+        return std::find(keywords.begin(), keywords.end(), keyword) != keywords.end();
+    }
+
     ref<Texture> Material::getTexture(TextureType textureType)
     {
         MG_PROFILE_ZONE_SCOPED;
 
-        if (m_textureMap.contains(textureType))
+        auto& textureMap = getTextureMap();
+        if (textureMap.contains(textureType))
         {
-            return m_textureMap[textureType];
+            return textureMap[textureType];
         }
 
         MG_CORE_ASSERT_FAIL("Couldn't find texture with the specified texture type!");
@@ -104,4 +152,78 @@ namespace mango
         return false;
     }
 
+    MaterialInstance::MaterialInstance(const ref<Material>& parent, const std::string& name)
+        : Material(name, parent->isInstance() ? parent->getParent() : parent)
+    {
+        MG_CORE_ASSERT(parent);
+
+        if (parent->isInstance())
+        {
+            m_overrides = std::static_pointer_cast<MaterialInstance>(parent)->m_overrides;
+        }
+    }
+
+    void MaterialInstance::addVector3(const std::string& uniformName, const glm::vec3& vec)
+    {
+        setOverride(uniformName, OverrideType::VECTOR3, vec);
+    }
+
+    void MaterialInstance::addFloat(const std::string& uniformName, float value)
+    {
+        setOverride(uniformName, OverrideType::FLOAT, glm::vec3(value, 0.0f, 0.0f));
+    }
+
+    void MaterialInstance::addBool(const std::string& uniformName, bool value)
+    {
+        setOverride(uniformName, OverrideType::BOOL, glm::vec3(value ? 1.0f : 0.0f, 0.0f, 0.0f));
+    }
+
+    glm::vec3 MaterialInstance::getVector3(const std::string & uniformName)
+    {
+        auto found = findOverride(uniformName);
+        return found ? found->value : getParent()->getVector3(uniformName);
+    }
+
+    float MaterialInstance::getFloat(const std::string & uniformName)
+    {
+        auto found = findOverride(uniformName);
+        return found ? found->value.x : getParent()->getFloat(uniformName);
+    }
+
+    bool MaterialInstance::getBool(const std::string & uniformName)
+    {
+        auto found = findOverride(uniformName);
+        return found ? found->value.x != 0.0f : getParent()->getBool(uniformName);
+    }
+
+    void MaterialInstance::removeOverride(const std::string & uniformName)
+    {
+        auto it = std::lower_bound(m_overrides.begin(), m_overrides.end(), uniformName, OverrideNameLess{});
+        if (it != m_overrides.end() && it->name == uniformName)
+        {
+            m_overrides.erase(it);
+        }
+    }
+
+    const MaterialInstance::Override * MaterialInstance::findOverride(const std::string & uniformName) const
+    {
+        auto it = std::lower_bound(m_overrides.begin(), m_overrides.end(), uniformName, OverrideNameLess{});
+        return it != m_overrides.end() && it->name == uniformName ? &*it : nullptr;
+    }
+
+    void MaterialInstance::setOverride(const std::string & uniformName, OverrideType type, const glm::vec3 & value)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        auto it = std::lower_bound(m_overrides.begin(), m_overrides.end(), uniformName, OverrideNameLess{});
+        if (it != m_overrides.end() && it->name == uniformName)
+        {
+            it->type  = type;
+            it->value = value;
+        }
+        else
+        {
+            m_overrides.insert(it, { uniformName, type, value });
+        }
+    }
 }
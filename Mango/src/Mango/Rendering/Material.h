@@ -2,7 +2,9 @@
 
 #include <glm/vec3.hpp>
 #include <memory>
+#include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "Texture.h"
 
@@ -18,42 +20,129 @@ namespace mango
         enum class BlendMode   { NONE, ALPHA };
         enum class RenderQueue { RQ_OPAQUE, RQ_TRANSPARENT, RQ_ENVIRO_MAPPING_STATIC, RQ_ENVIRO_MAPPING_DYNAMIC };
 
+        // How RQ_TRANSPARENT materials are blended; DEFAULT follows RenderingSystem::s_TransparencyMode
+        enum class TransparencyMode { DEFAULT, SORTED, ORDER_INDEPENDENT };
+
         Material(const std::string& name = "Unnamed");
-        ~Material();
+        virtual ~Material();
+
+                void addTexture(      TextureType  textureType,  const ref<Texture>& texture);
+        virtual void addVector3(const std::string& uniformName,  const glm::vec3&    vec);
+        virtual void addFloat  (const std::string& uniformName,  float               value);
+        virtual void addBool   (const std::string& uniform_name, bool                value);
+
+                ref<Texture> getTexture(TextureType textureType);
+        virtual glm::vec3    getVector3(const std::string & uniformName);
+        virtual float        getFloat  (const std::string & uniformName);
+        virtual bool         getBool   (const std::string & uniformName);
+
+        // An instance shares the settings, the textures and the parameter maps of its parent (see MaterialInstance)
+        void      setBlendMode(BlendMode mode) { getBase()->m_blendMode = mode; }
+        BlendMode getBlendMode() const         { return getBase()->m_blendMode; }
+
+        void        setRenderQueue(RenderQueue queue) { getBase()->m_renderQueue = queue; }
+        RenderQueue getRenderQueue() const { return getBase()->m_renderQueue; }
+
+        void             setTransparencyMode(TransparencyMode mode) { getBase()->m_transparencyMode = mode; }
+        TransparencyMode getTransparencyMode() const                { return getBase()->m_transparencyMode; }
+
+        // Keywords of the shader variant (see Shader::getVariant) the material is drawn with
+        void                             setKeyword(const std::string & keyword, bool isEnabled);
+        bool                             hasKeyword(const std::string & keyword) const;
+        const std::vector<std::string> & getKeywords()     const { return getBase()->m_keywords; }
+        uint64_t                         getKeywordsMask() const { return getBase()->m_keywordsMask; }
 
-        void addTexture(      TextureType  textureType,  const ref<Texture>& texture);
-        void addVector3(const std::string& uniformName,  const glm::vec3&    vec);
-        void addFloat  (const std::string& uniformName,  float               value);
-        void addBool   (const std::string& uniform_name, bool                value);
+              std::unordered_map<TextureType, ref<Texture>>& getTextureMap()       { return getBase()->m_textureMap; }
+        const std::unordered_map<TextureType, ref<Texture>>& getTextureMap() const { return getBase()->m_textureMap; }
+        std::unordered_map<std::string, glm::vec3>   & getVec3Map()    { return getBase()->m_vec3Map; }
+        std::unordered_map<std::string, float>       & getFloatMap()   { return getBase()->m_floatMap; }
+        std::unordered_map<std::string, bool>        & getBoolMap()    { return getBase()->m_boolMap; }
 
-        ref<Texture> getTexture(TextureType textureType);
-        glm::vec3    getVector3(const std::string & uniformName);
-        float        getFloat  (const std::string & uniformName);
-        bool         getBool   (const std::string & uniformName);
+        // Layers of the texture arrays that hold the textures (see MaterialTextureArrays), empty if they are bound one by one
+        struct TextureLayer
+        {
+            ref<Texture> array;
+            uint32_t     layer = 0;
+        };
 
-        void      setBlendMode(BlendMode mode) { m_blendMode = mode; }
-        BlendMode getBlendMode() const         { return m_blendMode; }
+              std::unordered_map<TextureType, TextureLayer> & getTextureLayers()       { return getBase()->m_textureLayers; }
+        const std::unordered_map<TextureType, TextureLayer> & getTextureLayers() const { return getBase()->m_textureLayers; }
 
-        void        setRenderQueue(RenderQueue queue) { m_renderQueue = queue; }
-        RenderQueue getRenderQueue() const { return m_renderQueue; }
+        bool                  isInstance() const { return m_parent != nullptr; }
+        const ref<Material> & getParent()  const { return m_parent; }
 
-        std::unordered_map<TextureType, ref<Texture>>& getTextureMap() { return m_textureMap; }
-        std::unordered_map<std::string, glm::vec3>   & getVec3Map()    { return m_vec3Map; }
-        std::unordered_map<std::string, float>       & getFloatMap()   { return m_floatMap; }
-        std::unordered_map<std::string, bool>        & getBoolMap()    { return m_boolMap; }
+        // The material that owns the shared state, the parent of an instance
+              Material * getBase()       { return m_parent ? m_parent.get() : this; }
+        const Material * getBase() const { return m_parent ? m_parent.get() : this; }
 
         std::string name;
 
+    protected:
+        // Instances keep the maps empty
+        Material(const std::string& name, const ref<Material>& parent);
+
     private:
         std::unordered_map<TextureType, ref<Texture>> m_textureMap;
         std::unordered_map<std::string, glm::vec3>    m_vec3Map;
         std::unordered_map<std::string, float>        m_floatMap;
         std::unordered_map<std::string, bool>         m_boolMap;
+        std::unordered_map<TextureType, TextureLayer> m_textureLayers;
 
         BlendMode   m_blendMode   = BlendMode::NONE;
         RenderQueue m_renderQueue = RenderQueue::RQ_OPAQUE;
 
+        TransparencyMode m_transparencyMode = TransparencyMode::DEFAULT;
+
+        std::vector<std::string> m_keywords;
+        uint64_t                 m_keywordsMask = 0;
+
+        ref<Material> m_parent;
+
     private:
         friend class SceneHierarchyPanel;
     };
+
+    /*
+     * A material that shares everything with its parent but the parameters it overrides. The overrides are kept in a small array
+     * sorted by their names, so thousands of tinted variants of a material don't copy its maps. The renderer keeps the state of
+     * the parent bound between the draws of its instances and sets only the overridden uniforms (see RenderingSystem::bindMaterial),
+     * the queues are sorted by the parents so the instances are drawn one after another.
+     * The textures can't be overridden, an instance of an instance overrides the parent of the latter.
+     */
+    class MaterialInstance final : public Material
+    {
+    public:
+        enum class OverrideType { VECTOR3, FLOAT, BOOL };
+
+        struct Override
+        {
+            std::string  name;
+            OverrideType type;
+            glm::vec3    value; // floats and bools are stored in x
+        };
+
+        MaterialInstance(const ref<Material>& parent, const std::string& name = "Unnamed");
+
+        // Override the parameter of the parent
+        void addVector3(const std::string& uniformName, const glm::vec3& vec)   override;
+        void addFloat  (const std::string& uniformName, float            value) override;
+        void addBool   (const std::string& uniformName, bool             value) override;
+
+        glm::vec3 getVector3(const std::string & uniformName) override;
+        float     getFloat  (const std::string & uniformName) override;
+        bool      getBool   (const std::string & uniformName) override;
+
+        // Goes back to the value of the parent
+        void removeOverride(const std::string & uniformName);
+        bool isOverridden  (const std::string & uniformName) const { return findOverride(uniformName) != nullptr; }
+
+        const std::vector<Override> & getOverrides() const { return m_overrides; }
+
+    private:
+        const Override * findOverride(const std::string & uniformName) const;
+        void             setOverride (const std::string & uniformName, OverrideType type, const glm::vec3 & value);
+
+    private:
+        std::vector<Override> m_overrides;
+    };
 }
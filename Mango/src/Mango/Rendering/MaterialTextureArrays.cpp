@@ -0,0 +1,164 @@
+#include "mgpch.h"
+
+#include "MaterialTextureArrays.h"
+#include "TextureStreaming.h"
+
+#include <map>
+#include <tuple>
+
+namespace mango
+{
+    namespace
+    {
+        // The storage and the sampler state, the textures of an array are sampled with their common state
+        struct ArrayKey
+        {
+            GLint   internalFormat = 0;
+            GLint   width          = 0;
+            GLint   height         = 0;
+            GLint   mipLevels      = 0;
+            GLint   minFilter      = 0;
+            GLint   magFilter      = 0;
+            GLint   wrapS          = 0;
+            GLint   wrapT          = 0;
+            GLfloat anisotropy     = 1.0f;
+            GLint   swizzle[4]     = {};
+
+            auto tie() const
+            {
+                return std::tie(internalFormat, width, height, mipLevels, minFilter, magFilter, wrapS, wrapT, anisotropy, swizzle[0], swizzle[1], swizzle[2], swizzle[3]);
+            }
+
+            bool operator<(const ArrayKey & other) const { return tie() < other.tie(); }
+        };
+    }
+
+    void MaterialTextureArrays::build(const std::vector<ref<Material>> & materials)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+        MG_PROFILE_GL_ZONE("MaterialTextureArrays::build");
+
+        clear();
+
+        /* Group the distinct 2D textures by their storage, the other ones keep their materials out of the arrays */
+        std::map<ArrayKey, std::vector<ref<Texture>>> groups;
+        std::unordered_set<const Texture *>           groupedTextures;
+        std::unordered_set<const Texture *>           skippedTextures;
+
+        for (auto & material : materials)
+        {
+            if (!material || material->isInstance()) continue;
+
+            for (auto & [type, texture] : material->getTextureMap())
+            {
+                if (!texture || groupedTextures.contains(texture.get()) || skippedTextures.contains(texture.get())) continue;
+
+                GLint    target = 0;
+                ArrayKey key;
+                glGetTextureParameteriv     (texture->getRendererID(), GL_TEXTURE_TARGET,          &target);
+                glGetTextureParameteriv     (texture->getRendererID(), GL_TEXTURE_IMMUTABLE_LEVELS, &key.mipLevels);
+                glGetTextureLevelParameteriv(texture->getRendererID(), 0, GL_TEXTURE_INTERNAL_FORMAT, &key.internalFormat);
+                glGetTextureLevelParameteriv(texture->getRendererID(), 0, GL_TEXTURE_WIDTH,           &key.width);
+                glGetTextureLevelParameteriv(texture->getRendererID(), 0, GL_TEXTURE_HEIGHT,          &key.height);
+                glGetTextureParameteriv     (texture->getRendererID(), GL_TEXTURE_MIN_FILTER,       &key.minFilter);
+                glGetTextureParameteriv     (texture->getRendererID(), GL_TEXTURE_MAG_FILTER,       &key.magFilter);
+                glGetTextureParameteriv     (texture->getRendererID(), GL_TEXTURE_WRAP_S,           &key.wrapS);
+                glGetTextureParameteriv     (texture->getRendererID(), GL_TEXTURE_WRAP_T,           &key.wrapT);
+                glGetTextureParameterfv     (texture->getRendererID(), GL_TEXTURE_MAX_ANISOTROPY,   &key.anisotropy);
+                glGetTextureParameteriv     (texture->getRendererID(), GL_TEXTURE_SWIZZLE_RGBA,     key.swizzle);
+
+                // The storage of the streamed textures changes with their resident mips
+                if (target != GL_TEXTURE_2D || key.mipLevels == 0 || TextureStreaming::isStreamed(texture.get()))
+                {
+                    skippedTextures.insert(texture.get());
+                    continue;
+                }
+
+                groups[key].push_back(texture);
+                groupedTextures.insert(texture.get());
+            }
+        }
+
+        /* Copy the groups into the arrays, the groups larger than the layers limit are split */
+        GLint maxLayers = 0;
+        glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+
+        std::unordered_map<const Texture *, Material::TextureLayer> layers;
+
+        for (auto & [key, textures] : groups)
+        {
+            for (uint32_t first = 0; first < textures.size(); first += maxLayers)
+            {
+                uint32_t count = std::min(uint32_t(textures.size()) - first, uint32_t(maxLayers));
+
+                auto array = createRef<Texture>();
+                array->createTexture2dArray(key.internalFormat, key.width, key.height, key.mipLevels, count);
+                array->copySamplerState(*textures[first]);
+
+                // The textures become the views of their layers, so their storage isn't held twice
+                for (uint32_t layer = 0; layer < count; ++layer)
+                {
+                    auto & texture = textures[first + layer];
+
+                    array->copyToLayer(*texture, layer);
+                    texture->replaceWithLayerView(*array, layer);
+
+                    layers[texture.get()] = { array, layer };
+                }
+
+                m_arrays.push_back(array);
+            }
+        }
+
+        /* A material samples the arrays only when all of its textures are in them */
+        for (auto & material : materials)
+        {
+            if (!material || material->isInstance()) continue;
+
+            auto & textureMap = material->getTextureMap();
+
+            bool isInArrays = true;
+            for (auto & [type, texture] : textureMap)
+            {
+                isInArrays &= texture && layers.contains(texture.get());
+            }
+
+            if (!isInArrays) continue;
+
+            auto & textureLayers = material->getTextureLayers();
+            for (auto & [type, texture] : textureMap)
+            {
+                textureLayers[type] = layers[texture.get()];
+            }
+
+            m_materials.push_back(material);
+        }
+
+        m_texturesCount = uint32_t(groupedTextures.size());
+
+        MG_CORE_INFO("Grouped {} textures of {} materials into {} texture arrays.", m_texturesCount, m_materials.size(), m_arrays.size());
+    }
+
+    void MaterialTextureArrays::clear()
+    {
+        for (auto & material : m_materials)
+        {
+            material->getTextureLayers().clear();
+        }
+
+        m_materials.clear();
+        m_arrays   .clear();
+        m_texturesCount = 0;
+    }
+
+    const std::string & MaterialTextureArrays::getLayerUniformName(Material::TextureType textureType)
+    {
+        static const std::string names[] = { "m_texture_diffuse_layer",
+                                             "m_texture_specular_layer",
+                                             "m_texture_normal_layer",
+                                             "m_texture_emission_layer",
+                                             "m_texture_depth_layer" };
+
+        return names[uint32_t(textureType)];
+    }
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include "Mango/Core/Base.h"
+#include "Mango/Rendering/Material.h"
+
+#include <vector>
+
+namespace mango
+{
+    /*
+     * Groups the 2D textures of the materials that have the same internal format, size and mip levels into texture arrays.
+     * The materials keep the array and the layer of every texture (see Material::getTextureLayers), the shaders that include
+     * MaterialTextures.glh sample the layers in their MATERIAL_TEXTURE_ARRAYS variant. The draws of the materials whose textures
+     * share the arrays then don't rebind any textures, only the layer uniforms change (see RenderingSystem::bindMaterial).
+     * The textures are copied on the GPU and their storage is released, they become the views of their layers (see Texture::replaceWithLayerView),
+     * so the editor and the imposters still sample them one by one. The textures are grouped also by their sampler state. The streamed
+     * textures (see TextureStreaming) keep their materials out of the arrays.
+     */
+    class MaterialTextureArrays
+    {
+    public:
+        MaterialTextureArrays() = default;
+        ~MaterialTextureArrays() { clear(); }
+
+        MaterialTextureArrays(const MaterialTextureArrays &)             = delete;
+        MaterialTextureArrays & operator=(const MaterialTextureArrays &) = delete;
+
+        // Groups the textures of the materials, the instances share the layers of their parents
+        void build(const std::vector<ref<Material>> & materials);
+        void clear();
+
+        uint32_t getArraysCount()   const { return uint32_t(m_arrays.size()); }
+        uint32_t getTexturesCount() const { return m_texturesCount; }
+
+        // Uniform with the layer of the texture in the MATERIAL_TEXTURE_ARRAYS variants
+        static const std::string & getLayerUniformName(Material::TextureType textureType);
+
+    private:
+        std::vector<ref<Material>> m_materials; // with the layers set
+        std::vector<ref<Texture>>  m_arrays;
+        uint32_t                   m_texturesCount = 0;
+    };
+}
@@ -1,20 +1,43 @@
 #include "mgpch.h"
 
 #include "Mesh.h"
+#include "GPUUploads.h"
 #include "Mango/Core/AssetManager.h"
+#include "Mango/Core/Jobs.h"
 #include "Mango/Core/Services.h"
+#include "Mango/Utils/Hash.h"
 
 namespace mango
 {
+    namespace
+    {
+        template<typename T>
+        uint64_t hashArray(const std::vector<T> & array)
+        {
+            return fnvHash1a64(reinterpret_cast<const char*>(array.data()), array.size() * sizeof(T));
+        }
+
+        uint64_t hashVertexData(const VertexData & vertexData)
+        {
+            MG_PROFILE_ZONE_SCOPED;
+
+            uint64_t hashes[] = { hashArray(vertexData.positions), hashArray(vertexData.texcoords), hashArray(vertexData.normals),
+                                  hashArray(vertexData.tangents),  hashArray(vertexData.indices) };
+
+            return fnvHash1a64(reinterpret_cast<const char*>(hashes), sizeof(hashes));
+        }
+    }
 
     void Mesh::bind() const
     {
+        MG_RENDER_STATS_INC(vaoBinds);
         glBindVertexArray(m_vaoName);
     }
 
     void Mesh::render(uint32_t submeshIndex, uint32_t instancesCount)
     {
         MG_PROFILE_ZONE_SCOPED;
+        MG_RENDER_STATS_DRAW(GLenum(m_drawMode), m_submeshes[submeshIndex].indicesCount, instancesCount);
 
         if (instancesCount == 0)
         {
@@ -35,11 +58,31 @@ namespace mango
         }
     }
 
+    void Mesh::renderIndirect(uint64_t commandsOffset, uint32_t commandsCount, uint32_t indicesCount)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+        MG_RENDER_STATS_DRAW(GLenum(m_drawMode), indicesCount, 0);
+
+        glMultiDrawElementsIndirect(GLenum(m_drawMode), GL_UNSIGNED_INT, (void*)commandsOffset, commandsCount, 0);
+    }
+
     void Mesh::createBuffers(VertexData& vertexData)
     {
         MG_PROFILE_ZONE_SCOPED;
         bool hasTangents = !vertexData.tangents.empty();
 
+        calcBounds(vertexData);
+
+        // The imported meshes are keyed before by their source
+        if (m_contentKey == 0)
+        {
+            m_contentKey = hashVertexData(vertexData);
+        }
+
+        m_verticesCount = uint32_t(vertexData.positions.size());
+        m_indicesCount  = uint32_t(vertexData.indices.size());
+        m_hasTangents   = hasTangents;
+
         const GLsizei positionsSizeBytes = vertexData.positions.size() * sizeof(vertexData.positions[0]);
         const GLsizei texcoordsSizeBytes = vertexData.texcoords.size() * sizeof(vertexData.texcoords[0]);
         const GLsizei normalsSizeBytes   = vertexData.normals  .size() * sizeof(vertexData.normals  [0]);
@@ -50,38 +93,74 @@ namespace mango
         glNamedBufferStorage(m_vboName, totalSizeBytes, nullptr, GL_DYNAMIC_STORAGE_BIT);
 
         uint64_t offset = 0;
-        glNamedBufferSubData(m_vboName, offset, positionsSizeBytes, vertexData.positions.data());
+        GPUUploads::uploadBuffer(m_vboName, offset, positionsSizeBytes, vertexData.positions.data());
 
         offset += positionsSizeBytes;
-        glNamedBufferSubData(m_vboName, offset, texcoordsSizeBytes, vertexData.texcoords.data());
+        GPUUploads::uploadBuffer(m_vboName, offset, texcoordsSizeBytes, vertexData.texcoords.data());
 
         offset += texcoordsSizeBytes;
-        glNamedBufferSubData(m_vboName, offset, normalsSizeBytes, vertexData.normals.data());
+        GPUUploads::uploadBuffer(m_vboName, offset, normalsSizeBytes, vertexData.normals.data());
 
         if(hasTangents)
         {
             offset += normalsSizeBytes;
-            glNamedBufferSubData(m_vboName, offset, tangentsSizeBytes, vertexData.tangents.data());
+            GPUUploads::uploadBuffer(m_vboName, offset, tangentsSizeBytes, vertexData.tangents.data());
         }
 
-        glCreateBuffers     (1, &m_iboName);
-        glNamedBufferStorage(m_iboName, sizeof(vertexData.indices[0]) * vertexData.indices.size(), vertexData.indices.data(), GL_DYNAMIC_STORAGE_BIT);
+        const GLsizei indicesSizeBytes = vertexData.indices.size() * sizeof(vertexData.indices[0]);
+
+        glCreateBuffers         (1, &m_iboName);
+        glNamedBufferStorage    (m_iboName, indicesSizeBytes, nullptr, GL_DYNAMIC_STORAGE_BIT);
+        GPUUploads::uploadBuffer(m_iboName, 0, indicesSizeBytes, vertexData.indices.data());
+
+        createVertexArray();
+    }
+
+    void Mesh::createBuffers(const void* vertices, uint32_t verticesCount, bool hasTangents, const uint32_t* indices, uint32_t indicesCount)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        m_verticesCount = verticesCount;
+        m_indicesCount  = indicesCount;
+        m_hasTangents   = hasTangents;
+
+        const GLsizeiptr vertexSizeBytes  = sizeof(glm::vec3) + sizeof(glm::vec2) + sizeof(glm::vec3) + (hasTangents ? sizeof(glm::vec3) : 0);
+        const GLsizeiptr totalSizeBytes   = GLsizeiptr(verticesCount) * vertexSizeBytes;
+        const GLsizeiptr indicesSizeBytes = GLsizeiptr(indicesCount)  * sizeof(uint32_t);
+
+        glCreateBuffers         (1, &m_vboName);
+        glNamedBufferStorage    (m_vboName, totalSizeBytes, nullptr, GL_DYNAMIC_STORAGE_BIT);
+        GPUUploads::uploadBuffer(m_vboName, 0, totalSizeBytes, vertices);
+
+        glCreateBuffers         (1, &m_iboName);
+        glNamedBufferStorage    (m_iboName, indicesSizeBytes, nullptr, GL_DYNAMIC_STORAGE_BIT);
+        GPUUploads::uploadBuffer(m_iboName, 0, indicesSizeBytes, indices);
+
+        createVertexArray();
+    }
+
+    void Mesh::createVertexArray()
+    {
+        const GLintptr positionsSizeBytes = GLintptr(m_verticesCount) * sizeof(glm::vec3);
+        const GLintptr texcoordsSizeBytes = GLintptr(m_verticesCount) * sizeof(glm::vec2);
+        const GLintptr normalsSizeBytes   = GLintptr(m_verticesCount) * sizeof(glm::vec3);
+        const bool     hasTangents        = m_hasTangents;
 
         glCreateVertexArrays(1, &m_vaoName);
 
-        offset = 0;
-        glVertexArrayVertexBuffer(m_vaoName, 0 /* bindingindex*/, m_vboName, offset, sizeof(vertexData.positions[0]) /*stride*/);
+        GLintptr offset = 0;
+        glVertexArrayVertexBuffer(m_vaoName, 0 /* bindingindex*/, m_vboName, offset, sizeof(glm::vec3) /*stride*/);
                           
         offset += positionsSizeBytes;
-        glVertexArrayVertexBuffer(m_vaoName, 1 /* bindingindex*/, m_vboName, offset, sizeof(vertexData.texcoords[0]) /*stride*/);
+        glVertexArrayVertexBuffer(m_vaoName, 1 /* bindingindex*/, m_vboName, offset, sizeof(glm::vec2) /*stride*/);
         
         offset += texcoordsSizeBytes;
-        glVertexArrayVertexBuffer(m_vaoName, 2 /* bindingindex*/, m_vboName,  offset, sizeof(vertexData.normals[0]) /*stride*/);
+        glVertexArrayVertexBuffer(m_vaoName, 2 /* bindingindex*/, m_vboName,  offset, sizeof(glm::vec3) /*stride*/);
 
         if (hasTangents)
         {
             offset += normalsSizeBytes;
-            glVertexArrayVertexBuffer(m_vaoName, 3 /* bindingindex*/, m_vboName, offset, sizeof(vertexData.tangents[0]) /*stride*/);
+            glVertexArrayVertexBuffer(m_vaoName, 3 /* bindingindex*/, m_vboName, offset, sizeof(glm::vec3) /*stride*/);
         }
 
         glVertexArrayElementBuffer(m_vaoName, m_iboName);
@@ -102,6 +181,43 @@ namespace mango
         if (hasTangents) glVertexArrayAttribBinding(m_vaoName, 3 /*attribindex*/, 3 /*bindingindex*/); // tangents
     }
 
+    bool Mesh::readVertexData(VertexData& vertexData) const
+    {
+        MG_PROFILE_ZONE_SCOPED;
+        MG_PROFILE_GL_ZONE("Mesh::readVertexData");
+
+        if (!m_vboName || !m_iboName || m_verticesCount == 0)
+        {
+            return false;
+        }
+
+        vertexData.positions.resize(m_verticesCount);
+        vertexData.texcoords.resize(m_verticesCount);
+        vertexData.normals  .resize(m_verticesCount);
+        vertexData.tangents .resize(m_hasTangents ? m_verticesCount : 0);
+        vertexData.indices  .resize(m_indicesCount);
+
+        // Same layout as in createBuffers: positions, texcoords, normals and tangents one after another
+        GLintptr offset = 0;
+        glGetNamedBufferSubData(m_vboName, offset, m_verticesCount * sizeof(glm::vec3), vertexData.positions.data());
+
+        offset += m_verticesCount * sizeof(glm::vec3);
+        glGetNamedBufferSubData(m_vboName, offset, m_verticesCount * sizeof(glm::vec2), vertexData.texcoords.data());
+
+        offset += m_verticesCount * sizeof(glm::vec2);
+        glGetNamedBufferSubData(m_vboName, offset, m_verticesCount * sizeof(glm::vec3), vertexData.normals.data());
+
+        if (m_hasTangents)
+        {
+            offset += m_verticesCount * sizeof(glm::vec3);
+            glGetNamedBufferSubData(m_vboName, offset, m_verticesCount * sizeof(glm::vec3), vertexData.tangents.data());
+        }
+
+        glGetNamedBufferSubData(m_iboName, 0, m_indicesCount * sizeof(uint32_t), vertexData.indices.data());
+
+        return true;
+    }
+
     /* The first available input attribute index is 4. */
     void Mesh::addAttributeBuffer(GLuint attribIndex, GLuint bindingIndex, GLint formatSize, GLenum dataType, GLuint bufferID, GLsizei stride, GLuint divisor)
     {
@@ -162,6 +278,101 @@ namespace mango
         }
     }
 
+    void Mesh::calcBounds(const VertexData& vertexData)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        if (vertexData.positions.empty())
+        {
+            m_boundsMin    = m_boundsMax = m_boundsCenter = glm::vec3(0.0f);
+            m_boundsRadius = 0.0f;
+            m_uvDensity    = 0.0f;
+
+            return;
+        }
+
+        m_boundsMin = m_boundsMax = vertexData.positions[0];
+        for (auto& position : vertexData.positions)
+        {
+            m_boundsMin = glm::min(m_boundsMin, position);
+            m_boundsMax = glm::max(m_boundsMax, position);
+        }
+
+        // The sphere is centered at the box, its radius is tighter than the half of the box diagonal
+        m_boundsCenter = 0.5f * (m_boundsMin + m_boundsMax);
+
+        float radiusSquared = 0.0f;
+        for (auto& position : vertexData.positions)
+        {
+            radiusSquared = glm::max(radiusSquared, glm::dot(position - m_boundsCenter, position - m_boundsCenter));
+        }
+
+        m_boundsRadius = glm::sqrt(radiusSquared);
+
+        // The ratio of the texture coordinates area to the surface area, the texture streaming picks the mips with it
+        m_uvDensity = 0.0f;
+
+        if (vertexData.texcoords.size() != vertexData.positions.size()) return;
+
+        const bool     isIndexed      = !vertexData.indices.empty();
+        const uint32_t trianglesCount = uint32_t(isIndexed ? vertexData.indices.size() : vertexData.positions.size()) / 3;
+
+        double surfaceArea = 0.0;
+        double uvArea      = 0.0;
+
+        for (uint32_t t = 0; t < trianglesCount; ++t)
+        {
+            uint32_t i0 = isIndexed ? vertexData.indices[3 * t + 0] : 3 * t + 0;
+            uint32_t i1 = isIndexed ? vertexData.indices[3 * t + 1] : 3 * t + 1;
+            uint32_t i2 = isIndexed ? vertexData.indices[3 * t + 2] : 3 * t + 2;
+
+            auto& p0 = vertexData.positions[i0];
+            auto& t0 = vertexData.texcoords[i0];
+
+            glm::vec2 uv1 = vertexData.texcoords[i1] - t0;
+            glm::vec2 uv2 = vertexData.texcoords[i2] - t0;
+
+            surfaceArea += 0.5 * glm::length(glm::cross(vertexData.positions[i1] - p0, vertexData.positions[i2] - p0));
+            uvArea      += 0.5 * glm::abs(uv1.x * uv2.y - uv1.y * uv2.x);
+        }
+
+        if (surfaceArea > 0.0)
+        {
+            m_uvDensity = float(glm::sqrt(uvArea / surfaceArea));
+        }
+    }
+
+    void Mesh::buildMeshlets(const VertexData& vertexData)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        m_meshlets.clear();
+
+        if (m_drawMode != DrawMode::TRIANGLES || m_submeshes.empty())
+        {
+            return;
+        }
+
+        std::vector<std::vector<Meshlet>> submeshesMeshlets(m_submeshes.size());
+
+        tf::Taskflow taskflow;
+        taskflow.for_each_index(size_t(0), m_submeshes.size(), size_t(1), [&](size_t i)
+        {
+            auto& submesh = m_submeshes[i];
+            Meshlets::build(vertexData.positions, vertexData.indices, submesh.baseIndex, submesh.indicesCount, submesh.baseVertex, submeshesMeshlets[i]);
+        });
+
+        Jobs::executor.run(taskflow).wait();
+
+        for (uint32_t i = 0; i < m_submeshes.size(); ++i)
+        {
+            m_submeshes[i].meshletOffset = uint32_t(m_meshlets.size());
+            m_submeshes[i].meshletsCount = uint32_t(submeshesMeshlets[i].size());
+
+            m_meshlets.insert(m_meshlets.end(), submeshesMeshlets[i].begin(), submeshesMeshlets[i].end());
+        }
+    }
+
     void Mesh::genPrimitive(VertexData& vertexData, bool generateTangents /*= true*/)
     {
         MG_PROFILE_ZONE_SCOPED;
@@ -190,6 +401,8 @@ namespace mango
         m_materialTable.emplace_back(AssetManager::getMaterial("DefaultMaterial"));
 
         m_submeshes.emplace_back(submesh);
+
+        buildMeshlets(vertexData);
     }
 
     void Mesh::genCapsule(float            radius     /*= 0.5f*/, 
@@ -1,6 +1,7 @@
 #pragma once
 #include "Material.h"
 #include "Mesh.h"
+#include "Meshlets.h"
 #include "Shader.h"
 
 #include <glm/glm.hpp>
@@ -35,6 +36,8 @@ namespace mango
         uint32_t baseVertex    = 0;
         uint32_t baseIndex     = 0;
         uint32_t indicesCount  = 0;
+        uint32_t meshletOffset = 0; // range of Mesh::getMeshlets()
+        uint32_t meshletsCount = 0;
     };
 
     class Mesh
@@ -63,12 +66,22 @@ namespace mango
         Mesh& operator=(const Mesh&) = delete;
 
         Mesh(Mesh&& other) noexcept
-            : m_submeshes(std::move(other.m_submeshes)),
-              m_unitScale(other.m_unitScale),
-              m_vaoName  (other.m_vaoName),
-              m_vboName  (other.m_vboName),
-              m_iboName  (other.m_iboName),
-              m_drawMode (other.m_drawMode)
+            : m_submeshes   (std::move(other.m_submeshes)),
+              m_meshlets    (std::move(other.m_meshlets)),
+              m_unitScale   (other.m_unitScale),
+              m_vaoName     (other.m_vaoName),
+              m_vboName     (other.m_vboName),
+              m_iboName     (other.m_iboName),
+              m_drawMode    (other.m_drawMode),
+              m_boundsMin   (other.m_boundsMin),
+              m_boundsMax   (other.m_boundsMax),
+              m_boundsCenter(other.m_boundsCenter),
+              m_boundsRadius(other.m_boundsRadius),
+              m_uvDensity   (other.m_uvDensity),
+              m_contentKey  (other.m_contentKey),
+              m_verticesCount(other.m_verticesCount),
+              m_indicesCount (other.m_indicesCount),
+              m_hasTangents  (other.m_hasTangents)
         {
             other.m_unitScale = 1;
             other.m_vaoName   = 0;
@@ -84,11 +97,23 @@ namespace mango
                 release();
 
                 std::swap(m_submeshes, other.m_submeshes);
+                std::swap(m_meshlets,  other.m_meshlets);
                 std::swap(m_unitScale, other.m_unitScale);
                 std::swap(m_vaoName,   other.m_vaoName);
                 std::swap(m_vboName,   other.m_vboName);
                 std::swap(m_iboName,   other.m_iboName);
                 std::swap(m_drawMode,  other.m_drawMode);
+
+                std::swap(m_boundsMin,    other.m_boundsMin);
+                std::swap(m_boundsMax,    other.m_boundsMax);
+                std::swap(m_boundsCenter, other.m_boundsCenter);
+                std::swap(m_boundsRadius, other.m_boundsRadius);
+                std::swap(m_uvDensity,    other.m_uvDensity);
+                std::swap(m_contentKey,   other.m_contentKey);
+
+                std::swap(m_verticesCount, other.m_verticesCount);
+                std::swap(m_indicesCount,  other.m_indicesCount);
+                std::swap(m_hasTangents,   other.m_hasTangents);
             }
 
             return *this;
@@ -97,6 +122,9 @@ namespace mango
         void bind() const;
         void render(uint32_t submeshIndex = 0, uint32_t instancesCount = 0);
 
+        // Draws the commands stored at the offset of the bound GL_DRAW_INDIRECT_BUFFER
+        void renderIndirect(uint64_t commandsOffset, uint32_t commandsCount, uint32_t indicesCount);
+
         void addAttributeBuffer(GLuint attribIndex, GLuint bindingIndex, GLint formatSize, GLenum dataType, GLuint bufferID, GLsizei stride, GLuint divisor = 0);
         void build(VertexData& data, DrawMode drawMode = DrawMode::TRIANGLES, bool calcTangents = false);
 
@@ -106,6 +134,25 @@ namespace mango
         float getUnitScaleFactor() const { return m_unitScale; }
         std::string getName()      const { return m_name; }
 
+        // Object space bounds of all of the submeshes, computed when the buffers are created
+        const glm::vec3& getBoundsMin()    const { return m_boundsMin;    }
+        const glm::vec3& getBoundsMax()    const { return m_boundsMax;    }
+        const glm::vec3& getBoundsCenter() const { return m_boundsCenter; }
+        float            getBoundsRadius() const { return m_boundsRadius; }
+
+        // Texture coordinate units per object space unit, averaged over the area of the triangles. 0 if it's unknown
+        float getUVDensity() const { return m_uvDensity; }
+
+        // Changes with the vertex data: the cooked key of the imported meshes (the content of the source and the import flags),
+        // a hash of the vertices and the indices of the rest. Keys the caches derived from the mesh, like the static batches
+        uint64_t getContentKey() const { return m_contentKey; }
+
+        uint32_t getVerticesCount() const { return m_verticesCount; }
+        uint32_t getIndicesCount()  const { return m_indicesCount;  }
+
+        // Reads the vertex data back from the GPU buffers. It stalls the pipeline, meant for the load time steps like the static batching.
+        bool readVertexData(VertexData& vertexData) const;
+
         Submesh* getSubmesh(unsigned int index = 0)
         {
             if (m_submeshes.empty()) return nullptr;
@@ -121,6 +168,8 @@ namespace mango
         std::vector<Submesh>& getSubmeshes()          { return m_submeshes; }
         uint32_t              getSubmeshCount() const { return m_submeshes.size(); }
 
+        const std::vector<Meshlet>& getMeshlets() const { return m_meshlets; }
+
         MaterialTable getMaterials() { return m_materialTable; }
 
         /* Primitives */
@@ -144,7 +193,16 @@ namespace mango
     protected:
         void createBuffers(VertexData& vertexData);
 
+        // The vertices are laid out like the buffer of createBuffers(VertexData&): the positions, texcoords, normals and optional tangents
+        // one after another, e.g. straight from a memory mapped cooked mesh. The bounds and the UV density aren't computed
+        void createBuffers(const void* vertices, uint32_t verticesCount, bool hasTangents, const uint32_t* indices, uint32_t indicesCount);
+        void createVertexArray();
+
         void calcTangentSpace(VertexData& vertexData);
+        void calcBounds      (const VertexData& vertexData); // and the UV density
+
+        // Partitions the triangles of every submesh into meshlets, the submeshes are processed on the worker threads
+        void buildMeshlets(const VertexData& vertexData);
         void genPrimitive(VertexData& vertexData, bool generateTangents = true);
 
         void release()
@@ -162,11 +220,18 @@ namespace mango
 
             m_drawMode = DrawMode::TRIANGLES;
 
+            m_verticesCount = 0;
+            m_indicesCount  = 0;
+            m_hasTangents   = false;
+            m_contentKey    = 0;
+
             m_submeshes.clear();
+            m_meshlets.clear();
         }
 
     protected:
         std::vector<Submesh> m_submeshes;
+        std::vector<Meshlet> m_meshlets;
         MaterialTable        m_materialTable;
 
         std::string m_name      = "";
@@ -176,7 +241,20 @@ namespace mango
         GLuint      m_iboName   = 0;
         DrawMode    m_drawMode  = DrawMode::TRIANGLES;
 
+        glm::vec3 m_boundsMin    = glm::vec3(0.0f);
+        glm::vec3 m_boundsMax    = glm::vec3(0.0f);
+        glm::vec3 m_boundsCenter = glm::vec3(0.0f);
+        float     m_boundsRadius = 0.0f;
+        float     m_uvDensity    = 0.0f;
+        uint64_t  m_contentKey   = 0;
+
+        uint32_t m_verticesCount = 0;
+        uint32_t m_indicesCount  = 0;
+        bool     m_hasTangents   = false;
+
     private:
+        friend class AssetManager;
         friend class AssimpMeshImporter;
+        friend class StaticBatches;
     };
 }
@@ -0,0 +1,313 @@
+#include "mgpch.h"
+
+#include "Meshlets.h"
+
+namespace mango
+{
+    void Meshlets::build(const std::vector<glm::vec3> & positions,
+                         const std::vector<uint32_t>  & indices,
+                         uint32_t                       firstIndex,
+                         uint32_t                       indicesCount,
+                         uint32_t                       baseVertex,
+                         std::vector<Meshlet>         & meshlets)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        uint32_t uniqueVertices[MAX_VERTICES];
+        uint32_t uniqueVerticesCount = 0;
+        uint32_t trianglesCount      = 0;
+
+        Meshlet meshlet;
+        meshlet.firstIndex = firstIndex;
+
+        auto isUnique = [&](uint32_t index)
+        {
+            return std::find(uniqueVertices, uniqueVertices + uniqueVerticesCount, index) == uniqueVertices + uniqueVerticesCount;
+        };
+
+        auto flush = [&]()
+        {
+            meshlet.indicesCount = trianglesCount * 3;
+            computeBounds(positions, indices, baseVertex, meshlet);
+            meshlets.push_back(meshlet);
+
+            meshlet            = Meshlet();
+            meshlet.firstIndex = meshlets.back().firstIndex + meshlets.back().indicesCount;
+
+            uniqueVerticesCount = 0;
+            trianglesCount      = 0;
+        };
+
+        for (uint32_t i = firstIndex; i + 2 < firstIndex + indicesCount; i += 3)
+        {
+            const uint32_t a = indices[i], b = indices[i + 1], c = indices[i + 2];
+
+            uint32_t newVerticesCount = uint32_t(isUnique(a)) + uint32_t(isUnique(b) && b != a) + uint32_t(isUnique(c) && c != a && c != b);
+
+            if (uniqueVerticesCount + newVerticesCount > MAX_VERTICES || trianglesCount == MAX_TRIANGLES)
+            {
+                flush();
+            }
+
+            for (uint32_t index : { a, b, c })
+            {
+                if (isUnique(index))
+                {
+                    uniqueVertices[uniqueVerticesCount++] = index;
+                }
+            }
+
+            ++trianglesCount;
+        }
+
+        if (trianglesCount > 0)
+        {
+            flush();
+        }
+    }
+
+    uint32_t Meshlets::cull(const Meshlet                            * meshlets,
+                            uint32_t                                   meshletsCount,
+                            const glm::mat4                          & model,
+                            const glm::vec4                            frustumPlanes[6],
+                            const Viewer                             & viewer,
+                            int32_t                                    baseVertex,
+                            std::vector<DrawElementsIndirectCommand> & commands)
+    {
+        glm::vec3 axesScale = { glm::length(glm::vec3(model[0])), glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2])) };
+        float     maxScale  = glm::max(axesScale.x, glm::max(axesScale.y, axesScale.z));
+        float     minScale  = glm::min(axesScale.x, glm::min(axesScale.y, axesScale.z));
+
+        // Non-uniform scale skews the normals, so the normal cones are valid only for the uniformly scaled meshes
+        bool useCones = minScale > 0.99f * maxScale;
+
+        // A mirroring transform flips the winding, so the triangles that face the viewer are the other ones
+        float axisSign = glm::determinant(glm::mat3(model)) < 0.0f ? -1.0f : 1.0f;
+
+        uint32_t culledCount     = 0;
+        bool     previousIsDrawn = false;
+
+        for (uint32_t i = 0; i < meshletsCount; ++i)
+        {
+            const auto & meshlet = meshlets[i];
+
+            glm::vec3 center  = model * glm::vec4(meshlet.center, 1.0f);
+            float     radius  = meshlet.radius * maxScale;
+            bool      visible = true;
+
+            for (uint32_t p = 0; p < 6; ++p)
+            {
+                visible &= glm::dot(glm::vec3(frustumPlanes[p]), center) + frustumPlanes[p].w >= -radius;
+            }
+
+            if (visible && useCones && meshlet.coneCutoff < 1.0f)
+            {
+                glm::vec3 axis = axisSign * glm::normalize(glm::mat3(model) * meshlet.coneAxis);
+
+                if (viewer.isOrthographic)
+                {
+                    visible = glm::dot(viewer.direction, axis) < meshlet.coneCutoff;
+                }
+                else
+                {
+                    glm::vec3 toCenter = center - viewer.position;
+                    visible = glm::dot(toCenter, axis) < meshlet.coneCutoff * glm::length(toCenter) + radius;
+                }
+            }
+
+            if (!visible)
+            {
+                ++culledCount;
+                previousIsDrawn = false;
+                continue;
+            }
+
+            if (previousIsDrawn)
+            {
+                commands.back().count += meshlet.indicesCount;
+            }
+            else
+            {
+                commands.push_back({ meshlet.indicesCount, 1, meshlet.firstIndex, baseVertex, 0 });
+            }
+
+            previousIsDrawn = true;
+        }
+
+        return culledCount;
+    }
+
+    bool Meshlets::selfTest()
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        std::vector<glm::vec3> positions;
+        std::vector<uint32_t>  indices;
+        std::vector<Meshlet>   meshlets;
+
+        // Counter clockwise unit quad facing the normal, one meshlet each
+        auto addQuad = [&](const glm::vec3 & center, const glm::vec3 & normal)
+        {
+            glm::vec3 tangent   = glm::normalize(glm::cross(glm::abs(normal.y) < 0.99f ? glm::vec3(0.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.0f, 0.0f), normal));
+            glm::vec3 bitangent = glm::cross(normal, tangent);
+
+            uint32_t first = uint32_t(positions.size());
+            positions.push_back(center - tangent - bitangent);
+            positions.push_back(center + tangent - bitangent);
+            positions.push_back(center + tangent + bitangent);
+            positions.push_back(center - tangent + bitangent);
+
+            uint32_t firstIndex = uint32_t(indices.size());
+            for (uint32_t index : { 0u, 1u, 2u, 0u, 2u, 3u })
+            {
+                indices.push_back(first + index);
+            }
+
+            build(positions, indices, firstIndex, 6, 0, meshlets);
+            return uint32_t(meshlets.size() - 1);
+        };
+
+        const uint32_t facingQuad  = addQuad(glm::vec3(0.0f),                glm::vec3(0.0f, 0.0f,  1.0f));
+        const uint32_t sideQuad    = addQuad(glm::vec3(0.0f),                glm::normalize(glm::vec3(1.0f, 0.0f, 0.3f)));
+        const uint32_t awayQuad    = addQuad(glm::vec3(0.0f),                glm::vec3(0.0f, 0.0f, -1.0f));
+        const uint32_t outsideQuad = addQuad(glm::vec3(0.0f, 0.0f, -200.0f), glm::vec3(0.0f, 0.0f,  1.0f));
+
+        // Box frustum of a camera at z = 5 looking down -z, the far plane is at z = -100
+        const glm::vec4 planes[6] = { { 1.0f, 0.0f, 0.0f, 50.0f }, { -1.0f,  0.0f, 0.0f, 50.0f }, { 0.0f, 0.0f, -1.0f,   5.0f },
+                                      { 0.0f, 1.0f, 0.0f, 50.0f }, {  0.0f, -1.0f, 0.0f, 50.0f }, { 0.0f, 0.0f,  1.0f, 100.0f } };
+
+        Viewer perspective;
+        perspective.position = glm::vec3(-10.0f, 0.0f, 5.0f);
+
+        Viewer orthographic         = perspective;
+        orthographic.isOrthographic = true;
+
+        glm::mat4 mirrored = glm::mat4(1.0f);
+        mirrored[0][0] = -1.0f;
+
+        struct TestCase
+        {
+            const char*      name;
+            uint32_t         meshlet;
+            const glm::mat4  model;
+            const Viewer   & viewer;
+            bool             isVisible;
+        };
+
+        const TestCase testCases[] = { { "facing",                  facingQuad,  glm::mat4(1.0f), perspective,  true  },
+                                       { "back-facing",             awayQuad,    glm::mat4(1.0f), perspective,  false },
+                                       { "outside of the frustum",  outsideQuad, glm::mat4(1.0f), perspective,  false },
+                                       { "mirrored facing",         facingQuad,  mirrored,        perspective,  false },
+                                       { "mirrored back-facing",    awayQuad,    mirrored,        perspective,  true  },
+                                       { "side, perspective",       sideQuad,    glm::mat4(1.0f), perspective,  false },
+                                       { "side, orthographic",      sideQuad,    glm::mat4(1.0f), orthographic, true  } };
+
+        bool passed = true;
+        for (auto& testCase : testCases)
+        {
+            std::vector<DrawElementsIndirectCommand> commands;
+            uint32_t culledCount = cull(&meshlets[testCase.meshlet], 1, testCase.model, planes, testCase.viewer, 0, commands);
+
+            if ((culledCount == 0) != testCase.isVisible || commands.size() != (testCase.isVisible ? 1 : 0))
+            {
+                MG_CORE_ERROR("Meshlets: the {} quad is {}, it should be {}.", testCase.name, culledCount ? "culled" : "visible", testCase.isVisible ? "visible" : "culled");
+                passed = false;
+            }
+        }
+
+        // The facing and the side quads are consecutive, their draws are merged
+        std::vector<DrawElementsIndirectCommand> commands;
+        cull(meshlets.data(), uint32_t(meshlets.size()), glm::mat4(1.0f), planes, orthographic, 0, commands);
+
+        if (commands.size() != 1 || commands[0].count != 12)
+        {
+            MG_CORE_ERROR("Meshlets: the visible meshlets are drawn with {} commands, they should be merged into one.", commands.size());
+            passed = false;
+        }
+
+        return passed;
+    }
+
+    void Meshlets::computeBounds(const std::vector<glm::vec3> & positions,
+                                 const std::vector<uint32_t>  & indices,
+                                 uint32_t                       baseVertex,
+                                 Meshlet                      & meshlet)
+    {
+        const uint32_t first = meshlet.firstIndex;
+        const uint32_t last  = meshlet.firstIndex + meshlet.indicesCount;
+
+        /* Bounding sphere centered at the bounding box */
+        glm::vec3 min = positions[baseVertex + indices[first]];
+        glm::vec3 max = min;
+
+        for (uint32_t i = first; i < last; ++i)
+        {
+            min = glm::min(min, positions[baseVertex + indices[i]]);
+            max = glm::max(max, positions[baseVertex + indices[i]]);
+        }
+
+        meshlet.center = 0.5f * (min + max);
+
+        float radiusSquared = 0.0f;
+        for (uint32_t i = first; i < last; ++i)
+        {
+            glm::vec3 offset = positions[baseVertex + indices[i]] - meshlet.center;
+            radiusSquared = glm::max(radiusSquared, glm::dot(offset, offset));
+        }
+
+        meshlet.radius = glm::sqrt(radiusSquared);
+
+        /* Normal cone (counter clockwise front faces) */
+        glm::vec3 normalsSum = glm::vec3(0.0f);
+        for (uint32_t i = first; i < last; i += 3)
+        {
+            glm::vec3 p0 = positions[baseVertex + indices[i]];
+            glm::vec3 p1 = positions[baseVertex + indices[i + 1]];
+            glm::vec3 p2 = positions[baseVertex + indices[i + 2]];
+
+            glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+            float     length = glm::length(normal);
+
+            if (length > 0.0f)
+            {
+                normalsSum += normal / length;
+            }
+        }
+
+        meshlet.coneAxis   = glm::vec3(0.0f);
+        meshlet.coneCutoff = 1.0f;
+
+        float axisLength = glm::length(normalsSum);
+        if (axisLength <= 0.0f)
+        {
+            return;
+        }
+
+        glm::vec3 axis   = normalsSum / axisLength;
+        float     minDot = 1.0f;
+
+        for (uint32_t i = first; i < last; i += 3)
+        {
+            glm::vec3 p0 = positions[baseVertex + indices[i]];
+            glm::vec3 p1 = positions[baseVertex + indices[i + 1]];
+            glm::vec3 p2 = positions[baseVertex + indices[i + 2]];
+
+            glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+            float     length = glm::length(normal);
+
+            if (length > 0.0f)
+            {
+                minDot = glm::min(minDot, glm::dot(normal / length, axis));
+            }
+        }
+
+        // The cone is wider than ~85 degrees, it would hardly ever cull the meshlet
+        if (minDot <= 0.1f)
+        {
+            return;
+        }
+
+        meshlet.coneAxis   = axis;
+        meshlet.coneCutoff = glm::sqrt(1.0f - minDot * minDot);
+    }
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace mango
+{
+    // Cluster of the triangles of a submesh, its triangles are a contiguous range of the index buffer
+    struct Meshlet
+    {
+        glm::vec3 center       = glm::vec3(0.0f); // object space bounding sphere
+        float     radius       = 0.0f;
+        glm::vec3 coneAxis     = glm::vec3(0.0f); // normal cone, the cluster is back-facing for the viewers inside of the cone
+        float     coneCutoff   = 1.0f;            // sine of the cone half angle, 1 if the cone is too wide to cull anything
+        uint32_t  firstIndex   = 0;               // offset into the index buffer
+        uint32_t  indicesCount = 0;
+    };
+
+    // Layout of the GL_DRAW_INDIRECT_BUFFER commands of glMultiDrawElementsIndirect
+    struct DrawElementsIndirectCommand
+    {
+        uint32_t count         = 0;
+        uint32_t instanceCount = 0;
+        uint32_t firstIndex    = 0;
+        int32_t  baseVertex    = 0;
+        uint32_t baseInstance  = 0;
+    };
+
+    /*
+     * CPU only (no GL calls) partitioning of the submeshes into meshlets and their culling.
+     * The partitioning is a greedy scan of the index buffer, like meshopt_buildMeshletsScan: it expects the triangles
+     * to be in the vertex cache friendly order (aiProcess_ImproveCacheLocality), so the consecutive triangles are close to each other.
+     */
+    class Meshlets
+    {
+    public:
+        static const uint32_t MAX_VERTICES  = 64;
+        static const uint32_t MAX_TRIANGLES = 124;
+
+        // Viewer of the cone test: the rays of a perspective camera start at its position, the ones of an orthographic camera are parallel
+        struct Viewer
+        {
+            glm::vec3 position       = glm::vec3(0.0f);
+            glm::vec3 direction      = glm::vec3(0.0f, 0.0f, -1.0f); // world space
+            bool      isOrthographic = false;
+        };
+
+        Meshlets() = delete;
+
+        // Appends the meshlets of the triangle list indices[firstIndex, firstIndex + indicesCount), the indices are relative to baseVertex
+        static void build(const std::vector<glm::vec3> & positions,
+                          const std::vector<uint32_t>  & indices,
+                          uint32_t                       firstIndex,
+                          uint32_t                       indicesCount,
+                          uint32_t                       baseVertex,
+                          std::vector<Meshlet>         & meshlets);
+
+        /* Appends the draw commands of the meshlets that are inside of the frustum and aren't back-facing.
+           Consecutive surviving meshlets are merged into one command. Frustum planes are in world space and normalized.
+           The cones of the mirrored models are flipped, like the winding of their triangles. Returns the number of the culled meshlets. */
+        static uint32_t cull(const Meshlet                            * meshlets,
+                             uint32_t                                   meshletsCount,
+                             const glm::mat4                          & model,
+                             const glm::vec4                            frustumPlanes[6],
+                             const Viewer                             & viewer,
+                             int32_t                                    baseVertex,
+                             std::vector<DrawElementsIndirectCommand> & commands);
+
+        // Builds and culls the test quads on the CPU, false if any of them ends up on the wrong side. MangoCooker --self-test runs it
+        static bool selfTest();
+
+    private:
+        static void computeBounds(const std::vector<glm::vec3> & positions,
+                                  const std::vector<uint32_t>  & indices,
+                                  uint32_t                       baseVertex,
+                                  Meshlet                      & meshlet);
+    };
+}
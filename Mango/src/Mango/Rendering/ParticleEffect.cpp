@@ -141,6 +141,9 @@ namespace mango
         //m_shader->setUniformMatrix4fv("viewProj", cam->getViewProjection());
         m_shader->setUniform("color", color);
 
+        MG_RENDER_STATS_INC(vaoBinds);
+        MG_RENDER_STATS_DRAW(GL_POINTS, m_maxParticles, 0);
+
         glBindVertexArray(m_vao);
         glDrawArrays(GL_POINTS, 0, m_maxParticles);
     }
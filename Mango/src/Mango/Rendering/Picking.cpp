@@ -18,13 +18,14 @@ namespace mango
         glCreateBuffers(1, &m_ssbo);
         PickingData initialValues = { -1, 1.0f };
         glNamedBufferData(m_ssbo, sizeof(initialValues), &initialValues, GL_DYNAMIC_COPY);
+        MG_RENDER_STATS_ADD(bytesUploaded, sizeof(initialValues));
         glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, m_ssbo);
 
         m_pickingShader = AssetManager::createShader("PickingShader", "Picking.vert", "Picking.frag");
-        m_pickingShader->link();
+        m_pickingShader->requestLink();
 
         m_pickingBillboardShader = AssetManager::createShader("PickingBillboardSprite", "PickingBillboardSprite.vert", "PickingBillboardSprite.frag", "PickingBillboardSprite.geom");
-        m_pickingBillboardShader->link();
+        m_pickingBillboardShader->requestLink();
     }
 
     void Picking::clear()
@@ -24,7 +24,7 @@ namespace mango
         MG_PROFILE_ZONE_SCOPED;
 
         m_postprocess = AssetManager::createShader(filterName, "FSQ.vert", fragmentShaderFilename);
-        m_postprocess->link();
+        m_postprocess->requestLink();
     }
 
     void PostprocessEffect::bind() const
@@ -39,6 +39,9 @@ namespace mango
         MG_PROFILE_ZONE_SCOPED;
         MG_PROFILE_GL_ZONE("PostprocessEffect::render");
 
+        MG_RENDER_STATS_INC(vaoBinds);
+        MG_RENDER_STATS_DRAW(GL_TRIANGLES, 3, 0);
+
         glBindVertexArray(m_dummyVao);
         glDrawArrays(GL_TRIANGLES, 0, 3);
     }
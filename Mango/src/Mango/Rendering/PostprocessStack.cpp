@@ -0,0 +1,339 @@
+#include "mgpch.h"
+
+#include "PostprocessStack.h"
+#include "Mango/Core/Services.h"
+#include "Mango/Profiling/GPUProfiler.h"
+#include "Mango/Rendering/Debug/DebugMarkersGL.h"
+#include "Mango/Systems/RenderingSystem.h"
+
+#include <yaml-cpp/yaml.h>
+
+namespace mango
+{
+    namespace
+    {
+        std::string readShaderSnippet(const std::string & filename)
+        {
+            auto data = VFI::readFile(filename);
+            return std::string(data.begin(), data.end()) + "\n";
+        }
+
+        template<typename T>
+        T readOr(const YAML::Node & node, const char * key, const T & defaultValue)
+        {
+            return node[key] ? node[key].as<T>() : defaultValue;
+        }
+
+        ToneMappingOperator stringToToneMappingOperator(const std::string & s)
+        {
+            if (s == "Exponential") return ToneMappingOperator::EXPONENTIAL;
+            if (s == "Reinhard")    return ToneMappingOperator::REINHARD;
+            if (s == "ACES")        return ToneMappingOperator::ACES;
+
+            MG_CORE_WARN("Unknown tone mapping operator '{}', using Exponential.", s);
+            return ToneMappingOperator::EXPONENTIAL;
+        }
+    }
+
+    void PostprocessStack::create(const std::string & settingsFilename)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        m_fxaaPass = createRef<PostprocessEffect>();
+        m_fxaaPass->init("FXAA_PS", "FXAA_PS.frag");
+
+        if (!load(settingsFilename))
+        {
+            MG_CORE_WARN("Using default postprocess settings.");
+        }
+
+        rebuildUberShader();
+    }
+
+    bool PostprocessStack::load(const std::string & settingsFilename)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        if (!VFI::exists(settingsFilename))
+        {
+            MG_CORE_ERROR("Postprocess settings file '{}' does not exist.", settingsFilename);
+            return false;
+        }
+
+        auto fileData = VFI::readFile(settingsFilename);
+
+        YAML::Node data;
+        try
+        {
+            data = YAML::Load(std::string(fileData.begin(), fileData.end()));
+        }
+        catch (const YAML::ParserException & e)
+        {
+            MG_CORE_ERROR("Failed to load postprocess settings file '{}'\n    {}", settingsFilename, e.what());
+            return false;
+        }
+
+        // PostprocessStack is a mandatory node
+        auto stackNode = data["PostprocessStack"];
+        if (!stackNode)
+            return false;
+
+        PostprocessSettings settings;
+        settings.gamma = readOr(stackNode, "Gamma", settings.gamma);
+
+        if (auto bloom = stackNode["Bloom"])
+        {
+            settings.bloom.enabled        = readOr(bloom, "Enabled",        settings.bloom.enabled);
+            settings.bloom.threshold      = readOr(bloom, "Threshold",      settings.bloom.threshold);
+            settings.bloom.blurIterations = readOr(bloom, "BlurIterations", settings.bloom.blurIterations);
+            settings.bloom.intensity      = readOr(bloom, "Intensity",      settings.bloom.intensity);
+        }
+
+        if (auto exposure = stackNode["Exposure"])
+        {
+            settings.exposure.enabled  = readOr(exposure, "Enabled",  settings.exposure.enabled);
+            settings.exposure.exposure = readOr(exposure, "Exposure", settings.exposure.exposure);
+        }
+
+        if (auto toneMapping = stackNode["ToneMapping"])
+        {
+            settings.toneMapping.enabled   = readOr(toneMapping, "Enabled", settings.toneMapping.enabled);
+            settings.toneMapping.operation = stringToToneMappingOperator(readOr<std::string>(toneMapping, "Operator", "Exponential"));
+        }
+
+        if (auto colorGrading = stackNode["ColorGrading"])
+        {
+            settings.colorGrading.enabled    = readOr(colorGrading, "Enabled",    settings.colorGrading.enabled);
+            settings.colorGrading.contrast   = readOr(colorGrading, "Contrast",   settings.colorGrading.contrast);
+            settings.colorGrading.saturation = readOr(colorGrading, "Saturation", settings.colorGrading.saturation);
+
+            auto colorFilter = colorGrading["ColorFilter"];
+            if (colorFilter && colorFilter.IsSequence() && colorFilter.size() == 3)
+            {
+                settings.colorGrading.colorFilter = glm::vec3(colorFilter[0].as<float>(),
+                                                              colorFilter[1].as<float>(),
+                                                              colorFilter[2].as<float>());
+            }
+        }
+
+        if (auto fxaa = stackNode["FXAA"])
+        {
+            settings.fxaa.enabled = readOr(fxaa, "Enabled", settings.fxaa.enabled);
+        }
+
+        // create() builds the fused shader itself
+        if (m_postprocess)
+        {
+            setSettings(settings);
+        }
+        else
+        {
+            m_settings = settings;
+        }
+
+        return true;
+    }
+
+    void PostprocessStack::setSettings(const PostprocessSettings & settings)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        bool rebuild = needsRebuild(m_settings, settings);
+        m_settings   = settings;
+
+        if (rebuild)
+        {
+            rebuildUberShader();
+        }
+        else
+        {
+            updateUniforms();
+        }
+    }
+
+    void PostprocessStack::apply(const ref<RenderTarget> & src,
+                                 const ref<RenderTarget> & helper,
+                                 const ref<RenderTarget> & dst,
+                                 const glm::uvec2        & backbufferSize,
+                                 const glm::vec4         & viewport)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+        MG_PROFILE_GL_ZONE("PostprocessStack::apply");
+        MG_BEGIN_GL_MARKER("Postprocess Stack");
+
+        const glm::vec4 fullViewport = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+
+        // Returns the pixel rect of the viewport in the bound target
+        auto bindTarget = [&backbufferSize](const ref<RenderTarget> & target, const glm::vec4 & targetViewport) -> glm::ivec4
+        {
+            glm::vec2 size;
+            if (target == nullptr)
+            {
+                glBindFramebuffer(GL_FRAMEBUFFER, 0);
+                size = glm::vec2(backbufferSize);
+            }
+            else
+            {
+                target->bind();
+                size = glm::vec2(target->getViewportSize());
+            }
+
+            glm::ivec4 rect = glm::ivec4(glm::round(targetViewport * glm::vec4(size, size)));
+            glViewport(rect.x, rect.y, rect.z, rect.w);
+
+            return rect;
+        };
+
+        // Every pass covers the whole viewport, so there is no need to clear it
+        glDisable(GL_DEPTH_TEST);
+        glDisable(GL_BLEND);
+
+        bool useFxaa    = m_settings.fxaa.enabled;
+        auto uberTarget = (useFxaa || dst == src) ? helper : dst;
+
+        // FXAA samples the whole intermediate target, so the viewport is applied by its pass
+        auto uberViewport = useFxaa ? fullViewport : viewport;
+
+        /* Fused pass: bloom composite + exposure + tone mapping + color grading + gamma */
+        glm::ivec4 uberRect;
+        {
+            MG_GPU_PASS(Services::renderer()->getGPUProfiler(), "Postprocess Uber Pass");
+
+            uberRect = bindTarget(uberTarget, uberViewport);
+            bind();
+            src->bindTexture(0);
+            render();
+        }
+
+        if (useFxaa)
+        {
+            MG_GPU_PASS(Services::renderer()->getGPUProfiler(), "FXAA");
+
+            bindTarget(dst, viewport);
+            m_fxaaPass->bind();
+            uberTarget->bindTexture(0);
+            m_fxaaPass->render();
+        }
+        else if (dst == src)
+        {
+            // Can't read and write the same texture, so copy the result back
+            glCopyImageSubData(helper->getTexture(0)->getRendererID(), GL_TEXTURE_2D, 0, uberRect.x, uberRect.y, 0,
+                               dst   ->getTexture(0)->getRendererID(), GL_TEXTURE_2D, 0, uberRect.x, uberRect.y, 0,
+                               uberRect.z, uberRect.w, 1);
+        }
+
+        glEnable(GL_BLEND);
+        glEnable(GL_DEPTH_TEST);
+
+        MG_END_GL_MARKER;
+    }
+
+    void PostprocessStack::rebuildUberShader()
+    {
+        MG_PROFILE_ZONE_SCOPED;
+        MG_PROFILE_GL_ZONE("PostprocessStack::rebuildUberShader");
+
+        auto shader = createRef<Shader>();
+        shader->addShaderSource("FSQ.vert",                     readShaderSnippet("FSQ.vert"), Shader::Type::VERTEX);
+        shader->addShaderSource("Postprocess-Uber (generated)", generateUberShaderSource(),    Shader::Type::FRAGMENT);
+
+        if (!shader->link())
+        {
+            MG_CORE_ERROR("Failed to build the fused postprocess shader, keeping the previous one.");
+            return;
+        }
+
+        m_postprocess = shader;
+        updateUniforms();
+    }
+
+    void PostprocessStack::updateUniforms()
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        if (!m_postprocess) return;
+
+        m_postprocess->setUniform("gamma", m_settings.gamma);
+
+        if (m_settings.bloom.enabled)
+        {
+            m_postprocess->setUniform("bloom_intensity", m_settings.bloom.intensity);
+        }
+
+        if (m_settings.exposure.enabled)
+        {
+            m_postprocess->setUniform("exposure", m_settings.exposure.exposure);
+        }
+
+        if (m_settings.colorGrading.enabled)
+        {
+            m_postprocess->setUniform("contrast",     m_settings.colorGrading.contrast);
+            m_postprocess->setUniform("saturation",   m_settings.colorGrading.saturation);
+            m_postprocess->setUniform("color_filter", m_settings.colorGrading.colorFilter);
+        }
+    }
+
+    std::string PostprocessStack::generateUberShaderSource() const
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        std::string source = "#version 450\n";
+
+        if (m_settings.toneMapping.enabled)
+        {
+            switch (m_settings.toneMapping.operation)
+            {
+                case ToneMappingOperator::EXPONENTIAL: source += "#define TONE_MAPPING_EXPONENTIAL\n"; break;
+                case ToneMappingOperator::REINHARD:    source += "#define TONE_MAPPING_REINHARD\n";    break;
+                case ToneMappingOperator::ACES:        source += "#define TONE_MAPPING_ACES\n";        break;
+            }
+        }
+
+        source += "in vec2 texcoord;\n"
+                  "out vec4 fragColor;\n"
+                  "layout(binding = 0) uniform sampler2D filterTexture;\n"
+                  "uniform vec2  uv_scale = vec2(1.0f);\n"
+                  "uniform float gamma;\n";
+
+        // Don't let the bilinear filter pick up texels outside the scaled viewport
+        std::string body = "    vec2 uv    = min(texcoord, uv_scale - 0.5f / vec2(textureSize(filterTexture, 0)));\n"
+                           "    vec3 color = texture(filterTexture, uv).rgb;\n";
+
+        if (m_settings.bloom.enabled)
+        {
+            source += readShaderSnippet("Postprocess/BloomComposite.glh");
+            body   += "    color = bloomComposite(color);\n";
+        }
+
+        if (m_settings.exposure.enabled)
+        {
+            source += readShaderSnippet("Postprocess/Exposure.glh");
+            body   += "    color = applyExposure(color);\n";
+        }
+
+        if (m_settings.toneMapping.enabled)
+        {
+            source += readShaderSnippet("Postprocess/ToneMapping.glh");
+            body   += "    color = toneMapping(color);\n";
+        }
+
+        if (m_settings.colorGrading.enabled)
+        {
+            source += readShaderSnippet("Postprocess/ColorGrading.glh");
+            body   += "    color = colorGrading(color);\n";
+        }
+
+        body += "    fragColor = vec4(pow(color, vec3(1.0f / gamma)), 1.0f);\n";
+
+        return source + "void main()\n{\n" + body + "}\n";
+    }
+
+    bool PostprocessStack::needsRebuild(const PostprocessSettings & lhs, const PostprocessSettings & rhs)
+    {
+        return lhs.bloom.enabled         != rhs.bloom.enabled        ||
+               lhs.exposure.enabled      != rhs.exposure.enabled     ||
+               lhs.toneMapping.enabled   != rhs.toneMapping.enabled  ||
+               lhs.toneMapping.operation != rhs.toneMapping.operation ||
+               lhs.colorGrading.enabled  != rhs.colorGrading.enabled;
+    }
+}
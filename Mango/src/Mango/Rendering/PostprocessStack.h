@@ -0,0 +1,87 @@
+#pragma once
+#include "PostprocessEffect.h"
+#include "RenderTarget.h"
+
+namespace mango
+{
+    enum class ToneMappingOperator { EXPONENTIAL, REINHARD, ACES };
+
+    struct PostprocessSettings
+    {
+        struct Bloom
+        {
+            bool     enabled        = false;
+            float    threshold      = 1.0f;
+            uint32_t blurIterations = 2;
+            float    intensity      = 1.0f;
+        } bloom;
+
+        struct Exposure
+        {
+            bool  enabled  = true;
+            float exposure = 1.0f;
+        } exposure;
+
+        struct ToneMapping
+        {
+            bool                enabled   = true;
+            ToneMappingOperator operation = ToneMappingOperator::EXPONENTIAL;
+        } toneMapping;
+
+        struct ColorGrading
+        {
+            bool      enabled     = false;
+            float     contrast    = 1.0f;
+            float     saturation  = 1.0f;
+            glm::vec3 colorFilter = glm::vec3(1.0f);
+        } colorGrading;
+
+        struct FXAA
+        {
+            bool enabled = true;
+        } fxaa;
+
+        float gamma = 2.4f;
+    };
+
+    /*
+     * Fuses all per-pixel postprocess effects (bloom composite, exposure, tone mapping, color grading)
+     * into one generated shader. FXAA samples the neighbourhood of the tone mapped image, so it is
+     * the only effect that runs as a separate, dependent pass.
+     */
+    class PostprocessStack : public PostprocessEffect
+    {
+    public:
+        PostprocessStack() = default;
+
+        void create(const std::string & settingsFilename = "postprocess/Default.yaml");
+
+        // Loads the stack description from a YAML file, returns false if the file is invalid
+        bool load(const std::string & settingsFilename);
+
+        // Rebuilds the fused shader only if the set of enabled effects has changed
+        void setSettings(const PostprocessSettings & settings);
+        const PostprocessSettings & getSettings() const { return m_settings; }
+
+        /* Bloom's blurred texture is expected to be bound to texture unit 1.
+           dst == nullptr means the default framebuffer of the given size.
+           If dst == src, helper is used as the intermediate target.
+           The result is written to the viewport (normalized x, y, width, height) of dst, the rest of dst is left intact. */
+        void apply(const ref<RenderTarget> & src,
+                   const ref<RenderTarget> & helper,
+                   const ref<RenderTarget> & dst,
+                   const glm::uvec2        & backbufferSize,
+                   const glm::vec4         & viewport = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f));
+
+    private:
+        void        rebuildUberShader();
+        void        updateUniforms();
+        std::string generateUberShaderSource() const;
+
+        static bool needsRebuild(const PostprocessSettings & lhs, const PostprocessSettings & rhs);
+
+    private:
+        PostprocessSettings    m_settings;
+        ref<PostprocessEffect> m_fxaaPass;
+    };
+}
@@ -0,0 +1,306 @@
+#include "mgpch.h"
+
+#include "ReflectionProbes.h"
+#include "Mango/Core/AssetManager.h"
+#include "Mango/Rendering/Shader.h"
+#include "Mango/Scene/Components.h"
+#include "Mango/Scene/Scene.h"
+
+namespace mango
+{
+    namespace
+    {
+        // Look directions and up vectors of the GL_TEXTURE_CUBE_MAP_POSITIVE_X + i faces
+        const glm::vec3 FACE_TARGETS[6] = { {  1.0f,  0.0f,  0.0f }, { -1.0f,  0.0f,  0.0f },
+                                            {  0.0f,  1.0f,  0.0f }, {  0.0f, -1.0f,  0.0f },
+                                            {  0.0f,  0.0f,  1.0f }, {  0.0f,  0.0f, -1.0f } };
+
+        const glm::vec3 FACE_UPS[6]     = { {  0.0f, -1.0f,  0.0f }, {  0.0f, -1.0f,  0.0f },
+                                            {  0.0f,  0.0f,  1.0f }, {  0.0f,  0.0f, -1.0f },
+                                            {  0.0f, -1.0f,  0.0f }, {  0.0f, -1.0f,  0.0f } };
+    }
+
+    ReflectionProbes::~ReflectionProbes()
+    {
+        clear();
+
+        if (m_prefilterFbo) glDeleteFramebuffers (1, &m_prefilterFbo);
+        if (m_dummyVao)     glDeleteVertexArrays(1, &m_dummyVao);
+    }
+
+    void ReflectionProbes::init()
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        m_prefilterShader = AssetManager::createShader("ReflectionProbe-Prefilter", "FSQ.vert", "ReflectionProbe-Prefilter.frag");
+        m_prefilterShader->requestLink();
+
+        glCreateFramebuffers(1, &m_prefilterFbo);
+        glCreateVertexArrays(1, &m_dummyVao);
+    }
+
+    void ReflectionProbes::update(Scene * scene, const glm::vec3 & cameraPosition, const RenderFaceFunc & renderFace)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+        MG_PROFILE_GL_ZONE("ReflectionProbes::update");
+
+        ++m_frameIndex;
+
+        /* Sync the probes with the scene */
+        auto view = scene->getEntitiesWithComponent<TransformComponent, ReflectionProbeComponent>();
+        for (auto e : view)
+        {
+            auto [tc, rpc] = view.get<TransformComponent, ReflectionProbeComponent>(e);
+
+            GLuint resolution = GLuint(glm::clamp(rpc.resolution, 16, 1024));
+
+            auto & probe = m_probes[e];
+            if (probe.resolution != resolution)
+            {
+                destroyProbe(probe);
+                createProbe (probe, resolution);
+            }
+
+            // Moving the probe doesn't invalidate the captured faces, they are just refreshed in the usual order
+            probe.position      = tc.getPosition();
+            probe.radius        = glm::max(rpc.radius, 0.0f);
+            probe.nearPlane     = glm::max(rpc.nearPlane, 0.001f);
+            probe.farPlane      = glm::max(rpc.farPlane, probe.nearPlane + 0.001f);
+            probe.lastSeenFrame = m_frameIndex;
+        }
+
+        for (auto it = m_probes.begin(); it != m_probes.end();)
+        {
+            if (it->second.lastSeenFrame != m_frameIndex)
+            {
+                destroyProbe(it->second);
+                it = m_probes.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+
+        if (m_probes.empty() || !*CVarSystem::get()->getIntCVar("renderer.reflectionProbes"))
+        {
+            return;
+        }
+
+        /* Render the budget of faces, each one goes to the probe with the highest priority at the moment */
+        GLint viewport[4];
+        glGetIntegerv(GL_VIEWPORT, viewport);
+
+        // The faces and the prefiltering set their own states, the passes of the views expect the previous ones
+        GLboolean isBlendEnabled     = glIsEnabled(GL_BLEND);
+        GLboolean isDepthTestEnabled = glIsEnabled(GL_DEPTH_TEST);
+        GLboolean depthMask          = GL_TRUE;
+        glGetBooleanv(GL_DEPTH_WRITEMASK, &depthMask);
+
+        int facesBudget = glm::max(*CVarSystem::get()->getIntCVar("renderer.probeFacesPerFrame"), 1);
+        for (int i = 0; i < facesBudget; ++i)
+        {
+            Probe * bestProbe    = nullptr;
+            float   bestPriority = -1.0f;
+
+            for (auto & [entity, probe] : m_probes)
+            {
+                float priority = getPriority(probe, cameraPosition);
+                if (priority > bestPriority)
+                {
+                    bestPriority = priority;
+                    bestProbe    = &probe;
+                }
+            }
+
+            captureFace(*bestProbe, renderFace);
+        }
+
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+
+        isBlendEnabled     ? glEnable(GL_BLEND)      : glDisable(GL_BLEND);
+        isDepthTestEnabled ? glEnable(GL_DEPTH_TEST) : glDisable(GL_DEPTH_TEST);
+        glDepthMask(depthMask);
+    }
+
+    bool ReflectionProbes::bindNearestProbe(const glm::vec3 & position, GLuint unit) const
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        const Probe * nearestProbe    = nullptr;
+        float         nearestDistance = std::numeric_limits<float>::max();
+
+        for (auto & [entity, probe] : m_probes)
+        {
+            if (probe.renderedFacesCount < 6) continue;
+
+            float distance = glm::distance(position, probe.position);
+            if (distance <= probe.radius && distance < nearestDistance)
+            {
+                nearestDistance = distance;
+                nearestProbe    = &probe;
+            }
+        }
+
+        if (!nearestProbe)
+        {
+            return false;
+        }
+
+        glBindTextureUnit(unit, nearestProbe->cubemap);
+        MG_RENDER_STATS_INC(textureBinds);
+
+        return true;
+    }
+
+    void ReflectionProbes::clear()
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        for (auto & [entity, probe] : m_probes)
+        {
+            destroyProbe(probe);
+        }
+
+        m_probes.clear();
+    }
+
+    void ReflectionProbes::createProbe(Probe & probe, GLuint resolution)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+        MG_PROFILE_GL_ZONE("ReflectionProbes::createProbe");
+
+        GLsizei mipLevels = GLsizei(glm::floor(glm::log2(float(resolution)))) + 1;
+
+        glCreateTextures(GL_TEXTURE_CUBE_MAP, 1, &probe.cubemap);
+        glCreateTextures(GL_TEXTURE_CUBE_MAP, 1, &probe.captureCubemap);
+
+        for (auto cubemap : { probe.cubemap, probe.captureCubemap })
+        {
+            glTextureStorage2D(cubemap, mipLevels, GL_RGBA16F, resolution, resolution);
+            glTextureParameteri(cubemap, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+            glTextureParameteri(cubemap, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTextureParameteri(cubemap, GL_TEXTURE_WRAP_S,     GL_CLAMP_TO_EDGE);
+            glTextureParameteri(cubemap, GL_TEXTURE_WRAP_T,     GL_CLAMP_TO_EDGE);
+            glTextureParameteri(cubemap, GL_TEXTURE_WRAP_R,     GL_CLAMP_TO_EDGE);
+        }
+
+        glCreateRenderbuffers(1, &probe.depthBuffer);
+        glNamedRenderbufferStorage(probe.depthBuffer, GL_DEPTH_COMPONENT24, resolution, resolution);
+
+        glCreateFramebuffers(1, &probe.fbo);
+        glNamedFramebufferRenderbuffer(probe.fbo, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, probe.depthBuffer);
+        glNamedFramebufferTextureLayer(probe.fbo, GL_COLOR_ATTACHMENT0, probe.captureCubemap, 0, 0);
+
+        if (glCheckNamedFramebufferStatus(probe.fbo, GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        {
+            MG_CORE_ERROR("Reflection probe framebuffer is not complete.");
+        }
+
+        probe.resolution         = resolution;
+        probe.mipLevels          = GLuint(mipLevels);
+        probe.nextFace           = 0;
+        probe.renderedFacesCount = 0;
+    }
+
+    void ReflectionProbes::destroyProbe(Probe & probe)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        if (probe.fbo)            glDeleteFramebuffers (1, &probe.fbo);
+        if (probe.depthBuffer)    glDeleteRenderbuffers(1, &probe.depthBuffer);
+        if (probe.cubemap)        glDeleteTextures     (1, &probe.cubemap);
+        if (probe.captureCubemap) glDeleteTextures     (1, &probe.captureCubemap);
+
+        probe.fbo            = 0;
+        probe.depthBuffer    = 0;
+        probe.cubemap        = 0;
+        probe.captureCubemap = 0;
+        probe.resolution     = 0;
+        probe.mipLevels      = 0;
+    }
+
+    void ReflectionProbes::captureFace(Probe & probe, const RenderFaceFunc & renderFace)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+        MG_PROFILE_GL_ZONE("ReflectionProbes::captureFace");
+
+        uint32_t face = probe.nextFace;
+
+        glNamedFramebufferTextureLayer(probe.fbo, GL_COLOR_ATTACHMENT0, probe.captureCubemap, 0, face);
+        glBindFramebuffer(GL_FRAMEBUFFER, probe.fbo);
+        glViewport(0, 0, probe.resolution, probe.resolution);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        m_faceCamera.setPerspective(glm::radians(90.0f), 1.0f, probe.nearPlane, probe.farPlane);
+        m_faceCamera.setView(glm::lookAt(probe.position, probe.position + FACE_TARGETS[face], FACE_UPS[face]));
+
+        renderFace(m_faceCamera, probe.position);
+
+        // The box filtered mips are only the source of the prefiltering, the sharp mip is copied as it is
+        glGenerateTextureMipmap(probe.captureCubemap);
+        glCopyImageSubData(probe.captureCubemap, GL_TEXTURE_CUBE_MAP, 0, 0, 0, GLint(face),
+                           probe.cubemap,        GL_TEXTURE_CUBE_MAP, 0, 0, 0, GLint(face),
+                           GLsizei(probe.resolution), GLsizei(probe.resolution), 1);
+
+        // The lobes of the rough mips reach into the neighbouring faces, so all of the faces are filtered again
+        prefilter(probe);
+
+        probe.faceUpdateFrame[face] = m_frameIndex;
+        probe.renderedFacesCount    = glm::min(probe.renderedFacesCount + 1, 6u);
+        probe.nextFace              = (face + 1) % 6;
+    }
+
+    void ReflectionProbes::prefilter(const Probe & probe)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+        MG_PROFILE_GL_ZONE("ReflectionProbes::prefilter");
+
+        glDisable(GL_DEPTH_TEST);
+        glDepthMask(GL_FALSE);
+
+        m_prefilterShader->bind();
+        m_prefilterShader->setUniform("source_resolution", float(probe.resolution));
+
+        glBindTextureUnit(0, probe.captureCubemap);
+        MG_RENDER_STATS_INC(textureBinds);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, m_prefilterFbo);
+        glBindVertexArray(m_dummyVao);
+        MG_RENDER_STATS_INC(vaoBinds);
+
+        for (GLuint level = 1; level < probe.mipLevels; ++level)
+        {
+            GLuint size = glm::max(probe.resolution >> level, 1u);
+            glViewport(0, 0, size, size);
+
+            m_prefilterShader->setUniform("roughness", float(level) / float(probe.mipLevels - 1));
+
+            for (int face = 0; face < 6; ++face)
+            {
+                glNamedFramebufferTextureLayer(m_prefilterFbo, GL_COLOR_ATTACHMENT0, probe.cubemap, GLint(level), face);
+                m_prefilterShader->setUniform("face", face);
+
+                MG_RENDER_STATS_DRAW(GL_TRIANGLES, 3, 0);
+                glDrawArrays(GL_TRIANGLES, 0, 3);
+            }
+        }
+
+        glBindVertexArray(0);
+    }
+
+    float ReflectionProbes::getPriority(const Probe & probe, const glm::vec3 & cameraPosition) const
+    {
+        // Finish the probes that can't be sampled yet first
+        if (probe.renderedFacesCount < 6)
+        {
+            return std::numeric_limits<float>::max();
+        }
+
+        float staleness = float(m_frameIndex - probe.faceUpdateFrame[probe.nextFace]);
+        float distance  = glm::distance(cameraPosition, probe.position);
+
+        return staleness / (1.0f + distance / glm::max(probe.radius, 0.001f));
+    }
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include "glad/glad.h"
+#include "Mango/Core/Base.h"
+#include "Mango/Rendering/Camera/Camera.h"
+
+#include <entt.hpp>
+#include <functional>
+#include <unordered_map>
+
+namespace mango
+{
+    class Scene;
+    class Shader;
+
+    /*
+     * Dynamic environment probes (see ReflectionProbeComponent) for the RQ_ENVIRO_MAPPING_DYNAMIC queue.
+     * Capturing a whole cubemap every frame is too expensive, so the probes are time-sliced: only a budget of faces
+     * is rendered per frame (renderer.probeFacesPerFrame), picking the probes which are the most stale and the closest to the camera.
+     * The faces are captured into a separate cubemap, its box filtered mips are the source of the GGX prefiltering (split sum,
+     * filtered importance sampling) of the mips of the sampled cubemap after each face, the roughness grows linearly with the mip.
+     */
+    class ReflectionProbes
+    {
+    public:
+        // Renders the scene into the currently bound framebuffer using the given camera and its position
+        using RenderFaceFunc = std::function<void(Camera & camera, const glm::vec3 & cameraPosition)>;
+
+        ReflectionProbes() = default;
+        ~ReflectionProbes();
+
+        ReflectionProbes(const ReflectionProbes &)             = delete;
+        ReflectionProbes & operator=(const ReflectionProbes &) = delete;
+
+        void init();
+
+        // Syncs the probes with the scene entities and renders the faces scheduled for this frame
+        void update(Scene * scene, const glm::vec3 & cameraPosition, const RenderFaceFunc & renderFace);
+
+        // Binds the cubemap of the closest fully captured probe which contains the position. Returns false if there's none.
+        bool bindNearestProbe(const glm::vec3 & position, GLuint unit = 0) const;
+
+        void clear();
+
+        uint32_t getProbesCount() const { return uint32_t(m_probes.size()); }
+
+    private:
+        struct Probe
+        {
+            GLuint cubemap        = 0; // prefiltered
+            GLuint captureCubemap = 0;
+            GLuint fbo            = 0;
+            GLuint depthBuffer    = 0;
+            GLuint resolution     = 0;
+            GLuint mipLevels      = 0;
+
+            glm::vec3 position  = glm::vec3(0.0f);
+            float     radius    = 0.0f;
+            float     nearPlane = 0.1f;
+            float     farPlane  = 100.0f;
+
+            uint32_t nextFace            = 0;
+            uint32_t renderedFacesCount  = 0; // the probe can't be sampled until all of its faces were rendered once
+            uint64_t faceUpdateFrame[6]  = {};
+            uint64_t lastSeenFrame       = 0;
+        };
+
+        void createProbe (Probe & probe, GLuint resolution);
+        void destroyProbe(Probe & probe);
+
+        void  captureFace (Probe & probe, const RenderFaceFunc & renderFace);
+        void  prefilter   (const Probe & probe);
+        float getPriority (const Probe & probe, const glm::vec3 & cameraPosition) const;
+
+    private:
+        std::unordered_map<entt::entity, Probe> m_probes;
+
+        Camera   m_faceCamera;
+        uint64_t m_frameIndex = 0;
+
+        ref<Shader> m_prefilterShader;
+        GLuint      m_prefilterFbo = 0;
+        GLuint      m_dummyVao     = 0;
+    };
+}
@@ -262,8 +262,21 @@ namespace mango
         MG_PROFILE_ZONE_SCOPED;
         MG_PROFILE_GL_ZONE("RenderTarget::bind");
 
+        auto viewportSize = getViewportSize();
+
         glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
-        glViewport(0, 0, m_width, m_height);
+        glViewport(0, 0, viewportSize.x, viewportSize.y);
+    }
+
+    glm::uvec2 RenderTarget::getViewportSize() const
+    {
+        if (!m_dynamicScaling)
+        {
+            return { m_width, m_height };
+        }
+
+        return { glm::max(1u, GLuint(m_width  * s_renderScale)),
+                 glm::max(1u, GLuint(m_height * s_renderScale)) };
     }
 
     void RenderTarget::bindReadOnly() const
@@ -136,6 +136,14 @@ namespace mango
         unsigned getWidth()  const { return m_width;  }
         unsigned getHeight() const { return m_height; }
 
+        /* Render targets with dynamic scaling enabled are rendered to the (0, 0, scale * width, scale * height) sub-rect.
+           Changing the scale only changes the viewport, the textures are not reallocated. */
+        void       setDynamicScaling(bool enabled) { m_dynamicScaling = enabled; }
+        glm::uvec2 getViewportSize() const;
+
+        static void  setRenderScale(float scale) { s_renderScale = scale; }
+        static float getRenderScale()            { return s_renderScale; }
+
         ref<Texture> getTexture(GLuint renderTargetID) { return m_textures[renderTargetID]; }
 
     private:
@@ -147,6 +155,10 @@ namespace mango
         GLuint m_width, m_height;
         GLenum m_type;
 
+        bool m_dynamicScaling = false;
+
+        inline static float s_renderScale = 1.0f;
+
     private:
         friend class RenderingSystem;
     };
@@ -29,6 +29,7 @@ namespace mango
         MG_PROFILE_ZONE_SCOPED;
 
         PostprocessEffect::init(filterName, fragmentShaderFilename);
+        m_blurShader = m_postprocess->getVariant(Shader::getKeywordMask("SSAO_BLUR"));
 
         genKernel();
         genRandomRotationVectors(4, 4); // Generates 4x4 texture with random rotation vectors
@@ -40,9 +41,11 @@ namespace mango
 
         m_ssaoBuffer = createRef<RenderTarget>();
         m_ssaoBuffer->create(width, height, RenderTarget::ColorInternalFormat::R8, RenderTarget::DepthInternalFormat::NoDepth, RenderTarget::RenderTargetType::Tex2D, false);
+        m_ssaoBuffer->setDynamicScaling(true);
 
         m_blurredBuffer = createRef<RenderTarget>();
         m_blurredBuffer->create(width, height, RenderTarget::ColorInternalFormat::R8, RenderTarget::DepthInternalFormat::NoDepth, RenderTarget::RenderTargetType::Tex2D, false);
+        m_blurredBuffer->setDynamicScaling(true);
     }
 
     void SSAO::clear()
@@ -73,7 +76,6 @@ namespace mango
         MG_PROFILE_GL_ZONE("SSAO::computeSSAO");
 
         m_postprocess->bind();
-        m_postprocess->setSubroutine(Shader::Type::FRAGMENT, "calcSSAO");
 
         m_postprocess->setUniform("samples", m_kernel.size(), m_kernel.data());
         m_postprocess->setUniform("view", view);
@@ -89,6 +91,7 @@ namespace mango
         gbuffer->bindGBufferTexture(1, GLuint(DeferredRendering::GBufferPropertyName::POSITION));
         gbuffer->bindGBufferTexture(2, GLuint(DeferredRendering::GBufferPropertyName::NORMAL));
         glBindTextureUnit(3, m_noiseTextureID);
+        MG_RENDER_STATS_INC(textureBinds);
 
         render();
     }
@@ -98,8 +101,7 @@ namespace mango
         MG_PROFILE_ZONE_SCOPED;
         MG_PROFILE_GL_ZONE("SSAO::blurSSAO");
 
-        m_postprocess->bind();
-        m_postprocess->setSubroutine(Shader::Type::FRAGMENT, "blurSSAO");
+        m_blurShader->bind();
 
         m_blurredBuffer->bind();
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -108,6 +110,12 @@ namespace mango
         render();
     }
 
+    void SSAO::setUVScale(const glm::vec2 & uvScale)
+    {
+        m_postprocess->setUniform("uv_scale", uvScale);
+        m_blurShader ->setUniform("uv_scale", uvScale);
+    }
+
     void SSAO::cleanGLdata()
     {
         MG_PROFILE_ZONE_SCOPED;
@@ -187,6 +195,7 @@ namespace mango
                             GL_RGB,
                             GL_FLOAT,
                             noiseData.data());
+        MG_RENDER_STATS_ADD(bytesUploaded, noiseData.size() * sizeof(noiseData[0]));
 
         glTextureParameteri(m_noiseTextureID, GL_TEXTURE_WRAP_S, GL_REPEAT);
         glTextureParameteri(m_noiseTextureID, GL_TEXTURE_WRAP_T, GL_REPEAT);
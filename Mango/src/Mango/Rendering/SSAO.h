@@ -31,11 +31,16 @@ namespace mango
         void setBias      (float bias)          { m_bias       = bias;                    }
         void setPower     (float power)         { m_power      = power;                   }
 
+        // Of the SSAO and its blur, they're separate programs
+        void setUVScale(const glm::vec2 & uvScale);
+
     private:
         void cleanGLdata();
         void genKernel();
         void genRandomRotationVectors(unsigned noiseTexWidth, unsigned noiseTexHeight);
 
+        ref<Shader> m_blurShader;
+
         std::vector<glm::vec3> m_kernel;
 
         ref<RenderTarget> m_ssaoBuffer;
@@ -5,13 +5,66 @@
 
 #include "Shader.h"
 #include "ShaderGlobals.h"
+#include "ShaderPreprocessor.h"
 #include "Mango/Core/AssetManager.h"
 #include "Mango/Core/Services.h"
 #include "Mango/Scene/Components.h"
 #include "Mango/Systems/RenderingSystem.h"
+#include "Mango/Utils/Hash.h"
 
 namespace mango
 {
+    namespace
+    {
+        const uint32_t PROGRAM_BINARY_MAGIC   = 0x5053474D; // "MGSP"
+        const uint32_t PROGRAM_BINARY_VERSION = 1;
+
+        struct ProgramBinaryHeader
+        {
+            uint32_t magic        = PROGRAM_BINARY_MAGIC;
+            uint32_t version      = PROGRAM_BINARY_VERSION;
+            uint64_t sourcesHash  = 0;
+            GLenum   binaryFormat = 0;
+            uint32_t binarySize   = 0;
+        };
+
+        template<typename T>
+        void appendBytes(std::string & bytes, const T & value)
+        {
+            bytes.append(reinterpret_cast<const char*>(&value), sizeof(T));
+        }
+
+        // Names of the keywords, the index is the bit of the keyword in the masks
+        std::vector<std::string> & keywordsNames()
+        {
+            static std::vector<std::string> names;
+            return names;
+        }
+
+        // The binaries are kept in the write directory, empty if there isn't one or the driver can't save them
+        std::filesystem::path programBinaryPath(uint64_t sourcesHash)
+        {
+            static const bool isSupported = []
+            {
+                GLint formatsCount = 0;
+                glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatsCount);
+
+                return formatsCount > 0;
+            }();
+
+            auto writeDir = VFI::getWriteDir();
+            if (!isSupported || writeDir.empty())
+            {
+                return {};
+            }
+
+            char filename[32];
+            snprintf(filename, sizeof(filename), "%016llx.mgprogram", (unsigned long long)sourcesHash);
+
+            return writeDir / "shadercache" / filename;
+        }
+    }
+
     Shader::Shader()
         : m_programID(0),
           m_isLinked (false)
@@ -70,15 +123,15 @@ namespace mango
     {
         if (m_programID != 0)
         {
+            releaseStages();
             glDeleteProgram(m_programID);
             m_programID = 0;
         }
     }
 
-    void Shader::addShader(const std::string & filename, GLuint type) const
+    void Shader::addShader(const std::string & filename, GLuint type)
     {
         MG_PROFILE_ZONE_SCOPED;
-        MG_PROFILE_GL_ZONE("Shader::addShader");
 
         if (m_programID == 0)
         {
@@ -92,53 +145,459 @@ namespace mango
             return;
         }
 
-        GLuint shaderObject = glCreateShader(type);
+        Stage stage;
+        stage.name     = VFI::getFilepath(filename).string();
+        stage.filename = filename;
+        stage.type     = type;
 
-        MG_ASSERT_MSG(shaderObject != 0, "Error while creating GL Shader Object");
+        addStage(std::move(stage), ShaderPreprocessor::processFile(filename));
+    }
 
-        auto        filepath = VFI::getFilepath(filename);
-        std::string code     = loadFile(filepath);
-                    code     = loadShaderIncludes(code);
+    void Shader::addShaderSource(const std::string & sourceName, const std::string & source, Type type)
+    {
+        MG_PROFILE_ZONE_SCOPED;
 
-        std::string codeAscii = "";
-        for (auto& s : code)
+        if (m_programID == 0)
+        {
+            MG_CORE_WARN("Program Object is NULL for shader {}", sourceName);
+            return;
+        }
+
+        Stage stage;
+        stage.name   = sourceName;
+        stage.source = source;
+        stage.type   = GLenum(type);
+
+        addStage(std::move(stage), ShaderPreprocessor::processSource(sourceName, source));
+    }
+
+    void Shader::addStage(Stage stage, const ShaderPreprocessor::Result & preprocessed)
+    {
+        stage.files = preprocessed.files;
+
+        for (auto& s : preprocessed.code)
         {
             if ((int)s >= 0)
             {
-                codeAscii += s;
+                stage.code += s;
+            }
+        }
+
+        addKeywords(stage.code);
+
+        m_stages.push_back(std::move(stage));
+    }
+
+    bool Shader::dependsOn(const std::vector<std::string> & files) const
+    {
+        for (auto & stage : m_stages)
+        {
+            for (auto & file : stage.files)
+            {
+                if (std::find(files.begin(), files.end(), file) != files.end())
+                {
+                    return true;
+                }
             }
         }
-        const char* shaderCode            = codeAscii.c_str();
-              int   shaderCodeSizeBytes[] = { codeAscii.length() };
 
-        glShaderSource(shaderObject, 1, &shaderCode, shaderCodeSizeBytes);
-        glCompileShader(shaderObject);
+        return false;
+    }
+
+    bool Shader::reload()
+    {
+        MG_PROFILE_ZONE_SCOPED;
 
-        GLint result;
-        glGetShaderiv(shaderObject, GL_COMPILE_STATUS, &result);
+        /* Built aside, so the program keeps working if the changed files don't compile */
+        auto reloaded = createRef<Shader>();
+        reloaded->m_name = m_name;
 
-        if (result == GL_FALSE)
+        for (auto & stage : m_stages)
         {
-            MG_CORE_ERROR("Shader {} compilation failed!", filepath.string());
+            if (stage.filename.empty())
+            {
+                reloaded->addShaderSource(stage.name, stage.source, Type(stage.type));
+            }
+            else
+            {
+                reloaded->addShader(stage.filename, stage.type);
+            }
+        }
 
-            GLint logLen;
-            glGetShaderiv(shaderObject, GL_INFO_LOG_LENGTH, &logLen);
+        if (!reloaded->link())
+        {
+            MG_CORE_ERROR("Failed to reload shader program {}, keeping the previous one.", m_name);
+            return false;
+        }
 
-            if (logLen > 0)
+        adopt(*reloaded);
+
+        for (auto & [keywordsMask, variant] : m_variants)
+        {
+            auto reloadedVariant = createVariant(keywordsMask);
+            if (reloadedVariant->link())
             {
-                char * log = static_cast<char *>(malloc(logLen));
+                variant->adopt(*reloadedVariant);
+            }
+        }
 
-                GLsizei written;
-                glGetShaderInfoLog(shaderObject, logLen, &written, log);
+        return true;
+    }
 
-                MG_CORE_ERROR("Shader log: \n{}", log);
-                free(log);
+    void Shader::adopt(Shader & other)
+    {
+        std::swap(m_programID,    other.m_programID);
+        std::swap(m_isLinked,     other.m_isLinked);
+        std::swap(m_stages,       other.m_stages);
+        std::swap(m_keywordsMask, other.m_keywordsMask);
+        std::swap(m_sourcesHash,  other.m_sourcesHash);
+
+        std::swap(m_uniformsLocations,   other.m_uniformsLocations);
+        std::swap(m_uniformsNames,       other.m_uniformsNames);
+        std::swap(m_globalUniformsNames, other.m_globalUniformsNames);
+        std::swap(m_uniformsTypes,       other.m_uniformsTypes);
+        std::swap(m_globalUniformsTypes, other.m_globalUniformsTypes);
+    }
+
+    void Shader::addKeywords(std::string & code)
+    {
+        const std::string pragmaPhrase = "#pragma multi_compile";
+
+        size_t lineStart = 0;
+        while (lineStart < code.size())
+        {
+            size_t lineEnd = code.find('\n', lineStart);
+            if (lineEnd == std::string::npos)
+            {
+                lineEnd = code.size();
+            }
+
+            if (code.compare(lineStart, pragmaPhrase.size(), pragmaPhrase) == 0)
+            {
+                std::istringstream keywords(code.substr(lineStart + pragmaPhrase.size(), lineEnd - lineStart - pragmaPhrase.size()));
+
+                // "_" stands for none of the keywords of the group
+                std::string keyword;
+                while (keywords >> keyword)
+                {
+                    if (keyword != "_")
+                    {
+                        m_keywordsMask |= getKeywordMask(keyword);
+                    }
+                }
+
+                // Commented out, so the lines of the errors stay the same
+                code.replace(lineStart, 2, "//");
+            }
+
+            lineStart = lineEnd + 1;
+        }
+    }
+
+    uint64_t Shader::getKeywordMask(const std::string & keyword)
+    {
+        auto & keywords = keywordsNames();
+
+        for (uint32_t bit = 0; bit < keywords.size(); ++bit)
+        {
+            if (keywords[bit] == keyword)
+            {
+                return 1ull << bit;
+            }
+        }
+
+        if (keywords.size() == 64)
+        {
+            MG_CORE_ERROR("Can't add the shader keyword {}, all of the 64 keywords are used.", keyword);
+            return 0;
+        }
+
+        keywords.push_back(keyword);
+        return 1ull << (keywords.size() - 1);
+    }
+
+    uint64_t Shader::getKeywordsMask(const std::vector<std::string> & keywords)
+    {
+        uint64_t mask = 0;
+        for (auto & keyword : keywords)
+        {
+            mask |= getKeywordMask(keyword);
+        }
+
+        return mask;
+    }
+
+    std::vector<std::string> Shader::getKeywordsNames(uint64_t keywordsMask)
+    {
+        std::vector<std::string> names;
+
+        auto & keywords = keywordsNames();
+        for (uint32_t bit = 0; bit < keywords.size(); ++bit)
+        {
+            if (keywordsMask & (1ull << bit))
+            {
+                names.push_back(keywords[bit]);
+            }
+        }
+
+        return names;
+    }
+
+    ref<Shader> Shader::getVariant(uint64_t keywordsMask)
+    {
+        keywordsMask &= m_keywordsMask;
+
+        if (keywordsMask == 0)
+        {
+            return shared_from_this();
+        }
+
+        if (auto it = m_variants.find(keywordsMask); it != m_variants.end())
+        {
+            return it->second;
+        }
+
+        auto variant = createVariant(keywordsMask);
+        variant->requestLink();
+        m_variants[keywordsMask] = variant;
+
+        return variant;
+    }
+
+    ref<Shader> Shader::createVariant(uint64_t keywordsMask) const
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        auto variant = createRef<Shader>();
+        variant->m_keywordsMask        = m_keywordsMask;
+        variant->m_enabledKeywordsMask = keywordsMask;
+        variant->m_name                = m_name;
+
+        /* The defines of the keywords follow the #version line */
+        std::string defines;
+        std::string keywordsList;
+
+        auto & keywords = keywordsNames();
+        for (uint32_t bit = 0; bit < keywords.size(); ++bit)
+        {
+            if (keywordsMask & (1ull << bit))
+            {
+                defines      += "#define " + keywords[bit] + "\n";
+                keywordsList += (keywordsList.empty() ? "" : " ") + keywords[bit];
+            }
+        }
+
+        variant->m_name += " [" + keywordsList + "]";
+
+        for (auto & stage : m_stages)
+        {
+            Stage variantStage;
+            variantStage.name  = stage.name;
+            variantStage.files = stage.files;
+            variantStage.type  = stage.type;
+            variantStage.code  = stage.code;
+
+            size_t insertAt = 0;
+            size_t version  = variantStage.code.find("#version");
+
+            if (version != std::string::npos)
+            {
+                insertAt = variantStage.code.find('\n', version);
+                if (insertAt == std::string::npos)
+                {
+                    insertAt = variantStage.code.size();
+                    variantStage.code += '\n';
+                }
+                ++insertAt;
+            }
+
+            // The lines after the defines keep their numbers
+            auto nextLine = std::count(variantStage.code.begin(), variantStage.code.begin() + insertAt, '\n') + 1;
+            variantStage.code.insert(insertAt, defines + "#line " + std::to_string(nextLine) + " 0\n");
+
+            variant->m_stages.push_back(std::move(variantStage));
+        }
+
+        return variant;
+    }
+
+    void Shader::compileStages()
+    {
+        MG_PROFILE_ZONE_SCOPED;
+        MG_PROFILE_GL_ZONE("Shader::compileStages");
+
+        /* The statuses aren't queried here, the link fails if any of the stages doesn't compile */
+        for (auto & stage : m_stages)
+        {
+            stage.shaderObject = glCreateShader(stage.type);
+
+            MG_ASSERT_MSG(stage.shaderObject != 0, "Error while creating GL Shader Object");
+
+            const char* shaderCode            = stage.code.c_str();
+                  int   shaderCodeSizeBytes[] = { int(stage.code.length()) };
+
+            glShaderSource(stage.shaderObject, 1, &shaderCode, shaderCodeSizeBytes);
+            glCompileShader(stage.shaderObject);
+            glAttachShader(m_programID, stage.shaderObject);
+        }
+    }
+
+    void Shader::releaseStages()
+    {
+        for (auto & stage : m_stages)
+        {
+            if (stage.shaderObject != 0)
+            {
+                glDetachShader(m_programID, stage.shaderObject);
+                glDeleteShader(stage.shaderObject);
+                stage.shaderObject = 0;
+            }
+        }
+    }
+
+    void Shader::logStagesErrors() const
+    {
+        for (auto & stage : m_stages)
+        {
+            if (stage.shaderObject == 0)
+            {
+                continue;
             }
+
+            GLint result;
+            glGetShaderiv(stage.shaderObject, GL_COMPILE_STATUS, &result);
+
+            if (result == GL_FALSE)
+            {
+                MG_CORE_ERROR("Shader {} compilation failed!", stage.name);
+
+                // The source string numbers of the errors
+                if (stage.files.size() > 1)
+                {
+                    std::string sourceStrings;
+                    for (uint32_t i = 0; i < stage.files.size(); ++i)
+                    {
+                        sourceStrings += "\n  " + std::to_string(i) + ": " + stage.files[i];
+                    }
+
+                    MG_CORE_ERROR("Shader source strings: {}", sourceStrings);
+                }
+
+                GLint logLen;
+                glGetShaderiv(stage.shaderObject, GL_INFO_LOG_LENGTH, &logLen);
+
+                if (logLen > 0)
+                {
+                    char * log = static_cast<char *>(malloc(logLen));
+
+                    GLsizei written;
+                    glGetShaderInfoLog(stage.shaderObject, logLen, &written, log);
+
+                    MG_CORE_ERROR("Shader log: \n{}", log);
+                    free(log);
+                }
+            }
+        }
+    }
+
+    uint64_t Shader::computeSourcesHash() const
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        // The binaries are valid only for the driver that produced them
+        static const std::string driver = std::string((const char*)glGetString(GL_VENDOR))   + "|" +
+                                          std::string((const char*)glGetString(GL_RENDERER)) + "|" +
+                                          std::string((const char*)glGetString(GL_VERSION));
+
+        std::string hashedBytes = driver;
+        for (auto & stage : m_stages)
+        {
+            appendBytes(hashedBytes, stage.type);
+            hashedBytes += stage.code;
+        }
+
+        return fnvHash1a64(hashedBytes.data(), hashedBytes.size());
+    }
+
+    bool Shader::loadProgramBinary()
+    {
+        MG_PROFILE_ZONE_SCOPED;
+        MG_PROFILE_GL_ZONE("Shader::loadProgramBinary");
+
+        auto cachePath = programBinaryPath(m_sourcesHash);
+        if (cachePath.empty())
+        {
+            return false;
+        }
+
+        std::ifstream file(cachePath, std::ios::binary);
+        if (!file.is_open())
+        {
+            return false;
+        }
+
+        ProgramBinaryHeader header;
+        file.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+        if (!file                                           ||
+            header.magic       != PROGRAM_BINARY_MAGIC      ||
+            header.version     != PROGRAM_BINARY_VERSION    ||
+            header.sourcesHash != m_sourcesHash             ||
+            header.binarySize  == 0)
+        {
+            return false;
+        }
+
+        std::vector<char> binary(header.binarySize);
+        file.read(binary.data(), std::streamsize(binary.size()));
+
+        if (!file)
+        {
+            return false;
+        }
+
+        glProgramBinary(m_programID, header.binaryFormat, binary.data(), GLsizei(binary.size()));
+        return true;
+    }
+
+    void Shader::saveProgramBinary() const
+    {
+        MG_PROFILE_ZONE_SCOPED;
+        MG_PROFILE_GL_ZONE("Shader::saveProgramBinary");
+
+        auto cachePath = programBinaryPath(m_sourcesHash);
+        if (cachePath.empty())
+        {
             return;
         }
 
-        glAttachShader(m_programID, shaderObject);
-        glDeleteShader(shaderObject);
+        GLint binarySize = 0;
+        glGetProgramiv(m_programID, GL_PROGRAM_BINARY_LENGTH, &binarySize);
+
+        if (binarySize <= 0)
+        {
+            return;
+        }
+
+        ProgramBinaryHeader header;
+        header.sourcesHash = m_sourcesHash;
+
+        std::vector<char> binary(binarySize);
+        glGetProgramBinary(m_programID, binarySize, nullptr, &header.binaryFormat, binary.data());
+        header.binarySize = uint32_t(binarySize);
+
+        std::error_code error;
+        std::filesystem::create_directories(cachePath.parent_path(), error);
+
+        std::ofstream file(cachePath, std::ios::binary);
+        if (!file.is_open())
+        {
+            MG_CORE_WARN("Can't save the program binary {}.", cachePath.string());
+            return;
+        }
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(binary.data(), std::streamsize(binary.size()));
     }
 
     void Shader::addAllUniforms()
@@ -189,46 +648,53 @@ namespace mango
         }
     }
 
-    void Shader::addAllSubroutines()
+    void Shader::requestLink()
     {
         MG_PROFILE_ZONE_SCOPED;
-        MG_PROFILE_GL_ZONE("Shader::addAllSubroutines");
+        MG_PROFILE_GL_ZONE("Shader::requestLink");
 
-        GLenum interfaces[]   = { GL_VERTEX_SUBROUTINE, GL_FRAGMENT_SUBROUTINE };
-        GLenum shaderStages[] = { GL_VERTEX_SHADER, GL_FRAGMENT_SHADER };
+        if (m_isLinkRequested || m_programID == 0)
+        {
+            return;
+        }
 
-        GLint interfacesCount = sizeof(interfaces) / sizeof(interfaces[0]);
+        m_linkTimer.reset();
 
-        for(GLint i = 0; i < interfacesCount; ++i)
+        if (m_name.empty())
         {
-            /* Get all active subroutines */
-            GLenum programInterface = interfaces[i];
+            for (auto & stage : m_stages)
+            {
+                m_name += (m_name.empty() ? "" : " + ") + std::filesystem::path(stage.name).filename().string();
+            }
+        }
 
-            GLint numSubroutines = 0;
-            glGetProgramInterfaceiv(m_programID, programInterface, GL_ACTIVE_RESOURCES, &numSubroutines);
+        m_isLinkRequested = true;
+        m_isLinkPending   = true;
+        m_sourcesHash     = computeSourcesHash();
+        m_isFromBinary    = loadProgramBinary();
 
-            const GLenum properties[]   = { GL_NAME_LENGTH };
-            const GLint  propertiesSize = sizeof(properties) / sizeof(properties[0]);
+        if (!m_isFromBinary)
+        {
+            compileStages();
 
-            GLint count_subroutine_locations = 0;
-            glGetProgramStageiv(m_programID, shaderStages[i], GL_ACTIVE_SUBROUTINE_UNIFORM_LOCATIONS, &count_subroutine_locations);
-            m_activeSubroutineUniformLocations[shaderStages[i]] = count_subroutine_locations;
+            glProgramParameteri(m_programID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+            glLinkProgram(m_programID);
+        }
 
-            for (GLint j = 0; j < numSubroutines; ++j)
-            {
-                GLint values[propertiesSize];
-                GLint length = 0;
-                glGetProgramResourceiv(m_programID, programInterface, j, propertiesSize, properties, propertiesSize, &length, values);
+        m_requestTimeMs = m_linkTimer.elapsedMs();
+    }
 
-                std::vector<char> nameData(values[0]);
-                glGetProgramResourceName(m_programID, programInterface, j, nameData.size(), nullptr, &nameData[0]);
-                std::string subroutineName(nameData.begin(), nameData.end() - 1);
+    bool Shader::isLinkCompleted() const
+    {
+        if (!m_isLinkPending || !GLAD_GL_KHR_parallel_shader_compile)
+        {
+            return true;
+        }
 
-                GLuint subroutineIndex = glGetSubroutineIndex(m_programID, shaderStages[i], subroutineName.c_str());
+        GLint isCompleted = GL_FALSE;
+        glGetProgramiv(m_programID, GL_COMPLETION_STATUS_KHR, &isCompleted);
 
-                m_subroutineIndices[subroutineName] = subroutineIndex;
-            }
-        }
+        return isCompleted == GL_TRUE;
     }
 
     bool Shader::link()
@@ -236,14 +702,38 @@ namespace mango
         MG_PROFILE_ZONE_SCOPED;
         MG_PROFILE_GL_ZONE("Shader::link");
 
-        glLinkProgram(m_programID);
+        requestLink();
+
+        if (!m_isLinkPending)
+        {
+            return m_isLinked;
+        }
+
+        m_isLinkPending = false;
+
+        Timer waitTimer;
 
         GLint status;
         glGetProgramiv(m_programID, GL_LINK_STATUS, &status);
 
+        /* The driver rejects the binaries of the other driver versions, compile them again */
+        if (status == GL_FALSE && m_isFromBinary)
+        {
+            MG_CORE_WARN("The cached program binary of {} is out of date, compiling the shaders.", m_name);
+
+            m_isFromBinary = false;
+            compileStages();
+
+            glProgramParameteri(m_programID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+            glLinkProgram(m_programID);
+            glGetProgramiv(m_programID, GL_LINK_STATUS, &status);
+        }
+
         if (status == GL_FALSE)
         {
-            MG_CORE_ERROR("Failed to link shader program with ID {}!", m_programID);
+            logStagesErrors();
+
+            MG_CORE_ERROR("Failed to link shader program {} with ID {}!", m_name, m_programID);
 
             GLint logLen;
             glGetProgramiv(m_programID, GL_INFO_LOG_LENGTH, &logLen);
@@ -262,20 +752,36 @@ namespace mango
         {
             m_isLinked = true;
 
+            if (!m_isFromBinary)
+            {
+                saveProgramBinary();
+            }
+
             addAllUniforms();
-            addAllSubroutines();
         }
 
+        releaseStages();
+
+        MG_CORE_INFO("Shader program {} {} in {:.2f} ms (requested in {:.2f} ms, waited {:.2f} ms).",
+                     m_name,
+                     m_isFromBinary ? "loaded from the cached binary" : "compiled",
+                     m_linkTimer.elapsedMs(),
+                     m_requestTimeMs,
+                     waitTimer.elapsedMs());
+
         return m_isLinked;
     }
 
-    void Shader::bind() const
+    void Shader::bind()
     {
         MG_PROFILE_ZONE_SCOPED;
         MG_PROFILE_GL_ZONE("Shader::bind");
 
+        ensureLinked();
+
         if (m_programID != 0 && m_isLinked)
         {
+            MG_RENDER_STATS_INC(programBinds);
             glUseProgram(m_programID);
         }
     }
@@ -285,6 +791,8 @@ namespace mango
         MG_PROFILE_ZONE_SCOPED;
         MG_PROFILE_GL_ZONE("Shader::updateUniforms");
 
+        ensureLinked();
+
         for (unsigned i = 0; i < m_uniformsNames.size(); ++i)
         {
             auto uniformName = m_uniformsNames[i];
@@ -333,6 +841,8 @@ namespace mango
         MG_PROFILE_ZONE_SCOPED;
         MG_PROFILE_GL_ZONE("Shader::updateGlobalUniforms");
 
+        ensureLinked();
+
         for (unsigned i = 0; i < m_globalUniformsNames.size(); ++i)
         {
             auto uniformName = m_globalUniformsNames[i];
@@ -398,6 +908,8 @@ namespace mango
         MG_PROFILE_ZONE_SCOPED;
         MG_PROFILE_GL_ZONE("Shader::getUniformLocation");
 
+        ensureLinked();
+
         GLint uniformLocation = glGetUniformLocation(m_programID, uniformName.c_str());
 
         if (uniformLocation != -1)
@@ -408,61 +920,10 @@ namespace mango
         return false;
     }
 
-    std::string Shader::loadFile(const std::filesystem::path& filepath) const
-    {
-        MG_PROFILE_ZONE_SCOPED;
-
-        std::string output;
-        std::ifstream file(filepath, std::ios::in | std::ios::binary | std::ios::ate);
-
-        if (file)
-        {
-            size_t size = file.tellg();
-
-            if (size != -1)
-            {
-                output.resize(size);
-                file.seekg(0, std::ios::beg);
-                file.read(&output[0], size);
-            }
-            else
-            {
-                MG_CORE_ERROR("Could not read from the file '{}'", filepath);
-            }
-        }
-        else
-        {
-            MG_CORE_ERROR("Could not open file '{}'", filepath);
-        }
-
-        return output;
-    }
-
-    std::string Shader::loadShaderIncludes(const std::string& shaderCode) const
-    {
-        MG_PROFILE_ZONE_SCOPED;
-
-        std::istringstream ss(shaderCode);
-
-        std::string line, newShaderCode;
-        std::string includePhrase = "#include";
-        
-        while (std::getline(ss, line))
-        {
-            if (line.substr(0, includePhrase.size()) == includePhrase)
-            {
-                std::string include_file_name = line.substr(includePhrase.size() + 2, line.size() - includePhrase.size() - 4);
-                line = loadFile(VFI::getFilepath(include_file_name));
-            }
-        
-            newShaderCode.append(line + "\n");
-        }
-        
-        return newShaderCode;
-    }
-
     void Shader::setUniform(const std::string& uniformName, float value)
     {
+        MG_RENDER_STATS_INC(uniformCalls);
+
         if (m_uniformsLocations.count(uniformName))
         {
             glProgramUniform1f(m_programID, m_uniformsLocations[uniformName], value);
@@ -478,6 +939,8 @@ namespace mango
 
     void Shader::setUniform(const std::string & uniformName, int value)
     {
+        MG_RENDER_STATS_INC(uniformCalls);
+
         if (m_uniformsLocations.count(uniformName))
         {
             glProgramUniform1i(m_programID, m_uniformsLocations[uniformName], value);
@@ -493,6 +956,8 @@ namespace mango
 
     void Shader::setUniform(const std::string & uniformName, unsigned int value)
     {
+        MG_RENDER_STATS_INC(uniformCalls);
+
         if (m_uniformsLocations.count(uniformName))
         {
             glProgramUniform1ui(m_programID, m_uniformsLocations.at(uniformName), value);
@@ -508,6 +973,8 @@ namespace mango
 
     void Shader::setUniform(const std::string & uniformName, GLsizei count, float * value)
     {
+        MG_RENDER_STATS_INC(uniformCalls);
+
         if (m_uniformsLocations.count(uniformName))
         {
             glProgramUniform1fv(m_programID, m_uniformsLocations[uniformName], count, value);
@@ -523,6 +990,8 @@ namespace mango
 
     void Shader::setUniform(const std::string & uniformName, GLsizei count, int * value)
     {
+        MG_RENDER_STATS_INC(uniformCalls);
+
         if (m_uniformsLocations.count(uniformName))
         {
             glProgramUniform1iv(m_programID, m_uniformsLocations[uniformName], count, value);
@@ -538,6 +1007,8 @@ namespace mango
 
     void Shader::setUniform(const std::string & uniformName, GLsizei count, glm::vec3 * vectors)
     {
+        MG_RENDER_STATS_INC(uniformCalls);
+
         if (m_uniformsLocations.count(uniformName))
         {
             glProgramUniform3fv(m_programID, m_uniformsLocations[uniformName], count, glm::value_ptr(vectors[0]));
@@ -553,6 +1024,8 @@ namespace mango
 
     void Shader::setUniform(const std::string & uniformName, const glm::vec2 & vector)
     {
+        MG_RENDER_STATS_INC(uniformCalls);
+
         if (m_uniformsLocations.count(uniformName))
         {
             glProgramUniform2fv(m_programID, m_uniformsLocations[uniformName], 1, glm::value_ptr(vector));
@@ -568,6 +1041,8 @@ namespace mango
 
     void Shader::setUniform(const std::string & uniformName, const glm::vec3 & vector)
     {
+        MG_RENDER_STATS_INC(uniformCalls);
+
         if (m_uniformsLocations.count(uniformName))
         {
             glProgramUniform3fv(m_programID, m_uniformsLocations[uniformName], 1, glm::value_ptr(vector));
@@ -583,6 +1058,8 @@ namespace mango
 
     void Shader::setUniform(const std::string & uniformName, const glm::vec4 & vector)
     {
+        MG_RENDER_STATS_INC(uniformCalls);
+
         if (m_uniformsLocations.count(uniformName))
         {
             glProgramUniform4fv(m_programID, m_uniformsLocations[uniformName], 1, glm::value_ptr(vector));
@@ -598,6 +1075,8 @@ namespace mango
 
     void Shader::setUniform(const std::string & uniformName, const glm::mat3 & matrix)
     {
+        MG_RENDER_STATS_INC(uniformCalls);
+
         if (m_uniformsLocations.count(uniformName))
         {
             glProgramUniformMatrix3fv(m_programID, m_uniformsLocations[uniformName], 1, GL_FALSE, glm::value_ptr(matrix));
@@ -613,6 +1092,8 @@ namespace mango
 
     void Shader::setUniform(const std::string & uniformName, const glm::mat4 & matrix)
     {
+        MG_RENDER_STATS_INC(uniformCalls);
+
         if (m_uniformsLocations.count(uniformName))
         {
             glProgramUniformMatrix4fv(m_programID, m_uniformsLocations[uniformName], 1, GL_FALSE, glm::value_ptr(matrix));
@@ -628,6 +1109,8 @@ namespace mango
 
     void Shader::setUniform(const std::string & uniformName, glm::mat4 * matrices, unsigned count)
     {
+        MG_RENDER_STATS_INC(uniformCalls);
+
         if (m_uniformsLocations.count(uniformName))
         {
             glProgramUniformMatrix4fv(m_programID, m_uniformsLocations[uniformName], count, GL_FALSE, &matrices[0][0][0]);
@@ -640,9 +1123,4 @@ namespace mango
             }
         }
     }
-
-    void Shader::setSubroutine(Type shaderType, const std::string & subroutineName)
-    {
-        glUniformSubroutinesuiv(GLenum(shaderType), m_activeSubroutineUniformLocations[GLenum(shaderType)], &m_subroutineIndices[subroutineName]);
-    }
-}
+}
\ No newline at end of file
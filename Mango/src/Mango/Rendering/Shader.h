@@ -7,12 +7,20 @@
 #include "glad/glad.h"
 
 #include "Material.h"
+#include "ShaderPreprocessor.h"
+#include "Mango/Core/Timer.h"
 
 namespace mango
 {
     class TransformComponent;
 
-    class Shader final
+    /*
+     * GPU program built from the shader files. A stage can declare feature keywords with #pragma multi_compile KEYWORD_A KEYWORD_B,
+     * every keyword is a bit of a 64 bit mask shared by all of the shaders (see getKeywordMask). The variants are separate programs
+     * compiled with the enabled keywords defined, requested on the first getVariant() of their mask, so the passes and the materials
+     * pick them with a bind instead of switching the state of one program per draw. The shader itself is the variant without keywords.
+     */
+    class Shader final : public std::enable_shared_from_this<Shader>
     {
     public:
         enum class Type 
@@ -48,8 +56,18 @@ namespace mango
 
         ~Shader();
 
+        // Starts the link without waiting for the driver: loads the cached program binary or compiles all of the stages and links them.
+        // The status is queried by link() or on the first use, so the driver can compile the programs in parallel
+        void requestLink();
+
+        // Waits for the requested link (requests it if needed), falls back to the compilation when the cached binary is rejected
         bool link();
-        void bind() const;
+        bool isLinkPending() const { return m_isLinkPending; }
+
+        // True if link() won't wait for the driver
+        bool isLinkCompleted() const;
+
+        void bind();
         void updateUniforms(Material & material);
         void updateGlobalUniforms(const TransformComponent & transform);
 
@@ -66,30 +84,87 @@ namespace mango
         void setUniform(const std::string & uniformName, const glm::mat4 & matrix);
         void setUniform(const std::string & uniformName, glm::mat4 * matrices, unsigned count);
 
-        void setSubroutine(Type shaderType, const std::string & subroutineName);
+        // Bit of the keyword, assigned on the first use
+        static uint64_t getKeywordMask(const std::string & keyword);
+        static uint64_t getKeywordsMask(const std::vector<std::string> & keywords);
+
+        // Names of the keywords of the mask
+        static std::vector<std::string> getKeywordsNames(uint64_t keywordsMask);
+
+        // Program with the keywords of the mask defined, the keywords that the shader doesn't declare are ignored
+        ref<Shader> getVariant(uint64_t keywordsMask);
+        bool        hasKeywords() const { return m_keywordsMask != 0; }
+
+        // Keywords declared by the #pragma multi_compile lines of the stages
+        uint64_t getDeclaredKeywordsMask() const { return m_keywordsMask; }
+
+        // Keywords defined in the variant
+        uint64_t getEnabledKeywordsMask() const { return m_enabledKeywordsMask; }
+
+        // True if any of the files is one of the stages or is included by them
+        bool dependsOn(const std::vector<std::string> & files) const;
+
+        // Builds the program and its variants from the files again, keeps the previous programs if they don't link
+        bool reload();
+
+        // Adds the shader code that was generated at runtime (not loaded from a file), compiled when the link is requested
+        void addShaderSource(const std::string & sourceName, const std::string & source, Type type);
 
     private:
+        struct Stage
+        {
+            std::string              name;
+            std::string              filename; // empty for the generated sources
+            std::string              source;   // of the generated sources
+            std::vector<std::string> files;    // the stage and its includes, indexed by the source string numbers
+            std::string              code;     // with the includes expanded
+            GLenum                   type         = 0;
+            GLuint                   shaderObject = 0;
+        };
+
         void addAllUniforms();
-        void addAllSubroutines();
+        void addKeywords(std::string & code);
 
-        void addShader(const std::string & filename, GLuint type) const;
+        void addShader(const std::string & filename, GLuint type);
+        void addStage (Stage stage, const ShaderPreprocessor::Result & preprocessed);
         bool getUniformLocation(const std::string & uniformName);
 
-        std::string loadFile(const std::filesystem::path& filepath) const;
-        std::string loadShaderIncludes(const std::string& shaderCode) const;
+        void compileStages();
+        void releaseStages();
+        void logStagesErrors() const;
 
-    private:
-        std::unordered_map<std::string, GLuint> m_subroutineIndices;
-        std::unordered_map<GLenum, GLuint>      m_activeSubroutineUniformLocations;
+        uint64_t computeSourcesHash() const;
+        bool     loadProgramBinary();
+        void     saveProgramBinary() const;
+
+        ref<Shader> createVariant(uint64_t keywordsMask) const;
+        void        adopt(Shader & other);
+
+        void ensureLinked() { if (m_isLinkPending) link(); }
 
+    private:
         std::unordered_map<std::string, GLint> m_uniformsLocations;
         std::vector<std::string>               m_uniformsNames;
         std::vector<std::string>               m_globalUniformsNames;
         std::vector<GLint>                     m_uniformsTypes;
         std::vector<GLint>                     m_globalUniformsTypes;
 
+        std::string        m_name;
+        std::vector<Stage> m_stages;
+        uint64_t           m_keywordsMask        = 0; // declared by the stages
+        uint64_t           m_enabledKeywordsMask = 0;
+
+        std::unordered_map<uint64_t, ref<Shader>> m_variants;
+
+        uint64_t           m_sourcesHash = 0;
+        Timer              m_linkTimer;
+        float              m_requestTimeMs = 0.0f;
+
         GLuint m_programID;
         bool m_isLinked;
+        bool m_isLinkPending   = false;
+        bool m_isLinkRequested = false;
+        bool m_isFromBinary    = false;
 
         friend class AssetManager;
     };
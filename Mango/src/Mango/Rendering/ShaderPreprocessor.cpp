@@ -0,0 +1,175 @@
+#include "mgpch.h"
+
+#include "ShaderPreprocessor.h"
+
+namespace mango
+{
+    namespace
+    {
+        const uint32_t MAX_INCLUDE_DEPTH = 32;
+
+        const std::string INCLUDE_PHRASE     = "#include";
+        const std::string PRAGMA_ONCE_PHRASE = "#pragma once";
+    }
+
+    std::unordered_map<std::string, ShaderPreprocessor::CachedFile> ShaderPreprocessor::m_files;
+
+    ShaderPreprocessor::Result ShaderPreprocessor::processFile(const std::string & filename)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        Result result;
+        result.files.push_back(filename);
+
+        auto file = readFile(filename);
+        if (!file)
+        {
+            MG_CORE_ERROR("Could not open file '{}'", filename);
+
+            result.isValid = false;
+            return result;
+        }
+
+        expand(file->code, 0, 0, result);
+        return result;
+    }
+
+    ShaderPreprocessor::Result ShaderPreprocessor::processSource(const std::string & sourceName, const std::string & source)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        Result result;
+        result.files.push_back(sourceName);
+
+        expand(source, 0, 0, result);
+        return result;
+    }
+
+    std::vector<std::string> ShaderPreprocessor::collectChangedFiles()
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        std::vector<std::string> changedFiles;
+
+        for (auto it = m_files.begin(); it != m_files.end();)
+        {
+            std::error_code error;
+            auto writeTime = std::filesystem::last_write_time(VFI::getFilepath(it->first), error);
+
+            if (error || writeTime != it->second.writeTime)
+            {
+                changedFiles.push_back(it->first);
+                it = m_files.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+
+        return changedFiles;
+    }
+
+    void ShaderPreprocessor::clear()
+    {
+        m_files.clear();
+    }
+
+    const ShaderPreprocessor::CachedFile * ShaderPreprocessor::readFile(const std::string & filename)
+    {
+        if (auto it = m_files.find(filename); it != m_files.end())
+        {
+            return &it->second;
+        }
+
+        MG_PROFILE_ZONE_SCOPED;
+
+        if (!VFI::exists(filename))
+        {
+            return nullptr;
+        }
+
+        auto data = VFI::readFile(filename);
+
+        CachedFile file;
+        file.code = std::string(data.begin(), data.end());
+
+        std::error_code error;
+        file.writeTime = std::filesystem::last_write_time(VFI::getFilepath(filename), error);
+
+        // Blanked out, so the lines of the errors stay the same
+        size_t pragmaOnce = file.code.find(PRAGMA_ONCE_PHRASE);
+        if (pragmaOnce != std::string::npos && (pragmaOnce == 0 || file.code[pragmaOnce - 1] == '\n'))
+        {
+            file.code.replace(pragmaOnce, PRAGMA_ONCE_PHRASE.size(), PRAGMA_ONCE_PHRASE.size(), ' ');
+            file.hasPragmaOnce = true;
+        }
+
+        return &(m_files[filename] = std::move(file));
+    }
+
+    void ShaderPreprocessor::expand(const std::string & code, uint32_t sourceIndex, uint32_t depth, Result & result)
+    {
+        uint32_t lineNumber = 1;
+        size_t   lineStart  = 0;
+
+        while (lineStart < code.size())
+        {
+            size_t lineEnd = code.find('\n', lineStart);
+            if (lineEnd == std::string::npos)
+            {
+                lineEnd = code.size();
+            }
+
+            if (code.compare(lineStart, INCLUDE_PHRASE.size(), INCLUDE_PHRASE) != 0)
+            {
+                result.code.append(code, lineStart, lineEnd - lineStart);
+                result.code += '\n';
+            }
+            else
+            {
+                /* The included file is a new source string, the lines of the including one continue after it */
+                size_t nameStart = code.find('"', lineStart);
+                size_t nameEnd   = nameStart < lineEnd ? code.find('"', nameStart + 1) : std::string::npos;
+
+                std::string includeName = nameEnd < lineEnd ? code.substr(nameStart + 1, nameEnd - nameStart - 1) : std::string();
+
+                auto includedIt = std::find(result.files.begin(), result.files.end(), includeName);
+                auto file       = includeName.empty() ? nullptr : readFile(includeName);
+
+                if (!file)
+                {
+                    MG_CORE_ERROR("Can't include '{}' in {} at line {}.", includeName, result.files[sourceIndex], lineNumber);
+                    result.isValid = false;
+                }
+                else if (depth >= MAX_INCLUDE_DEPTH)
+                {
+                    MG_CORE_ERROR("Too deep includes of '{}' in {}, is it including itself?", includeName, result.files[sourceIndex]);
+                    result.isValid = false;
+                }
+                else if (!(file->hasPragmaOnce && includedIt != result.files.end()))
+                {
+                    uint32_t includedIndex = uint32_t(includedIt - result.files.begin());
+                    if (includedIt == result.files.end())
+                    {
+                        result.files.push_back(includeName);
+                    }
+
+                    result.code += "#line 1 " + std::to_string(includedIndex) + "\n";
+                    expand(file->code, includedIndex, depth + 1, result);
+                    result.code += "#line " + std::to_string(lineNumber + 1) + " " + std::to_string(sourceIndex) + "\n";
+
+                    lineStart = lineEnd + 1;
+                    ++lineNumber;
+                    continue;
+                }
+
+                // Kept as an empty line, so the lines that follow keep their numbers
+                result.code += '\n';
+            }
+
+            lineStart = lineEnd + 1;
+            ++lineNumber;
+        }
+    }
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace mango
+{
+    /*
+     * Expands the #include "file" directives of the shader sources, also in the included files. The files are read once and kept
+     * in memory, a file with #pragma once is expanded only once per source. Every file is a separate source string: #line directives
+     * around the included code keep the line numbers of the compilation errors, the source string numbers are the indices of
+     * Result::files. The programs keep their files, so a changed file reloads only the programs that depend on it
+     * (see AssetManager::reloadChangedShaders).
+     */
+    class ShaderPreprocessor final
+    {
+    public:
+        struct Result
+        {
+            std::string              code;
+            std::vector<std::string> files; // the source itself first, then the included files
+            bool                     isValid = true;
+        };
+
+        static Result processFile  (const std::string & filename);
+        static Result processSource(const std::string & sourceName, const std::string & source);
+
+        // Forgets the cached files that were saved since they were read and returns their names
+        static std::vector<std::string> collectChangedFiles();
+
+        static void clear();
+
+    private:
+        struct CachedFile
+        {
+            std::string                     code;
+            std::filesystem::file_time_type writeTime;
+            bool                            hasPragmaOnce = false;
+        };
+
+        static const CachedFile * readFile(const std::string & filename);
+
+        static void expand(const std::string & code, uint32_t sourceIndex, uint32_t depth, Result & result);
+
+    private:
+        static std::unordered_map<std::string, CachedFile> m_files;
+    };
+}
@@ -29,7 +29,7 @@ namespace mango
 
         /* Create skybox shader object */
         m_skyboxShader = AssetManager::createShader("Skybox", "Skybox.vert", "Skybox.frag");
-        m_skyboxShader->link();
+        m_skyboxShader->requestLink();
 
         m_skyboxMesh = createRef<Mesh>();
         m_skyboxMesh->genCubeMap(2.0f);
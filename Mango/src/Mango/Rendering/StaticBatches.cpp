@@ -0,0 +1,340 @@
+#include "mgpch.h"
+
+#include "StaticBatches.h"
+#include "Mango/Scene/Components.h"
+#include "Mango/Scene/Scene.h"
+#include "Mango/Utils/Hash.h"
+
+#include <fstream>
+#include <limits>
+#include <map>
+
+namespace mango
+{
+    namespace
+    {
+        const uint32_t CACHE_MAGIC   = 0x4253474D; // "MGSB"
+        const uint32_t CACHE_VERSION = 2; // the mirrored entities are baked with the flipped winding
+
+        struct CacheHeader
+        {
+            uint32_t magic         = CACHE_MAGIC;
+            uint32_t version       = CACHE_VERSION;
+            uint64_t hash          = 0;
+            uint32_t verticesCount = 0;
+            uint32_t indicesCount  = 0;
+            uint32_t batchesCount  = 0;
+            uint32_t padding       = 0;
+        };
+
+        template<typename T>
+        void appendBytes(std::string & bytes, const T & value)
+        {
+            bytes.append(reinterpret_cast<const char*>(&value), sizeof(T));
+        }
+
+        template<typename T>
+        void writeArray(std::ofstream & file, const std::vector<T> & array)
+        {
+            file.write(reinterpret_cast<const char*>(array.data()), std::streamsize(array.size() * sizeof(T)));
+        }
+
+        template<typename T>
+        bool readArray(std::ifstream & file, std::vector<T> & array, uint32_t count)
+        {
+            array.resize(count);
+            file.read(reinterpret_cast<char*>(array.data()), std::streamsize(count * sizeof(T)));
+
+            return bool(file);
+        }
+    }
+
+    void StaticBatches::build(Scene * scene)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+        MG_PROFILE_GL_ZONE("StaticBatches::build");
+
+        clear();
+
+        /* Static opaque entities in a deterministic order, so the batches match the cache */
+        auto view = scene->getEntitiesWithComponent<IDComponent, TransformComponent, StaticMeshComponent>();
+
+        std::vector<entt::entity> statics;
+        for (auto e : view)
+        {
+            auto & smc = view.get<StaticMeshComponent>(e);
+
+            // Animated meshes don't report their vertices, so they are never batched
+            if (!smc.isStatic || !smc.mesh || smc.mesh->getDrawMode() != Mesh::DrawMode::TRIANGLES || smc.mesh->getVerticesCount() == 0) continue;
+
+            // The queue of the entity is selected by the material of its first submesh, see RenderingSystem::gatherRenderables
+            auto & material = smc.materials[smc.mesh->getSubmesh()->materialIndex];
+            if (!material || material->getRenderQueue() != Material::RenderQueue::RQ_OPAQUE) continue;
+
+            statics.push_back(e);
+        }
+
+        if (statics.empty()) return;
+
+        std::sort(statics.begin(), statics.end(), [&view](entt::entity a, entt::entity b)
+        {
+            return uint64_t(view.get<IDComponent>(a).id) < uint64_t(view.get<IDComponent>(b).id);
+        });
+
+        /* Group the submeshes by material, layers and cell, everything that determines the baked geometry goes into the hash */
+        std::map<std::tuple<uint32_t, uint32_t, int32_t, int32_t, int32_t>, uint32_t> groupsIndices;
+        std::vector<std::vector<Part>>                                                groups;
+        std::vector<ref<Material>>                                                    materials;
+
+        std::string hashedBytes;
+        appendBytes(hashedBytes, CACHE_VERSION);
+        appendBytes(hashedBytes, CELL_SIZE);
+
+        for (auto e : statics)
+        {
+            Entity entity = { e, scene };
+
+            auto & smc    = view.get<StaticMeshComponent>(e);
+            auto & mesh   = smc.mesh;
+            auto   world  = view.get<TransformComponent>(e).getWorldMatrix();
+            auto   layers = entity.hasComponent<LayerComponent>() ? entity.getComponent<LayerComponent>().layers : 1u;
+
+            glm::ivec3 cell = glm::ivec3(glm::floor(glm::vec3(world * glm::vec4(mesh->getBoundsCenter(), 1.0f)) / CELL_SIZE));
+
+            appendBytes(hashedBytes, uint64_t(view.get<IDComponent>(e).id));
+            appendBytes(hashedBytes, world);
+            appendBytes(hashedBytes, layers);
+            appendBytes(hashedBytes, mesh->getContentKey());
+            appendBytes(hashedBytes, mesh->getVerticesCount());
+            appendBytes(hashedBytes, mesh->getIndicesCount());
+            hashedBytes += mesh->getName();
+
+            auto & submeshes = mesh->getSubmeshes();
+            for (uint32_t submeshIndex = 0; submeshIndex < submeshes.size(); ++submeshIndex)
+            {
+                auto & material   = smc.materials[submeshes[submeshIndex].materialIndex];
+                auto   materialIt = std::find(materials.begin(), materials.end(), material);
+                auto   materialId = uint32_t(materialIt - materials.begin());
+
+                if (materialIt == materials.end())
+                {
+                    materials.push_back(material);
+                }
+
+                appendBytes(hashedBytes, materialId);
+
+                auto key     = std::make_tuple(materialId, layers, cell.x, cell.y, cell.z);
+                auto groupIt = groupsIndices.find(key);
+                if (groupIt == groupsIndices.end())
+                {
+                    groupIt = groupsIndices.emplace(key, uint32_t(groups.size())).first;
+                    groups.emplace_back();
+
+                    m_batches.push_back({ material, layers });
+                }
+
+                groups[groupIt->second].push_back({ e, submeshIndex });
+            }
+        }
+
+        uint64_t hash = fnvHash1a64(hashedBytes.data(), hashedBytes.size());
+
+        /* Load the baked geometry or bake it again */
+        VertexData               vertexData;
+        std::vector<CachedBatch> cachedBatches;
+
+        std::filesystem::path cachePath = scene->getFilepath();
+        if (!cachePath.empty())
+        {
+            cachePath.replace_extension(".mgbatch");
+        }
+
+        if (cachePath.empty() || !loadCache(cachePath, hash, vertexData, cachedBatches) || cachedBatches.size() != groups.size())
+        {
+            if (!bake(scene, groups, vertexData, cachedBatches))
+            {
+                // The entities are drawn one by one
+                clear();
+                return;
+            }
+
+            if (!cachePath.empty())
+            {
+                saveCache(cachePath, hash, vertexData, cachedBatches);
+            }
+        }
+
+        m_mesh = createRef<Mesh>("StaticBatches");
+        m_mesh->createBuffers(vertexData);
+
+        for (uint32_t i = 0; i < cachedBatches.size(); ++i)
+        {
+            Submesh submesh;
+            submesh.baseIndex     = cachedBatches[i].baseIndex;
+            submesh.indicesCount  = cachedBatches[i].indicesCount;
+            submesh.materialIndex = int32_t(i);
+
+            m_mesh->m_submeshes.push_back(submesh);
+
+            m_batches[i].center = cachedBatches[i].center;
+            m_batches[i].radius = cachedBatches[i].radius;
+        }
+
+        m_batchedEntities.insert(statics.begin(), statics.end());
+
+        MG_CORE_INFO("Merged {} static entities into {} batches.", statics.size(), m_batches.size());
+    }
+
+    void StaticBatches::clear()
+    {
+        m_mesh = nullptr;
+        m_batches.clear();
+        m_batchedEntities.clear();
+    }
+
+    bool StaticBatches::bake(Scene * scene, const std::vector<std::vector<Part>> & groups, VertexData & vertexData, std::vector<CachedBatch> & batches)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        vertexData = {};
+        batches.clear();
+
+        // Vertex data of the source meshes, read back from the GPU once per mesh
+        std::unordered_map<Mesh*, VertexData> sourcesData;
+
+        for (auto & group : groups)
+        {
+            CachedBatch batch;
+            batch.baseIndex = uint32_t(vertexData.indices.size());
+
+            const uint32_t firstVertex = uint32_t(vertexData.positions.size());
+
+            for (auto & part : group)
+            {
+                Entity entity = { part.entity, scene };
+
+                auto & mesh   = entity.getComponent<StaticMeshComponent>().mesh;
+                auto & source = sourcesData[mesh.get()];
+
+                if (source.positions.empty() && !mesh->readVertexData(source))
+                {
+                    MG_CORE_WARN("Can't read back the vertices of the mesh {}, the static entities aren't batched.", mesh->getName());
+                    return false;
+                }
+
+                auto & submesh = mesh->getSubmeshes()[part.submeshIndex];
+
+                // The vertices of a submesh start at its base vertex and go up to its largest index
+                uint32_t maxIndex = 0;
+                for (uint32_t i = submesh.baseIndex; i < submesh.baseIndex + submesh.indicesCount; ++i)
+                {
+                    maxIndex = glm::max(maxIndex, source.indices[i]);
+                }
+
+                glm::mat4 world        = entity.getComponent<TransformComponent>().getWorldMatrix();
+                glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(world)));
+
+                const uint32_t vertexOffset = uint32_t(vertexData.positions.size());
+
+                // A mirroring transform flips the winding, so the triangles are flipped back to face the same side
+                const bool isMirrored = glm::determinant(glm::mat3(world)) < 0.0f;
+
+                for (uint32_t v = submesh.baseVertex; v <= submesh.baseVertex + maxIndex; ++v)
+                {
+                    glm::vec3 tangent = source.tangents.empty() ? glm::vec3(0.0f) : glm::mat3(world) * source.tangents[v];
+
+                    vertexData.positions.push_back(world * glm::vec4(source.positions[v], 1.0f));
+                    vertexData.texcoords.push_back(source.texcoords[v]);
+                    vertexData.normals  .push_back(glm::normalize(normalMatrix * source.normals[v]));
+                    vertexData.tangents .push_back(glm::length(tangent) > 0.0f ? glm::normalize(tangent) : tangent);
+                }
+
+                for (uint32_t i = submesh.baseIndex; i < submesh.baseIndex + submesh.indicesCount; i += 3)
+                {
+                    vertexData.indices.push_back(vertexOffset + source.indices[i]);
+                    vertexData.indices.push_back(vertexOffset + source.indices[isMirrored ? i + 2 : i + 1]);
+                    vertexData.indices.push_back(vertexOffset + source.indices[isMirrored ? i + 1 : i + 2]);
+                }
+            }
+
+            batch.indicesCount = uint32_t(vertexData.indices.size()) - batch.baseIndex;
+
+            /* World space bounding sphere centered at the bounding box */
+            glm::vec3 min = glm::vec3( std::numeric_limits<float>::max());
+            glm::vec3 max = glm::vec3(-std::numeric_limits<float>::max());
+
+            for (uint32_t v = firstVertex; v < vertexData.positions.size(); ++v)
+            {
+                min = glm::min(min, vertexData.positions[v]);
+                max = glm::max(max, vertexData.positions[v]);
+            }
+
+            batch.center = 0.5f * (min + max);
+
+            float radiusSquared = 0.0f;
+            for (uint32_t v = firstVertex; v < vertexData.positions.size(); ++v)
+            {
+                radiusSquared = glm::max(radiusSquared, glm::dot(vertexData.positions[v] - batch.center, vertexData.positions[v] - batch.center));
+            }
+
+            batch.radius = glm::sqrt(radiusSquared);
+
+            batches.push_back(batch);
+        }
+
+        return true;
+    }
+
+    bool StaticBatches::loadCache(const std::filesystem::path & path, uint64_t hash, VertexData & vertexData, std::vector<CachedBatch> & batches)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        std::ifstream file(path, std::ios::binary);
+        if (!file.is_open())
+        {
+            return false;
+        }
+
+        CacheHeader header;
+        file.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+        if (!file || header.magic != CACHE_MAGIC || header.version != CACHE_VERSION || header.hash != hash)
+        {
+            return false;
+        }
+
+        return readArray(file, vertexData.positions, header.verticesCount) &&
+               readArray(file, vertexData.texcoords, header.verticesCount) &&
+               readArray(file, vertexData.normals,   header.verticesCount) &&
+               readArray(file, vertexData.tangents,  header.verticesCount) &&
+               readArray(file, vertexData.indices,   header.indicesCount)  &&
+               readArray(file, batches,              header.batchesCount);
+    }
+
+    void StaticBatches::saveCache(const std::filesystem::path & path, uint64_t hash, const VertexData & vertexData, const std::vector<CachedBatch> & batches)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        std::ofstream file(path, std::ios::binary);
+        if (!file.is_open())
+        {
+            MG_CORE_WARN("Can't save the static batches cache {}.", path.string());
+            return;
+        }
+
+        CacheHeader header;
+        header.hash          = hash;
+        header.verticesCount = uint32_t(vertexData.positions.size());
+        header.indicesCount  = uint32_t(vertexData.indices.size());
+        header.batchesCount  = uint32_t(batches.size());
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+        writeArray(file, vertexData.positions);
+        writeArray(file, vertexData.texcoords);
+        writeArray(file, vertexData.normals);
+        writeArray(file, vertexData.tangents);
+        writeArray(file, vertexData.indices);
+        writeArray(file, batches);
+    }
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include "Mango/Core/Base.h"
+#include "Mango/Rendering/Mesh.h"
+
+#include <entt.hpp>
+#include <filesystem>
+#include <unordered_set>
+
+namespace mango
+{
+    class Scene;
+
+    /*
+     * Static batching of the entities which never move (StaticMeshComponent::isStatic).
+     * The submeshes of the static opaque entities are pre-transformed into the world space and merged into one mesh,
+     * one submesh (batch) per material, layers and cell of a uniform grid, so the batches can still be frustum culled.
+     * The baked geometry is cached next to the scene file and reused as long as the static entities don't change.
+     */
+    class StaticBatches
+    {
+    public:
+        struct Batch
+        {
+            ref<Material> material;
+            uint32_t      layers = 1;
+            glm::vec3     center = glm::vec3(0.0f); // world space bounding sphere
+            float         radius = 0.0f;
+        };
+
+        static constexpr float CELL_SIZE = 32.0f;
+
+        StaticBatches() = default;
+
+        StaticBatches(const StaticBatches &)             = delete;
+        StaticBatches & operator=(const StaticBatches &) = delete;
+
+        // Merges the static entities of the scene, loads the geometry from the cache if it's up to date
+        void build(Scene * scene);
+        void clear();
+
+        bool isBatched(entt::entity entity) const { return m_batchedEntities.contains(entity); }
+        bool isEmpty()                      const { return m_batches.empty(); }
+
+        const std::vector<Batch> & getBatches() const { return m_batches; }
+        const ref<Mesh>          & getMesh()    const { return m_mesh; }
+
+    private:
+        // A submesh of a static entity that goes into one of the batches
+        struct Part
+        {
+            entt::entity entity;
+            uint32_t     submeshIndex;
+        };
+
+        struct CachedBatch
+        {
+            uint32_t  baseIndex    = 0;
+            uint32_t  indicesCount = 0;
+            glm::vec3 center       = glm::vec3(0.0f);
+            float     radius       = 0.0f;
+        };
+
+        // False if the vertices of a source mesh can't be read back, nothing is batched then
+        bool bake(Scene * scene, const std::vector<std::vector<Part>> & groups, VertexData & vertexData, std::vector<CachedBatch> & batches);
+
+        static bool loadCache(const std::filesystem::path & path, uint64_t hash, VertexData & vertexData, std::vector<CachedBatch> & batches);
+        static void saveCache(const std::filesystem::path & path, uint64_t hash, const VertexData & vertexData, const std::vector<CachedBatch> & batches);
+
+    private:
+        ref<Mesh>                        m_mesh;
+        std::vector<Batch>               m_batches; // the batch i is the submesh i of m_mesh
+        std::unordered_set<entt::entity> m_batchedEntities;
+    };
+}
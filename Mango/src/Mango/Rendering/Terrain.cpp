@@ -0,0 +1,665 @@
+#include "mgpch.h"
+
+#include "Terrain.h"
+#include "Mango/Core/AssetManager.h"
+#include "Mango/Core/Jobs.h"
+#include "Mango/Rendering/Shader.h"
+#include "Mango/Rendering/TextureStreaming.h"
+#include "Mango/Scene/Components.h"
+#include "Mango/Scene/Scene.h"
+
+#include <limits>
+
+namespace mango
+{
+    namespace
+    {
+        const float    MORPH_START   = 0.66f; // part of the range of a level where the vertices start to morph
+        const float    STREAM_MARGIN = 1.25f; // the tiles are requested a bit before the nodes need them
+        const uint32_t TILE_SAMPLES  = TerrainHeightmap::TILE_SIZE + 1;
+
+        bool isInRange(const glm::vec3 & min, const glm::vec3 & max, const glm::vec3 & position, float range)
+        {
+            glm::vec3 toBox = glm::max(glm::max(min - position, position - max), glm::vec3(0.0f));
+            return glm::dot(toBox, toBox) <= range * range;
+        }
+
+        bool isVisible(const glm::vec3 & min, const glm::vec3 & max, const glm::vec4 * frustumPlanes)
+        {
+            // The corner of the box furthest along the plane normal
+            for (uint32_t p = 0; p < 6; ++p)
+            {
+                glm::vec3 normal = glm::vec3(frustumPlanes[p]);
+                glm::vec3 corner = glm::mix(min, max, glm::greaterThanEqual(normal, glm::vec3(0.0f)));
+
+                if (glm::dot(normal, corner) + frustumPlanes[p].w < 0.0f) return false;
+            }
+
+            return true;
+        }
+    }
+
+    Terrain::~Terrain()
+    {
+        clear();
+
+        glDeleteVertexArrays(1, &m_gridVao);
+        glDeleteBuffers     (1, &m_gridVbo);
+        glDeleteBuffers     (1, &m_gridIbo);
+        glDeleteBuffers     (1, &m_instancesBuffer);
+        glDeleteBuffers     (1, &m_commandsBuffer);
+    }
+
+    void Terrain::init()
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        m_shader = AssetManager::createShader("Terrain", "Terrain.vert", "GBuffer.frag");
+        m_shader->requestLink();
+
+        /* Grid shared by all of the nodes, the vertices are in [0, 1]. The z is 1 for the copies of the vertices lowered by the skirts */
+        const uint32_t verticesCount = (GRID_SIZE + 1) * (GRID_SIZE + 1);
+
+        std::vector<glm::vec3> vertices;
+        vertices.reserve(2 * verticesCount);
+
+        for (float skirt : { 0.0f, 1.0f })
+        {
+            for (uint32_t y = 0; y <= GRID_SIZE; ++y)
+            {
+                for (uint32_t x = 0; x <= GRID_SIZE; ++x)
+                {
+                    vertices.emplace_back(float(x) / GRID_SIZE, float(y) / GRID_SIZE, skirt);
+                }
+            }
+        }
+
+        // Ordered by the quadrants, so the whole grid and every quadrant is a range of indices
+        const uint32_t halfSize = GRID_SIZE / 2;
+
+        std::vector<uint32_t> indices;
+        indices.reserve(GRID_SIZE * GRID_SIZE * 6 + 4 * 4 * halfSize * 6);
+
+        // Wall hanging from the edge from a to b, it faces the right side of the edge when seen from above
+        auto addSkirt = [&](uint32_t a, uint32_t b)
+        {
+            indices.insert(indices.end(), { a, a + verticesCount, b, b, a + verticesCount, b + verticesCount });
+        };
+
+        for (uint32_t quadrant = 0; quadrant < 4; ++quadrant)
+        {
+            uint32_t startX = (quadrant & 1) * halfSize;
+            uint32_t startY = (quadrant >> 1) * halfSize;
+
+            for (uint32_t y = startY; y < startY + halfSize; ++y)
+            {
+                for (uint32_t x = startX; x < startX + halfSize; ++x)
+                {
+                    uint32_t i00 = y * (GRID_SIZE + 1) + x;
+                    uint32_t i10 = i00 + 1;
+                    uint32_t i01 = i00 + GRID_SIZE + 1;
+                    uint32_t i11 = i01 + 1;
+
+                    // Counter clockwise when seen from above
+                    indices.insert(indices.end(), { i00, i01, i10, i10, i01, i11 });
+                }
+            }
+
+            /* Skirts around the quadrant cover the cracks to the neighbours of the other levels and sources, they face outwards */
+            const uint32_t endX = startX + halfSize;
+            const uint32_t endY = startY + halfSize;
+
+            for (uint32_t i = 0; i < halfSize; ++i)
+            {
+                addSkirt(startY * (GRID_SIZE + 1) + startX + i + 1, startY * (GRID_SIZE + 1) + startX + i);
+                addSkirt(endY   * (GRID_SIZE + 1) + startX + i,     endY   * (GRID_SIZE + 1) + startX + i + 1);
+                addSkirt((startY + i)     * (GRID_SIZE + 1) + startX, (startY + i + 1) * (GRID_SIZE + 1) + startX);
+                addSkirt((startY + i + 1) * (GRID_SIZE + 1) + endX,   (startY + i)     * (GRID_SIZE + 1) + endX);
+            }
+        }
+
+        m_gridIndicesCount = uint32_t(indices.size());
+
+        glCreateBuffers     (1, &m_gridVbo);
+        glNamedBufferStorage(m_gridVbo, vertices.size() * sizeof(glm::vec3), vertices.data(), 0);
+
+        glCreateBuffers     (1, &m_gridIbo);
+        glNamedBufferStorage(m_gridIbo, indices.size() * sizeof(uint32_t), indices.data(), 0);
+
+        glCreateVertexArrays(1, &m_gridVao);
+
+        glVertexArrayVertexBuffer (m_gridVao, 0, m_gridVbo, 0, sizeof(glm::vec3));
+        glEnableVertexArrayAttrib (m_gridVao, 0);
+        glVertexArrayAttribFormat (m_gridVao, 0, 3, GL_FLOAT, GL_FALSE, 0);
+        glVertexArrayAttribBinding(m_gridVao, 0, 0);
+        glVertexArrayElementBuffer(m_gridVao, m_gridIbo);
+
+        glCreateBuffers(1, &m_instancesBuffer);
+        glCreateBuffers(1, &m_commandsBuffer);
+    }
+
+    void Terrain::clear()
+    {
+        for (auto & [entity, surface] : m_surfaces)
+        {
+            releaseSurface(surface);
+        }
+
+        m_surfaces.clear();
+        m_instances.clear();
+        m_commands.clear();
+        m_instancesRange = {};
+        m_commandsRange  = {};
+
+        m_residentTilesCount = 0;
+    }
+
+    void Terrain::update(Scene * scene, const glm::vec3 & cameraPosition)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+        MG_PROFILE_GL_ZONE("Terrain::update");
+
+        auto view = scene->getEntitiesWithComponent<TransformComponent, TerrainComponent>();
+
+        for (auto it = m_surfaces.begin(); it != m_surfaces.end();)
+        {
+            // A heightmap still being cooked isn't drawn yet
+            bool isDrawn = view.contains(it->first) && view.get<TerrainComponent>(it->first).heightmap && view.get<TerrainComponent>(it->first).heightmap->isLoaded();
+            if (!isDrawn)
+            {
+                releaseSurface(it->second);
+                it = m_surfaces.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+
+        m_residentTilesCount = 0;
+
+        for (auto e : view)
+        {
+            auto [tc, terrain] = view.get<TransformComponent, TerrainComponent>(e);
+            if (!terrain.heightmap || !terrain.heightmap->isLoaded()) continue;
+
+            auto & surface = m_surfaces[e];
+            if (surface.heightmap != terrain.heightmap)
+            {
+                releaseSurface(surface);
+                createSurface (surface, terrain.heightmap);
+            }
+
+            Entity entity = { e, scene };
+
+            glm::vec3 position = tc.getWorldMatrix()[3];
+
+            surface.material      = terrain.material ? terrain.material : AssetManager::getMaterial("DefaultMaterial");
+            surface.size          = glm::max(terrain.size, 1.0f);
+            surface.height        = terrain.height;
+            surface.corner        = position - glm::vec3(0.5f * surface.size, 0.0f, 0.5f * surface.size);
+            surface.lodLevels     = glm::clamp(terrain.lodLevels, 1u, MAX_LOD_LEVELS);
+            surface.lodDistance   = terrain.lodDistance;
+            surface.textureTiling = glm::max(terrain.textureTiling, 0.001f);
+            surface.layers        = entity.hasComponent<LayerComponent>() ? entity.getComponent<LayerComponent>().layers : 1u;
+
+            streamTiles(surface, cameraPosition);
+
+            m_residentTilesCount += uint32_t(surface.layerTiles.size() - surface.freeLayers.size());
+        }
+    }
+
+    void Terrain::cull(const glm::vec4 * frustumPlanes, const glm::vec3 & viewPosition, uint32_t layerMask)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        m_instances.clear();
+        m_commands.clear();
+
+        // Nothing is bound nor drawn until the selected nodes are streamed
+        m_instancesRange = {};
+        m_commandsRange  = {};
+
+        for (auto & [entity, surface] : m_surfaces)
+        {
+            surface.isVisible    = false;
+            surface.firstCommand = uint32_t(m_commands.size());
+            surface.nearestPoint = glm::clamp(viewPosition, surface.corner, surface.corner + glm::vec3(surface.size, surface.height, surface.size));
+
+            if ((surface.layers & layerMask) == 0) continue;
+
+            Selection selection;
+            selection.surface       = &surface;
+            selection.frustumPlanes = frustumPlanes;
+            selection.viewPosition  = viewPosition;
+
+            // The finest range has to enclose a few of the finest nodes, otherwise the morphs can't keep up with the levels
+            float finestNodeSize = surface.size / float(1u << (surface.lodLevels - 1));
+
+            selection.ranges[0] = glm::max(surface.lodDistance, 3.0f * finestNodeSize);
+            for (uint32_t lod = 1; lod < surface.lodLevels; ++lod)
+            {
+                selection.ranges[lod] = 2.0f * selection.ranges[lod - 1];
+            }
+
+            for (auto & instances : m_selectedInstances)
+            {
+                instances.clear();
+            }
+
+            // Out of all of the ranges, the root is still drawn at the coarsest level
+            if (!selectNode(selection, 0, 0, 0))
+            {
+                glm::vec3 min, max;
+                nodeBounds(surface, 0, 0, 0, min, max);
+
+                if (isVisible(min, max, frustumPlanes))
+                {
+                    addNode(selection, 0, 0, 0, FULL);
+                }
+            }
+
+            for (uint32_t command = 0; command < DRAW_COMMANDS_COUNT; ++command)
+            {
+                auto & instances = m_selectedInstances[command];
+
+                DrawElementsIndirectCommand drawCommand;
+                drawCommand.count         = command == FULL ? m_gridIndicesCount : m_gridIndicesCount / 4;
+                drawCommand.instanceCount = uint32_t(instances.size());
+                drawCommand.firstIndex    = command == FULL ? 0 : (command - QUADRANT_0) * (m_gridIndicesCount / 4);
+                drawCommand.baseVertex    = 0;
+                drawCommand.baseInstance  = uint32_t(m_instances.size());
+
+                m_commands .push_back(drawCommand);
+                m_instances.insert(m_instances.end(), instances.begin(), instances.end());
+
+                surface.isVisible |= !instances.empty();
+            }
+        }
+
+        if (m_instances.empty()) return;
+
+        GLsizeiptr instancesSize = GLsizeiptr(m_instances.size() * sizeof(Instance));
+        GLsizeiptr commandsSize  = GLsizeiptr(m_commands.size()  * sizeof(DrawElementsIndirectCommand));
+
+        // Read from the staging ring, so the buffers of the previous view aren't waited for
+        m_instancesRange = GPUUploads::stream(m_instances.data(), instancesSize, m_instancesBuffer);
+        m_commandsRange  = GPUUploads::stream(m_commands.data(),  commandsSize,  m_commandsBuffer);
+    }
+
+    void Terrain::render(const std::function<void(ref<Shader> &, const ref<Material> &)> & bindMaterial)
+    {
+        // An empty range can't be bound to the storage buffer
+        if (m_instances.empty() || m_instancesRange.buffer == 0 || m_commandsRange.buffer == 0) return;
+
+        MG_PROFILE_ZONE_SCOPED;
+        MG_PROFILE_GL_ZONE("Terrain::render");
+
+        // The view and projection are the only globals used, they don't depend on the transform
+        static const TransformComponent identityTransform;
+
+        m_shader->bind();
+        m_shader->updateGlobalUniforms(identityTransform);
+
+        // The meshlet commands stay bound for the rest of the frame
+        GLint previousCommandsBuffer = 0;
+        glGetIntegerv(GL_DRAW_INDIRECT_BUFFER_BINDING, &previousCommandsBuffer);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_commandsRange.buffer);
+
+        glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 0, m_instancesRange.buffer, m_instancesRange.offset, m_instances.size() * sizeof(Instance));
+
+        glBindVertexArray(m_gridVao);
+        MG_RENDER_STATS_INC(vaoBinds);
+
+        for (auto & [entity, surface] : m_surfaces)
+        {
+            if (!surface.isVisible) continue;
+
+            bindMaterial(m_shader, surface.material);
+
+            m_shader->setUniform("terrain_height", glm::vec2(surface.corner.y, surface.height));
+            m_shader->setUniform("texture_tiling", surface.textureTiling);
+
+            glBindTextureUnit(9,  surface.overviewTexture);
+            glBindTextureUnit(10, surface.tilesTexture);
+            MG_RENDER_STATS_ADD(textureBinds, 2);
+
+            uint32_t indicesCount = 0;
+            for (uint32_t command = 0; command < DRAW_COMMANDS_COUNT; ++command)
+            {
+                indicesCount += m_commands[surface.firstCommand + command].count * m_commands[surface.firstCommand + command].instanceCount;
+            }
+
+            MG_RENDER_STATS_DRAW(GL_TRIANGLES, indicesCount, 0);
+            glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (void*)(m_commandsRange.offset + uint64_t(surface.firstCommand) * sizeof(DrawElementsIndirectCommand)), DRAW_COMMANDS_COUNT, 0);
+        }
+
+        glBindVertexArray(0);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, GLuint(previousCommandsBuffer));
+    }
+
+    void Terrain::requestTextureMips(const std::function<float(const glm::vec3 &, float, float)> & pixelsPerUV) const
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        for (auto & [entity, surface] : m_surfaces)
+        {
+            if (!surface.isVisible || !surface.material) continue;
+
+            // Terrain.vert repeats the textures every textureTiling world units
+            TextureStreaming::requestMips(*surface.material, pixelsPerUV(surface.nearestPoint, 0.0f, 1.0f / glm::max(surface.textureTiling, 0.001f)));
+        }
+    }
+
+    void Terrain::createSurface(Surface & surface, const ref<TerrainHeightmap> & heightmap)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+        MG_PROFILE_GL_ZONE("Terrain::createSurface");
+
+        surface.heightmap = heightmap;
+
+        const uint32_t tilesCount   = heightmap->getTilesCount();
+        const uint32_t overviewSize = TerrainHeightmap::OVERVIEW_SIZE + 1;
+
+        // The rows of 16 bit samples with an odd width aren't 4 byte aligned
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 2);
+
+        glCreateTextures   (GL_TEXTURE_2D, 1, &surface.overviewTexture);
+        glTextureStorage2D (surface.overviewTexture, 1, GL_R16, overviewSize, overviewSize);
+        glTextureSubImage2D(surface.overviewTexture, 0, 0, 0, overviewSize, overviewSize, GL_RED, GL_UNSIGNED_SHORT, heightmap->getOverview().data());
+        MG_RENDER_STATS_ADD(bytesUploaded, overviewSize * overviewSize * sizeof(uint16_t));
+
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+        glCreateTextures  (GL_TEXTURE_2D_ARRAY, 1, &surface.tilesTexture);
+        glTextureStorage3D(surface.tilesTexture, 1, GL_R16, TILE_SAMPLES, TILE_SAMPLES, MAX_RESIDENT_TILES);
+
+        for (auto texture : { surface.overviewTexture, surface.tilesTexture })
+        {
+            glTextureParameteri(texture, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTextureParameteri(texture, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTextureParameteri(texture, GL_TEXTURE_WRAP_S,     GL_CLAMP_TO_EDGE);
+            glTextureParameteri(texture, GL_TEXTURE_WRAP_T,     GL_CLAMP_TO_EDGE);
+        }
+
+        surface.tileLayers  .assign(tilesCount * tilesCount, -1);
+        surface.tilesPending.assign(tilesCount * tilesCount, 0);
+        surface.layerTiles  .assign(MAX_RESIDENT_TILES, 0);
+        surface.freeLayers  .clear();
+
+        for (int32_t layer = MAX_RESIDENT_TILES - 1; layer >= 0; --layer)
+        {
+            surface.freeLayers.push_back(layer);
+        }
+
+        surface.pendingCount = 0;
+        surface.loadedTiles  = createRef<LoadedTiles>();
+    }
+
+    void Terrain::releaseSurface(Surface & surface)
+    {
+        glDeleteTextures(1, &surface.overviewTexture);
+        glDeleteTextures(1, &surface.tilesTexture);
+
+        surface.overviewTexture = 0;
+        surface.tilesTexture    = 0;
+
+        // The tiles still being read are dropped with the queue
+        surface.heightmap   = nullptr;
+        surface.loadedTiles = nullptr;
+
+        surface.tileLayers  .clear();
+        surface.tilesPending.clear();
+        surface.layerTiles  .clear();
+        surface.freeLayers  .clear();
+        surface.pendingCount = 0;
+    }
+
+    void Terrain::nodeBounds(const Surface & surface, uint32_t depth, uint32_t x, uint32_t y, glm::vec3 & min, glm::vec3 & max)
+    {
+        float     nodeSize    = surface.size / float(1u << depth);
+        glm::vec2 heightRange = surface.heightmap->getHeightRange(depth, x, y) * surface.height;
+
+        min = surface.corner + glm::vec3(float(x) * nodeSize, heightRange.x, float(y) * nodeSize);
+        max = surface.corner + glm::vec3(float(x + 1) * nodeSize, heightRange.y, float(y + 1) * nodeSize);
+    }
+
+    void Terrain::streamTiles(Surface & surface, const glm::vec3 & cameraPosition)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        const uint32_t tilesCount = surface.heightmap->getTilesCount();
+        const uint32_t tileLevel  = surface.heightmap->getTileLevel();
+
+        // The tiles are only sampled by the nodes as large as a tile and smaller
+        std::vector<uint8_t> isTileWanted(tilesCount * tilesCount, 0);
+        std::vector<std::pair<float, uint32_t>> wantedTiles;
+
+        if (tileLevel < surface.lodLevels)
+        {
+            uint32_t tileLod        = surface.lodLevels - 1 - tileLevel;
+            float    finestNodeSize = surface.size / float(1u << (surface.lodLevels - 1));
+            float    streamDistance = glm::max(surface.lodDistance, 3.0f * finestNodeSize) * float(1u << tileLod) * STREAM_MARGIN;
+
+            for (uint32_t y = 0; y < tilesCount; ++y)
+            {
+                for (uint32_t x = 0; x < tilesCount; ++x)
+                {
+                    glm::vec3 min, max;
+                    nodeBounds(surface, tileLevel, x, y, min, max);
+
+                    if (isInRange(min, max, cameraPosition, streamDistance))
+                    {
+                        glm::vec3 toTile = glm::max(glm::max(min - cameraPosition, cameraPosition - max), glm::vec3(0.0f));
+
+                        isTileWanted[y * tilesCount + x] = 1;
+                        wantedTiles.emplace_back(glm::dot(toTile, toTile), y * tilesCount + x);
+                    }
+                }
+            }
+        }
+
+        std::sort(wantedTiles.begin(), wantedTiles.end());
+
+        // Layer of the resident tile furthest from the camera that isn't wanted anymore, -1 if there is none
+        auto findEvictedLayer = [&]() -> int32_t
+        {
+            int32_t evictedLayer    = -1;
+            float   evictedDistance = -1.0f;
+
+            for (uint32_t layer = 0; layer < surface.layerTiles.size(); ++layer)
+            {
+                uint32_t tile = surface.layerTiles[layer];
+                if (surface.tileLayers[tile] != int32_t(layer) || isTileWanted[tile]) continue;
+
+                glm::vec3 min, max;
+                nodeBounds(surface, tileLevel, tile % tilesCount, tile / tilesCount, min, max);
+
+                float distance = glm::distance(0.5f * (min + max), cameraPosition);
+                if (distance > evictedDistance)
+                {
+                    evictedLayer    = int32_t(layer);
+                    evictedDistance = distance;
+                }
+            }
+
+            return evictedLayer;
+        };
+
+        /* Upload the tiles read since the last update */
+        std::vector<LoadedTile> loadedTiles;
+        {
+            std::lock_guard<std::mutex> lock(surface.loadedTiles->mutex);
+            loadedTiles.swap(surface.loadedTiles->tiles);
+        }
+
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 2);
+
+        std::vector<LoadedTile> deferredTiles;
+
+        for (auto & tile : loadedTiles)
+        {
+            // The tiles over the upload budget of this frame wait for the next ones
+            if (!tile.samples.empty() && GPUUploads::getRemainingBudget() < tile.samples.size() * sizeof(uint16_t))
+            {
+                deferredTiles.push_back(std::move(tile));
+                continue;
+            }
+
+            --surface.pendingCount;
+
+            // A tile that couldn't be read stays pending, so it isn't requested again
+            if (tile.samples.empty()) continue;
+
+            surface.tilesPending[tile.index] = 0;
+
+            if (!isTileWanted[tile.index]) continue;
+
+            int32_t layer = -1;
+            if (!surface.freeLayers.empty())
+            {
+                layer = surface.freeLayers.back();
+                surface.freeLayers.pop_back();
+            }
+            else
+            {
+                layer = findEvictedLayer();
+                if (layer < 0) continue;
+
+                surface.tileLayers[surface.layerTiles[layer]] = -1;
+            }
+
+            GPUUploads::uploadTexture3D(surface.tilesTexture, 0, 0, 0, layer, TILE_SAMPLES, TILE_SAMPLES, 1, GL_RED, GL_UNSIGNED_SHORT, tile.samples.data(), tile.samples.size() * sizeof(uint16_t));
+
+            surface.tileLayers[tile.index] = layer;
+            surface.layerTiles[layer]      = tile.index;
+        }
+
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+        if (!deferredTiles.empty())
+        {
+            std::lock_guard<std::mutex> lock(surface.loadedTiles->mutex);
+            surface.loadedTiles->tiles.insert(surface.loadedTiles->tiles.end(), std::make_move_iterator(deferredTiles.begin()), std::make_move_iterator(deferredTiles.end()));
+        }
+
+        /* Request the closest missing tiles, as many as there are layers to put them in */
+        int32_t availableLayers = int32_t(surface.freeLayers.size()) - int32_t(surface.pendingCount);
+        for (uint32_t layer = 0; layer < surface.layerTiles.size(); ++layer)
+        {
+            uint32_t tile = surface.layerTiles[layer];
+            if (surface.tileLayers[tile] == int32_t(layer) && !isTileWanted[tile]) ++availableLayers;
+        }
+
+        for (auto & [distance, index] : wantedTiles)
+        {
+            if (surface.pendingCount >= MAX_PENDING_TILES || availableLayers <= 0) break;
+            if (surface.tileLayers[index] >= 0 || surface.tilesPending[index]) continue;
+
+            surface.tilesPending[index] = 1;
+            ++surface.pendingCount;
+            --availableLayers;
+
+            Jobs::executor.silent_async([heightmap = surface.heightmap, loadedTiles = surface.loadedTiles, index, tilesCount]()
+            {
+                LoadedTile tile;
+                tile.index = index;
+
+                if (!heightmap->readTile(index % tilesCount, index / tilesCount, tile.samples))
+                {
+                    MG_CORE_ERROR("Can't read the tile {} of the terrain heightmap {}.", index, heightmap->getFilename());
+                    tile.samples.clear();
+                }
+
+                std::lock_guard<std::mutex> lock(loadedTiles->mutex);
+                loadedTiles->tiles.push_back(std::move(tile));
+            });
+        }
+    }
+
+    bool Terrain::selectNode(const Selection & selection, uint32_t depth, uint32_t x, uint32_t y)
+    {
+        const Surface & surface = *selection.surface;
+        const uint32_t  lod     = surface.lodLevels - 1 - depth;
+
+        glm::vec3 min, max;
+        nodeBounds(surface, depth, x, y, min, max);
+
+        // Out of the range of its level, the parent covers the node
+        if (!isInRange(min, max, selection.viewPosition, selection.ranges[lod])) return false;
+
+        // In range, but there is nothing to draw
+        if (!isVisible(min, max, selection.frustumPlanes)) return true;
+
+        if (lod == 0 || !isInRange(min, max, selection.viewPosition, selection.ranges[lod - 1]))
+        {
+            addNode(selection, depth, x, y, FULL);
+            return true;
+        }
+
+        // The children out of their range are drawn as the quadrants of this node
+        for (uint32_t quadrant = 0; quadrant < 4; ++quadrant)
+        {
+            uint32_t childX = 2 * x + (quadrant & 1);
+            uint32_t childY = 2 * y + (quadrant >> 1);
+
+            if (!selectNode(selection, depth + 1, childX, childY))
+            {
+                glm::vec3 childMin, childMax;
+                nodeBounds(surface, depth + 1, childX, childY, childMin, childMax);
+
+                if (isVisible(childMin, childMax, selection.frustumPlanes))
+                {
+                    addNode(selection, depth, x, y, DrawCommand(QUADRANT_0 + quadrant));
+                }
+            }
+        }
+
+        return true;
+    }
+
+    void Terrain::addNode(const Selection & selection, uint32_t depth, uint32_t x, uint32_t y, DrawCommand command)
+    {
+        const Surface & surface   = *selection.surface;
+        const uint32_t  lod       = surface.lodLevels - 1 - depth;
+        const uint32_t  tileLevel = surface.heightmap->getTileLevel();
+        const float     nodeSize  = surface.size / float(1u << depth);
+
+        // The skirts reach the lowest point of the parent, the edges of the coarser neighbours and the other sources can't be lower
+        glm::vec3 parentMin, parentMax;
+        nodeBounds(surface, depth > 0 ? depth - 1 : 0, x >> (depth > 0 ? 1 : 0), y >> (depth > 0 ? 1 : 0), parentMin, parentMax);
+
+        Instance instance;
+        instance.node = glm::vec4(surface.corner.x + float(x) * nodeSize, surface.corner.z + float(y) * nodeSize, nodeSize, parentMax.y - parentMin.y);
+
+        // The coarsest level has nothing to morph into
+        if (lod + 1 < surface.lodLevels)
+        {
+            float rangeStart = lod > 0 ? selection.ranges[lod - 1] : 0.0f;
+            float rangeEnd   = selection.ranges[lod];
+
+            instance.morph = glm::vec4(glm::mix(rangeStart, rangeEnd, MORPH_START), rangeEnd, 0.0f, 0.0f);
+        }
+        else
+        {
+            instance.morph = glm::vec4(std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), 0.0f, 0.0f);
+        }
+
+        instance.source = glm::vec4(surface.corner.x, surface.corner.z, surface.size, -1.0f);
+
+        if (depth >= tileLevel)
+        {
+            uint32_t tileX = x >> (depth - tileLevel);
+            uint32_t tileY = y >> (depth - tileLevel);
+            int32_t  layer = surface.tileLayers[tileY * surface.heightmap->getTilesCount() + tileX];
+
+            if (layer >= 0)
+            {
+                float tileSize = surface.size / float(surface.heightmap->getTilesCount());
+                instance.source = glm::vec4(surface.corner.x + float(tileX) * tileSize, surface.corner.z + float(tileY) * tileSize, tileSize, float(layer));
+            }
+        }
+
+        m_selectedInstances[command].push_back(instance);
+    }
+}
@@ -0,0 +1,153 @@
+#pragma once
+#include "glad/glad.h"
+#include "Mango/Core/Base.h"
+#include "Mango/Rendering/GPUUploads.h"
+#include "Mango/Rendering/Material.h"
+#include "Mango/Rendering/Meshlets.h"
+#include "Mango/Rendering/TerrainHeightmap.h"
+
+#include <entt.hpp>
+#include <functional>
+#include <glm/glm.hpp>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace mango
+{
+    class Scene;
+    class Shader;
+
+    /*
+     * Continuous distance-dependent LOD (CDLOD) rendering of the terrains (see TerrainComponent).
+     * Every view selects the nodes of a quadtree over the terrain: a node is drawn when its children are out of the range of
+     * their level, the quadrants of a node are drawn at its level when only some of the children are in range. All of the nodes
+     * are the same grid of GRID_SIZE quads, Terrain.vert samples the heights and morphs the vertices of a level into the ones of
+     * the next level towards the end of its range. The edges of every quadrant have skirts hanging down to the lowest point of the
+     * parent node, so the cracks left by the morph and by the neighbours sampling another source are covered. The nodes and the
+     * quadrants are five commands of one multi draw indirect per terrain.
+     * The nodes as large as a tile and smaller sample the streamed full resolution tiles, the rest samples the overview.
+     * The tiles around the camera are read by the worker threads and kept in a texture array, the furthest ones are evicted.
+     */
+    class Terrain
+    {
+    public:
+        static const uint32_t GRID_SIZE          = 32; // quads along a side of the grid, even
+        static const uint32_t MAX_LOD_LEVELS     = 12;
+        static const uint32_t MAX_RESIDENT_TILES = 64; // per terrain
+        static const uint32_t MAX_PENDING_TILES  = 4;  // per terrain
+
+        Terrain() = default;
+        ~Terrain();
+
+        Terrain(const Terrain &)             = delete;
+        Terrain & operator=(const Terrain &) = delete;
+
+        void init();
+        void clear();
+
+        // Picks up the terrains of the scene, uploads the streamed tiles and requests the missing ones around the camera
+        void update(Scene * scene, const glm::vec3 & cameraPosition);
+
+        // Selects the nodes for the view and uploads their instances and draw commands
+        void cull(const glm::vec4 * frustumPlanes, const glm::vec3 & viewPosition, uint32_t layerMask);
+
+        // Draws the selected nodes into the bound GBuffer, the materials are bound by the caller
+        void render(const std::function<void(ref<Shader> &, const ref<Material> &)> & bindMaterial);
+
+        // Requests the streamed mips of the materials of the culled terrains (see TextureStreaming) for their point nearest to the view.
+        // pixelsPerUV takes the world space bounding sphere and the texture coordinate units per world unit
+        void requestTextureMips(const std::function<float(const glm::vec3 &, float, float)> & pixelsPerUV) const;
+
+        uint32_t getNodesCount()         const { return uint32_t(m_instances.size()); }
+        uint32_t getResidentTilesCount() const { return m_residentTilesCount; }
+
+    private:
+        struct Instance
+        {
+            glm::vec4 node;   // world space corner x and z, size, depth of the skirts
+            glm::vec4 morph;  // distances where the morph to the next level starts and ends
+            glm::vec4 source; // world space corner x and z, size and the layer of the sampled tile, -1 for the overview
+        };
+
+        // The quadrants of the grid follow the whole grid in the index buffer
+        enum DrawCommand : uint32_t { FULL = 0, QUADRANT_0, QUADRANT_1, QUADRANT_2, QUADRANT_3, DRAW_COMMANDS_COUNT };
+
+        struct LoadedTile
+        {
+            uint32_t              index = 0;
+            std::vector<uint16_t> samples;
+        };
+
+        // Filled by the worker threads, emptied by the render thread
+        struct LoadedTiles
+        {
+            std::mutex              mutex;
+            std::vector<LoadedTile> tiles;
+        };
+
+        struct Surface
+        {
+            ref<TerrainHeightmap> heightmap;
+            ref<Material>         material;
+            glm::vec3             corner        = glm::vec3(0.0f); // world space corner with the lowest x and z
+            float                 size          = 0.0f;
+            float                 height        = 0.0f;
+            uint32_t              lodLevels     = 1;
+            float                 lodDistance   = 0.0f;
+            float                 textureTiling = 1.0f;
+            uint32_t              layers        = 1;
+
+            GLuint overviewTexture = 0;
+            GLuint tilesTexture    = 0;
+
+            std::vector<int32_t>  tileLayers;   // texture array layer of every tile, -1 if it isn't resident
+            std::vector<uint8_t>  tilesPending; // requested, not uploaded yet
+            std::vector<uint32_t> layerTiles;   // tile of every used layer
+            std::vector<int32_t>  freeLayers;
+            uint32_t              pendingCount = 0;
+
+            ref<LoadedTiles> loadedTiles;
+
+            // Draws of the last cull
+            uint32_t  firstCommand = 0;
+            bool      isVisible    = false;
+            glm::vec3 nearestPoint = glm::vec3(0.0f); // to the view
+        };
+
+        struct Selection
+        {
+            const Surface   * surface;
+            const glm::vec4 * frustumPlanes;
+            glm::vec3         viewPosition;
+            float             ranges[MAX_LOD_LEVELS];
+        };
+
+        static void createSurface (Surface & surface, const ref<TerrainHeightmap> & heightmap);
+        static void releaseSurface(Surface & surface);
+        static void nodeBounds    (const Surface & surface, uint32_t depth, uint32_t x, uint32_t y, glm::vec3 & min, glm::vec3 & max);
+
+        void streamTiles(Surface & surface, const glm::vec3 & cameraPosition);
+        bool selectNode (const Selection & selection, uint32_t depth, uint32_t x, uint32_t y);
+        void addNode    (const Selection & selection, uint32_t depth, uint32_t x, uint32_t y, DrawCommand command);
+
+    private:
+        std::unordered_map<entt::entity, Surface> m_surfaces;
+
+        ref<Shader> m_shader;
+
+        GLuint   m_gridVao            = 0;
+        GLuint   m_gridVbo            = 0;
+        GLuint   m_gridIbo            = 0;
+        uint32_t m_gridIndicesCount   = 0;
+        uint32_t m_residentTilesCount = 0;
+
+        std::vector<Instance>                    m_selectedInstances[DRAW_COMMANDS_COUNT];
+        std::vector<Instance>                    m_instances;
+        std::vector<DrawElementsIndirectCommand> m_commands;
+        GLuint                                   m_instancesBuffer = 0; // used when the staging ring is full
+        GLuint                                   m_commandsBuffer  = 0;
+        GPUUploads::Allocation                   m_instancesRange;       // of the current view
+        GPUUploads::Allocation                   m_commandsRange;
+    };
+}
@@ -0,0 +1,265 @@
+#include "mgpch.h"
+
+#include "TerrainHeightmap.h"
+#include "Mango/Utils/Hash.h"
+
+#include "stb_image.h"
+
+#include <fstream>
+#include <limits>
+
+namespace mango
+{
+    namespace
+    {
+        const uint32_t COOKED_MAGIC   = 0x5254474D; // "MGTR"
+        const uint32_t COOKED_VERSION = 1;
+
+        struct CookedHeader
+        {
+            uint32_t magic        = COOKED_MAGIC;
+            uint32_t version      = COOKED_VERSION;
+            uint64_t sourceHash   = 0;
+            uint32_t tilesCount   = 0;
+            uint32_t tileSize     = TerrainHeightmap::TILE_SIZE;
+            uint32_t overviewSize = TerrainHeightmap::OVERVIEW_SIZE;
+            uint32_t padding      = 0;
+        };
+
+        const uint32_t TILE_SAMPLES_COUNT = (TerrainHeightmap::TILE_SIZE + 1) * (TerrainHeightmap::TILE_SIZE + 1);
+    }
+
+    bool TerrainHeightmap::load()
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        auto sourcePath = VFI::getFilepath(m_filename);
+
+        std::error_code error;
+        auto sourceSize      = std::filesystem::file_size(sourcePath, error);
+        auto sourceWriteTime = std::filesystem::last_write_time(sourcePath, error);
+
+        if (error)
+        {
+            MG_CORE_ERROR("Can't find the terrain heightmap {}.", m_filename);
+            return false;
+        }
+
+        // The cooked file is stale as soon as the source image is saved again
+        std::string hashedBytes = std::to_string(sourceSize) + "|" + std::to_string(sourceWriteTime.time_since_epoch().count());
+        uint64_t    sourceHash  = fnvHash1a64(hashedBytes.data(), hashedBytes.size());
+
+        m_cookedPath = sourcePath;
+        m_cookedPath.replace_extension(".mgterrain");
+
+        if (readCooked(m_cookedPath, sourceHash))
+        {
+            return true;
+        }
+
+        return cook(sourcePath, m_cookedPath, sourceHash) && readCooked(m_cookedPath, sourceHash);
+    }
+
+    glm::vec2 TerrainHeightmap::getHeightRange(uint32_t depth, uint32_t x, uint32_t y) const
+    {
+        if (depth > m_tileLevel)
+        {
+            x   >>= depth - m_tileLevel;
+            y   >>= depth - m_tileLevel;
+            depth = m_tileLevel;
+        }
+
+        auto range = m_heightRanges[depth][y * (1u << depth) + x];
+        return glm::vec2(range) / 65535.0f;
+    }
+
+    bool TerrainHeightmap::readTile(uint32_t x, uint32_t y, std::vector<uint16_t> & samples) const
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        // Every reader has its own stream, so the tiles can be read in parallel
+        std::ifstream file(m_cookedPath, std::ios::binary);
+        if (!file.is_open())
+        {
+            return false;
+        }
+
+        uint64_t tileIndex = uint64_t(y) * m_tilesCount + x;
+
+        samples.resize(TILE_SAMPLES_COUNT);
+        file.seekg(std::streamoff(m_tilesStart + tileIndex * TILE_SAMPLES_COUNT * sizeof(uint16_t)));
+        file.read(reinterpret_cast<char*>(samples.data()), std::streamsize(samples.size() * sizeof(uint16_t)));
+
+        return bool(file);
+    }
+
+    bool TerrainHeightmap::cook(const std::filesystem::path & sourcePath, const std::filesystem::path & cookedPath, uint64_t sourceHash)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        MG_CORE_INFO("Cooking the terrain heightmap {}...", m_filename);
+
+        int width, height, channelsCount;
+        uint16_t* data = stbi_load_16(sourcePath.string().c_str(), &width, &height, &channelsCount, 1);
+
+        if (!data)
+        {
+            MG_CORE_ERROR("Can't load the terrain heightmap {}.", m_filename);
+            return false;
+        }
+
+        // As many tiles as needed to keep the resolution of the source, the quadtree needs a power of two
+        uint32_t sourceQuads = uint32_t(glm::max(width, height) - 1);
+        uint32_t tilesCount  = 1;
+        while (tilesCount * TILE_SIZE < sourceQuads && tilesCount < MAX_TILES)
+        {
+            tilesCount *= 2;
+        }
+
+        // Bilinear sample of the source at the normalized coordinates
+        auto sample = [&](float u, float v) -> uint16_t
+        {
+            float x = u * float(width  - 1);
+            float y = v * float(height - 1);
+
+            int x0 = glm::min(int(x), width  - 1), x1 = glm::min(x0 + 1, width  - 1);
+            int y0 = glm::min(int(y), height - 1), y1 = glm::min(y0 + 1, height - 1);
+
+            float fx = x - float(x0);
+            float fy = y - float(y0);
+
+            float top    = glm::mix(float(data[y0 * width + x0]), float(data[y0 * width + x1]), fx);
+            float bottom = glm::mix(float(data[y1 * width + x0]), float(data[y1 * width + x1]), fx);
+
+            return uint16_t(glm::round(glm::mix(top, bottom, fy)));
+        };
+
+        std::ofstream file(cookedPath, std::ios::binary);
+        if (!file.is_open())
+        {
+            MG_CORE_ERROR("Can't save the cooked terrain heightmap {}.", cookedPath.string());
+            stbi_image_free(data);
+            return false;
+        }
+
+        CookedHeader header;
+        header.sourceHash = sourceHash;
+        header.tilesCount = tilesCount;
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+        /* Overview */
+        std::vector<uint16_t> overview((OVERVIEW_SIZE + 1) * (OVERVIEW_SIZE + 1));
+        for (uint32_t y = 0; y <= OVERVIEW_SIZE; ++y)
+        {
+            for (uint32_t x = 0; x <= OVERVIEW_SIZE; ++x)
+            {
+                overview[y * (OVERVIEW_SIZE + 1) + x] = sample(float(x) / OVERVIEW_SIZE, float(y) / OVERVIEW_SIZE);
+            }
+        }
+
+        file.write(reinterpret_cast<const char*>(overview.data()), std::streamsize(overview.size() * sizeof(uint16_t)));
+
+        /* Tiles, the height ranges are written in front of them once they are known */
+        std::vector<glm::u16vec2> heightRanges(tilesCount * tilesCount);
+        auto rangesOffset = file.tellp();
+
+        file.write(reinterpret_cast<const char*>(heightRanges.data()), std::streamsize(heightRanges.size() * sizeof(glm::u16vec2)));
+
+        const float totalQuads = float(tilesCount * TILE_SIZE);
+
+        std::vector<uint16_t> samples(TILE_SAMPLES_COUNT);
+        for (uint32_t tileY = 0; tileY < tilesCount; ++tileY)
+        {
+            for (uint32_t tileX = 0; tileX < tilesCount; ++tileX)
+            {
+                glm::u16vec2 range(std::numeric_limits<uint16_t>::max(), 0);
+
+                for (uint32_t y = 0; y <= TILE_SIZE; ++y)
+                {
+                    for (uint32_t x = 0; x <= TILE_SIZE; ++x)
+                    {
+                        uint16_t value = sample(float(tileX * TILE_SIZE + x) / totalQuads, float(tileY * TILE_SIZE + y) / totalQuads);
+
+                        samples[y * (TILE_SIZE + 1) + x] = value;
+                        range = glm::u16vec2(glm::min(range.x, value), glm::max(range.y, value));
+                    }
+                }
+
+                heightRanges[tileY * tilesCount + tileX] = range;
+                file.write(reinterpret_cast<const char*>(samples.data()), std::streamsize(samples.size() * sizeof(uint16_t)));
+            }
+        }
+
+        file.seekp(rangesOffset);
+        file.write(reinterpret_cast<const char*>(heightRanges.data()), std::streamsize(heightRanges.size() * sizeof(glm::u16vec2)));
+
+        stbi_image_free(data);
+
+        return bool(file);
+    }
+
+    bool TerrainHeightmap::readCooked(const std::filesystem::path & cookedPath, uint64_t sourceHash)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        std::ifstream file(cookedPath, std::ios::binary);
+        if (!file.is_open())
+        {
+            return false;
+        }
+
+        CookedHeader header;
+        file.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+        if (!file                                 ||
+            header.magic        != COOKED_MAGIC   ||
+            header.version      != COOKED_VERSION ||
+            header.sourceHash   != sourceHash     ||
+            header.tileSize     != TILE_SIZE      ||
+            header.overviewSize != OVERVIEW_SIZE  ||
+            header.tilesCount   == 0              ||
+            header.tilesCount   >  MAX_TILES)
+        {
+            return false;
+        }
+
+        m_tilesCount = header.tilesCount;
+        m_tileLevel  = uint32_t(glm::log2(float(m_tilesCount)) + 0.5f);
+
+        m_overview.resize((OVERVIEW_SIZE + 1) * (OVERVIEW_SIZE + 1));
+        file.read(reinterpret_cast<char*>(m_overview.data()), std::streamsize(m_overview.size() * sizeof(uint16_t)));
+
+        /* Height ranges of the tiles, then of their parents up to the root */
+        m_heightRanges.assign(m_tileLevel + 1, {});
+        m_heightRanges[m_tileLevel].resize(m_tilesCount * m_tilesCount);
+
+        file.read(reinterpret_cast<char*>(m_heightRanges[m_tileLevel].data()), std::streamsize(m_heightRanges[m_tileLevel].size() * sizeof(glm::u16vec2)));
+
+        for (int32_t level = int32_t(m_tileLevel) - 1; level >= 0; --level)
+        {
+            uint32_t nodesCount = 1u << level;
+            auto &   children   = m_heightRanges[level + 1];
+            auto &   ranges     = m_heightRanges[level];
+
+            ranges.resize(nodesCount * nodesCount);
+            for (uint32_t y = 0; y < nodesCount; ++y)
+            {
+                for (uint32_t x = 0; x < nodesCount; ++x)
+                {
+                    auto & c00 = children[(2 * y + 0) * (2 * nodesCount) + 2 * x + 0];
+                    auto & c10 = children[(2 * y + 0) * (2 * nodesCount) + 2 * x + 1];
+                    auto & c01 = children[(2 * y + 1) * (2 * nodesCount) + 2 * x + 0];
+                    auto & c11 = children[(2 * y + 1) * (2 * nodesCount) + 2 * x + 1];
+
+                    ranges[y * nodesCount + x] = glm::u16vec2(glm::min(glm::min(c00.x, c10.x), glm::min(c01.x, c11.x)),
+                                                              glm::max(glm::max(c00.y, c10.y), glm::max(c01.y, c11.y)));
+                }
+            }
+        }
+
+        m_tilesStart = uint64_t(file.tellg());
+
+        return bool(file);
+    }
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include "Mango/Core/Base.h"
+
+#include <filesystem>
+#include <glm/glm.hpp>
+#include <glm/gtc/type_precision.hpp>
+#include <string>
+#include <vector>
+
+namespace mango
+{
+    /*
+     * Heightmap of a terrain (see TerrainComponent) split into square tiles, so the full resolution can be streamed in.
+     * The source image is cooked on the first use into a .mgterrain file next to it: a low resolution overview of the whole
+     * terrain, the height range of every tile and the 16 bit samples of the tiles. The overview and the height ranges stay
+     * in memory, the tiles are read on demand by the renderer and the physics. Cooked again when the source image changes.
+     */
+    class TerrainHeightmap
+    {
+    public:
+        static const uint32_t TILE_SIZE     = 256; // quads along a side of a tile, the tiles have TILE_SIZE + 1 samples, so the neighbours share the edges
+        static const uint32_t OVERVIEW_SIZE = 256; // quads along a side of the overview
+        static const uint32_t MAX_TILES     = 64;  // along a side
+
+        explicit TerrainHeightmap(const std::string & filename) : m_filename(filename) {}
+
+        TerrainHeightmap(const TerrainHeightmap &)             = delete;
+        TerrainHeightmap & operator=(const TerrainHeightmap &) = delete;
+
+        // Cooks the tiles if the cooked file is missing or stale, then reads the overview and the height ranges
+        bool load();
+
+        // Set on the main thread when the load on the worker thread has succeeded (see AssetManager::createTerrainHeightmapFromFile)
+        bool isLoaded() const { return m_isLoaded; }
+
+        const std::string & getFilename() const { return m_filename; }
+
+        uint32_t getTilesCount() const { return m_tilesCount; } // along a side, power of two
+        uint32_t getTileLevel()  const { return m_tileLevel;  } // depth of the quadtree nodes as large as a tile
+
+        // (OVERVIEW_SIZE + 1)^2 samples of the whole terrain
+        const std::vector<uint16_t> & getOverview() const { return m_overview; }
+
+        // Normalized min and max heights of the quadtree node, deeper nodes than the tile level get the range of their tile
+        glm::vec2 getHeightRange(uint32_t depth, uint32_t x, uint32_t y) const;
+
+        // Reads the (TILE_SIZE + 1)^2 samples of the tile, safe to call from the worker threads
+        bool readTile(uint32_t x, uint32_t y, std::vector<uint16_t> & samples) const;
+
+    private:
+        bool cook(const std::filesystem::path & sourcePath, const std::filesystem::path & cookedPath, uint64_t sourceHash);
+        bool readCooked(const std::filesystem::path & cookedPath, uint64_t sourceHash);
+
+    private:
+        std::string           m_filename;
+        std::filesystem::path m_cookedPath;
+
+        uint32_t m_tilesCount = 0;
+        uint32_t m_tileLevel  = 0;
+        uint64_t m_tilesStart = 0; // byte offset of the first tile in the cooked file
+
+        std::vector<uint16_t> m_overview;
+
+        // Min and max of the nodes down to the tile level, the level l has 4^l nodes
+        std::vector<std::vector<glm::u16vec2>> m_heightRanges;
+
+        bool m_isLoaded = false;
+
+        friend class AssetManager;
+    };
+}
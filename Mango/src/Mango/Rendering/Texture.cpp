@@ -1,5 +1,6 @@
 #include "mgpch.h"
 #include "Texture.h"
+#include "GPUUploads.h"
 
 #include "glm/common.hpp"
 #include "glm/exponential.hpp"
@@ -14,6 +15,34 @@ using namespace tinyddsloader;
 
 namespace
 {
+    // Size of an uncompressed image, as passed to glTextureSubImage*
+    [[maybe_unused]] uint64_t imageSizeBytes(GLenum format, GLenum type, uint64_t width, uint64_t height, uint64_t depth = 1)
+    {
+        uint64_t channelsCount = 4;
+        switch (format)
+        {
+            case GL_RED:  channelsCount = 1; break;
+            case GL_RG:   channelsCount = 2; break;
+            case GL_RGB:  channelsCount = 3; break;
+        }
+
+        uint64_t channelSize = (type == GL_FLOAT) ? sizeof(float) : sizeof(uint8_t);
+
+        return width * height * depth * channelsCount * channelSize;
+    }
+
+    // Instead of stbi_set_flip_vertically_on_load, which is global and the images are decoded on many threads
+    void flipRows(uint8_t* data, uint64_t rowSize, uint64_t rowsCount)
+    {
+        std::vector<uint8_t> row(rowSize);
+        for (uint64_t top = 0, bottom = rowsCount - 1; top < bottom; ++top, --bottom)
+        {
+            std::memcpy(row.data(),             data + top    * rowSize, rowSize);
+            std::memcpy(data + top    * rowSize, data + bottom * rowSize, rowSize);
+            std::memcpy(data + bottom * rowSize, row.data(),             rowSize);
+        }
+    }
+
     struct GLFormat
     {
         DDSFile::DXGIFormat dxgiFormat;
@@ -35,6 +64,7 @@ namespace
             { GL_RED,  GL_GREEN, GL_BLUE, GL_ONE   },
             { GL_RED,  GL_ZERO,  GL_ZERO, GL_ZERO  },
             { GL_RED,  GL_GREEN, GL_ZERO, GL_ZERO  },
+            { GL_RED,  GL_RED,   GL_RED,  GL_ONE   },
         };
 
         using DXGIFmt = DDSFile::DXGIFormat;
@@ -47,12 +77,16 @@ namespace
             { DXGIFmt::R32G32_Float,        GL_FLOAT,         GL_RG,                                    GL_RG32F,                                 sws[0] },
             { DXGIFmt::R32G32B32A32_Float,  GL_FLOAT,         GL_RGBA,                                  GL_RGBA32F,                               sws[0] },
             { DXGIFmt::BC1_UNorm,           0,                GL_COMPRESSED_RGBA_S3TC_DXT1_EXT,         GL_COMPRESSED_RGBA_S3TC_DXT1_EXT,         sws[0] },
+            { DXGIFmt::BC1_UNorm_SRGB,      0,                GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT,   GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT,   sws[0] },
             { DXGIFmt::BC2_UNorm,           0,                GL_COMPRESSED_RGBA_S3TC_DXT3_EXT,         GL_COMPRESSED_RGBA_S3TC_DXT3_EXT,         sws[0] },
             { DXGIFmt::BC3_UNorm,           0,                GL_COMPRESSED_RGBA_S3TC_DXT5_EXT,         GL_COMPRESSED_RGBA_S3TC_DXT5_EXT,         sws[0] },
-            { DXGIFmt::BC4_UNorm,           0,                GL_COMPRESSED_RED_RGTC1_EXT,              GL_COMPRESSED_RED_RGTC1_EXT,              sws[0] },
+            { DXGIFmt::BC3_UNorm_SRGB,      0,                GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT,   GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT,   sws[0] },
+            { DXGIFmt::BC4_UNorm,           0,                GL_COMPRESSED_RED_RGTC1_EXT,              GL_COMPRESSED_RED_RGTC1_EXT,              sws[6] }, // grayscale, e.g. cooked specular
             { DXGIFmt::BC4_SNorm,           0,                GL_COMPRESSED_SIGNED_RED_RGTC1_EXT,       GL_COMPRESSED_SIGNED_RED_RGTC1_EXT,       sws[0] },
             { DXGIFmt::BC5_UNorm,           0,                GL_COMPRESSED_RED_GREEN_RGTC2_EXT,        GL_COMPRESSED_RED_GREEN_RGTC2_EXT,        sws[0] },
             { DXGIFmt::BC5_SNorm,           0,                GL_COMPRESSED_SIGNED_RED_GREEN_RGTC2_EXT, GL_COMPRESSED_SIGNED_RED_GREEN_RGTC2_EXT, sws[0] },
+            { DXGIFmt::BC7_UNorm,           0,                GL_COMPRESSED_RGBA_BPTC_UNORM,            GL_COMPRESSED_RGBA_BPTC_UNORM,            sws[0] },
+            { DXGIFmt::BC7_UNorm_SRGB,      0,                GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM,      GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM,      sws[0] },
         };
 
         for (const auto& format : formats)
@@ -85,11 +119,34 @@ namespace
             case GL_COMPRESSED_SIGNED_RED_RGTC1_EXT:
             case GL_COMPRESSED_RED_GREEN_RGTC2_EXT:
             case GL_COMPRESSED_SIGNED_RED_GREEN_RGTC2_EXT:
+            case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT:
+            case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:
+            case GL_COMPRESSED_RGBA_BPTC_UNORM:
+            case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM:
                 return true;
             default:
                 return false;
         }
     }
+
+    // The sampler state the materials set on their textures, the rest keeps the defaults
+    void copySamplerParameters(GLuint source, GLuint destination)
+    {
+        for (GLenum parameter : { GL_TEXTURE_MIN_FILTER, GL_TEXTURE_MAG_FILTER, GL_TEXTURE_WRAP_S, GL_TEXTURE_WRAP_T })
+        {
+            GLint value = 0;
+            glGetTextureParameteriv(source,      parameter, &value);
+            glTextureParameteri    (destination, parameter, value);
+        }
+
+        GLint swizzle[4] = {};
+        glGetTextureParameteriv(source,      GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+        glTextureParameteriv   (destination, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+
+        GLfloat anisotropy = 1.0f;
+        glGetTextureParameterfv(source,      GL_TEXTURE_MAX_ANISOTROPY, &anisotropy);
+        glTextureParameterf    (destination, GL_TEXTURE_MAX_ANISOTROPY, anisotropy);
+    }
 }
 
 namespace mango
@@ -277,25 +334,30 @@ namespace mango
         }
     }
 
-    uint8_t* Texture::load(const std::string& filename, bool isSrgb, bool flip /*= true*/)
+    bool Texture::decodeImage(const std::string& filename, TextureImage& image, bool flip /*= true*/)
     {
         MG_PROFILE_ZONE_SCOPED;
 
         auto filepath = VFI::getFilepath(filename);
-        
-        if (flip) stbi_set_flip_vertically_on_load(true);
 
         int width, height, channelsCount;
         uint8_t* data = stbi_load(filepath.string().c_str(), &width, &height, &channelsCount, 0);
-        
-        if (flip) stbi_set_flip_vertically_on_load(false);
 
-        if (data)
+        if (!data)
         {
-            setDescriptor(width, height, channelsCount, isSrgb);
+            return false;
         }
 
-        return data;
+        if (flip) flipRows(data, uint64_t(width) * channelsCount, height);
+
+        image.pixels.assign(data, data + uint64_t(width) * height * channelsCount);
+        image.width         = width;
+        image.height        = height;
+        image.channelsCount = channelsCount;
+
+        stbi_image_free(data);
+
+        return true;
     }
 
     uint8_t* Texture::load(uint8_t* memoryData, uint64_t dataSize, bool isSrgb)
@@ -318,15 +380,14 @@ namespace mango
         MG_PROFILE_ZONE_SCOPED;
 
         auto filepath = VFI::getFilepath(filename);
-        if (flip) stbi_set_flip_vertically_on_load(true);
 
         int width, height, channelsCount;
         float* data = stbi_loadf(filepath.string().c_str(), &width, &height, &channelsCount, 3);
 
-        if (flip) stbi_set_flip_vertically_on_load(false);
-
         if (data)
         {
+            if (flip) flipRows(reinterpret_cast<uint8_t*>(data), uint64_t(width) * 3 * sizeof(float), height);
+
             m_descriptor.width          = width;
             m_descriptor.height         = height;
             m_descriptor.format         = GL_RGB;
@@ -339,23 +400,32 @@ namespace mango
     bool Texture::createTexture2d(const std::string& filename, bool isSrgb, uint32_t mipmapLevels)
     {
         MG_PROFILE_ZONE_SCOPED;
-        MG_PROFILE_GL_ZONE("Texture::createTexture2d");
-
-        m_filename = filename;
-        auto data = load(filename, isSrgb);
 
-        if (!data)
+        TextureImage image;
+        if (!decodeImage(filename, image))
         {
             MG_CORE_ERROR("Texture failed to load at path: {}", VFI::getFilepath(filename));
             return false;
         }
 
+        m_filename = filename;
+        return createTexture2d(image, isSrgb, mipmapLevels);
+    }
+
+    bool Texture::createTexture2d(const TextureImage& image, bool isSrgb, uint32_t mipmapLevels)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+        MG_PROFILE_GL_ZONE("Texture::createTexture2d");
+
+        setDescriptor(image.width, image.height, image.channelsCount, isSrgb);
+
         const GLuint maxMipmapLevels = calcMaxMipMapsLevels(m_descriptor.width, m_descriptor.height, 0);
                      mipmapLevels    = mipmapLevels == 0 ? maxMipmapLevels : glm::clamp(mipmapLevels, 1u, maxMipmapLevels);
 
         glCreateTextures       (GLenum(TextureType::Texture2D), 1, &m_id);
         glTextureStorage2D     (m_id, mipmapLevels, m_descriptor.internalFormat, m_descriptor.width, m_descriptor.height);
-        glTextureSubImage2D    (m_id, 0 /* level */, 0 /* xoffset */, 0 /* yoffset */, m_descriptor.width, m_descriptor.height, m_descriptor.format, GL_UNSIGNED_BYTE, data);
+        GPUUploads::uploadTexture2D(m_id, 0 /* level */, 0 /* xoffset */, 0 /* yoffset */, m_descriptor.width, m_descriptor.height, m_descriptor.format, GL_UNSIGNED_BYTE, image.pixels.data(),
+                                    image.pixels.size());
         glGenerateTextureMipmap(m_id);
 
         setFiltering (TextureFiltering::MIN,       TextureFilteringParam::LINEAR_MIP_LINEAR);
@@ -364,8 +434,6 @@ namespace mango
         setWraping   (TextureWrapingCoordinate::T, TextureWrapingParam::REPEAT);
         setAnisotropy(16.0f);
 
-        stbi_image_free(data);
-
         return true;
     }
 
@@ -403,6 +471,7 @@ namespace mango
                             m_descriptor.format,
                             GL_UNSIGNED_BYTE,
                             pixelData);
+        MG_RENDER_STATS_ADD(bytesUploaded, sizeof(pixelData));
 
         setFiltering(TextureFiltering::MIN,       TextureFilteringParam::NEAREST);
         setFiltering(TextureFiltering::MAG,       TextureFilteringParam::NEAREST);
@@ -412,6 +481,115 @@ namespace mango
         return true;
     }
 
+    bool Texture::createTexture2dArray(GLenum internalFormat, uint32_t width, uint32_t height, uint32_t mipmapLevels, uint32_t layersCount)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+        MG_PROFILE_GL_ZONE("Texture::createTexture2dArray");
+
+        m_descriptor.type           = GL_TEXTURE_2D_ARRAY;
+        m_descriptor.internalFormat = internalFormat;
+        m_descriptor.mipLevels      = mipmapLevels;
+        m_descriptor.width          = width;
+        m_descriptor.height         = height;
+        m_descriptor.depth          = layersCount;
+
+        glCreateTextures  (m_descriptor.type, 1, &m_id);
+        glTextureStorage3D(m_id, mipmapLevels, internalFormat, width, height, layersCount);
+
+        setFiltering(TextureFiltering::MIN, mipmapLevels > 1 ? TextureFilteringParam::LINEAR_MIP_LINEAR : TextureFilteringParam::LINEAR);
+        setFiltering(TextureFiltering::MAG, TextureFilteringParam::LINEAR);
+
+        return true;
+    }
+
+    void Texture::copySamplerState(const Texture& source)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        copySamplerParameters(source.m_id, m_id);
+    }
+
+    void Texture::replaceWithLayerView(const Texture& array, uint32_t layer)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+        MG_PROFILE_GL_ZONE("Texture::replaceWithLayerView");
+
+        // The name of a view can't be initialized before glTextureView, so it's generated instead of created
+        GLuint view = 0;
+        glGenTextures(1, &view);
+        glTextureView(view, GL_TEXTURE_2D, array.m_id, array.m_descriptor.internalFormat, 0, array.m_descriptor.mipLevels, layer, 1);
+
+        copySamplerParameters(m_id, view);
+
+        release();
+        m_id = view;
+    }
+
+    void Texture::copyToLayer(const Texture& source, uint32_t layer)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+        MG_PROFILE_GL_ZONE("Texture::copyToLayer");
+
+        for (uint32_t level = 0; level < m_descriptor.mipLevels; ++level)
+        {
+            GLsizei width  = std::max(m_descriptor.width  >> level, 1u);
+            GLsizei height = std::max(m_descriptor.height >> level, 1u);
+
+            glCopyImageSubData(source.m_id, GL_TEXTURE_2D,       level, 0, 0, 0,
+                               m_id,        GL_TEXTURE_2D_ARRAY, level, 0, 0, layer,
+                               width, height, 1);
+        }
+    }
+
+    bool Texture::createCompressedTexture2d(GLenum internalFormat, uint32_t width, uint32_t height, uint32_t mipmapLevels)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+        MG_PROFILE_GL_ZONE("Texture::createCompressedTexture2d");
+
+        m_descriptor.type           = GL_TEXTURE_2D;
+        m_descriptor.format         = internalFormat;
+        m_descriptor.internalFormat = internalFormat;
+        m_descriptor.mipLevels      = mipmapLevels;
+        m_descriptor.width          = width;
+        m_descriptor.height         = height;
+        m_descriptor.depth          = 1;
+        m_descriptor.compressed     = true;
+
+        glCreateTextures  (m_descriptor.type, 1, &m_id);
+        glTextureStorage2D(m_id, mipmapLevels, internalFormat, width, height);
+
+        setFiltering     (TextureFiltering::MIN,       mipmapLevels > 1 ? TextureFilteringParam::LINEAR_MIP_LINEAR : TextureFilteringParam::LINEAR);
+        setFiltering     (TextureFiltering::MAG,       TextureFilteringParam::LINEAR);
+        setWraping       (TextureWrapingCoordinate::S, TextureWrapingParam::REPEAT);
+        setWraping       (TextureWrapingCoordinate::T, TextureWrapingParam::REPEAT);
+        setMaxMipmapLevel(mipmapLevels - 1);
+
+        // The grayscale textures are cooked to BC4, sampled as (r, r, r, 1) like in translateDdsFormat
+        if (internalFormat == GL_COMPRESSED_RED_RGTC1_EXT)
+        {
+            m_descriptor.swizzles = glm::ivec4(GL_RED, GL_RED, GL_RED, GL_ONE);
+            setSwizzle(m_descriptor.swizzles);
+        }
+
+        return true;
+    }
+
+    void Texture::copyMips(const Texture& source, uint32_t sourceLevel, uint32_t level, uint32_t levelsCount)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+        MG_PROFILE_GL_ZONE("Texture::copyMips");
+
+        for (uint32_t i = 0; i < levelsCount; ++i)
+        {
+            GLsizei width  = std::max(m_descriptor.width  >> (level + i), 1u);
+            GLsizei height = std::max(m_descriptor.height >> (level + i), 1u);
+
+            glCopyImageSubData(source.m_id, GL_TEXTURE_2D, sourceLevel + i, 0, 0, 0,
+                               m_id,        GL_TEXTURE_2D, level       + i, 0, 0, 0,
+                               width, height, 1);
+        }
+    }
+
     bool Texture::createTexture2dFromMemory(uint8_t* memoryData, uint64_t dataSize, bool isSrgb, uint32_t mipmapLevels)
     {
         MG_PROFILE_ZONE_SCOPED;
@@ -431,7 +609,8 @@ namespace mango
 
         glCreateTextures       (GLenum(TextureType::Texture2D), 1, &m_id);
         glTextureStorage2D     (m_id, mipmapLevels /* levels */, m_descriptor.internalFormat, m_descriptor.width, m_descriptor.height);
-        glTextureSubImage2D    (m_id, 0 /* level */, 0 /* xoffset */, 0 /* yoffset */, m_descriptor.width, m_descriptor.height, m_descriptor.format, GL_UNSIGNED_BYTE, data);
+        GPUUploads::uploadTexture2D(m_id, 0 /* level */, 0 /* xoffset */, 0 /* yoffset */, m_descriptor.width, m_descriptor.height, m_descriptor.format, GL_UNSIGNED_BYTE, data,
+                                    imageSizeBytes(m_descriptor.format, GL_UNSIGNED_BYTE, m_descriptor.width, m_descriptor.height));
         glGenerateTextureMipmap(m_id);
 
         setFiltering(TextureFiltering::MIN,       TextureFilteringParam::LINEAR_MIP_LINEAR);
@@ -463,7 +642,8 @@ namespace mango
 
         glCreateTextures       (GLenum(TextureType::Texture2D), 1, &m_id);
         glTextureStorage2D     (m_id, 1 /* levels */, m_descriptor.internalFormat, m_descriptor.width, m_descriptor.height);
-        glTextureSubImage2D    (m_id, 0 /* level */, 0 /* xoffset */, 0 /* yoffset */, m_descriptor.width, m_descriptor.height, m_descriptor.format, GL_FLOAT, data);
+        GPUUploads::uploadTexture2D(m_id, 0 /* level */, 0 /* xoffset */, 0 /* yoffset */, m_descriptor.width, m_descriptor.height, m_descriptor.format, GL_FLOAT, data,
+                                    imageSizeBytes(m_descriptor.format, GL_FLOAT, m_descriptor.width, m_descriptor.height));
         glGenerateTextureMipmap(m_id);
 
         setFiltering(TextureFiltering::MIN,       TextureFilteringParam::LINEAR);
@@ -476,7 +656,7 @@ namespace mango
         return true;
     }
 
-    bool Texture::createTextureDDS(const std::string& filename)
+    bool Texture::createTextureDDS(const std::string& filename, bool flip /*= true*/)
     {
         MG_PROFILE_ZONE_SCOPED;
         MG_PROFILE_GL_ZONE("Texture::createTextureDDS");
@@ -537,11 +717,20 @@ namespace mango
         setSwizzle       (format.swizzle);
 
         glTextureStorage2D(m_id, m_descriptor.mipLevels, format.internalFormat, m_descriptor.width, m_descriptor.height);
-        dds.Flip();
+
+        if (flip)
+        {
+            dds.Flip();
+        }
 
         for (uint32_t level = 0; level < dds.GetMipCount(); level++)
         {
             auto imageData = dds.GetImageData(level, 0);
+            if (m_descriptor.type != GL_TEXTURE_2D) // the 2D levels are counted by GPUUploads
+            {
+                MG_RENDER_STATS_ADD(bytesUploaded, uint64_t(imageData->m_memSlicePitch) * imageData->m_depth);
+            }
+
             switch (m_descriptor.type)
             {
                 case GL_TEXTURE_1D:
@@ -566,11 +755,11 @@ namespace mango
 
                     if (m_descriptor.compressed)
                     {
-                        glCompressedTextureSubImage2D(m_id, level, 0, 0, w, h, format.format, imageData->m_memSlicePitch, imageData->m_mem);
+                        GPUUploads::uploadCompressedTexture2D(m_id, level, 0, 0, w, h, format.format, imageData->m_mem, imageData->m_memSlicePitch);
                     }
                     else
                     {
-                        glTextureSubImage2D(m_id, level, 0, 0, w, h, format.format, format.type, imageData->m_mem);
+                        GPUUploads::uploadTexture2D(m_id, level, 0, 0, w, h, format.format, format.type, imageData->m_mem, imageData->m_memSlicePitch);
                     }
                     break;
                 }
@@ -600,42 +789,48 @@ namespace mango
     bool Texture::createTextureCubeMap(const std::string* filenames, bool isSrgb, uint32_t mipmapLevels)
     {
         MG_PROFILE_ZONE_SCOPED;
-        MG_PROFILE_GL_ZONE("Texture::createTextureCubeMap");
 
-        constexpr int NUM_FACES = 6;
+        TextureImage images[CUBE_MAP_FACES_COUNT];
 
-        uint8_t* images_data[NUM_FACES];
-
-        for (int i = 0; i < NUM_FACES; ++i)
+        for (uint32_t i = 0; i < CUBE_MAP_FACES_COUNT; ++i)
         {
-            images_data[i] = load(filenames[i], isSrgb, false);
-
-            if (!images_data[i])
+            if (!decodeImage(filenames[i], images[i], false))
             {
                 MG_CORE_ERROR("Texture failed to load at path: {}", VFI::getFilepath(filenames[i]));
                 return false;
             }
         }
 
+        return createTextureCubeMap(images, isSrgb, mipmapLevels);
+    }
+
+    bool Texture::createTextureCubeMap(const TextureImage* images, bool isSrgb, uint32_t mipmapLevels)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+        MG_PROFILE_GL_ZONE("Texture::createTextureCubeMap");
+
+        setDescriptor(images[0].width, images[0].height, images[0].channelsCount, isSrgb);
+
         const GLuint maxMipmapLevels = calcMaxMipMapsLevels(m_descriptor.width, m_descriptor.height, 0);
                      mipmapLevels    = mipmapLevels == 0 ? maxMipmapLevels : glm::clamp(mipmapLevels, 1u, maxMipmapLevels);
 
         glCreateTextures  (GLenum(TextureType::TextureCubeMap), 1, &m_id);
         glTextureStorage2D(m_id, mipmapLevels, m_descriptor.internalFormat, m_descriptor.width, m_descriptor.height);
 
-        for (int i = 0; i < NUM_FACES; ++i)
+        for (uint32_t i = 0; i < CUBE_MAP_FACES_COUNT; ++i)
         {
-            glTextureSubImage3D(m_id, 
-                                0 /*level*/, 
-                                0 /*xoffset*/, 
-                                0 /*yoffset*/,
-                                i /*zoffset*/,
-                                m_descriptor.width,
-                                m_descriptor.height,
-                                1 /*depth*/,
-                                m_descriptor.format,
-                                GL_UNSIGNED_BYTE,
-                                images_data[i]);
+            GPUUploads::uploadTexture3D(m_id,
+                                        0 /*level*/,
+                                        0 /*xoffset*/,
+                                        0 /*yoffset*/,
+                                        i /*zoffset*/,
+                                        m_descriptor.width,
+                                        m_descriptor.height,
+                                        1 /*depth*/,
+                                        m_descriptor.format,
+                                        GL_UNSIGNED_BYTE,
+                                        images[i].pixels.data(),
+                                        images[i].pixels.size());
         }
 
         glGenerateTextureMipmap(m_id);
@@ -646,11 +841,6 @@ namespace mango
         setWraping  (TextureWrapingCoordinate::T, TextureWrapingParam::CLAMP_TO_EDGE);
         setWraping  (TextureWrapingCoordinate::R, TextureWrapingParam::CLAMP_TO_EDGE);
 
-        for (int i = 0; i < NUM_FACES; ++i)
-        {
-            stbi_image_free(images_data[i]);
-        }
-
         return true;
     }
 }
@@ -1,13 +1,15 @@
 #pragma once
 #include <cmath>
 #include <string>
+#include <vector>
 
 #include "glad/glad.h"
 #include "glm/vec4.hpp"
+#include "Mango/Profiling/RenderStats.h"
 
 namespace mango
 {
-    enum class TextureType              { NONE = 0, Texture2D = GL_TEXTURE_2D, TextureCubeMap = GL_TEXTURE_CUBE_MAP };
+    enum class TextureType              { NONE = 0, Texture2D = GL_TEXTURE_2D, Texture2DArray = GL_TEXTURE_2D_ARRAY, TextureCubeMap = GL_TEXTURE_CUBE_MAP };
     enum class TextureFiltering         { MAG                  = GL_TEXTURE_MAG_FILTER,
                                           MIN                  = GL_TEXTURE_MIN_FILTER };
     enum class TextureFilteringParam    { NEAREST              = GL_NEAREST,
@@ -99,9 +101,20 @@ namespace mango
         bool               compressed     = false;
     };
 
+    // Pixels decoded by stb_image, see Texture::decodeImage
+    struct TextureImage
+    {
+        std::vector<uint8_t> pixels;
+        int                  width         = 0;
+        int                  height        = 0;
+        int                  channelsCount = 0;
+    };
+
     class Texture final
     {
     public:
+        static constexpr uint32_t CUBE_MAP_FACES_COUNT = 6;
+
         Texture() : m_id(0) {}
         ~Texture() { release(); };
 
@@ -126,7 +139,7 @@ namespace mango
             return *this;
         }
 
-        void bind             (uint32_t unit) const { glBindTextureUnit(unit, m_id); }
+        void bind             (uint32_t unit) const { MG_RENDER_STATS_INC(textureBinds); glBindTextureUnit(unit, m_id); }
         void setFiltering     (TextureFiltering type, TextureFilteringParam param);
         void setMinLod        (float min);
         void setMaxLod        (float max);
@@ -142,15 +155,38 @@ namespace mango
         bool createTexture2d1x1       (const glm::uvec4& color);
         bool createTexture2dFromMemory(uint8_t* memory_data, uint64_t dataSize, bool isSrgb = false, uint32_t mipmapLevels = 0);
         bool createTexture2dHDR       (const std::string& filename, uint32_t mipmapLevels = 0);
-        bool createTextureDDS         (const std::string& filename);
+        bool createTextureDDS         (const std::string& filename, bool flip = true); // the cooked textures are stored bottom-up already
         bool createTextureCubeMap     (const std::string* filenames, bool isSrgb = false, uint32_t mipmapLevels = 0);
 
+        // From the images decoded earlier, e.g. on the worker threads by AssetManager::createTexture2DAsync
+        bool createTexture2d     (const TextureImage& image,  bool isSrgb = false, uint32_t mipmapLevels = 0);
+        bool createTextureCubeMap(const TextureImage* images, bool isSrgb = false, uint32_t mipmapLevels = 0);
+
+        // Empty layers, filled with copyToLayer from the 2D textures of the same internal format, size and mip levels
+        bool createTexture2dArray(GLenum internalFormat, uint32_t width, uint32_t height, uint32_t mipmapLevels, uint32_t layersCount);
+        void copyToLayer         (const Texture& source, uint32_t layer);
+
+        // Filtering, wrapping, anisotropy and swizzle
+        void copySamplerState(const Texture& source);
+
+        // Releases the storage of the 2D texture and makes it a view of the layer of the array with the same content (see copyToLayer),
+        // so it can still be sampled on its own. The sampler state is kept, the storage of the array lives as long as its views
+        void replaceWithLayerView(const Texture& array, uint32_t layer);
+
+        // Empty block compressed storage, filled by TextureStreaming with the mips of the cooked textures
+        bool createCompressedTexture2d(GLenum internalFormat, uint32_t width, uint32_t height, uint32_t mipmapLevels);
+        // Copies levelsCount levels of the source, starting at sourceLevel, to the levels starting at level
+        void copyMips                 (const Texture& source, uint32_t sourceLevel, uint32_t level, uint32_t levelsCount);
+
         TextureDescriptor getDescriptor() const { return m_descriptor; }
         std::string&      getFilename()         { return m_filename;   }
         uint32_t          getRendererID() const { return m_id;         }
 
         void setName(const std::string& name) { m_filename = name; }
 
+        // No GL calls, so it's safe on the worker threads
+        static bool decodeImage(const std::string& filename, TextureImage& image, bool flip = true);
+
         static uint8_t calcMaxMipMapsLevels(uint32_t width, uint32_t height, uint32_t depth)
         {
             uint8_t num_levels = 1 + std::floor(std::log2(std::max(width, std::max(height, depth))));
@@ -160,7 +196,6 @@ namespace mango
     private:
         void setDescriptor(int width, int height, int channelsCount, bool isSrgb);
 
-        uint8_t* load(const std::string& filename, bool isSrgb, bool flip = true);
         uint8_t* load(uint8_t* memoryData, uint64_t dataSize, bool isSrgb);
         float*   loadf(const std::string& filename, bool flip = true);
 
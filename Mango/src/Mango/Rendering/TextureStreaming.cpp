@@ -0,0 +1,500 @@
+#include "mgpch.h"
+
+#include "TextureStreaming.h"
+#include "GPUUploads.h"
+#include "Material.h"
+#include "Texture.h"
+#include "Mango/Core/Jobs.h"
+
+#include <deque>
+#include <fstream>
+#include <mutex>
+
+namespace mango
+{
+    namespace
+    {
+        const int32_t DEFAULT_BUDGET_MB = 512;
+
+        /* Layout of the DDS files written by TextureCooker: the magic, DDS_HEADER, DDS_HEADER_DXT10 and the mips one after another */
+        const uint32_t DDS_MAGIC               = 0x20534444; // "DDS "
+        const uint32_t DX10_FOURCC             = 0x30315844; // "DX10"
+        const uint64_t HEADER_HEIGHT_OFFSET    = 12;
+        const uint64_t HEADER_WIDTH_OFFSET     = 16;
+        const uint64_t HEADER_MIPS_OFFSET      = 28;
+        const uint64_t HEADER_FOURCC_OFFSET    = 84;
+        const uint64_t DX10_FORMAT_OFFSET      = 128;
+        const uint64_t DX10_DIMENSION_OFFSET   = 132;
+        const uint64_t DX10_ARRAY_SIZE_OFFSET  = 140;
+        const uint64_t DATA_OFFSET             = 148;
+        const uint32_t DIMENSION_TEXTURE2D     = 3;
+
+        struct CookedFormat
+        {
+            uint32_t dxgiFormat;
+            GLenum   internalFormat;
+            uint32_t blockSize;
+        };
+
+        const CookedFormat COOKED_FORMATS[] =
+        {
+            { 71, GL_COMPRESSED_RGBA_S3TC_DXT1_EXT,       8  },
+            { 72, GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT, 8  },
+            { 77, GL_COMPRESSED_RGBA_S3TC_DXT5_EXT,       16 },
+            { 78, GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT, 16 },
+            { 80, GL_COMPRESSED_RED_RGTC1_EXT,            8  },
+            { 83, GL_COMPRESSED_RED_GREEN_RGTC2_EXT,      16 },
+            { 98, GL_COMPRESSED_RGBA_BPTC_UNORM,          16 },
+            { 99, GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM,    16 },
+        };
+
+        struct StreamedTexture
+        {
+            std::weak_ptr<Texture> texture;
+            std::filesystem::path  filepath;
+            GLenum                 internalFormat = 0;
+            uint32_t               width          = 0; // of mip 0
+            uint32_t               height         = 0;
+            uint32_t               mipsCount      = 0;
+            std::vector<uint64_t>  mipOffsets;          // in the file, with the end of the last mip
+
+            uint32_t tailMip        = 0; // the mips from here on are always resident
+            uint32_t residentMip    = 0; // first resident mip, level 0 of the GL texture
+            uint32_t loadingMip     = 0; // first mip being read, equal to residentMip if there's no read in flight
+            uint32_t streamableMip  = 0; // the reads of the larger ones have failed
+
+            float    pixelsPerUV        = 0.0f; // the largest one requested in lastRequestedFrame
+            uint64_t lastRequestedFrame = 0;
+
+            uint64_t bytes(uint32_t firstMip, uint32_t lastMip) const { return mipOffsets[lastMip] - mipOffsets[firstMip]; }
+            uint32_t mipWidth (uint32_t mip)                    const { return std::max(width  >> mip, 1u); }
+            uint32_t mipHeight(uint32_t mip)                    const { return std::max(height >> mip, 1u); }
+            bool     isLoading()                                const { return loadingMip != residentMip; }
+        };
+
+        // Mips [firstMip, lastMip) read by a worker thread, laid out like in the file
+        struct ReadMips
+        {
+            const Texture *        key = nullptr;
+            std::weak_ptr<Texture> texture;
+            uint32_t               firstMip   = 0;
+            uint32_t               lastMip    = 0;
+            uint64_t               generation = 0;
+            std::vector<uint8_t>   data;
+            bool                   succeeded  = false;
+        };
+
+        struct TextureStreamingState
+        {
+            std::unordered_map<const Texture *, StreamedTexture> textures;
+
+            std::mutex           mutex;
+            std::deque<ReadMips> readMips;
+
+            uint64_t frame         = 1; // the requests of the renderer are counted in the frame since the last update
+            uint64_t generation    = 0; // of the reads, bumped by clear()
+            uint64_t residentBytes = 0; // of the streamed textures
+            uint64_t pendingBytes  = 0; // being read, or read and waiting for the upload budget
+
+            TextureStreaming::Statistics statistics;
+        };
+
+        TextureStreamingState & state()
+        {
+            static TextureStreamingState s;
+            return s;
+        }
+
+        uint32_t readUint32(const uint8_t * data, uint64_t offset)
+        {
+            uint32_t value;
+            std::memcpy(&value, data + offset, sizeof(value));
+
+            return value;
+        }
+
+        void uploadMips(GLuint textureID, const StreamedTexture & entry, uint32_t firstMip, uint32_t lastMip, uint32_t level0Mip, const uint8_t * data)
+        {
+            for (uint32_t mip = firstMip; mip < lastMip; ++mip)
+            {
+                GPUUploads::uploadCompressedTexture2D(textureID, GLint(mip - level0Mip), 0, 0, entry.mipWidth(mip), entry.mipHeight(mip), entry.internalFormat,
+                                                      data + entry.bytes(firstMip, mip), entry.bytes(mip, mip + 1));
+            }
+        }
+
+        // Reallocates the storage of the texture for the mips from newMip on. The kept mips are copied from the old storage,
+        // the added ones are uploaded from data that holds the mips [newMip, entry.residentMip)
+        void setResidentMip(StreamedTexture & entry, Texture & texture, uint32_t newMip, const uint8_t * data)
+        {
+            MG_PROFILE_ZONE_SCOPED;
+
+            auto & s = state();
+
+            Texture resized;
+            resized.createCompressedTexture2d(entry.internalFormat, entry.mipWidth(newMip), entry.mipHeight(newMip), entry.mipsCount - newMip);
+
+            uint32_t keptMip = std::max(newMip, entry.residentMip);
+            resized.copyMips(texture, keptMip - entry.residentMip, keptMip - newMip, entry.mipsCount - keptMip);
+
+            if (newMip < entry.residentMip)
+            {
+                uploadMips(resized.getRendererID(), entry, newMip, entry.residentMip, newMip, data);
+            }
+
+            s.residentBytes += entry.bytes(newMip, entry.mipsCount);
+            s.residentBytes -= entry.bytes(entry.residentMip, entry.mipsCount);
+
+            // The handles keep the Texture object, only its storage is swapped
+            texture = std::move(resized);
+
+            entry.residentMip = newMip;
+            entry.loadingMip  = newMip;
+        }
+
+        void startRead(StreamedTexture & entry, const Texture * key, uint32_t firstMip)
+        {
+            auto & s = state();
+
+            uint64_t bytes = entry.bytes(firstMip, entry.residentMip);
+
+            entry.loadingMip = firstMip;
+            s.pendingBytes  += bytes;
+
+            ReadMips read;
+            read.key        = key;
+            read.texture    = entry.texture;
+            read.firstMip   = firstMip;
+            read.lastMip    = entry.residentMip;
+            read.generation = s.generation;
+
+            Jobs::executor.silent_async([read = std::move(read), filepath = entry.filepath, offset = entry.mipOffsets[firstMip], bytes]() mutable
+            {
+                MG_PROFILE_ZONE_SCOPED;
+
+                std::ifstream file(filepath, std::ios::binary);
+
+                read.data.resize(bytes);
+                read.succeeded = file.is_open() && file.seekg(std::streamoff(offset)) && file.read(reinterpret_cast<char *>(read.data.data()), std::streamsize(bytes));
+
+                auto & s = state();
+                std::lock_guard<std::mutex> lock(s.mutex);
+                s.readMips.push_back(std::move(read));
+            });
+        }
+
+        // Drops the mips of the least recently requested textures until the resident and the pending bytes fit into the target.
+        // The textures requested in the last frame are evicted only if includeRequested is set, e.g. when the budget was lowered
+        void evict(uint64_t targetBytes, bool includeRequested)
+        {
+            MG_PROFILE_ZONE_SCOPED;
+
+            auto & s = state();
+
+            uint64_t committedBytes = s.residentBytes + s.pendingBytes;
+            if (committedBytes <= targetBytes) return;
+
+            std::vector<std::pair<const Texture *, StreamedTexture *>> candidates;
+            for (auto & [key, entry] : s.textures)
+            {
+                if (entry.residentMip == entry.tailMip || entry.isLoading())   continue;
+                if (!includeRequested && entry.lastRequestedFrame == s.frame) continue;
+
+                candidates.emplace_back(key, &entry);
+            }
+
+            // The least magnified ones go first among the textures requested in the same frame
+            std::sort(candidates.begin(), candidates.end(), [](auto & a, auto & b)
+            {
+                return std::make_pair(a.second->lastRequestedFrame, a.second->pixelsPerUV) < std::make_pair(b.second->lastRequestedFrame, b.second->pixelsPerUV);
+            });
+
+            for (auto & [key, entry] : candidates)
+            {
+                auto texture = entry->texture.lock();
+                if (!texture) continue;
+
+                uint32_t newMip = entry->residentMip;
+                while (newMip < entry->tailMip && committedBytes > targetBytes)
+                {
+                    committedBytes -= entry->bytes(newMip, newMip + 1);
+                    ++newMip;
+                }
+
+                s.statistics.evictedMips += newMip - entry->residentMip;
+                setResidentMip(*entry, *texture, newMip, nullptr);
+
+                if (committedBytes <= targetBytes) break;
+            }
+        }
+    }
+
+    bool TextureStreaming::createTexture(const ref<Texture> & texture, const std::string & cookedName)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+        MG_PROFILE_GL_ZONE("TextureStreaming::createTexture");
+
+        auto & s = state();
+
+        StreamedTexture entry;
+        entry.texture  = texture;
+        entry.filepath = VFI::getFilepath(cookedName);
+
+        std::ifstream file(entry.filepath, std::ios::binary | std::ios::ate);
+        if (!file.is_open()) return false;
+
+        const uint64_t fileSize = uint64_t(file.tellg());
+
+        uint8_t header[DATA_OFFSET];
+        if (fileSize < DATA_OFFSET || !file.seekg(0) || !file.read(reinterpret_cast<char *>(header), DATA_OFFSET)) return false;
+
+        if (readUint32(header, 0)                      != DDS_MAGIC           ||
+            readUint32(header, HEADER_FOURCC_OFFSET)   != DX10_FOURCC         ||
+            readUint32(header, DX10_DIMENSION_OFFSET)  != DIMENSION_TEXTURE2D ||
+            readUint32(header, DX10_ARRAY_SIZE_OFFSET) != 1)
+        {
+            return false;
+        }
+
+        const uint32_t dxgiFormat = readUint32(header, DX10_FORMAT_OFFSET);
+        auto           format     = std::find_if(std::begin(COOKED_FORMATS), std::end(COOKED_FORMATS), [dxgiFormat](auto & f) { return f.dxgiFormat == dxgiFormat; });
+        if (format == std::end(COOKED_FORMATS)) return false;
+
+        entry.internalFormat = format->internalFormat;
+        entry.width          = readUint32(header, HEADER_WIDTH_OFFSET);
+        entry.height         = readUint32(header, HEADER_HEIGHT_OFFSET);
+        entry.mipsCount      = std::max(readUint32(header, HEADER_MIPS_OFFSET), 1u);
+
+        if (entry.width == 0 || entry.height == 0 || entry.mipsCount > Texture::calcMaxMipMapsLevels(entry.width, entry.height, 1)) return false;
+
+        entry.mipOffsets.push_back(DATA_OFFSET);
+        for (uint32_t mip = 0; mip < entry.mipsCount; ++mip)
+        {
+            uint64_t blocks = uint64_t((entry.mipWidth(mip) + 3) / 4) * ((entry.mipHeight(mip) + 3) / 4);
+            entry.mipOffsets.push_back(entry.mipOffsets.back() + blocks * format->blockSize);
+        }
+
+        if (entry.mipOffsets.back() > fileSize) return false;
+
+        // The small textures are loaded whole, there's nothing to stream
+        while (entry.tailMip + 1 < entry.mipsCount && std::max(entry.mipWidth(entry.tailMip), entry.mipHeight(entry.tailMip)) > RESIDENT_TAIL_SIZE)
+        {
+            ++entry.tailMip;
+        }
+
+        if (entry.tailMip == 0) return false;
+
+        std::vector<uint8_t> tail(entry.bytes(entry.tailMip, entry.mipsCount));
+        if (!file.seekg(std::streamoff(entry.mipOffsets[entry.tailMip])) || !file.read(reinterpret_cast<char *>(tail.data()), std::streamsize(tail.size())))
+        {
+            return false;
+        }
+
+        Texture created;
+        created.createCompressedTexture2d(entry.internalFormat, entry.mipWidth(entry.tailMip), entry.mipHeight(entry.tailMip), entry.mipsCount - entry.tailMip);
+        uploadMips(created.getRendererID(), entry, entry.tailMip, entry.mipsCount, entry.tailMip, tail.data());
+
+        *texture = std::move(created);
+
+        entry.residentMip = entry.tailMip;
+        entry.loadingMip  = entry.tailMip;
+
+        // A texture destroyed without the update may have left its entry at the same address
+        if (auto it = s.textures.find(texture.get()); it != s.textures.end())
+        {
+            s.residentBytes -= it->second.bytes(it->second.residentMip, it->second.mipsCount);
+            s.pendingBytes  -= it->second.bytes(it->second.loadingMip,  it->second.residentMip);
+        }
+
+        s.residentBytes += entry.bytes(entry.residentMip, entry.mipsCount);
+        s.textures[texture.get()] = std::move(entry);
+
+        return true;
+    }
+
+    void TextureStreaming::requestMips(const Material & material, float pixelsPerUV)
+    {
+        auto & s = state();
+        if (s.textures.empty()) return;
+
+        for (auto & [type, texture] : material.getTextureMap())
+        {
+            auto it = s.textures.find(texture.get());
+            if (it == s.textures.end()) continue;
+
+            auto & entry = it->second;
+            if (entry.lastRequestedFrame != s.frame)
+            {
+                entry.lastRequestedFrame = s.frame;
+                entry.pixelsPerUV        = 0.0f;
+            }
+
+            entry.pixelsPerUV = std::max(entry.pixelsPerUV, pixelsPerUV);
+        }
+    }
+
+    bool TextureStreaming::update()
+    {
+        MG_PROFILE_ZONE_SCOPED;
+        MG_PROFILE_GL_ZONE("TextureStreaming::update");
+
+        auto & s = state();
+
+        s.statistics.streamedInMips = 0;
+        s.statistics.evictedMips    = 0;
+
+        /* Forget the textures that were destroyed, their reads are dropped when they finish */
+        std::erase_if(s.textures, [&s](auto & pair)
+        {
+            auto & entry = pair.second;
+            if (!entry.texture.expired()) return false;
+
+            s.residentBytes -= entry.bytes(entry.residentMip, entry.mipsCount);
+            s.pendingBytes  -= entry.bytes(entry.loadingMip,  entry.residentMip);
+
+            return true;
+        });
+
+        /* Upload the read mips within the per-frame budget of GPUUploads, at least one texture per update */
+        bool hasChanged = false;
+        while (true)
+        {
+            ReadMips read;
+            {
+                std::lock_guard<std::mutex> lock(s.mutex);
+                if (s.readMips.empty()) break;
+                if (hasChanged && GPUUploads::getRemainingBudget() < s.readMips.front().data.size()) break;
+
+                read = std::move(s.readMips.front());
+                s.readMips.pop_front();
+            }
+
+            auto it      = s.textures.find(read.key);
+            auto texture = read.texture.lock();
+            if (read.generation != s.generation || !texture || it == s.textures.end() || it->second.texture.lock() != texture) continue;
+
+            auto & entry = it->second;
+            if (entry.loadingMip != read.firstMip || entry.residentMip != read.lastMip) continue;
+
+            s.pendingBytes -= entry.bytes(read.firstMip, read.lastMip);
+
+            if (!read.succeeded)
+            {
+                MG_CORE_ERROR("TextureStreaming: can't read the mips of {}.", entry.filepath.string());
+
+                entry.loadingMip    = entry.residentMip;
+                entry.streamableMip = entry.residentMip;
+                continue;
+            }
+
+            setResidentMip(entry, *texture, read.firstMip, read.data.data());
+
+            s.statistics.streamedInMips += read.lastMip - read.firstMip;
+            hasChanged = true;
+        }
+
+        uint64_t budget = uint64_t(DEFAULT_BUDGET_MB) * 1024 * 1024;
+        if (auto budgetMB = CVarSystem::get()->getIntCVar("renderer.textureStreamingBudgetMB"))
+        {
+            budget = uint64_t(std::max(*budgetMB, 0)) * 1024 * 1024;
+        }
+
+        evict(budget, true);
+
+        /* The mips requested in the last frame, the blurriest textures first */
+        struct Wish
+        {
+            const Texture *   key;
+            StreamedTexture * entry;
+            uint32_t          mip;
+        };
+
+        std::vector<Wish> wishes;
+        uint64_t          wishedBytes = 0;
+
+        for (auto & [key, entry] : s.textures)
+        {
+            if (entry.lastRequestedFrame != s.frame || entry.isLoading()) continue;
+
+            // The mip whose texel covers a pixel
+            float    texelsPerPixel = float(std::max(entry.width, entry.height)) / std::max(entry.pixelsPerUV, 1.0f);
+            uint32_t mip            = uint32_t(std::max(std::floor(std::log2(texelsPerPixel)), 0.0f));
+
+            mip = std::clamp(mip, entry.streamableMip, entry.tailMip);
+            if (mip >= entry.residentMip) continue;
+
+            wishes.push_back({ key, &entry, mip });
+            wishedBytes += entry.bytes(mip, entry.residentMip);
+        }
+
+        std::sort(wishes.begin(), wishes.end(), [](const Wish & a, const Wish & b)
+        {
+            return a.entry->residentMip - a.mip > b.entry->residentMip - b.mip;
+        });
+
+        // The textures that weren't requested make the room
+        evict(budget - std::min(wishedBytes, budget), false);
+
+        for (auto & wish : wishes)
+        {
+            auto & entry = *wish.entry;
+
+            uint32_t mip = wish.mip;
+            while (mip < entry.residentMip && s.residentBytes + s.pendingBytes + entry.bytes(mip, entry.residentMip) > budget)
+            {
+                ++mip;
+            }
+
+            if (mip < entry.residentMip)
+            {
+                startRead(entry, wish.key, mip);
+            }
+        }
+
+        hasChanged |= s.statistics.evictedMips > 0;
+
+        ++s.frame;
+
+        s.statistics.texturesCount = uint32_t(s.textures.size());
+        s.statistics.loadingCount  = uint32_t(std::count_if(s.textures.begin(), s.textures.end(), [](auto & pair) { return pair.second.isLoading(); }));
+        s.statistics.residentBytes = s.residentBytes;
+        s.statistics.budgetBytes   = budget;
+
+        MG_PROGILE_PLOT_VALUE("Streamed Texture Bytes", int64_t(s.residentBytes));
+
+        return hasChanged;
+    }
+
+    bool TextureStreaming::isStreamed(const Texture * texture)
+    {
+        auto & s  = state();
+        auto   it = s.textures.find(texture);
+
+        return it != s.textures.end() && !it->second.texture.expired();
+    }
+
+    bool TextureStreaming::hasPendingLoads()
+    {
+        return state().pendingBytes > 0;
+    }
+
+    void TextureStreaming::clear()
+    {
+        auto & s = state();
+
+        s.textures.clear();
+        {
+            std::lock_guard<std::mutex> lock(s.mutex);
+            s.readMips.clear();
+        }
+
+        ++s.generation;
+        s.residentBytes = 0;
+        s.pendingBytes  = 0;
+        s.statistics    = {};
+    }
+
+    const TextureStreaming::Statistics & TextureStreaming::getStatistics()
+    {
+        return state().statistics;
+    }
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include "Mango/Core/Base.h"
+
+#include <cstdint>
+#include <string>
+
+namespace mango
+{
+    class Material;
+    class Texture;
+
+    /*
+     * Mip streaming of the cooked textures (see TextureCooker) under the VRAM budget renderer.textureStreamingBudgetMB.
+     * A texture is created with only the small mips of its chain (up to RESIDENT_TAIL_SIZE) and the renderer requests the larger ones
+     * per material with the screen space size of the texture coordinates (see RenderingSystem::requestTextureMips). The requested mips
+     * are read from the cooked file on the worker threads of Jobs::executor and uploaded on the main thread within the per-frame budget
+     * of GPUUploads. When the budget runs out the least recently requested textures drop their streamed mips.
+     * The storage holds only the resident mips: it's reallocated and the kept mips are copied on the GPU when the residency changes,
+     * so the evicted mips free the memory without the sparse textures. The handles keep pointing at the same Texture objects.
+     */
+    class TextureStreaming
+    {
+    public:
+        struct Statistics
+        {
+            uint32_t texturesCount   = 0;
+            uint32_t loadingCount    = 0; // textures with the mips being read
+            uint64_t residentBytes   = 0;
+            uint64_t budgetBytes     = 0;
+            uint32_t streamedInMips  = 0; // during the last update
+            uint32_t evictedMips     = 0;
+        };
+
+        // The mips up to this size stay resident, so every streamed texture can be sampled
+        static constexpr uint32_t RESIDENT_TAIL_SIZE = 128;
+
+        TextureStreaming() = delete;
+
+        // Creates the texture from the tail of the cooked DDS file. False if the file can't be streamed, e.g. it isn't a cooked one
+        static bool createTexture(const ref<Texture> & texture, const std::string & cookedName);
+
+        // Pixels that one unit of the texture coordinates covers on the screen, the largest one of the frame picks the mips of the textures
+        static void requestMips(const Material & material, float pixelsPerUV);
+
+        // Finishes the read mips, evicts the least recently requested ones over the budget and starts reading the newly requested ones.
+        // Called once per frame by the Application, returns true if any texture has changed
+        static bool update();
+
+        static bool isStreamed(const Texture * texture);
+        static bool hasPendingLoads();
+
+        // Forgets all of the textures, the reads in flight are dropped
+        static void clear();
+
+        // Of the last update
+        static const Statistics & getStatistics();
+    };
+}
@@ -0,0 +1,13 @@
+#include "mgpch.h"
+
+#include "VertexAnimation.h"
+
+namespace mango
+{
+    VertexAnimation::~VertexAnimation()
+    {
+        glDeleteTextures(1, &m_bonesTexture);
+        glDeleteBuffers (1, &m_boneWeightsVbo);
+        glDeleteBuffers (1, &m_boneIndicesVbo);
+    }
+}
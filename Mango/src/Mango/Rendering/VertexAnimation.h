@@ -0,0 +1,66 @@
+#pragma once
+#include "glad/glad.h"
+#include "Mango/Core/Base.h"
+#include "Mango/Rendering/Mesh.h"
+
+#include <glm/glm.hpp>
+#include <string>
+#include <vector>
+
+namespace mango
+{
+    /*
+     * Skinned mesh with all of its animation clips baked into a texture (vertex animation texture, see CrowdComponent).
+     * Every row of the texture is one sampled frame, every bone takes three RGBA32F texels with the rows of its 3x4 skinning matrix.
+     * The clips are laid out one after another, the vertex shader picks and interpolates the frames, so nothing is evaluated on the CPU.
+     * The bone weights and indices of the mesh are bound to the attributes 4 and 5.
+     */
+    class VertexAnimation
+    {
+    public:
+        struct Clip
+        {
+            std::string name;
+            uint32_t    firstFrame  = 0; // row of the bones texture
+            uint32_t    framesCount = 0;
+        };
+
+        static constexpr float    FRAMES_PER_SECOND    = 30.0f;
+        static constexpr uint32_t MAX_BONES_PER_VERTEX = 4;
+
+        explicit VertexAnimation(const std::string & filename) : m_filename(filename) {}
+        ~VertexAnimation();
+
+        VertexAnimation(const VertexAnimation &)             = delete;
+        VertexAnimation & operator=(const VertexAnimation &) = delete;
+
+        const std::string       & getFilename() const { return m_filename; }
+        const ref<Mesh>         & getMesh()     const { return m_mesh; }
+        const std::vector<Clip> & getClips()    const { return m_clips; }
+
+        GLuint   getBonesTexture() const { return m_bonesTexture; }
+        uint32_t getBonesCount()   const { return m_bonesCount; }
+        uint32_t getFramesCount()  const { return m_framesCount; }
+
+        // Object space bounding sphere enclosing every frame of every clip
+        const glm::vec3 & getBoundsCenter() const { return m_boundsCenter; }
+        float             getBoundsRadius() const { return m_boundsRadius; }
+
+    private:
+        std::string       m_filename;
+        ref<Mesh>         m_mesh;
+        std::vector<Clip> m_clips;
+
+        GLuint   m_bonesTexture   = 0;
+        GLuint   m_boneWeightsVbo = 0;
+        GLuint   m_boneIndicesVbo = 0;
+        uint32_t m_bonesCount     = 0;
+        uint32_t m_framesCount    = 0;
+
+        glm::vec3 m_boundsCenter = glm::vec3(0.0f);
+        float     m_boundsRadius = 0.0f;
+
+    private:
+        friend class AssimpMeshImporter;
+    };
+}
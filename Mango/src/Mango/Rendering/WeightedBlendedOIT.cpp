@@ -0,0 +1,95 @@
+#include "mgpch.h"
+
+#include "WeightedBlendedOIT.h"
+#include "Mango/Core/AssetManager.h"
+
+namespace mango
+{
+    void WeightedBlendedOIT::create(int width, int height)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+        MG_PROFILE_GL_ZONE("WeightedBlendedOIT::create");
+
+        if (!m_accumulationShader)
+        {
+            m_accumulationShader = AssetManager::createShader("Blending-OIT", "Blending.vert", "Blending-OIT.frag");
+            m_accumulationShader->requestLink();
+        }
+
+        std::vector<RenderTarget::MRTEntry> mrtEntries(2);
+        mrtEntries[GLuint(BufferPropertyName::ACCUMULATION)] = RenderTarget::MRTEntry(RenderTarget::AttachmentType::Color, RenderTarget::ColorInternalFormat::RGBA16F);
+        mrtEntries[GLuint(BufferPropertyName::REVEALAGE)]    = RenderTarget::MRTEntry(RenderTarget::AttachmentType::Color, RenderTarget::ColorInternalFormat::R16F);
+
+        // Depth of the scene is copied to the renderbuffer before the accumulation
+        m_oitBuffer = createRef<RenderTarget>();
+        m_oitBuffer->createMRT(mrtEntries, width, height, RenderTarget::RenderTargetType::Tex2D, false, RenderTarget::DepthInternalFormat::DEPTH32F_STENCIL8);
+        m_oitBuffer->setDynamicScaling(true);
+    }
+
+    void WeightedBlendedOIT::clear()
+    {
+        MG_PROFILE_ZONE_SCOPED;
+        MG_PROFILE_GL_ZONE("WeightedBlendedOIT::clear");
+
+        m_oitBuffer->clear();
+    }
+
+    void WeightedBlendedOIT::beginAccumulation(const ref<RenderTarget> & sceneRenderTarget)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+        MG_PROFILE_GL_ZONE("WeightedBlendedOIT::beginAccumulation");
+
+        auto viewportSize = m_oitBuffer->getViewportSize();
+
+        sceneRenderTarget->bindReadOnly();
+        m_oitBuffer->bindWriteOnly();
+        glBlitFramebuffer(0, 0, viewportSize.x, viewportSize.y,
+                          0, 0, viewportSize.x, viewportSize.y,
+                          GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+
+        m_oitBuffer->bind();
+
+        const GLfloat accumulationClear[] = { 0.0f, 0.0f, 0.0f, 0.0f };
+        const GLfloat revealageClear[]    = { 1.0f, 0.0f, 0.0f, 0.0f };
+        glClearBufferfv(GL_COLOR, GLint(BufferPropertyName::ACCUMULATION), accumulationClear);
+        glClearBufferfv(GL_COLOR, GLint(BufferPropertyName::REVEALAGE),    revealageClear);
+
+        // Test against the opaque geometry, but don't occlude the other transparent surfaces
+        glEnable(GL_DEPTH_TEST);
+        glDepthMask(GL_FALSE);
+        glDisable(GL_CULL_FACE);
+
+        glEnable(GL_BLEND);
+        glBlendFunci(GLuint(BufferPropertyName::ACCUMULATION), GL_ONE,  GL_ONE);
+        glBlendFunci(GLuint(BufferPropertyName::REVEALAGE),    GL_ZERO, GL_ONE_MINUS_SRC_COLOR);
+    }
+
+    void WeightedBlendedOIT::endAccumulation()
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        glEnable(GL_CULL_FACE);
+        glDepthMask(GL_TRUE);
+    }
+
+    void WeightedBlendedOIT::composite(const ref<RenderTarget> & sceneRenderTarget)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+        MG_PROFILE_GL_ZONE("WeightedBlendedOIT::composite");
+
+        sceneRenderTarget->bind();
+
+        glDisable(GL_DEPTH_TEST);
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_ONE_MINUS_SRC_ALPHA, GL_SRC_ALPHA);
+
+        bind();
+        m_oitBuffer->bindTexture(0, GLuint(BufferPropertyName::ACCUMULATION));
+        m_oitBuffer->bindTexture(1, GLuint(BufferPropertyName::REVEALAGE));
+        render();
+
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        glEnable(GL_DEPTH_TEST);
+    }
+}
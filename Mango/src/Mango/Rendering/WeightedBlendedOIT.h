@@ -0,0 +1,36 @@
+#pragma once
+#include "PostprocessEffect.h"
+#include "RenderTarget.h"
+
+namespace mango
+{
+    /*
+     * Weighted, blended order-independent transparency (McGuire & Bavoil 2013).
+     * Transparent surfaces are accumulated in any order into an accumulation (RGBA16F) and a revealage (R16F) target,
+     * which are then composited over the scene in a single fullscreen pass.
+     */
+    class WeightedBlendedOIT : public PostprocessEffect
+    {
+    public:
+        enum class BufferPropertyName { ACCUMULATION = 0,
+                                        REVEALAGE    = 1 };
+
+        WeightedBlendedOIT() = default;
+
+        void create(int width, int height);
+        void clear();
+
+        // Binds the OIT targets with the scene depth (for depth testing only) and sets up the accumulation blending
+        void beginAccumulation(const ref<RenderTarget> & sceneRenderTarget);
+        void endAccumulation();
+
+        // Blends the accumulated transparent surfaces over the scene
+        void composite(const ref<RenderTarget> & sceneRenderTarget);
+
+        ref<Shader> getAccumulationShader() const { return m_accumulationShader; }
+
+    private:
+        ref<RenderTarget> m_oitBuffer;
+        ref<Shader>       m_accumulationShader;
+    };
+}
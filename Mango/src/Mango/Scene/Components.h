@@ -215,6 +215,11 @@ namespace mango
     {
         Camera camera;
         bool isPrimary = false;
+
+        // Additional cameras are rendered after the primary one into their viewports, e.g. split-screen or picture-in-picture
+        bool      isAdditionalView = false;
+        glm::vec4 viewport         = { 0.0f, 0.0f, 1.0f, 1.0f }; // normalized x, y, width, height of the output
+        uint32_t  layerMask        = 0xFFFFFFFF;                 // only the entities on these layers are rendered
     };
 
     struct StaticMeshComponent
@@ -237,6 +242,7 @@ namespace mango
     public:
         ref<Mesh>     mesh      = nullptr;
         MaterialTable materials;// = {};
+        bool          isStatic  = false; // never moves, merged into the static batches when the game starts
     };
 
     #if 0
@@ -532,6 +538,87 @@ namespace mango
         float     radius = 0.5f;
     };
 
+    // Dynamic environment probe used by the materials in the RQ_ENVIRO_MAPPING_DYNAMIC queue
+    struct ReflectionProbeComponent
+    {
+        float radius     = 10.0f;  // entities within this distance may sample the probe
+        int   resolution = 128;    // size of a cubemap face in pixels
+        float nearPlane  = 0.1f;
+        float farPlane   = 100.0f;
+    };
+
+    // Render layers of the entity. It's rendered by the cameras whose layer mask shares at least one bit with it.
+    // Entities without this component are on the first layer.
+    struct LayerComponent
+    {
+        uint32_t layers = 1;
+    };
+
+    // Static mesh beyond the distance from the camera is drawn as a billboard from its baked octahedral imposter
+    struct ImposterComponent
+    {
+        float distance = 100.0f;
+    };
+
+    // Character played from a baked vertex animation, all of the characters sharing the animation are drawn with one instanced draw
+    struct CrowdComponent
+    {
+        ref<VertexAnimation> animation  = nullptr;
+        uint32_t             clip       = 0;
+        float                timeOffset = 0.0f; // seconds, so the characters playing the same clip aren't in sync
+        float                speed      = 1.0f;
+    };
+
+    // Instances of the mesh scattered over the XZ plane of the entity (grass, rocks). They aren't entities,
+    // they are generated from the seed, grouped into the cells of a grid, culled and drawn per cell by the renderer
+    struct FoliageComponent
+    {
+    public:
+        FoliageComponent()
+        {
+            if (materials.empty())
+            {
+                materials.emplace_back(AssetManager::getMaterial("DefaultMaterial"));
+            }
+        }
+
+        explicit FoliageComponent(const ref<Mesh>& m)
+            : mesh(m)
+        {
+            if (mesh) materials = mesh->getMaterials();
+        }
+
+    public:
+        ref<Mesh>     mesh       = nullptr;
+        MaterialTable materials;
+        glm::vec2     extents    = glm::vec2(25.0f);      // half size of the scattered area
+        uint32_t      count      = 10000;
+        uint32_t      seed       = 1;
+        float         cellSize   = 16.0f;
+        glm::vec2     scaleRange = glm::vec2(0.8f, 1.2f);
+        float         fadeStart  = 80.0f;                 // the instances are thinned out between the fade distances
+        float         fadeEnd    = 100.0f;
+    };
+
+    // Heightmap terrain centered on the XZ position of the entity (the rotation and the scale are ignored). Drawn by the
+    // renderer as a CDLOD quadtree of one shared grid, the tiles of the heightmap are streamed in around the camera
+    struct TerrainComponent
+    {
+        ref<TerrainHeightmap> heightmap      = nullptr;
+        ref<Material>         material       = AssetManager::getMaterial("DefaultMaterial");
+        float                 size           = 1024.0f; // side of the terrain in world units
+        float                 height         = 200.0f;  // world height of the highest sample
+        uint32_t              lodLevels      = 8;
+        float                 lodDistance    = 32.0f;   // range of the finest level, every next level doubles it
+        float                 textureTiling  = 16.0f;   // world units covered by the textures of the material
+
+    protected:
+        std::vector<void*> runtimeBodies; // one height field per tile
+
+    private:
+        friend class PhysicsSystem;
+    };
+
     // Components Registry
     template<typename... Component>
     struct ComponentsGroup
@@ -541,5 +628,7 @@ namespace mango
     // Except: IDComponent, TagComponent which are special case components
     using ComponentsRegistry = ComponentsGroup<DirectionalLightComponent, PointLightComponent, SpotLightComponent, 
                                                CameraComponent, StaticMeshComponent, /*AnimatedMeshComponent,*/ TransformComponent, 
-                                               RigidBody3DComponent, BoxCollider3DComponent, CapsuleColliderComponent, SphereColliderComponent>;
+                                               RigidBody3DComponent, BoxCollider3DComponent, CapsuleColliderComponent, SphereColliderComponent,
+                                               ReflectionProbeComponent, LayerComponent, ImposterComponent, CrowdComponent,
+                                               FoliageComponent, TerrainComponent>;
 }
\ No newline at end of file
@@ -59,7 +59,8 @@ namespace mango
     {
         ref<Scene> newScene = createRef<Scene>();
 
-        newScene->m_name = other->m_name;
+        newScene->m_name     = other->m_name;
+        newScene->m_filepath = other->m_filepath;
 
         auto& srcSceneRegistry = other->m_registry;
         auto& dstSceneRegistry = newScene->m_registry;
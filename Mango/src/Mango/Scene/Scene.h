@@ -3,6 +3,7 @@
 
 #include <entt.hpp>
 
+#include <filesystem>
 #include <string>
 #include <string_view>
 
@@ -19,6 +20,10 @@ namespace mango
         static ref<Scene> copy(ref<Scene>& other);
 
         std::string& getName() { return m_name; };
+
+        // File the scene was loaded from or saved to, empty for the scenes created in code
+        const std::filesystem::path& getFilepath() const                              { return m_filepath; }
+        void                         setFilepath(const std::filesystem::path& filepath) { m_filepath = filepath; }
         
         Entity createEntity(const std::string& name = "Entity");
         Entity createEntityWithUUID(UUID uuid, const std::string& name = "Entity");
@@ -45,6 +50,7 @@ namespace mango
     private:
         entt::registry m_registry;
         std::string m_name;
+        std::filesystem::path m_filepath;
 
     private:
         friend class Entity;
@@ -246,6 +246,9 @@ namespace mango
                 out << YAML::Key << "OrthographicNear" << YAML::Value << camera.getOrthographicNearClip();
                 out << YAML::Key << "OrthographicFar"  << YAML::Value << camera.getOrthographicFarClip();
                 out << YAML::Key << "IsPrimary"        << YAML::Value << cc.isPrimary;
+                out << YAML::Key << "IsAdditionalView" << YAML::Value << cc.isAdditionalView;
+                out << YAML::Key << "Viewport"         << YAML::Value << cc.viewport;
+                out << YAML::Key << "LayerMask"        << YAML::Value << cc.layerMask;
             }
             out << YAML::EndMap;
         }
@@ -257,6 +260,7 @@ namespace mango
             {
                 auto& smc = entity.getComponent<StaticMeshComponent>();
                 out << YAML::Key << "Filename"  << YAML::Value << smc.mesh->getName();
+                out << YAML::Key << "IsStatic"  << YAML::Value << smc.isStatic;
                 out << YAML::Key << "Materials" << YAML::Value;
                 out << YAML::BeginMap;
                 {
@@ -268,7 +272,8 @@ namespace mango
                         {
                             auto& material = smc.materials[i];
 
-                            if (material != originalMaterials[i])
+                            // The slots past the table of a placeholder mesh are overrides, the empty ones get the loaded materials
+                            if (material && (i >= originalMaterials.size() || material != originalMaterials[i]))
                             {
                                 out << YAML::Key << i << YAML::Value << material->name;
                             }
@@ -345,6 +350,100 @@ namespace mango
             out << YAML::EndMap;
         }
 
+        if (entity.hasComponent<ReflectionProbeComponent>())
+        {
+            out << YAML::Key << "ReflectionProbeComponent";
+            out << YAML::BeginMap;
+            {
+                auto& rpc = entity.getComponent<ReflectionProbeComponent>();
+                out << YAML::Key << "Radius"     << YAML::Value << rpc.radius;
+                out << YAML::Key << "Resolution" << YAML::Value << rpc.resolution;
+                out << YAML::Key << "NearPlane"  << YAML::Value << rpc.nearPlane;
+                out << YAML::Key << "FarPlane"   << YAML::Value << rpc.farPlane;
+            }
+            out << YAML::EndMap;
+        }
+
+        if (entity.hasComponent<LayerComponent>())
+        {
+            out << YAML::Key << "LayerComponent";
+            out << YAML::BeginMap;
+            {
+                auto& lc = entity.getComponent<LayerComponent>();
+                out << YAML::Key << "Layers" << YAML::Value << lc.layers;
+            }
+            out << YAML::EndMap;
+        }
+
+        if (entity.hasComponent<ImposterComponent>())
+        {
+            out << YAML::Key << "ImposterComponent";
+            out << YAML::BeginMap;
+            {
+                auto& ic = entity.getComponent<ImposterComponent>();
+                out << YAML::Key << "Distance" << YAML::Value << ic.distance;
+            }
+            out << YAML::EndMap;
+        }
+
+        if (entity.hasComponent<CrowdComponent>())
+        {
+            out << YAML::Key << "CrowdComponent";
+            out << YAML::BeginMap;
+            {
+                auto& cc = entity.getComponent<CrowdComponent>();
+                out << YAML::Key << "Filename"   << YAML::Value << (cc.animation ? cc.animation->getFilename() : "");
+                out << YAML::Key << "Clip"       << YAML::Value << cc.clip;
+                out << YAML::Key << "TimeOffset" << YAML::Value << cc.timeOffset;
+                out << YAML::Key << "Speed"      << YAML::Value << cc.speed;
+            }
+            out << YAML::EndMap;
+        }
+
+        if (entity.hasComponent<TerrainComponent>())
+        {
+            out << YAML::Key << "TerrainComponent";
+            out << YAML::BeginMap;
+            {
+                auto& terrain = entity.getComponent<TerrainComponent>();
+                out << YAML::Key << "Heightmap"     << YAML::Value << (terrain.heightmap ? terrain.heightmap->getFilename() : "");
+                out << YAML::Key << "Material"      << YAML::Value << (terrain.material  ? terrain.material->name           : "");
+                out << YAML::Key << "Size"          << YAML::Value << terrain.size;
+                out << YAML::Key << "Height"        << YAML::Value << terrain.height;
+                out << YAML::Key << "LodLevels"     << YAML::Value << terrain.lodLevels;
+                out << YAML::Key << "LodDistance"   << YAML::Value << terrain.lodDistance;
+                out << YAML::Key << "TextureTiling" << YAML::Value << terrain.textureTiling;
+            }
+            out << YAML::EndMap;
+        }
+
+        if (entity.hasComponent<FoliageComponent>())
+        {
+            out << YAML::Key << "FoliageComponent";
+            out << YAML::BeginMap;
+            {
+                auto& fc = entity.getComponent<FoliageComponent>();
+                out << YAML::Key << "Filename"   << YAML::Value << (fc.mesh ? fc.mesh->getName() : "");
+                out << YAML::Key << "Extents"    << YAML::Value << fc.extents;
+                out << YAML::Key << "Count"      << YAML::Value << fc.count;
+                out << YAML::Key << "Seed"       << YAML::Value << fc.seed;
+                out << YAML::Key << "CellSize"   << YAML::Value << fc.cellSize;
+                out << YAML::Key << "ScaleRange" << YAML::Value << fc.scaleRange;
+                out << YAML::Key << "FadeStart"  << YAML::Value << fc.fadeStart;
+                out << YAML::Key << "FadeEnd"    << YAML::Value << fc.fadeEnd;
+                out << YAML::Key << "Materials"  << YAML::Value;
+                out << YAML::BeginMap;
+                {
+                    for (uint32_t i = 0; i < fc.materials.size(); ++i)
+                    {
+                        out << YAML::Key << i << YAML::Value << fc.materials[i]->name;
+                    }
+                }
+                out << YAML::EndMap;
+            }
+            out << YAML::EndMap;
+        }
+
         out << YAML::EndMap; // Entity
     }
     
@@ -394,74 +493,154 @@ namespace mango
             return {};
         };
 
+        auto transparencyModeToString = [](Material::TransparencyMode mode) -> std::string
+        {
+            switch (mode)
+            {
+                case Material::TransparencyMode::DEFAULT:           return "Default";
+                case Material::TransparencyMode::SORTED:            return "Sorted";
+                case Material::TransparencyMode::ORDER_INDEPENDENT: return "OrderIndependent";
+            }
+            MG_CORE_ASSERT_MSG(false, "Unknown transparency mode");
+            return {};
+        };
+
         std::unordered_set<std::string> alreadySerializedMaterials;
+        // The foliage references the materials the same way as the static meshes, the terrains have no mesh
+        std::vector<std::pair<ref<Mesh>, MaterialTable>> meshesMaterials;
+
         auto view = scene->getEntitiesWithComponent<StaticMeshComponent>();
         for (auto entityID : view)
         {
             auto& smc = view.get<StaticMeshComponent>(entityID);
+            meshesMaterials.emplace_back(smc.mesh, smc.materials);
+        }
+
+        auto foliageView = scene->getEntitiesWithComponent<FoliageComponent>();
+        for (auto entityID : foliageView)
+        {
+            auto& fc = foliageView.get<FoliageComponent>(entityID);
+            if (fc.mesh) meshesMaterials.emplace_back(fc.mesh, fc.materials);
+        }
+
+        auto terrainView = scene->getEntitiesWithComponent<TerrainComponent>();
+        for (auto entityID : terrainView)
+        {
+            auto& terrain = terrainView.get<TerrainComponent>(entityID);
+            if (terrain.material) meshesMaterials.emplace_back(nullptr, MaterialTable{ terrain.material });
+        }
+
+        auto serializeMaterial = [&](const ref<Material>& material)
+        {
+            alreadySerializedMaterials.insert(material->name);
 
-            if (!std::filesystem::path(smc.mesh->getName()).has_extension()) // check if mesh name has an extension, if yes, then don't store the materials
+            out << YAML::BeginMap;
             {
-                auto originalMaterials = smc.mesh->getMaterials();
+                out << YAML::Key << "Name" << YAML::Value << material->name;
 
-                if (!smc.materials.empty())
+                // The instances keep only the overridden parameters in the maps, the rest is shared with the parent
+                if (material->isInstance())
                 {
-                    for (uint32_t i = 0; i < smc.materials.size(); ++i)
-                    {
-                        auto& material = smc.materials[i];
+                    auto instance = std::static_pointer_cast<MaterialInstance>(material);
 
-                        if (material != originalMaterials[i] && !alreadySerializedMaterials.contains(material->name))
-                        {
-                            alreadySerializedMaterials.insert(material->name);
+                    out << YAML::Key << "Parent" << YAML::Value << instance->getParent()->name;
 
-                            out << YAML::BeginMap;
+                    const char* mapKeys[] = { "Vec3Map", "FloatMap", "BoolMap" };
+                    for (auto type : { MaterialInstance::OverrideType::VECTOR3, MaterialInstance::OverrideType::FLOAT, MaterialInstance::OverrideType::BOOL })
+                    {
+                        out << YAML::Key << mapKeys[uint32_t(type)] << YAML::Value;
+                        out << YAML::BeginMap;
+                        {
+                            for (auto& o : instance->getOverrides())
                             {
-                                out << YAML::Key << "Name" << YAML::Value << material->name;
+                                if (o.type != type) continue;
 
-                                out << YAML::Key << "Textures" << YAML::Value;
-                                out << YAML::BeginMap;
+                                out << YAML::Key << o.name << YAML::Value;
+                                switch (type)
                                 {
-                                    for (auto& [type, texture] : material->getTextureMap())
-                                    {
-                                        out << YAML::Key << materialTextureTypeToString(type) << YAML::Value << texture->getFilename();
-                                    }
+                                    case MaterialInstance::OverrideType::VECTOR3: out << o.value;             break;
+                                    case MaterialInstance::OverrideType::FLOAT:   out << o.value.x;           break;
+                                    case MaterialInstance::OverrideType::BOOL:    out << (o.value.x != 0.0f); break;
                                 }
-                                out << YAML::EndMap;
+                            }
+                        }
+                        out << YAML::EndMap;
+                    }
+                    out << YAML::EndMap;
+                    return;
+                }
 
-                                out << YAML::Key << "Vec3Map" << YAML::Value;
-                                out << YAML::BeginMap;
-                                {
-                                    for (auto& [name, value] : material->getVec3Map())
-                                    {
-                                        out << YAML::Key << name << YAML::Value << value;
-                                    }
-                                }
-                                out << YAML::EndMap;
+                out << YAML::Key << "Textures" << YAML::Value;
+                out << YAML::BeginMap;
+                {
+                    for (auto& [type, texture] : material->getTextureMap())
+                    {
+                        out << YAML::Key << materialTextureTypeToString(type) << YAML::Value << texture->getFilename();
+                    }
+                }
+                out << YAML::EndMap;
 
-                                out << YAML::Key << "FloatMap" << YAML::Value;
-                                out << YAML::BeginMap;
-                                {
-                                    for (auto& [name, value] : material->getFloatMap())
-                                    {
-                                        out << YAML::Key << name << YAML::Value << value;
-                                    }
-                                }
-                                out << YAML::EndMap;
+                out << YAML::Key << "Vec3Map" << YAML::Value;
+                out << YAML::BeginMap;
+                {
+                    for (auto& [name, value] : material->getVec3Map())
+                    {
+                        out << YAML::Key << name << YAML::Value << value;
+                    }
+                }
+                out << YAML::EndMap;
 
-                                out << YAML::Key << "BoolMap" << YAML::Value;
-                                out << YAML::BeginMap;
-                                {
-                                    for (auto& [name, value] : material->getBoolMap())
-                                    {
-                                        out << YAML::Key << name << YAML::Value << value;
-                                    }
-                                }
-                                out << YAML::EndMap;
+                out << YAML::Key << "FloatMap" << YAML::Value;
+                out << YAML::BeginMap;
+                {
+                    for (auto& [name, value] : material->getFloatMap())
+                    {
+                        out << YAML::Key << name << YAML::Value << value;
+                    }
+                }
+                out << YAML::EndMap;
 
-                                out << YAML::Key << "BlendMode"   << YAML::Value << materialBlendModeToString(material->getBlendMode());
-                                out << YAML::Key << "RenderQueue" << YAML::Value << renderQueueToString(material->getRenderQueue());
-                            }
-                            out << YAML::EndMap;
+                out << YAML::Key << "BoolMap" << YAML::Value;
+                out << YAML::BeginMap;
+                {
+                    for (auto& [name, value] : material->getBoolMap())
+                    {
+                        out << YAML::Key << name << YAML::Value << value;
+                    }
+                }
+                out << YAML::EndMap;
+
+                out << YAML::Key << "BlendMode"   << YAML::Value << materialBlendModeToString(material->getBlendMode());
+                out << YAML::Key << "RenderQueue" << YAML::Value << renderQueueToString(material->getRenderQueue());
+                out << YAML::Key << "Transparency" << YAML::Value << transparencyModeToString(material->getTransparencyMode());
+                out << YAML::Key << "Keywords"     << YAML::Value << material->getKeywords();
+            }
+            out << YAML::EndMap;
+        };
+
+        for (auto& [mesh, materials] : meshesMaterials)
+        {
+            if (!mesh || !std::filesystem::path(mesh->getName()).has_extension()) // check if mesh name has an extension, if yes, then don't store the materials
+            {
+                auto originalMaterials = mesh ? mesh->getMaterials() : MaterialTable{ AssetManager::getMaterial("DefaultMaterial") };
+
+                if (!materials.empty())
+                {
+                    for (uint32_t i = 0; i < materials.size(); ++i)
+                    {
+                        auto& material = materials[i];
+
+                        if (!material || (i < originalMaterials.size() && material == originalMaterials[i])) continue;
+
+                        // The parent may not be used by any of the entities
+                        if (material->isInstance() && !alreadySerializedMaterials.contains(material->getParent()->name))
+                        {
+                            serializeMaterial(material->getParent());
+                        }
+
+                        if (!alreadySerializedMaterials.contains(material->name))
+                        {
+                            serializeMaterial(material);
                         }
                     }
                 }
@@ -488,6 +667,7 @@ namespace mango
         if (fout.is_open())
         {
             fout << out.c_str();
+            scene->setFilepath(outFilepath);
             return true;
         }
         else
@@ -517,6 +697,10 @@ namespace mango
 
         std::string sceneName = data["Scene"].as<std::string>();
         auto scene = createRef<Scene>(sceneName);
+        scene->setFilepath(inFilepath);
+
+        // The meshes and textures are placeholders until AssetManager finishes their loads
+        bool asyncLoading = *CVarSystem::get()->getIntCVar("assets.asyncLoading");
 
         MG_CORE_TRACE("Deserializing scene '{}'", sceneName);
 
@@ -556,6 +740,16 @@ namespace mango
             return Material::BlendMode::NONE;
         };
 
+        auto stringToTransparencyMode = [](const std::string& s) -> Material::TransparencyMode
+        {
+            if (s == "Default")          return Material::TransparencyMode::DEFAULT;
+            if (s == "Sorted")           return Material::TransparencyMode::SORTED;
+            if (s == "OrderIndependent") return Material::TransparencyMode::ORDER_INDEPENDENT;
+
+            MG_CORE_ASSERT_MSG(false, "Unknown transparency mode");
+            return Material::TransparencyMode::DEFAULT;
+        };
+
         auto materials = data["Materials"];
         if (materials)
         {
@@ -565,15 +759,40 @@ namespace mango
                 
                 MG_CORE_TRACE("\tDeserializing material {}", materialName);
                 
-                auto mangoMaterial = AssetManager::createMaterial(materialName);
+                // An instance has only the maps, they are its overrides
+                ref<Material> mangoMaterial;
+                if (auto parent = material["Parent"])
+                {
+                    mangoMaterial = AssetManager::createMaterialInstance(materialName, AssetManager::createMaterial(parent.as<std::string>()));
+                }
+                else
+                {
+                    mangoMaterial = AssetManager::createMaterial(materialName);
+                }
 
-                auto blendModeString = material["BlendMode"].as<std::string>();
-                auto blendMode       = stringToMaterialBlendMode(blendModeString);
-                mangoMaterial->setBlendMode(blendMode);
+                if (auto blendMode = material["BlendMode"])
+                {
+                    mangoMaterial->setBlendMode(stringToMaterialBlendMode(blendMode.as<std::string>()));
+                }
+
+                if (auto renderQueue = material["RenderQueue"])
+                {
+                    mangoMaterial->setRenderQueue(stringToRenderQueue(renderQueue.as<std::string>()));
+                }
 
-                auto renderQueueString = material["RenderQueue"].as<std::string>();
-                auto renderQueue       = stringToRenderQueue(renderQueueString);
-                mangoMaterial->setRenderQueue(renderQueue);
+                // Optional, scenes saved before it was introduced don't have it
+                if (auto transparencyMode = material["Transparency"])
+                {
+                    mangoMaterial->setTransparencyMode(stringToTransparencyMode(transparencyMode.as<std::string>()));
+                }
+
+                if (auto keywords = material["Keywords"])
+                {
+                    for (auto& keyword : keywords.as<std::vector<std::string>>())
+                    {
+                        mangoMaterial->setKeyword(keyword, true);
+                    }
+                }
 
                 auto textureMap = material["Textures"];
                 if (textureMap)
@@ -585,7 +804,9 @@ namespace mango
                         if (!textureFilename.empty())
                         {
                             auto textureType = stringToMaterialTextureType(it->first.as<std::string>());
-                            auto texture     = AssetManager::createTexture2D(textureFilename, (textureType == Material::TextureType::DIFFUSE) ? true : false);
+                            auto isSrgb      = textureType == Material::TextureType::DIFFUSE;
+                            auto texture     = asyncLoading ? AssetManager::createTexture2DAsync(textureFilename, isSrgb)
+                                                            : AssetManager::createTexture2D     (textureFilename, isSrgb);
 
                             mangoMaterial->addTexture(textureType, texture);
                         }
@@ -720,6 +941,11 @@ namespace mango
                     camera.setOrthographicSize              (cameraComponent["OrthographicSize"].as<float>());
                     camera.setOrthographicNearClip          (cameraComponent["OrthographicNear"].as<float>());
                     camera.setOrthographicFarClip           (cameraComponent["OrthographicFar"].as<float>());
+
+                    // Scenes saved before the multi-view rendering don't have these
+                    cc.isAdditionalView = cameraComponent["IsAdditionalView"].as<bool>(false);
+                    cc.viewport         = cameraComponent["Viewport"].as<glm::vec4>(glm::vec4(0.0f, 0.0f, 1.0f, 1.0f));
+                    cc.layerMask        = cameraComponent["LayerMask"].as<uint32_t>(0xFFFFFFFF);
                 }
 
                 auto staticMeshComponent = entity["StaticMeshComponent"];
@@ -730,7 +956,8 @@ namespace mango
                     ref<Mesh> staticMesh = nullptr;
                     if (filename.has_extension())
                     {
-                        staticMesh = AssetManager::createMeshFromFile(filename.string());
+                        staticMesh = asyncLoading ? AssetManager::createMeshFromFileAsync(filename.string())
+                                                  : AssetManager::createMeshFromFile     (filename.string());
                     }
                     else
                     {
@@ -738,6 +965,7 @@ namespace mango
                     }
 
                     auto& smc = deserializedEntity.addComponent<StaticMeshComponent>(staticMesh);
+                    smc.isStatic = staticMeshComponent["IsStatic"].as<bool>(false);
 
                     auto materials = staticMeshComponent["Materials"];
                     if (materials)
@@ -746,6 +974,12 @@ namespace mango
                         {
                             auto materialIndex = it->first.as<uint32_t>();
                             auto materialName  = it->second.as<std::string>();
+
+                            // The placeholder of an asynchronously loaded mesh has fewer materials
+                            if (materialIndex >= smc.materials.size())
+                            {
+                                smc.materials.resize(materialIndex + 1);
+                            }
                             smc.materials[materialIndex] = AssetManager::getMaterial(materialName);
                         }
                     }
@@ -797,6 +1031,110 @@ namespace mango
                     sc.offset = sphereColliderComponent["Offset"].as<glm::vec3>();
                     sc.radius = sphereColliderComponent["Radius"].as<float>();
                 }
+
+                auto reflectionProbeComponent = entity["ReflectionProbeComponent"];
+                if (reflectionProbeComponent)
+                {
+                    auto& rpc      = deserializedEntity.addComponent<ReflectionProbeComponent>();
+                    rpc.radius     = reflectionProbeComponent["Radius"].as<float>();
+                    rpc.resolution = reflectionProbeComponent["Resolution"].as<int>();
+                    rpc.nearPlane  = reflectionProbeComponent["NearPlane"].as<float>();
+                    rpc.farPlane   = reflectionProbeComponent["FarPlane"].as<float>();
+                }
+
+                auto layerComponent = entity["LayerComponent"];
+                if (layerComponent)
+                {
+                    auto& lc  = deserializedEntity.addComponent<LayerComponent>();
+                    lc.layers = layerComponent["Layers"].as<uint32_t>();
+                }
+
+                auto imposterComponent = entity["ImposterComponent"];
+                if (imposterComponent)
+                {
+                    auto& ic    = deserializedEntity.addComponent<ImposterComponent>();
+                    ic.distance = imposterComponent["Distance"].as<float>();
+                }
+
+                auto crowdComponent = entity["CrowdComponent"];
+                if (crowdComponent)
+                {
+                    auto& cc      = deserializedEntity.addComponent<CrowdComponent>();
+                    auto filename = crowdComponent["Filename"].as<std::string>("");
+
+                    cc.animation  = filename.empty() ? nullptr : AssetManager::createVertexAnimationFromFile(filename);
+                    cc.clip       = crowdComponent["Clip"]      .as<uint32_t>(0);
+                    cc.timeOffset = crowdComponent["TimeOffset"].as<float>(0.0f);
+                    cc.speed      = crowdComponent["Speed"]     .as<float>(1.0f);
+                }
+
+                auto terrainComponent = entity["TerrainComponent"];
+                if (terrainComponent)
+                {
+                    auto& terrain      = deserializedEntity.addComponent<TerrainComponent>();
+                    auto  filename     = terrainComponent["Heightmap"].as<std::string>("");
+                    auto  materialName = terrainComponent["Material"] .as<std::string>("");
+
+                    terrain.heightmap     = filename.empty() ? nullptr : AssetManager::createTerrainHeightmapFromFile(filename);
+                    terrain.size          = terrainComponent["Size"]         .as<float>(1024.0f);
+                    terrain.height        = terrainComponent["Height"]       .as<float>(200.0f);
+                    terrain.lodLevels     = terrainComponent["LodLevels"]    .as<uint32_t>(8);
+                    terrain.lodDistance   = terrainComponent["LodDistance"]  .as<float>(32.0f);
+                    terrain.textureTiling = terrainComponent["TextureTiling"].as<float>(16.0f);
+
+                    if (!materialName.empty() && AssetManager::getMaterial(materialName))
+                    {
+                        terrain.material = AssetManager::getMaterial(materialName);
+                    }
+                }
+
+                auto foliageComponent = entity["FoliageComponent"];
+                if (foliageComponent)
+                {
+                    std::filesystem::path filename = foliageComponent["Filename"].as<std::string>("");
+
+                    ref<Mesh> foliageMesh = nullptr;
+                    if (filename.has_extension())
+                    {
+                        foliageMesh = asyncLoading ? AssetManager::createMeshFromFileAsync(filename.string())
+                                                   : AssetManager::createMeshFromFile     (filename.string());
+                    }
+                    else if (!filename.empty())
+                    {
+                        foliageMesh = AssetManager::getMesh(filename.string());
+                    }
+
+                    auto& fc = foliageMesh ? deserializedEntity.addComponent<FoliageComponent>(foliageMesh)
+                                           : deserializedEntity.addComponent<FoliageComponent>();
+                    fc.extents    = foliageComponent["Extents"]   .as<glm::vec2>(glm::vec2(25.0f));
+                    fc.count      = foliageComponent["Count"]     .as<uint32_t>(10000);
+                    fc.seed       = foliageComponent["Seed"]      .as<uint32_t>(1);
+                    fc.cellSize   = foliageComponent["CellSize"]  .as<float>(16.0f);
+                    fc.scaleRange = foliageComponent["ScaleRange"].as<glm::vec2>(glm::vec2(0.8f, 1.2f));
+                    fc.fadeStart  = foliageComponent["FadeStart"] .as<float>(80.0f);
+                    fc.fadeEnd    = foliageComponent["FadeEnd"]   .as<float>(100.0f);
+
+                    auto materials = foliageComponent["Materials"];
+                    if (materials)
+                    {
+                        for (auto it = materials.begin(); it != materials.end(); ++it)
+                        {
+                            auto materialIndex = it->first.as<uint32_t>();
+                            auto materialName  = it->second.as<std::string>();
+
+                            // The placeholder of an asynchronously loaded mesh has fewer materials
+                            if (materialIndex >= fc.materials.size() && foliageMesh)
+                            {
+                                fc.materials.resize(materialIndex + 1);
+                            }
+
+                            if (materialIndex < fc.materials.size())
+                            {
+                                fc.materials[materialIndex] = AssetManager::getMaterial(materialName);
+                            }
+                        }
+                    }
+                }
             }
 
             // Loop again to resolve parent-child hierarchy
@@ -2,8 +2,10 @@
 
 #include "ImGuiSystem.h"
 #include "Mango/Core/Services.h"
+#include "Mango/Profiling/GPUProfiler.h"
 #include "Mango/Rendering/Font.h"
 #include "Mango/Rendering/Texture.h"
+#include "Mango/Systems/RenderingSystem.h"
 #include "Mango/Window/Window.h"
 
 #include "glm/vec2.hpp"
@@ -113,7 +115,10 @@ namespace mango
         io.DisplaySize = ImVec2(Services::application()->getWindow()->getWidth(), Services::application()->getWindow()->getHeight());
 
         ImGui::Render();
-        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        {
+            MG_GPU_PASS(Services::renderer()->getGPUProfiler(), "ImGui");
+            ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        }
 
         if (io.ConfigFlags & ImGuiConfigFlags_ViewportsEnable)
         {
@@ -3,6 +3,8 @@
 #include "Mango/Scene/Components.h"
 #include "Mango/Scene/Entity.h"
 #include "Mango/Scene/SceneManager.h"
+#include "Mango/Core/AssetManager.h"
+#include "Mango/Core/Jobs.h"
 #include "Mango/Core/Services.h"
 
 #include "Jolt/Jolt.h"
@@ -15,6 +17,7 @@
 #include "Jolt/Physics/Collision/Shape/BoxShape.h"
 #include "Jolt/Physics/Collision/Shape/SphereShape.h"
 #include "Jolt/Physics/Collision/Shape/CapsuleShape.h"
+#include "Jolt/Physics/Collision/Shape/HeightFieldShape.h"
 #include "Jolt/Physics/Collision/Shape/MeshShape.h"
 #include "Jolt/Physics/Body/BodyCreationSettings.h"
 #include "Jolt/Physics/Body/BodyActivationListener.h"
@@ -281,12 +284,109 @@ namespace mango
                                   rb3d.isInitiallyActivated ? JPH::EActivation::Activate : JPH::EActivation::DontActivate);
         }
 
+        onInitTerrainBodies();
+
         // Optional step: Before starting the physics simulation you can optimize the broad phase. This improves collision detection performance (it's pointless here because we only have 2 bodies).
         // You should definitely not call this every frame or when e.g. streaming in a new level section as it is an expensive operation.
         // Instead insert all new objects in batches instead of 1 at a time to keep the broad phase efficient.
         m_physicsSystem->OptimizeBroadPhase();
     }
 
+    void PhysicsSystem::onInitTerrainBodies()
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        JPH::BodyInterface& bodyInterface = m_physicsSystem->GetBodyInterface();
+
+        // The sample count of a height field has to be a multiple of its block size, the padding doesn't collide
+        const uint32_t tileSamplesCount = TerrainHeightmap::TILE_SIZE + 1;
+        const uint32_t blockSize        = 4;
+        const uint32_t samplesCount     = (tileSamplesCount + blockSize - 1) / blockSize * blockSize;
+
+        auto view = m_scene->getEntitiesWithComponent<TransformComponent, TerrainComponent>();
+
+        // The heightmaps are cooked on the worker threads, the bodies need all of them
+        for (auto e : view)
+        {
+            auto& heightmap = view.get<TerrainComponent>(e).heightmap;
+            if (heightmap && !heightmap->isLoaded())
+            {
+                AssetManager::waitForAsyncLoads();
+                break;
+            }
+        }
+
+        for (auto e : view)
+        {
+            auto [tc, terrain] = view.get<TransformComponent, TerrainComponent>(e);
+            if (!terrain.heightmap || !terrain.heightmap->isLoaded()) continue;
+
+            auto&          heightmap  = terrain.heightmap;
+            const uint32_t tilesCount = heightmap->getTilesCount();
+            const float    size       = glm::max(terrain.size, 1.0f);
+            const float    tileSize   = size / float(tilesCount);
+
+            // Same placement as the renderer: centered on the XZ position of the entity
+            glm::vec3 corner = glm::vec3(tc.getWorldMatrix()[3]) - glm::vec3(0.5f * size, 0.0f, 0.5f * size);
+
+            /* The tiles are read and their shapes are built in parallel, the bodies are added afterwards */
+            std::vector<JPH::RefConst<JPH::Shape>> shapes(tilesCount * tilesCount);
+
+            tf::Taskflow taskflow;
+            taskflow.for_each_index(size_t(0), shapes.size(), size_t(1), [&](size_t i)
+            {
+                uint32_t tileX = uint32_t(i) % tilesCount;
+                uint32_t tileY = uint32_t(i) / tilesCount;
+
+                std::vector<uint16_t> tileSamples;
+                if (!heightmap->readTile(tileX, tileY, tileSamples)) return;
+
+                std::vector<float> samples(samplesCount * samplesCount, JPH::HeightFieldShapeConstants::cNoCollisionValue);
+                for (uint32_t y = 0; y < tileSamplesCount; ++y)
+                {
+                    for (uint32_t x = 0; x < tileSamplesCount; ++x)
+                    {
+                        samples[y * samplesCount + x] = float(tileSamples[y * tileSamplesCount + x]) / 65535.0f;
+                    }
+                }
+
+                JPH::Vec3 offset = glmVec3ToJoltVec3(corner + glm::vec3(float(tileX) * tileSize, 0.0f, float(tileY) * tileSize));
+                JPH::Vec3 scale  = JPH::Vec3(tileSize / TerrainHeightmap::TILE_SIZE, terrain.height, tileSize / TerrainHeightmap::TILE_SIZE);
+
+                JPH::HeightFieldShapeSettings settings(samples.data(), offset, scale, samplesCount);
+                settings.mBlockSize = blockSize;
+
+                auto result = settings.Create();
+                if (result.IsValid())
+                {
+                    shapes[i] = result.Get();
+                }
+            });
+
+            Jobs::executor.run(taskflow).wait();
+
+            for (uint32_t i = 0; i < shapes.size(); ++i)
+            {
+                if (!shapes[i])
+                {
+                    Entity entity = { e, m_scene.get() };
+
+                    MG_CORE_WARN("Physics System: can't create the height field of the tile {} of the terrain named [{}].",
+                                 i, entity.getComponent<TagComponent>().name);
+                    continue;
+                }
+
+                JPH::BodyCreationSettings bodySettings(shapes[i], JPH::RVec3::sZero(), JPH::Quat::sIdentity(), JPH::EMotionType::Static, Layers::NON_MOVING);
+
+                auto body = bodyInterface.CreateBody(bodySettings);
+                if (!body) continue;
+
+                bodyInterface.AddBody(body->GetID(), JPH::EActivation::DontActivate);
+                terrain.runtimeBodies.push_back(body);
+            }
+        }
+    }
+
     void PhysicsSystem::onDestroyBodies()
     {
         MG_PROFILE_ZONE_SCOPED;
@@ -307,5 +407,18 @@ namespace mango
                 bodyInterface.DestroyBody(static_cast<JPH::Body*>(rb3d.runtimeBody)->GetID());
             }
         }
+
+        auto terrains = m_scene->getEntitiesWithComponent<TerrainComponent>();
+        for (auto e : terrains)
+        {
+            auto& terrain = terrains.get<TerrainComponent>(e);
+
+            for (auto body : terrain.runtimeBodies)
+            {
+                bodyInterface.RemoveBody (static_cast<JPH::Body*>(body)->GetID());
+                bodyInterface.DestroyBody(static_cast<JPH::Body*>(body)->GetID());
+            }
+            terrain.runtimeBodies.clear();
+        }
     }
 }
\ No newline at end of file
@@ -189,14 +189,17 @@ namespace mango
         void start();
         void stop();
 
+        bool isRunning() const { return m_physicsSystemState == PhysicsSystemState::Running; }
+
     private:
         void onInitBodies();
+        void onInitTerrainBodies();
         void onDestroyBodies();
 
     private:
         // This is the max amount of rigid bodies that you can add to the physics system. If you try to add more you'll get an error.
-        // Note: This value is low because this is a simple test. For a real project use something in the order of 65536.
-        const uint32_t c_maxBodies = 1024;
+        // Note: Every tile of a terrain is a body, a terrain can have up to 64x64 tiles.
+        const uint32_t c_maxBodies = 65536;
 
         // This determines how many mutexes to allocate to protect rigid bodies from concurrent access. Set it to 0 for the default settings.
         const uint32_t c_numBodyMutexes = 0;
@@ -2,24 +2,62 @@
 
 #include "RenderingSystem.h"
 #include "Mango/Core/AssetManager.h"
+#include "Mango/Core/Jobs.h"
 #include "Mango/Rendering/BloomPS.h"
+#include "Mango/Rendering/Debug/DebugDraw.h"
 #include "Mango/Rendering/Debug/DebugMarkersGL.h"
 #include "Mango/Rendering/Debug/DebugMesh.h"
 #include "Mango/Rendering/DeferredRendering.h"
+#include "Mango/Rendering/Crowds.h"
+#include "Mango/Rendering/Foliage.h"
+#include "Mango/Rendering/GPUUploads.h"
+#include "Mango/Rendering/Terrain.h"
+#include "Mango/Rendering/DynamicResolution.h"
+#include "Mango/Rendering/Imposters.h"
+#include "Mango/Rendering/MaterialTextureArrays.h"
 #include "Mango/Rendering/Picking.h"
+#include "Mango/Rendering/PostprocessStack.h"
+#include "Mango/Rendering/ReflectionProbes.h"
 #include "Mango/Rendering/SSAO.h"
 #include "Mango/Rendering/ShaderGlobals.h"
+#include "Mango/Rendering/StaticBatches.h"
+#include "Mango/Rendering/TextureStreaming.h"
+#include "Mango/Rendering/WeightedBlendedOIT.h"
 #include "Mango/Rendering/JFAOutline.h"
+#include "Mango/Profiling/GPUProfiler.h"
 #include "Mango/Scene/Components.h"
 #include "Mango/Scene/SelectionManager.h"
 #include "Mango/Window/Window.h"
 
+#include <numeric>
+
 namespace mango
 {
+    namespace
+    {
+        const char* SCENE_PASS_NAME = "Scene";
+    }
+
     RenderingSystem::RenderingSystem()
         : System("RenderingSystem")
     {
-
+        // Set CVars
+        CVarInt   CVarDynamicResolution("renderer.dynamicResolution", "scale the scene resolution to keep the GPU time of the scene within the target", 0, CVarFlags::EditCheckbox);
+        CVarFloat CVarTargetFrameTime  ("renderer.targetFrameTime",   "target GPU time of the scene passes in ms used by dynamic resolution",   16.6f);
+        CVarFloat CVarMinRenderScale   ("renderer.minRenderScale",    "minimal scale of the scene resolution",                                  0.5f);
+        CVarFloat CVarMaxRenderScale   ("renderer.maxRenderScale",    "maximal scale of the scene resolution",                                  1.0f);
+        CVarInt   CVarGPUProfiler      ("renderer.gpuProfiler",       "measure GPU time of the render passes with timer queries",               1, CVarFlags::EditCheckbox);
+        CVarInt   CVarReflectionProbes ("renderer.reflectionProbes",  "update the dynamic reflection probes",                                   1, CVarFlags::EditCheckbox);
+        CVarInt   CVarProbeFaces       ("renderer.probeFacesPerFrame", "number of the reflection probe cubemap faces rendered per frame",       1);
+        CVarInt   CVarRenderOnDemand   ("renderer.renderOnDemand",    "editor: render the scene only when something has changed",               1, CVarFlags::EditCheckbox);
+        CVarInt   CVarMeshletCulling   ("renderer.meshletCulling",    "cull the meshlets of the meshes against the view frustum and their normal cones", 1, CVarFlags::EditCheckbox);
+        CVarInt   CVarStaticBatching   ("renderer.staticBatching",    "game: merge the static entities sharing a material into the cached batches", 1, CVarFlags::EditCheckbox);
+        CVarInt   CVarImposters        ("renderer.imposters",         "draw the distant entities with ImposterComponent as billboards",          1, CVarFlags::EditCheckbox);
+        CVarInt   CVarShaderHotReload  ("renderer.shaderHotReload",   "reload the shader programs when their files or includes are saved",      0, CVarFlags::EditCheckbox);
+        CVarInt   CVarTextureArrays    ("renderer.materialTextureArrays", "game: group the material textures of the same format and size into texture arrays", 1, CVarFlags::EditCheckbox);
+        CVarInt   CVarUploadBudget     ("renderer.uploadBudgetKB",    "kilobytes of the streamed data (e.g. the terrain tiles) uploaded per frame", 16384);
+        CVarInt   CVarTextureStreaming ("renderer.textureStreaming",  "stream the mips of the cooked textures that are loaded afterwards",      1, CVarFlags::EditCheckbox);
+        CVarInt   CVarStreamingBudget  ("renderer.textureStreamingBudgetMB", "megabytes of the resident mips of the streamed textures",      512);
     }
 
     void RenderingSystem::onInit()
@@ -32,6 +70,12 @@ namespace mango
         m_statistics.driverVersion = (const char*)glGetString(GL_VERSION);
         m_statistics.glslVersion   = (const char*)glGetString(GL_SHADING_LANGUAGE_VERSION);
 
+        // Let the driver compile the requested programs on its own threads, they are linked at the end of the init
+        if (GLAD_GL_KHR_parallel_shader_compile)
+        {
+            glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+        }
+
         MG_CORE_ASSERT_MSG(Services::application()              != nullptr, "application can't be nullptr!");
         MG_CORE_ASSERT_MSG(Services::application()->getWindow() != nullptr, "window can't be nullptr!");
         MG_CORE_ASSERT_MSG(Services::eventBus()                 != nullptr, "eventBus can't be nullptr!");
@@ -43,6 +87,7 @@ namespace mango
         //Services::eventBus()->subscribe<ComponentReplacedEvent<StaticMeshComponent>>(MG_BIND_EVENT(RenderingSystem::receive));
         //Services::eventBus()->subscribe<ComponentRemovedEvent<StaticMeshComponent>>(MG_BIND_EVENT(RenderingSystem::receive));
         Services::eventBus()->subscribe<ActiveSceneChangedEvent>(MG_BIND_EVENT(RenderingSystem::receive));
+        Services::eventBus()->subscribe<MeshLoadedEvent>(MG_BIND_EVENT(RenderingSystem::receive));
 
         // Init debug views
         addDebugTexture("None", nullptr);
@@ -50,65 +95,57 @@ namespace mango
 
         m_opaqueQueue.reserve(50);
         m_alphaQueue.reserve(5);
+        m_oitQueue.reserve(5);
 
         m_forwardAmbient = AssetManager::createShader("Forward-Ambient", "Forward-Light.vert", "Forward-Ambient.frag");
-        m_forwardAmbient->link();
+        m_forwardAmbient->requestLink();
 
         m_forwardDirectional = AssetManager::createShader("Forward-Directional", "Forward-Light.vert", "Forward-Directional.frag");
-        m_forwardDirectional->link();
+        m_forwardDirectional->requestLink();
 
         m_forwardPoint = AssetManager::createShader("Forward-Point", "Forward-Light.vert", "Forward-Point.frag");
-        m_forwardPoint->link();
+        m_forwardPoint->requestLink();
 
         m_forwardSpot = AssetManager::createShader("Forward-Spot", "Forward-Light.vert", "Forward-Spot.frag");
-        m_forwardSpot->link();
+        m_forwardSpot->requestLink();
 
         m_debugRendering = AssetManager::createShader("Debug-Rendering", "FSQ.vert", "DebugRendering.frag");
-        m_debugRendering->link();
+        m_debugRendering->requestLink();
+        m_debugDepthRendering = m_debugRendering->getVariant(Shader::getKeywordMask("DEBUG_DEPTH_TARGET"));
 
         m_wireframeShader = AssetManager::createShader("Wireframe", "Wireframe.vert", "Wireframe.frag");
-        m_wireframeShader->link();
-
-        m_billboardSpriteEditorShader = AssetManager::createShader("BillboardSprite", "BillboardSprite.vert", "BillboardSprite.frag", "BillboardSprite.geom");
-        m_billboardSpriteEditorShader->link();
+        m_wireframeShader->requestLink();
 
         m_shadowMapGenerator = AssetManager::createShader("Shadow-Map-Gen", "Shadow-Map-Gen.vert", "Shadow-Map-Gen.frag");
-        m_shadowMapGenerator->link();
+        m_shadowMapGenerator->requestLink();
 
         m_omniShadowMapGenerator = AssetManager::createShader("Omni-Shadow-Map-Gen", "Omni-Shadow-Map-Gen.vert", "Omni-Shadow-Map-Gen.frag", "Omni-Shadow-Map-Gen.geom");
-        m_omniShadowMapGenerator->link();
+        m_omniShadowMapGenerator->requestLink();
 
         m_blendingShader = AssetManager::createShader("Blending-Shader", "Blending.vert", "Blending.frag");
-        m_blendingShader->link();
+        m_blendingShader->requestLink();
 
         m_enviroMappingShader = AssetManager::createShader("EnviroMapping", "EnviroMapping.vert", "EnviroMapping.frag");
-        m_enviroMappingShader->link();
+        m_enviroMappingShader->requestLink();
 
         m_deferredDirectional = AssetManager::createShader("Deferred-Directional", "FSQ.vert", "Deferred-Directional.frag");
-        m_deferredDirectional->link();
+        m_deferredDirectional->requestLink();
 
         m_deferredPoint = AssetManager::createShader("Deferred-Point", "DebugMesh.vert", "Deferred-Point.frag");
-        m_deferredPoint->link();
+        m_deferredPoint->requestLink();
 
         m_deferredSpot = AssetManager::createShader("Deferred-Spot", "DebugMesh.vert", "Deferred-Spot.frag");
-        m_deferredSpot->link();
-
-        m_debugMeshShader = AssetManager::createShader("DebugMesh", "DebugMesh.vert", "DebugMesh.frag");
-        m_debugMeshShader->link();
+        m_deferredSpot->requestLink();
 
         m_nullShader = AssetManager::createShader("NullShader", "DebugMesh.vert", "Shadow-Map-Gen.frag");
-        m_nullShader->link();
+        m_nullShader->requestLink();
 
         m_lightBoundingSphere = createRef<Mesh>();
         m_lightBoundingSphere->genSphere(1.1f, 36);
 
-        m_lightBoundingCone      = DebugMesh::createDebugSpotLight();
-        m_physicsColliderBox     = DebugMesh::createDebugBox();
-        m_physicsColliderSphere  = DebugMesh::createDebugSphere();
-        m_physicsColliderCapsule = DebugMesh::createDebugCapsule();
-        m_debugSpotLightMesh     = DebugMesh::createDebugCone();
-        m_debugDirLightMesh      = DebugMesh::createDebugDirLight();
-        m_debugCameraFrustumMesh = DebugMesh::createDebugCameraFrustum();
+        m_lightBoundingCone = DebugMesh::createDebugSpotLight();
+
+        DebugDraw::init();
 
         int width  = m_mainWindow->getWidth();
         int height = m_mainWindow->getHeight();
@@ -116,11 +153,32 @@ namespace mango
         s_DebugWindowWidth = GLuint(width / 5.0f);
         sceneAmbientColor  = glm::vec3(0.18f);
 
-        m_hdrFilter = createRef<PostprocessEffect>();
-        m_hdrFilter->init("HDR_PS", "HDR_PS.frag");
+        m_postprocessStack = createRef<PostprocessStack>();
+        m_postprocessStack->create("postprocess/Default.yaml");
+
+        m_gpuProfiler = createRef<GPUProfiler>();
+        m_gpuProfiler->init();
+
+        m_dynamicResolution = createRef<DynamicResolution>();
+
+        m_reflectionProbes = createRef<ReflectionProbes>();
+        m_reflectionProbes->init();
+        m_staticBatches    = createRef<StaticBatches>();
+
+        m_materialTextureArrays        = createRef<MaterialTextureArrays>();
+        m_materialTextureArraysKeyword = Shader::getKeywordMask("MATERIAL_TEXTURE_ARRAYS");
 
-        m_fxaaFilter = createRef<PostprocessEffect>();
-        m_fxaaFilter->init("FXAA_PS", "FXAA_PS.frag");
+        m_imposters = createRef<Imposters>();
+        m_imposters->init();
+
+        m_crowds = createRef<Crowds>();
+        m_crowds->init();
+
+        m_foliage = createRef<Foliage>();
+        m_foliage->init();
+
+        m_terrain = createRef<Terrain>();
+        m_terrain->init();
 
         m_deferredRendering = createRef<DeferredRendering>();
         m_deferredRendering->init();
@@ -136,6 +194,10 @@ namespace mango
         m_ssao->init("SSAO_PS", "SSAO.frag");
         m_ssao->create(width, height);
 
+        m_oit = createRef<WeightedBlendedOIT>();
+        m_oit->init("OIT-Composite", "OIT-Composite.frag");
+        m_oit->create(width, height);
+
         m_picking = createRef<Picking>();
         m_picking->init(width, height);
 
@@ -144,10 +206,17 @@ namespace mango
 
         m_mainRenderTarget = createRef<RenderTarget>();
         m_mainRenderTarget->create(width, height, RenderTarget::ColorInternalFormat::RGBA16F, RenderTarget::DepthInternalFormat::DEPTH32F_STENCIL8);
+        m_mainRenderTarget->setDynamicScaling(true);
 
         m_helperRenderTarget = createRef<RenderTarget>();
         m_helperRenderTarget->create(width, height, RenderTarget::ColorInternalFormat::RGBA16F, RenderTarget::DepthInternalFormat::DEPTH32F_STENCIL8);
 
+        // Postprocessed LDR image, the stencil is used by the selection outline
+        m_outputRenderTarget = createRef<RenderTarget>();
+        m_outputRenderTarget->create(width, height, RenderTarget::ColorInternalFormat::RGBA8, RenderTarget::DepthInternalFormat::DEPTH24_STENCIL8);
+
+        glCreateBuffers(1, &m_meshletCommandsBuffer);
+
         m_dirShadowMap = createRef<RenderTarget>();
         m_dirShadowMap->create(2048, 2048, RenderTarget::DepthInternalFormat::DEPTH24);
 
@@ -169,6 +238,8 @@ namespace mango
         m_cameraSpriteTexture = createRef<Texture>();
         m_cameraSpriteTexture->createTexture2d("textures/CameraSprite.png", false, 8);
 
+        AssetManager::linkPendingShaders();
+
         initRenderingStates();
     }
 
@@ -177,88 +248,765 @@ namespace mango
         MG_PROFILE_ZONE_SCOPED;
         MG_PROFILE_GL_ZONE("RenderingSystem::onUpdate");
 
+        // The frame is ended by Application after the GUI is rendered
+        m_gpuProfiler->beginFrame();
+
+        if (*CVarSystem::get()->getIntCVar("renderer.shaderHotReload") && m_shaderReloadTimer.elapsed() > 1.0f)
+        {
+            m_shaderReloadTimer.reset();
+
+            if (AssetManager::reloadChangedShaders() > 0)
+            {
+                requestRedraw();
+            }
+        }
+
+        // The variants requested by the materials, e.g. after a keyword was set in the editor
+        if (AssetManager::linkCompletedShaders() > 0)
+        {
+            requestRedraw();
+        }
+
         if (!m_activeScene)
         {
             glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+            DebugDraw::clear();
             return;
         }
 
-        glBindFramebuffer(GL_FRAMEBUFFER, m_outputToOffscreenTexture ? m_mainRenderTarget->m_fbo : 0);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
-
-        m_opaqueQueue.clear();
-        m_alphaQueue.clear();
-        m_enviroStaticQueue.clear();
-        m_enviroDynamicQueue.clear();
-
-        auto view = m_activeScene->getEntitiesWithComponent<StaticMeshComponent>();
+        // The crowds keep playing their clips, so they keep the viewport redrawing
+        m_crowdsTime += dt;
+        if (!m_activeScene->getEntitiesWithComponent<CrowdComponent>().empty())
+        {
+            requestRedraw();
+        }
 
-        for (auto& e : view)
+        // Keep the last image in the offscreen texture if nothing has changed since it was rendered
+        if (isRenderOnDemandActive())
         {
-             Entity entity = { e, m_activeScene };
+            if (m_camera && (m_camera->getView() != m_lastRenderedView || m_camera->getProjection() != m_lastRenderedProjection))
+            {
+                requestRedraw();
+            }
 
-            auto& smc = entity.getComponent<StaticMeshComponent>();
+            if (m_redrawFramesCount == 0)
+            {
+                DebugDraw::clear();
+                return;
+            }
 
-            if (!smc.mesh) continue;
+            --m_redrawFramesCount;
 
-            auto materialIndex = smc.mesh->getSubmesh()->materialIndex;
-            auto renderQueue   = smc.materials[materialIndex]->getRenderQueue();
-            
-            addEntityToRenderQueue(entity, renderQueue);
+            if (m_camera)
+            {
+                m_lastRenderedView       = m_camera->getView();
+                m_lastRenderedProjection = m_camera->getProjection();
+            }
         }
 
+        glBindFramebuffer(GL_FRAMEBUFFER, m_outputToOffscreenTexture ? m_outputRenderTarget->m_fbo : 0);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+
+        m_views.clear();
+
         // TODO: create two methods: renderGame and renderEditor + use switch
         // Or SceneRenderer class
         if (renderingMode == RenderingMode::GAME)
         {
             auto primaryCameraEntity = m_activeScene->getPrimaryCamera();
 
-            if (!primaryCameraEntity) return;
-
-            auto& cc = primaryCameraEntity.getComponent<CameraComponent>();
-            auto& tc = primaryCameraEntity.getComponent<TransformComponent>();
-            
-            m_camera         = &cc.camera;
-            m_cameraPosition = tc.getLocalPosition();
+            if (!primaryCameraEntity)
+            {
+                DebugDraw::clear();
+                return;
+            }
 
-            // Update the view matrix of the primary camera
-            glm::mat4 cameraRotation    = glm::mat4_cast(tc.getLocalOrientation());
-            glm::mat4 cameraTranslation = glm::translate(glm::mat4(1.0f), -tc.getLocalPosition());
+            m_views.push_back(createCameraView(primaryCameraEntity));
 
-            m_camera->setView(cameraRotation * cameraTranslation);
+            // Split-screen and picture-in-picture cameras are rendered on top of the primary camera
+            auto view = m_activeScene->getEntitiesWithComponent<CameraComponent>();
+            for (auto e : view)
+            {
+                auto& cc = view.get<CameraComponent>(e);
+                if (!cc.isAdditionalView || cc.isPrimary || m_views.size() == MAX_VIEWS) continue;
 
-            renderDeferred(m_activeScene);
+                m_views.push_back(createCameraView({ e, m_activeScene }));
+            }
         }
 
         if (renderingMode == RenderingMode::EDITOR)
         {
-            renderDeferred(m_activeScene);
+            if (!m_camera)
+            {
+                DebugDraw::clear();
+                return;
+            }
+
+            RenderView editorView;
+            editorView.camera           = m_camera;
+            editorView.position         = m_cameraPosition;
+            editorView.drawEditorGizmos = true;
+
+            m_views.push_back(editorView);
+
+            // Preview of the selected camera in the corner of the viewport
+            auto entity = SelectionManager::getSelectedEntity();
+            if (s_VisualizeCamera && entity && entity.hasComponent<CameraComponent>())
+            {
+                auto preview = createCameraView(entity);
+                preview.viewport = glm::vec4(0.73f, 0.02f, 0.25f, 0.25f);
+
+                m_views.push_back(preview);
+            }
+        }
+
+        updateStaticBatches();
+        updateMaterialTextureArrays();
+        m_foliage->update(m_activeScene);
+        m_terrain->update(m_activeScene, m_views[0].position);
+
+        // The whole scene target is used by every view and stretched to its viewport by the postprocess,
+        // so the projection has to match the aspect ratio of the viewport. It's set before the frustum planes are extracted by the culling
+        for (auto& view : m_views)
+        {
+            glm::vec2 viewportSize = getViewportSize(view);
+            if (viewportSize.x >= 1.0f && viewportSize.y >= 1.0f)
+            {
+                view.camera->resize(int(viewportSize.x), int(viewportSize.y));
+            }
+        }
 
+        // Everything that doesn't depend on the view is done once for all of the views
+        gatherRenderables();
+        cullRenderables();
+
+        m_camera         = m_views[0].camera;
+        m_cameraPosition = m_views[0].position;
+
+        renderReflectionProbes();
+
+        // Only the scaled passes of the scene, and only when their new time has arrived: the GUI doesn't scale with the resolution
+        // and a repeated sample would move the scale twice for one frame
+        if (auto sceneTiming = m_gpuProfiler->getPassTiming(SCENE_PASS_NAME); sceneTiming && sceneTiming->samplesCount != m_sceneTimingSamplesCount)
+        {
+            m_sceneTimingSamplesCount = sceneTiming->samplesCount;
+            m_dynamicResolution->update(sceneTiming->lastMs);
+        }
+
+        for (uint32_t viewIndex = 0; viewIndex < m_views.size(); ++viewIndex)
+        {
+            renderView(m_views[viewIndex], viewIndex);
+        }
+
+        // Keep the main view as the current camera, e.g. for the picking and the gizmos
+        m_camera         = m_views[0].camera;
+        m_cameraPosition = m_views[0].position;
+        m_currentView    = m_views[0];
+    }
+
+    RenderView RenderingSystem::createCameraView(Entity cameraEntity)
+    {
+        auto& cc = cameraEntity.getComponent<CameraComponent>();
+        auto& tc = cameraEntity.getComponent<TransformComponent>();
+
+        // Update the view matrix of the camera
+        glm::mat4 cameraRotation    = glm::mat4_cast(tc.getLocalOrientation());
+        glm::mat4 cameraTranslation = glm::translate(glm::mat4(1.0f), -tc.getLocalPosition());
+
+        cc.camera.setView(cameraRotation * cameraTranslation);
+
+        RenderView view;
+        view.camera    = &cc.camera;
+        view.position  = tc.getLocalPosition();
+        view.viewport  = glm::clamp(cc.viewport, glm::vec4(0.0f), glm::vec4(1.0f));
+        view.layerMask = cc.layerMask;
+
+        return view;
+    }
+
+    glm::vec2 RenderingSystem::getViewportSize(const RenderView& view) const
+    {
+        return glm::vec2(view.viewport.z, view.viewport.w) * glm::vec2(m_mainRenderTarget->getWidth(), m_mainRenderTarget->getHeight());
+    }
+
+    void RenderingSystem::renderView(const RenderView& view, uint32_t viewIndex)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+        MG_PROFILE_GL_ZONE("RenderingSystem::renderView");
+
+        glm::vec2 viewportSize = getViewportSize(view);
+        if (viewportSize.x < 1.0f || viewportSize.y < 1.0f)
+        {
+            return;
+        }
+
+        m_currentView    = view;
+        m_camera         = view.camera;
+        m_cameraPosition = view.position;
+
+        buildRenderQueues(viewIndex);
+        cullMeshlets(viewIndex);
+        requestTextureMips(viewIndex);
+
+        beginSceneRendering();
+        renderDeferred(m_activeScene);
+
+        if (view.drawEditorGizmos)
+        {
             // Draw the outline of the selected entity
             auto entity = SelectionManager::getSelectedEntity();
             if (entity)
             {
-                m_jfaOutline->render(m_mainRenderTarget, entity, outlineColor, outlineWidth);
+                MG_GPU_PASS(m_gpuProfiler.get(), "Outline");
+                m_jfaOutline->render(m_outputToOffscreenTexture ? m_outputRenderTarget : m_mainRenderTarget, entity, outlineColor, outlineWidth);
             }
 
             renderDebugView();
         }
     }
 
+    void RenderingSystem::gatherRenderables()
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        m_renderables      .clear();
+        m_renderableQueues .clear();
+        m_renderableLayers .clear();
+        m_boundsX          .clear();
+        m_boundsY          .clear();
+        m_boundsZ          .clear();
+        m_boundsRadius     .clear();
+        m_imposterDistancesSq.clear();
+        m_renderableMaterials.clear();
+        m_uvDensities      .clear();
+
+        auto view = m_activeScene->getEntitiesWithComponent<TransformComponent, StaticMeshComponent>();
+        for (auto e : view)
+        {
+            auto [tc, smc] = view.get<TransformComponent, StaticMeshComponent>(e);
+
+            if (!smc.mesh || m_staticBatches->isBatched(e)) continue;
+
+            auto  materialIndex = smc.mesh->getSubmesh()->materialIndex;
+            auto& material      = smc.materials[materialIndex];
+            auto  renderQueue   = material->getRenderQueue();
+
+            auto transparencyMode = material->getTransparencyMode();
+            if (transparencyMode == Material::TransparencyMode::DEFAULT)
+            {
+                transparencyMode = s_TransparencyMode;
+            }
+
+            std::vector<Entity>* queue = nullptr;
+            switch (renderQueue)
+            {
+                case Material::RenderQueue::RQ_OPAQUE:
+                    queue = &m_opaqueQueue;
+                    break;
+                case Material::RenderQueue::RQ_TRANSPARENT:
+                    queue = transparencyMode == Material::TransparencyMode::ORDER_INDEPENDENT ? &m_oitQueue : &m_alphaQueue;
+                    break;
+                case Material::RenderQueue::RQ_ENVIRO_MAPPING_STATIC:
+                    queue = &m_enviroStaticQueue;
+                    break;
+                case Material::RenderQueue::RQ_ENVIRO_MAPPING_DYNAMIC:
+                    queue = &m_enviroDynamicQueue;
+                    break;
+            }
+
+            if (!queue) continue;
+
+            Entity entity = { e, m_activeScene };
+
+            // World space bounding sphere
+            glm::mat4 world  = tc.getWorldMatrix();
+            glm::vec3 center = world * glm::vec4(smc.mesh->getBoundsCenter(), 1.0f);
+            float     scale  = glm::max(glm::length(glm::vec3(world[0])), glm::max(glm::length(glm::vec3(world[1])), glm::length(glm::vec3(world[2]))));
+
+            m_renderables     .push_back(entity);
+            m_renderableQueues.push_back(queue);
+            m_renderableLayers.push_back(entity.hasComponent<LayerComponent>() ? entity.getComponent<LayerComponent>().layers : 1u);
+            m_boundsX         .push_back(center.x);
+            m_boundsY         .push_back(center.y);
+            m_boundsZ         .push_back(center.z);
+            m_boundsRadius    .push_back(smc.mesh->getBoundsRadius() * scale);
+
+            float imposterDistance = entity.hasComponent<ImposterComponent>() ? entity.getComponent<ImposterComponent>().distance : 0.0f;
+            m_imposterDistancesSq.push_back(imposterDistance > 0.0f ? imposterDistance * imposterDistance : std::numeric_limits<float>::max());
+            m_renderableMaterials.push_back(material->getBase());
+
+            // One repeat of the texture coordinates over the bounds if the mesh doesn't know its density
+            float uvDensity = smc.mesh->getUVDensity();
+            m_uvDensities.push_back(uvDensity > 0.0f ? uvDensity / scale : 0.5f / glm::max(m_boundsRadius.back(), 0.001f));
+        }
+    }
+
+    void RenderingSystem::cullRenderables()
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        const uint32_t count = uint32_t(m_renderables.size());
+
+        m_visibleViewsMasks.assign(count, 0);
+        m_cullResults      .resize(count);
+
+        const float*    x       = m_boundsX.data();
+        const float*    y       = m_boundsY.data();
+        const float*    z       = m_boundsZ.data();
+        const float*    radius  = m_boundsRadius.data();
+        const uint32_t* layers  = m_renderableLayers.data();
+        uint32_t*       results = m_cullResults.data();
+        uint32_t*       masks   = m_visibleViewsMasks.data();
+
+        // Branchless loops over all of the renderables for each of the view planes, the results of the views are packed into the visibility masks
+        for (uint32_t viewIndex = 0; viewIndex < m_views.size(); ++viewIndex)
+        {
+            auto&     view           = m_views[viewIndex];
+            glm::mat4 viewProjection = glm::transpose(view.camera->getProjection() * view.camera->getView());
+
+            // Gribb-Hartmann frustum planes: left, right, bottom, top, near, far
+            glm::vec4 planes[6] = { viewProjection[3] + viewProjection[0], viewProjection[3] - viewProjection[0],
+                                    viewProjection[3] + viewProjection[1], viewProjection[3] - viewProjection[1],
+                                    viewProjection[3] + viewProjection[2], viewProjection[3] - viewProjection[2] };
+
+            const uint32_t layerMask = view.layerMask;
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                results[i] = (layers[i] & layerMask) != 0;
+            }
+
+            for (uint32_t p = 0; p < 6; ++p)
+            {
+                auto& plane = planes[p];
+                plane /= glm::length(glm::vec3(plane));
+
+                m_frustumPlanes[viewIndex][p] = plane;
+
+                const float a = plane.x, b = plane.y, c = plane.z, d = plane.w;
+                for (uint32_t i = 0; i < count; ++i)
+                {
+                    results[i] &= (a * x[i] + b * y[i] + c * z[i] + d) >= -radius[i];
+                }
+            }
+
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                masks[i] |= results[i] << viewIndex;
+            }
+        }
+    }
+
+    void RenderingSystem::buildRenderQueues(uint32_t viewIndex)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        m_opaqueQueue       .clear();
+        m_alphaQueue        .clear();
+        m_oitQueue          .clear();
+        m_enviroStaticQueue .clear();
+        m_enviroDynamicQueue.clear();
+        m_shadowCastersQueue.clear();
+        m_imposterQueue     .clear();
+        m_crowdQueue        .clear();
+        m_opaqueIndices     .clear();
+
+        const uint32_t  viewBit      = 1u << viewIndex;
+        const uint32_t  layerMask    = m_views[viewIndex].layerMask;
+        const glm::vec3 viewPosition = m_views[viewIndex].position;
+        const bool      useImposters = *CVarSystem::get()->getIntCVar("renderer.imposters");
+
+        uint32_t visibleCount = 0;
+        uint32_t culledCount  = 0;
+
+        for (uint32_t i = 0; i < m_renderables.size(); ++i)
+        {
+            if ((m_renderableLayers[i] & layerMask) == 0) continue;
+
+            auto* queue = m_renderableQueues[i];
+            if (queue == &m_opaqueQueue || queue == &m_enviroStaticQueue)
+            {
+                m_shadowCastersQueue.push_back(m_renderables[i]);
+            }
+
+            if (m_visibleViewsMasks[i] & viewBit)
+            {
+                glm::vec3 toView     = viewPosition - glm::vec3(m_boundsX[i], m_boundsY[i], m_boundsZ[i]);
+                bool      isImposter = useImposters && queue == &m_opaqueQueue && glm::dot(toView, toView) > m_imposterDistancesSq[i];
+
+                if (isImposter)
+                {
+                    m_imposterQueue.push_back(m_renderables[i]);
+                }
+                else if (queue == &m_opaqueQueue)
+                {
+                    m_opaqueIndices.push_back(i);
+                }
+                else
+                {
+                    queue->push_back(m_renderables[i]);
+                }
+                ++visibleCount;
+            }
+            else
+            {
+                ++culledCount;
+            }
+        }
+
+        // The material instances of a parent and variant are drawn together, so only their overrides are set between them
+        std::sort(m_opaqueIndices.begin(), m_opaqueIndices.end(), [this](uint32_t a, uint32_t b)
+        {
+            auto* materialA = m_renderableMaterials[a];
+            auto* materialB = m_renderableMaterials[b];
+
+            return std::make_pair(getMaterialKeywordsMask(materialA), materialA) < std::make_pair(getMaterialKeywordsMask(materialB), materialB);
+        });
+
+        for (auto i : m_opaqueIndices)
+        {
+            m_opaqueQueue.push_back(m_renderables[i]);
+        }
+
+        // The batches are culled like the entities and counted as ones
+        m_visibleStaticBatches     .clear();
+        m_shadowCasterStaticBatches.clear();
+
+        const glm::vec4* planes  = m_frustumPlanes[viewIndex];
+        auto&            batches = m_staticBatches->getBatches();
+
+        for (uint32_t i = 0; i < batches.size(); ++i)
+        {
+            auto& batch = batches[i];
+            if ((batch.layers & layerMask) == 0) continue;
+
+            m_shadowCasterStaticBatches.push_back(i);
+
+            bool visible = true;
+            for (uint32_t p = 0; p < 6; ++p)
+            {
+                visible &= glm::dot(glm::vec3(planes[p]), batch.center) + planes[p].w >= -batch.radius;
+            }
+
+            if (visible)
+            {
+                m_visibleStaticBatches.push_back(i);
+                ++visibleCount;
+            }
+            else
+            {
+                ++culledCount;
+            }
+        }
+
+        // The bounds of the crowds enclose every frame of their animations
+        auto crowds = m_activeScene->getEntitiesWithComponent<TransformComponent, CrowdComponent>();
+        for (auto e : crowds)
+        {
+            auto [tc, cc] = crowds.get<TransformComponent, CrowdComponent>(e);
+            if (!cc.animation) continue;
+
+            Entity entity = { e, m_activeScene };
+
+            uint32_t layers = entity.hasComponent<LayerComponent>() ? entity.getComponent<LayerComponent>().layers : 1u;
+            if ((layers & layerMask) == 0) continue;
+
+            glm::mat4 world  = tc.getWorldMatrix();
+            glm::vec3 center = world * glm::vec4(cc.animation->getBoundsCenter(), 1.0f);
+            float     scale  = glm::max(glm::length(glm::vec3(world[0])), glm::max(glm::length(glm::vec3(world[1])), glm::length(glm::vec3(world[2]))));
+            float     radius = cc.animation->getBoundsRadius() * scale;
+
+            bool visible = true;
+            for (uint32_t p = 0; p < 6; ++p)
+            {
+                visible &= glm::dot(glm::vec3(planes[p]), center) + planes[p].w >= -radius;
+            }
+
+            if (visible)
+            {
+                m_crowdQueue.push_back(entity);
+                ++visibleCount;
+            }
+            else
+            {
+                ++culledCount;
+            }
+        }
+
+        // The foliage and the terrains are culled by their cells and nodes, they aren't counted as entities
+        m_foliage->cull(planes, viewPosition, layerMask);
+        m_terrain->cull(planes, viewPosition, layerMask);
+
+        MG_RENDER_STATS_ENTITIES(visibleCount, culledCount);
+    }
+
+    void RenderingSystem::updateStaticBatches()
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        // The static entities are merged when the game starts, the editor keeps them separate so they can still be moved
+        bool   useStaticBatches = renderingMode == RenderingMode::GAME && *CVarSystem::get()->getIntCVar("renderer.staticBatching");
+        Scene* scene            = useStaticBatches ? m_activeScene : nullptr;
+
+        if (scene == m_staticBatchesScene) return;
+
+        m_staticBatchesScene = scene;
+
+        if (scene)
+        {
+            m_staticBatches->build(scene);
+        }
+        else
+        {
+            m_staticBatches->clear();
+        }
+
+        m_allStaticBatches.resize(m_staticBatches->getBatches().size());
+        std::iota(m_allStaticBatches.begin(), m_allStaticBatches.end(), 0u);
+    }
+
+    void RenderingSystem::updateMaterialTextureArrays()
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        // Grouped when the game starts like the static batches, the editor can still change the textures of the materials
+        bool   useTextureArrays = renderingMode == RenderingMode::GAME && *CVarSystem::get()->getIntCVar("renderer.materialTextureArrays");
+        Scene* scene            = useTextureArrays ? m_activeScene : nullptr;
+
+        if (scene == m_materialTextureArraysScene) return;
+
+        m_materialTextureArraysScene = scene;
+
+        if (scene)
+        {
+            std::vector<ref<Material>> materials;
+            for (auto& [name, material] : AssetManager::getMaterialList())
+            {
+                materials.push_back(material);
+            }
+
+            m_materialTextureArrays->build(materials);
+        }
+        else
+        {
+            m_materialTextureArrays->clear();
+        }
+    }
+
+    void RenderingSystem::requestTextureMips(uint32_t viewIndex)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        auto&            view         = m_views[viewIndex];
+        const glm::mat4& projection   = view.camera->getProjection();
+        const bool       isOrthogonal = projection[3][3] == 1.0f;
+        const float      nearClip     = view.camera->getPerspectiveNearClip();
+
+        // Pixels per world unit at the distance of one unit, at any distance for the orthographic projection
+        const float pixelsPerUnit = 0.5f * view.viewport.w * float(m_mainRenderTarget->getHeight()) * projection[1][1];
+
+        auto pixelsPerUV = [&](const glm::vec3& center, float radius, float uvDensity)
+        {
+            float distance = isOrthogonal ? 1.0f : glm::max(glm::distance(view.position, center) - radius, nearClip);
+            return pixelsPerUnit / (distance * uvDensity);
+        };
+
+        const uint32_t viewBit = 1u << viewIndex;
+        for (uint32_t i = 0; i < m_renderables.size(); ++i)
+        {
+            if ((m_visibleViewsMasks[i] & viewBit) == 0) continue;
+
+            glm::vec3 center = glm::vec3(m_boundsX[i], m_boundsY[i], m_boundsZ[i]);
+            TextureStreaming::requestMips(*m_renderableMaterials[i], pixelsPerUV(center, m_boundsRadius[i], m_uvDensities[i]));
+        }
+
+        // The batched vertices are in the world space already
+        if (!m_visibleStaticBatches.empty())
+        {
+            auto& batches   = m_staticBatches->getBatches();
+            float uvDensity = m_staticBatches->getMesh()->getUVDensity();
+
+            for (auto i : m_visibleStaticBatches)
+            {
+                auto& batch = batches[i];
+                TextureStreaming::requestMips(*batch.material, pixelsPerUV(batch.center, batch.radius, uvDensity > 0.0f ? uvDensity : 0.5f / glm::max(batch.radius, 0.001f)));
+            }
+        }
+
+        for (auto& entity : m_crowdQueue)
+        {
+            auto& cc   = entity.getComponent<CrowdComponent>();
+            auto& mesh = cc.animation->getMesh();
+
+            glm::mat4 world  = entity.getComponent<TransformComponent>().getWorldMatrix();
+            glm::vec3 center = world * glm::vec4(cc.animation->getBoundsCenter(), 1.0f);
+            float     scale  = glm::max(glm::length(glm::vec3(world[0])), glm::max(glm::length(glm::vec3(world[1])), glm::length(glm::vec3(world[2]))));
+            float     radius = cc.animation->getBoundsRadius() * scale;
+
+            float uvDensity = mesh->getUVDensity();
+            uvDensity = uvDensity > 0.0f ? uvDensity / scale : 0.5f / glm::max(radius, 0.001f);
+
+            float pixels = pixelsPerUV(center, radius, uvDensity);
+            for (auto& material : mesh->getMaterials())
+            {
+                if (material)
+                {
+                    TextureStreaming::requestMips(*material, pixels);
+                }
+            }
+        }
+
+        // The foliage and the terrains are culled by their cells and nodes
+        m_foliage->requestTextureMips(pixelsPerUV);
+        m_terrain->requestTextureMips(pixelsPerUV);
+    }
+
+    void RenderingSystem::cullMeshlets(uint32_t viewIndex)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+        MG_PROFILE_GL_ZONE("RenderingSystem::cullMeshlets");
+
+        m_meshletDrawsOffsets.clear();
+        m_meshletDraws       .clear();
+        m_meshletCommands    .clear();
+
+        if (!*CVarSystem::get()->getIntCVar("renderer.meshletCulling")) return;
+
+        // Only the culled queues are drawn with the meshlets: the shadow casters and the probes see the meshes from the other viewpoints
+        // and the transparent meshes are rendered without face culling
+        uint32_t jobsCount = 0;
+        auto addJobs = [this, &jobsCount](const std::vector<Entity>& queue)
+        {
+            for (auto& entity : queue)
+            {
+                auto& mesh = entity.getComponent<StaticMeshComponent>().mesh;
+                if (mesh->getMeshlets().size() < 2) continue;
+
+                if (jobsCount == m_meshletCullingJobs.size())
+                {
+                    m_meshletCullingJobs.emplace_back();
+                }
+
+                auto& job  = m_meshletCullingJobs[jobsCount++];
+                job.mesh   = mesh.get();
+                job.model  = entity.getComponent<TransformComponent>().getWorldMatrix();
+                job.entity = entity;
+            }
+        };
+
+        addJobs(m_opaqueQueue);
+        addJobs(m_enviroStaticQueue);
+        addJobs(m_enviroDynamicQueue);
+
+        if (jobsCount == 0) return;
+
+        const glm::vec4* planes = m_frustumPlanes[viewIndex];
+        const auto&      view   = m_views[viewIndex];
+
+        // The camera looks down -z of its view space, the third row of the view matrix is its z axis in the world space
+        const glm::mat4& cameraView = view.camera->getView();
+
+        Meshlets::Viewer viewer;
+        viewer.position       = view.position;
+        viewer.direction      = -glm::normalize(glm::vec3(cameraView[0][2], cameraView[1][2], cameraView[2][2]));
+        viewer.isOrthographic = view.camera->getProjectionType() == Camera::ProjectionType::Orthographic;
+
+        tf::Taskflow taskflow;
+        taskflow.for_each_index(0u, jobsCount, 1u, [this, planes, &viewer](uint32_t i)
+        {
+            auto& job       = m_meshletCullingJobs[i];
+            auto& meshlets  = job.mesh->getMeshlets();
+
+            job.commands    .clear();
+            job.submeshDraws.clear();
+            job.visibleCount = 0;
+            job.culledCount  = 0;
+
+            for (auto& submesh : job.mesh->getSubmeshes())
+            {
+                MeshletDraws draws;
+                draws.firstCommand = uint32_t(job.commands.size());
+
+                uint32_t culledCount = Meshlets::cull(meshlets.data() + submesh.meshletOffset, submesh.meshletsCount, job.model, planes, viewer,
+                                                      int32_t(submesh.baseVertex), job.commands);
+
+                draws.commandsCount = uint32_t(job.commands.size()) - draws.firstCommand;
+                for (uint32_t c = draws.firstCommand; c < job.commands.size(); ++c)
+                {
+                    draws.indicesCount += job.commands[c].count;
+                }
+
+                job.submeshDraws.push_back(draws);
+                job.visibleCount += submesh.meshletsCount - culledCount;
+                job.culledCount  += culledCount;
+            }
+        });
+        Jobs::executor.run(taskflow).wait();
+
+        uint32_t visibleCount = 0;
+        uint32_t culledCount  = 0;
+
+        for (uint32_t i = 0; i < jobsCount; ++i)
+        {
+            auto& job = m_meshletCullingJobs[i];
+
+            m_meshletDrawsOffsets[job.entity] = uint32_t(m_meshletDraws.size());
+            for (auto draws : job.submeshDraws)
+            {
+                draws.firstCommand += uint32_t(m_meshletCommands.size());
+                m_meshletDraws.push_back(draws);
+            }
+
+            m_meshletCommands.insert(m_meshletCommands.end(), job.commands.begin(), job.commands.end());
+
+            visibleCount += job.visibleCount;
+            culledCount  += job.culledCount;
+        }
+
+        GLsizeiptr size = GLsizeiptr(m_meshletCommands.size() * sizeof(DrawElementsIndirectCommand));
+
+        // Read from the staging ring, so the commands of the previous view aren't waited for
+        m_meshletCommandsRange = GPUUploads::stream(m_meshletCommands.data(), size, m_meshletCommandsBuffer);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_meshletCommandsRange.buffer);
+
+        MG_RENDER_STATS_MESHLETS(visibleCount, culledCount);
+    }
+
     void RenderingSystem::onDestroy()
     {
         MG_PROFILE_ZONE_SCOPED;
 
+        DebugDraw::shutdown();
+
         m_opaqueQueue.clear();
         m_alphaQueue.clear();
+        m_oitQueue.clear();
         m_enviroStaticQueue.clear();
         m_enviroDynamicQueue.clear();
+        m_shadowCastersQueue.clear();
+        m_renderables.clear();
+
+        m_staticBatches->clear();
+        m_staticBatchesScene = nullptr;
+
+        m_materialTextureArrays->clear();
+        m_materialTextureArraysScene = nullptr;
+
+        m_imposters->clear();
+        m_crowds   ->clear();
+        m_crowdQueue.clear();
+        m_foliage  ->clear();
+        m_terrain  ->clear();
+
+        glDeleteBuffers(1, &m_meshletCommandsBuffer);
+        m_meshletCommandsBuffer = 0;
     }
 
     void RenderingSystem::receive(const EntityRemovedEvent& event)
     {
         MG_PROFILE_ZONE_SCOPED;
 
+        requestRedraw();
+
         if (event.entity.get().hasComponent<StaticMeshComponent>())
         {
             //auto& smc          = event.entity.get().getComponent<StaticMeshComponent>();
@@ -300,6 +1048,49 @@ namespace mango
     //    removeEntityFromRenderQueue(event.entity, renderQueue);
     //}
 
+    void RenderingSystem::receive(const MeshLoadedEvent& event)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        requestRedraw();
+
+        // The imposters of the placeholder are baked again
+        m_imposters->clear();
+
+        if (!m_activeScene) return;
+
+        /* The components added while the mesh was a placeholder get the materials of the loaded mesh, the ones that were set stay */
+        auto  meshMaterials        = event.mesh->getMaterials();
+        auto& placeholderMaterials = event.placeholderMaterials;
+        auto  fillMaterials        = [&meshMaterials, &placeholderMaterials](MaterialTable& materials)
+        {
+            if (materials.size() < meshMaterials.size())
+            {
+                materials.resize(meshMaterials.size());
+            }
+
+            for (uint32_t i = 0; i < meshMaterials.size(); ++i)
+            {
+                bool isPlaceholder = i < placeholderMaterials.size() && materials[i] == placeholderMaterials[i];
+                if (!materials[i] || isPlaceholder) materials[i] = meshMaterials[i];
+            }
+        };
+
+        auto staticMeshes = m_activeScene->getEntitiesWithComponent<StaticMeshComponent>();
+        for (auto e : staticMeshes)
+        {
+            auto& smc = staticMeshes.get<StaticMeshComponent>(e);
+            if (smc.mesh == event.mesh) fillMaterials(smc.materials);
+        }
+
+        auto foliage = m_activeScene->getEntitiesWithComponent<FoliageComponent>();
+        for (auto e : foliage)
+        {
+            auto& fc = foliage.get<FoliageComponent>(e);
+            if (fc.mesh == event.mesh) fillMaterials(fc.materials);
+        }
+    }
+
     void RenderingSystem::receive(const ActiveSceneChangedEvent& event)
     {
         MG_PROFILE_ZONE_SCOPED;
@@ -307,8 +1098,27 @@ namespace mango
 
         m_opaqueQueue.clear();
         m_alphaQueue.clear();
+        m_oitQueue.clear();
         m_enviroStaticQueue.clear();
         m_enviroDynamicQueue.clear();
+        m_shadowCastersQueue.clear();
+        m_renderables.clear();
+
+        m_reflectionProbes->clear();
+        m_imposters->clear();
+        m_crowds   ->clear();
+        m_crowdQueue.clear();
+        m_foliage  ->clear();
+        m_terrain  ->clear();
+        requestRedraw();
+
+        // The batches and the texture arrays are rebuilt for the new scene by the next frame
+        m_staticBatches->clear();
+        m_staticBatchesScene = nullptr;
+        m_allStaticBatches.clear();
+
+        m_materialTextureArrays->clear();
+        m_materialTextureArraysScene = nullptr;
 
         m_activeScene = event.scene;
 
@@ -324,9 +1134,18 @@ namespace mango
         }
     }
 
+    RendererStatistics RenderingSystem::getStatistics() const
+    {
+        auto statistics  = m_statistics;
+        statistics.frame = RenderStats::getLastFrame();
+
+        return statistics;
+    }
+
     void RenderingSystem::setSkybox(const ref<Skybox>& skybox)
     {
         m_skybox = skybox;
+        requestRedraw();
     }
 
     void RenderingSystem::resize(unsigned width, unsigned height)
@@ -335,18 +1154,23 @@ namespace mango
         MG_PROFILE_GL_ZONE("RenderingSystem::resize");
 
         m_mainFramebufferSize = { width, height };
+        requestRedraw();
 
         m_mainRenderTarget->clear();
         m_helperRenderTarget->clear();
+        m_outputRenderTarget->clear();
         m_deferredRendering->clearGBuffer();
         m_bloomFilter->clear();
         m_ssao->clear();
+        m_oit->clear();
 
         m_mainRenderTarget->create(width, height, RenderTarget::ColorInternalFormat::RGBA16F, RenderTarget::DepthInternalFormat::DEPTH32F_STENCIL8);
         m_helperRenderTarget->create(width, height, RenderTarget::ColorInternalFormat::RGBA16F, RenderTarget::DepthInternalFormat::DEPTH32F_STENCIL8);
+        m_outputRenderTarget->create(width, height, RenderTarget::ColorInternalFormat::RGBA8, RenderTarget::DepthInternalFormat::DEPTH24_STENCIL8);
         m_deferredRendering->createGBuffer(width, height);
         m_bloomFilter->create(width, height);
         m_ssao->create(width, height);
+        m_oit->create(width, height);
         m_picking->resize(width, height);
         m_jfaOutline->resize(width, height);
 
@@ -405,6 +1229,8 @@ namespace mango
                 pickingBillboardShader->setUniform("position", tc.getPosition());
                 pickingBillboardShader->setUniform("objectID", (int)id);
 
+                MG_RENDER_STATS_DRAW(GL_POINTS, 1, 0);
+
                 glDrawArrays(GL_POINTS, 0, 1);
             }
             glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
@@ -421,6 +1247,8 @@ namespace mango
                 pickingBillboardShader->setUniform("position", tc.getPosition());
                 pickingBillboardShader->setUniform("objectID", (int)id);
 
+                MG_RENDER_STATS_DRAW(GL_POINTS, 1, 0);
+
                 glDrawArrays(GL_POINTS, 0, 1);
             }
             glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
@@ -437,6 +1265,8 @@ namespace mango
                 pickingBillboardShader->setUniform("position", tc.getPosition());
                 pickingBillboardShader->setUniform("objectID", (int)id);
 
+                MG_RENDER_STATS_DRAW(GL_POINTS, 1, 0);
+
                 glDrawArrays(GL_POINTS, 0, 1);
             }
             glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
@@ -453,6 +1283,8 @@ namespace mango
                 pickingBillboardShader->setUniform("position", tc.getPosition());
                 pickingBillboardShader->setUniform("objectID", (int)id);
 
+                MG_RENDER_STATS_DRAW(GL_POINTS, 1, 0);
+
                 glDrawArrays(GL_POINTS, 0, 1);
             }
             glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
@@ -468,7 +1300,7 @@ namespace mango
 
     uint32_t RenderingSystem::getOutputOffscreenTextureID() const
     {
-        return m_mainRenderTarget->m_textures[0]->getRendererID();
+        return m_outputRenderTarget->m_textures[0]->getRendererID();
     }
 
     void RenderingSystem::setRenderingMode(RenderingMode mode, Camera* editorCamera /*= nullptr*/, const glm::vec3& editorCameraPosition /*= glm::vec3(0.0f)*/)
@@ -478,11 +1310,32 @@ namespace mango
         m_cameraPosition = editorCameraPosition;
     }
 
+    void RenderingSystem::requestRedraw()
+    {
+        // Render a few frames, so the time-sliced work (e.g. reflection probes) and the GPU timings can settle
+        m_redrawFramesCount = REDRAW_FRAMES_COUNT;
+    }
+
+    bool RenderingSystem::isIdle() const
+    {
+        return isRenderOnDemandActive() && m_redrawFramesCount == 0;
+    }
+
+    bool RenderingSystem::isRenderOnDemandActive() const
+    {
+        return renderingMode == RenderingMode::EDITOR && m_outputToOffscreenTexture && *CVarSystem::get()->getIntCVar("renderer.renderOnDemand");
+    }
+
     Camera& RenderingSystem::getCamera() const
     {
         return *(m_camera);
     }
 
+    float RenderingSystem::getRenderScale() const
+    {
+        return m_dynamicResolution->getScale();
+    }
+
     void RenderingSystem::addDebugTexture(const std::string& viewName, const ref<Texture>& texture)
     {
         m_debugViews[viewName] = texture;
@@ -543,28 +1396,40 @@ namespace mango
         m_mainRenderTarget->bind();
     }
 
-    void RenderingSystem::applyPostprocess(ref<PostprocessEffect> & effect, 
-                                           ref<RenderTarget>      * src, 
-                                           ref<RenderTarget>      * dst)
+    void RenderingSystem::beginSceneRendering()
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        RenderTarget::setRenderScale(m_dynamicResolution->getScale());
+
+        // Ended by applyPostprocess, it times the passes drawn at the render scale for the dynamic resolution
+        m_gpuProfiler->beginPass(SCENE_PASS_NAME);
+
+        // Full screen passes that sample the scene targets have to read only the rendered sub-rect
+        glm::vec2 uvScale = glm::vec2(m_mainRenderTarget->getViewportSize()) / glm::vec2(m_mainRenderTarget->getWidth(), m_mainRenderTarget->getHeight());
+
+        m_deferredDirectional->setUniform("uv_scale", uvScale);
+        m_ssao->setUVScale(uvScale);
+        m_bloomFilter->setUVScale(uvScale);
+        m_postprocessStack->getShader()->setUniform("uv_scale", uvScale);
+    }
+
+    void RenderingSystem::applyPostprocess()
     {
         MG_PROFILE_ZONE_SCOPED;
         MG_PROFILE_GL_ZONE("RenderingSystem::applyPostprocess");
 
-        if(dst == nullptr)
-        {
-            glBindFramebuffer(GL_FRAMEBUFFER, 0);
-            glViewport(0, 0, m_mainWindow->getWidth(), m_mainWindow->getHeight());
-        }
-        else
-        {
-            dst->get()->bind();
-        }
+        m_gpuProfiler->endPass();
 
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        // Postprocess upscales the scene to the output size
+        RenderTarget::setRenderScale(1.0f);
 
-        effect->bind();
-        src->get()->bindTexture();
-        effect->render();
+        m_bloomFilter->bindBrightnessTexture(1);
+        m_postprocessStack->apply(m_mainRenderTarget,
+                                  m_helperRenderTarget,
+                                  m_outputToOffscreenTexture ? m_outputRenderTarget : nullptr,
+                                  { m_mainWindow->getWidth(), m_mainWindow->getHeight() },
+                                  m_currentView.viewport);
     }
 
     void RenderingSystem::renderForward(Scene* scene)
@@ -576,21 +1441,18 @@ namespace mango
         m_mainRenderTarget->bind();
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-        m_forwardAmbient->bind();
-        m_forwardAmbient->setUniform("s_scene_ambient", sceneAmbientColor);
-        renderEntitiesInQueue(m_forwardAmbient, m_opaqueQueue);
+        {
+            MG_GPU_PASS(m_gpuProfiler.get(), "Forward Ambient");
 
-        renderLightsForward(scene);
+            m_forwardAmbient->bind();
+            m_forwardAmbient->setUniform("s_scene_ambient", sceneAmbientColor);
+            renderEntitiesInQueue(m_forwardAmbient, m_opaqueQueue);
+        }
 
-        /* Sort transparent objects back to front */
-        sortAlpha();
+        renderLightsForward(scene);
 
         /* Render transparent objects */
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-        glDisable(GL_CULL_FACE);
-        m_blendingShader->bind();
-        renderEntitiesInQueue(m_blendingShader, m_alphaQueue);
-        glEnable(GL_CULL_FACE);
+        renderTransparent();
 
         if (s_VisualizeLight)
         {
@@ -611,21 +1473,22 @@ namespace mango
         if (m_skybox != nullptr)
         {
             m_skybox->render(getCamera().getProjection(), getCamera().getView());
-
-            m_enviroMappingShader->bind();
-            m_enviroMappingShader->setSubroutine(Shader::Type::FRAGMENT, "reflection"); // TODO: control this using Material class
-
-            m_skybox->bindSkyboxTexture();
-            renderEntitiesInQueue(m_enviroMappingShader, m_enviroStaticQueue);
         }
 
+        renderEnviroMapping();
+
         /* Apply postprocess effect */
-        m_bloomFilter->extractBrightness(m_mainRenderTarget, 1.0);
-        m_bloomFilter->blurGaussian(2);
-        m_bloomFilter->bindBrightnessTexture(1);
+        const auto& bloom = m_postprocessStack->getSettings().bloom;
+        if (bloom.enabled)
+        {
+            MG_GPU_PASS(m_gpuProfiler.get(), "Bloom");
+
+            m_bloomFilter->extractBrightness(m_mainRenderTarget, bloom.threshold);
+            m_bloomFilter->blurGaussian(bloom.blurIterations);
+        }
 
-        applyPostprocess(m_hdrFilter, &m_mainRenderTarget, &m_helperRenderTarget);
-        applyPostprocess(m_fxaaFilter, &m_helperRenderTarget, m_outputToOffscreenTexture ? &m_mainRenderTarget : 0);
+        renderDebugDraw();
+        applyPostprocess();
     }
 
     void RenderingSystem::renderDeferred(Scene* scene)
@@ -645,12 +1508,24 @@ namespace mango
 
         if (ShadingMode::SHADED == s_ShadingMode || ShadingMode::SHADED_WIREFRAME == s_ShadingMode)
         {
-            m_gbufferShader->bind();
-            renderEntitiesInQueue(m_gbufferShader, m_opaqueQueue);
+            {
+                MG_GPU_PASS(m_gpuProfiler.get(), "GBuffer");
+
+                m_gbufferShader->bind();
+                renderEntitiesInQueue(m_gbufferShader, m_opaqueQueue);
+                renderImposters();
+                renderCrowds();
+                renderFoliage();
+                renderTerrain();
+            }
 
             /* Compute SSAO */
-            m_ssao->computeSSAO(m_deferredRendering, getCamera().getView(), getCamera().getProjection());
-            m_ssao->blurSSAO();
+            {
+                MG_GPU_PASS(m_gpuProfiler.get(), "SSAO");
+
+                m_ssao->computeSSAO(m_deferredRendering, getCamera().getView(), getCamera().getProjection());
+                m_ssao->blurSSAO();
+            }
 
             glDepthMask(GL_FALSE);
 
@@ -660,8 +1535,9 @@ namespace mango
 
             m_deferredRendering->bindGBufferReadOnly();
             m_mainRenderTarget->bindWriteOnly();
-            glBlitFramebuffer(0, 0, m_mainWindow->getWidth(), m_mainWindow->getHeight(),
-                              0, 0, m_mainWindow->getWidth(), m_mainWindow->getHeight(),
+            auto viewportSize = m_mainRenderTarget->getViewportSize();
+            glBlitFramebuffer(0, 0, viewportSize.x, viewportSize.y,
+                              0, 0, viewportSize.x, viewportSize.y,
                               GL_DEPTH_BUFFER_BIT, GL_NEAREST);
 
             m_ssao->bindBlurredSSAOTexture(9); //TODO: replace magic number with a variable
@@ -671,7 +1547,7 @@ namespace mango
             glEnable(GL_DEPTH_TEST);
             glDepthMask(GL_TRUE);
 
-            if (renderingMode == RenderingMode::EDITOR)
+            if (m_currentView.drawEditorGizmos)
             {
                 if (s_VisualizeLight)
                 {
@@ -691,33 +1567,26 @@ namespace mango
                 renderLightBillboards(scene);
             }
 
-            /* Sort transparent objects back to front */
-            sortAlpha();
-
             /* Render transparent objects */
-            glEnable(GL_BLEND);
-            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-            glDisable(GL_CULL_FACE);
-            m_blendingShader->bind();
-            renderEntitiesInQueue(m_blendingShader, m_alphaQueue);
-            glEnable(GL_CULL_FACE);
+            renderTransparent();
 
             /* Render skybox */
             if (m_skybox != nullptr)
             {
                 m_skybox->render(getCamera().getProjection(), getCamera().getView());
-
-                m_enviroMappingShader->bind();
-                //m_enviro_mapping_shader->setSubroutine(Shader::Type::FRAGMENT, "refraction"); // TODO: control this using Material class
-                m_enviroMappingShader->setSubroutine(Shader::Type::FRAGMENT, "reflection");
-
-                m_skybox->bindSkyboxTexture();
-                renderEntitiesInQueue(m_enviroMappingShader, m_enviroStaticQueue);
             }
 
+            renderEnviroMapping();
+
             /* Apply postprocess effect */
-            m_bloomFilter->extractBrightness(m_mainRenderTarget, 1.0);
-            m_bloomFilter->blurGaussian(2);
+            const auto& bloom = m_postprocessStack->getSettings().bloom;
+            if (bloom.enabled)
+            {
+                MG_GPU_PASS(m_gpuProfiler.get(), "Bloom");
+
+                m_bloomFilter->extractBrightness(m_mainRenderTarget, bloom.threshold);
+                m_bloomFilter->blurGaussian(bloom.blurIterations);
+            }
         }
         
         if (ShadingMode::WIREFRAME == s_ShadingMode || ShadingMode::SHADED_WIREFRAME == s_ShadingMode)
@@ -738,6 +1607,7 @@ namespace mango
 
             renderEntitiesInQueue(m_wireframeShader, m_opaqueQueue);
             renderEntitiesInQueue(m_wireframeShader, m_alphaQueue);
+            renderEntitiesInQueue(m_wireframeShader, m_oitQueue);
             renderEntitiesInQueue(m_wireframeShader, m_enviroStaticQueue);
             renderEntitiesInQueue(m_wireframeShader, m_enviroDynamicQueue);
 
@@ -745,9 +1615,8 @@ namespace mango
             glDisable(GL_POLYGON_OFFSET_LINE);
         }
 
-        m_bloomFilter->bindBrightnessTexture(1);
-        applyPostprocess(m_hdrFilter, &m_mainRenderTarget, &m_helperRenderTarget);
-        applyPostprocess(m_fxaaFilter, &m_helperRenderTarget, m_outputToOffscreenTexture ? &m_mainRenderTarget : 0);
+        renderDebugDraw();
+        applyPostprocess();
     }
 
     void RenderingSystem::renderDebugView()
@@ -761,340 +1630,599 @@ namespace mango
         glDisable(GL_BLEND);
         glClear(GL_DEPTH_BUFFER_BIT);
 
-        m_debugRendering->bind();
+        auto format = debugViewTexture->getDescriptor().format;
+        bool isDepth  = (RenderTarget::DepthInternalFormat)format == RenderTarget::DepthInternalFormat::DEPTH16;
+             isDepth |= (RenderTarget::DepthInternalFormat)format == RenderTarget::DepthInternalFormat::DEPTH24;
+             isDepth |= (RenderTarget::DepthInternalFormat)format == RenderTarget::DepthInternalFormat::DEPTH32;
+             isDepth |= (RenderTarget::DepthInternalFormat)format == RenderTarget::DepthInternalFormat::DEPTH32F;
+             isDepth |= (RenderTarget::DepthInternalFormat)format == RenderTarget::DepthInternalFormat::DEPTH24_STENCIL8;
+             isDepth |= (RenderTarget::DepthInternalFormat)format == RenderTarget::DepthInternalFormat::DEPTH32F_STENCIL8;
+             isDepth |= (RenderTarget::DepthInternalFormat)format == RenderTarget::DepthInternalFormat::STENCIL_INDEX8;
+
+        auto& debugShader = isDepth ? m_debugDepthRendering : m_debugRendering;
+        debugShader->bind();
+
+        // Note: editor camera is always set to perspective
+        debugShader->setUniform("nearZ", getCamera().getPerspectiveNearClip());
+        debugShader->setUniform("farZ",  getCamera().getPerspectiveFarClip());
+ 
+        debugViewTexture->bind(0);
+        glViewport(0, 0, m_mainFramebufferSize.x, m_mainFramebufferSize.y);
+        m_deferredRendering->render();
+
+        glEnable(GL_BLEND);
+    }
+
+    void RenderingSystem::renderDebugLightMesh(Entity entity)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        if (!entity)
+        {
+            return;
+        }
+
+        /* Point Lights */
+        if (entity.hasComponent<PointLightComponent>())
+        {
+            auto& pointLight = entity.getComponent<PointLightComponent>();
+            auto& transform  = entity.getComponent<TransformComponent>();
+
+            auto model = glm::translate(glm::mat4(1.0f), transform.getPosition()) *
+                         glm::scale(glm::mat4(1.0f), glm::vec3(pointLight.getRange()));
+
+            DebugDraw::wireShape(DebugDraw::Shape::SPHERE, model, pointLight.color);
+        }
+
+        /* Spot Lights */
+        if (entity.hasComponent<SpotLightComponent>())
+        {
+            auto& spotLight = entity.getComponent<SpotLightComponent>();
+            auto& transform = entity.getComponent<TransformComponent>();
+
+            float heightScale = spotLight.getRange();
+            float radiusScale = spotLight.getRange() * glm::tan(spotLight.getCutOffAngle()); 
+
+            auto model = glm::translate(glm::mat4(1.0f), transform.getPosition()) *
+                         glm::mat4_cast(transform.getOrientation()) *
+                         glm::scale(glm::mat4(1.0f), glm::vec3(radiusScale, radiusScale, heightScale));
+
+            DebugDraw::wireShape(DebugDraw::Shape::CONE, model, spotLight.color);
+        }
+
+        /* Directional Lights */
+        if (entity.hasComponent<DirectionalLightComponent>())
+        {
+            auto& dirLight  = entity.getComponent<DirectionalLightComponent>();
+            auto& transform = entity.getComponent<TransformComponent>();
+
+            float scaleFactor = length(transform.getPosition() - m_cameraPosition) * m_camera->getPerspectiveVerticalFieldOfView() * 0.05f;
+
+            auto model = glm::translate(glm::mat4(1.0f), transform.getPosition()) *
+                         glm::mat4_cast(glm::inverse(transform.getOrientation())) *
+                         glm::scale(glm::mat4(1.0f), glm::vec3(scaleFactor));
+
+            DebugDraw::wireShape(DebugDraw::Shape::DIR_LIGHT, model, dirLight.color);
+        }
+    }
+
+    void RenderingSystem::renderDebugCameraFrustumMesh(Entity entity)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        if (!entity || !entity.hasComponent<CameraComponent>())
+        {
+            return;
+        }
+
+        auto& camera    = entity.getComponent<CameraComponent>();
+        auto& transform = entity.getComponent<TransformComponent>();
+
+        auto model = glm::translate(glm::mat4(1.0f), transform.getPosition()) *
+                     glm::mat4_cast(glm::inverse(transform.getOrientation())) * 
+                     glm::inverse(camera.camera.getProjection());
+
+        DebugDraw::wireShape(DebugDraw::Shape::CAMERA_FRUSTUM, model, glm::vec3(1.0f));
+    }
+
+    void RenderingSystem::renderDebugPhysicsColliders(Scene* scene)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        // All of the colliders go to the same debug draw batch, so there's no need to limit this to the selected entity
+        {
+            auto view = scene->getEntitiesWithComponent<BoxCollider3DComponent>();
+            for (auto e : view)
+            {
+                Entity entity = { e, scene };
+                auto&  bc3d   = view.get<BoxCollider3DComponent>(e);
+
+                auto model = glm::translate(glm::mat4(1.0f), entity.getPosition() + bc3d.offset) *
+                             glm::mat4_cast(entity.getOrientation()) * 
+                             glm::scale(glm::mat4(1.0f), entity.getScale() * bc3d.halfExtent);
+
+                DebugDraw::wireShape(DebugDraw::Shape::BOX, model, s_PhysicsCollidersColor);
+            }
+        }
+
+        {
+            auto view = scene->getEntitiesWithComponent<CapsuleColliderComponent>();
+            for (auto e : view)
+            {
+                Entity entity = { e, scene };
+                auto&  cc     = view.get<CapsuleColliderComponent>(e);
+
+                auto scale             = entity.getScale();
+                auto maxScaleComponent = glm::vec3(glm::max(scale.x, scale.z));
+                auto model             = glm::translate(glm::mat4(1.0f), entity.getPosition() + cc.offset) *
+                                         glm::mat4_cast(entity.getOrientation()) *
+                                         glm::scale(glm::mat4(1.0f), maxScaleComponent * 2.0f * glm::vec3(cc.radius, cc.halfHeight, cc.radius));
+
+                DebugDraw::wireShape(DebugDraw::Shape::CAPSULE, model, s_PhysicsCollidersColor);
+            }
+        }
+
+        {
+            auto view = scene->getEntitiesWithComponent<SphereColliderComponent>();
+            for (auto e : view)
+            {
+                Entity entity = { e, scene };
+                auto&  sc     = view.get<SphereColliderComponent>(e);
+
+                auto scale             = entity.getScale();
+                auto maxScaleComponent = glm::vec3(glm::max(scale.x, glm::max(scale.y, scale.z)));
+                auto model             = glm::translate(glm::mat4(1.0f), entity.getPosition() + sc.offset) *
+                                         glm::mat4_cast(entity.getOrientation()) *
+                                         glm::scale(glm::mat4(1.0f), maxScaleComponent * sc.radius);
+
+                DebugDraw::wireShape(DebugDraw::Shape::SPHERE, model, s_PhysicsCollidersColor);
+            }
+        }
+    }
+
+    void RenderingSystem::renderLightBillboards(Scene* scene)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        // Directional Lights
+        {
+            auto view = scene->getEntitiesWithComponent<DirectionalLightComponent, TransformComponent>();
+            for (auto& e : view)
+            {
+                auto [light, transform] = view.get(e);
+                DebugDraw::sprite(m_dirLightSpriteTexture, transform.getPosition(), light.color);
+            }
+        }
+
+        // Point Lights
+        {
+            auto view = scene->getEntitiesWithComponent<PointLightComponent, TransformComponent>();
+            for (auto& e : view)
+            {
+                auto [light, transform] = view.get(e);
+                DebugDraw::sprite(m_pointLightSpriteTexture, transform.getPosition(), light.color);
+            }
+        }
+
+        // Spot Lights
+        {
+            auto view = scene->getEntitiesWithComponent<SpotLightComponent, TransformComponent>();
+            for (auto& e : view)
+            {
+                auto [light, transform] = view.get(e);
+                DebugDraw::sprite(m_spotLightSpriteTexture, transform.getPosition(), light.color);
+            }
+        }
+
+        // Cameras
+        {
+            auto view = scene->getEntitiesWithComponent<CameraComponent, TransformComponent>();
+            for (auto& e : view)
+            {
+                auto& transform = view.get<TransformComponent>(e);
+                DebugDraw::sprite(m_cameraSpriteTexture, transform.getPosition(), glm::vec3(1.0f));
+            }
+        }
+    }
+
+    void RenderingSystem::renderDebugDraw()
+    {
+        MG_PROFILE_ZONE_SCOPED;
+        MG_PROFILE_GL_ZONE("RenderingSystem::renderDebugDraw");
+        MG_GPU_PASS(m_gpuProfiler.get(), "Debug Draw");
+
+        m_mainRenderTarget->bind();
+        DebugDraw::flush(getCamera().getView(), getCamera().getProjection());
+    }
+
+    void RenderingSystem::renderEntitiesInQueue(ref<Shader>& shader, std::vector<Entity>& queue)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+        MG_PROFILE_GL_ZONE("RenderingSystem::renderOpaque");
 
-        // Note: editor camera is always set to perspective
-        m_debugRendering->setUniform("nearZ", getCamera().getPerspectiveNearClip());
-        m_debugRendering->setUniform("farZ",  getCamera().getPerspectiveFarClip());
+        // Shadow casters aren't culled by the view, so they are drawn whole
+        const bool useMeshletCulling = &queue != &m_shadowCastersQueue;
 
-        auto format = debugViewTexture->getDescriptor().format;
-        bool isDepth  = (RenderTarget::DepthInternalFormat)format == RenderTarget::DepthInternalFormat::DEPTH16;
-             isDepth |= (RenderTarget::DepthInternalFormat)format == RenderTarget::DepthInternalFormat::DEPTH24;
-             isDepth |= (RenderTarget::DepthInternalFormat)format == RenderTarget::DepthInternalFormat::DEPTH32;
-             isDepth |= (RenderTarget::DepthInternalFormat)format == RenderTarget::DepthInternalFormat::DEPTH32F;
-             isDepth |= (RenderTarget::DepthInternalFormat)format == RenderTarget::DepthInternalFormat::DEPTH24_STENCIL8;
-             isDepth |= (RenderTarget::DepthInternalFormat)format == RenderTarget::DepthInternalFormat::DEPTH32F_STENCIL8;
-             isDepth |= (RenderTarget::DepthInternalFormat)format == RenderTarget::DepthInternalFormat::STENCIL_INDEX8;
+        resetBoundMaterial();
 
-        if (isDepth)
-        {
-            m_debugRendering->setSubroutine(Shader::Type::FRAGMENT, "debugDepthTarget");
-        }
-        else
+        for (auto& entity : queue)
         {
-            m_debugRendering->setSubroutine(Shader::Type::FRAGMENT, "debugColorTarget");
+            renderEntity(shader, entity, useMeshletCulling);
         }
- 
-        debugViewTexture->bind(0);
-        glViewport(0, 0, m_mainFramebufferSize.x, m_mainFramebufferSize.y);
-        m_deferredRendering->render();
 
-        glEnable(GL_BLEND);
+        if (&queue == &m_opaqueQueue)        renderStaticBatches(shader, m_visibleStaticBatches);
+        if (&queue == &m_shadowCastersQueue) renderStaticBatches(shader, m_shadowCasterStaticBatches);
     }
 
-    void RenderingSystem::renderDebugLightMesh(Entity entity)
+    void RenderingSystem::renderEntity(ref<Shader>& shader, Entity entity, bool useMeshletCulling)
     {
-        MG_PROFILE_ZONE_SCOPED;
-        MG_PROFILE_GL_ZONE("RenderingSystem::renderDebugLightsBoundingBoxes");
+        auto& smc  = entity.getComponent<StaticMeshComponent>();
+        auto& tc   = entity.getComponent<TransformComponent>();
+        auto& mesh = smc.mesh;
 
-        if (!entity)
+        // Draws of the submeshes, if the meshlets of the entity were culled for the current view
+        const MeshletDraws* meshletDraws = nullptr;
+        if (useMeshletCulling)
         {
-            return;
+            auto it = m_meshletDrawsOffsets.find(entity);
+            if (it != m_meshletDrawsOffsets.end())
+            {
+                meshletDraws = &m_meshletDraws[it->second];
+            }
         }
 
-        glDisable(GL_BLEND);
+        mesh->bind();
+        shader->bind();
+        shader->updateGlobalUniforms(tc);
 
-        /* Point Lights */
-        if (entity.hasComponent<PointLightComponent>())
+        // The materials select the variants of the shaders with keywords, the program is switched only when the variant changes
+        ref<Shader> boundShader = shader;
+
+        auto& submeshes = mesh->getSubmeshes();
+        for (uint32_t submeshIndex = 0; submeshIndex < submeshes.size(); ++submeshIndex)
         {
-            auto& pointLight = entity.getComponent<PointLightComponent>();
-            auto& transform  = entity.getComponent<TransformComponent>();
+            auto materialIndex = submeshes[submeshIndex].materialIndex;
+            MG_CORE_ASSERT(materialIndex < smc.materials.size());
 
-            auto model       = glm::translate(glm::mat4(1.0f), transform.getPosition()) *
-                               glm::scale(glm::mat4(1.0f), glm::vec3(pointLight.getRange()));
-            auto& view       = getCamera().getView();
-            auto& projection = getCamera().getProjection();
+            auto& material = smc.materials[materialIndex];
+            if (shader->hasKeywords() && material)
+            {
+                auto variant = shader->getVariant(getMaterialKeywordsMask(material.get()));
+                if (variant != boundShader)
+                {
+                    boundShader = variant;
+                    boundShader->bind();
+                    boundShader->updateGlobalUniforms(tc);
+                }
+            }
 
-            m_debugMeshShader->bind();
-            m_debugMeshShader->setUniform("g_mvp", projection * view * model);
-            m_debugMeshShader->setUniform("color", pointLight.color);
+            bindMaterial(boundShader, material);
 
-            m_physicsColliderSphere->bind();
-            m_physicsColliderSphere->render();
+            if (meshletDraws)
+            {
+                auto& draws = meshletDraws[submeshIndex];
+                if (draws.commandsCount > 0)
+                {
+                    mesh->renderIndirect(m_meshletCommandsRange.offset + draws.firstCommand * sizeof(DrawElementsIndirectCommand), draws.commandsCount, draws.indicesCount);
+                }
+            }
+            else
+            {
+                mesh->render(submeshIndex);
+            }
         }
+    }
 
-        /* Spot Lights */
-        if (entity.hasComponent<SpotLightComponent>())
-        {
-            auto& spotLight = entity.getComponent<SpotLightComponent>();
-            auto& transform = entity.getComponent<TransformComponent>();
+    void RenderingSystem::renderStaticBatches(ref<Shader>& shader, const std::vector<uint32_t>& batches)
+    {
+        if (batches.empty()) return;
 
-            float heightScale = spotLight.getRange();
-            float radiusScale = spotLight.getRange() * glm::tan(spotLight.getCutOffAngle()); 
+        MG_PROFILE_ZONE_SCOPED;
 
-            auto model      = glm::translate(glm::mat4(1.0f), transform.getPosition()) *
-                              glm::mat4_cast(transform.getOrientation()) *
-                              glm::scale(glm::mat4(1.0f), glm::vec3(radiusScale, radiusScale, heightScale));
-            auto view       = getCamera().getView();
-            auto projection = getCamera().getProjection();
+        // The vertices of the batches are already in the world space
+        static const TransformComponent identityTransform;
 
-            m_debugMeshShader->bind();
-            m_debugMeshShader->setUniform("g_mvp", projection * view * model);
-            m_debugMeshShader->setUniform("color", spotLight.color);
+        auto& mesh = m_staticBatches->getMesh();
 
-            m_debugSpotLightMesh->bind();
-            m_debugSpotLightMesh->render();
-        }
+        mesh->bind();
+        shader->bind();
+        shader->updateGlobalUniforms(identityTransform);
 
-        /* Directional Lights */
-        if (entity.hasComponent<DirectionalLightComponent>())
+        for (auto batchIndex : batches)
         {
-            auto& dirLight  = entity.getComponent<DirectionalLightComponent>();
-            auto& transform = entity.getComponent<TransformComponent>();
-
-            float scaleFactor = length(transform.getPosition() - m_cameraPosition) * m_camera->getPerspectiveVerticalFieldOfView() * 0.05f;
+            bindMaterial(shader, m_staticBatches->getBatches()[batchIndex].material);
+            mesh->render(batchIndex);
+        }
+    }
 
-            auto model      = glm::translate(glm::mat4(1.0f), transform.getPosition()) *
-                              glm::mat4_cast(glm::inverse(transform.getOrientation())) *
-                              glm::scale(glm::mat4(1.0f), glm::vec3(scaleFactor));
-            auto view       = getCamera().getView();
-            auto projection = getCamera().getProjection();
+    void RenderingSystem::bindMaterial(ref<Shader>& shader, const ref<Material>& material)
+    {
+        if (!material) return;
 
-            m_debugMeshShader->bind();
-            m_debugMeshShader->setUniform("g_mvp", projection * view * model);
-            m_debugMeshShader->setUniform("color", dirLight.color);
+        auto setOverride = [&shader](const MaterialInstance::Override& o, const glm::vec3& value)
+        {
+            switch (o.type)
+            {
+                case MaterialInstance::OverrideType::VECTOR3: shader->setUniform(o.name, value);           break;
+                case MaterialInstance::OverrideType::FLOAT:   shader->setUniform(o.name, value.x);         break;
+                case MaterialInstance::OverrideType::BOOL:    shader->setUniform(o.name, value.x != 0.0f); break;
+            }
+        };
 
-            m_debugDirLightMesh->bind();
-            m_debugDirLightMesh->render();
-        }
+        auto* base = material->getBase();
 
-        /* Camera Frustum */
-        if (entity.hasComponent<CameraComponent>())
+        // The state of the parent stays bound between its instances, they change only the overridden uniforms
+        if (shader.get() == m_boundMaterialShader && m_boundMaterial && base == m_boundMaterial->getBase())
         {
-            m_debugMeshShader->setUniform("color", glm::vec3(1.0f, 1.0f, 1.0f));
+            if (material.get() == m_boundMaterial) return;
 
-            auto& camera    = entity.getComponent<CameraComponent>();
-            auto& transform = entity.getComponent<TransformComponent>();
+            if (m_boundMaterial->isInstance())
+            {
+                // Back to the values of the parent
+                for (auto& o : static_cast<MaterialInstance*>(m_boundMaterial)->getOverrides())
+                {
+                    switch (o.type)
+                    {
+                        case MaterialInstance::OverrideType::VECTOR3: setOverride(o, base->getVector3(o.name));                         break;
+                        case MaterialInstance::OverrideType::FLOAT:   setOverride(o, glm::vec3(base->getFloat(o.name)));               break;
+                        case MaterialInstance::OverrideType::BOOL:    setOverride(o, glm::vec3(base->getBool(o.name) ? 1.0f : 0.0f)); break;
+                    }
+                }
+            }
+        }
+        else
+        {
+            // The variants with MATERIAL_TEXTURE_ARRAYS sample the layers of the arrays shared by the materials
+            auto& textureLayers = base->getTextureLayers();
+            if ((shader->getEnabledKeywordsMask() & m_materialTextureArraysKeyword) && !textureLayers.empty())
+            {
+                for (auto const& [texture_type, textureLayer] : textureLayers)
+                {
+                    bindMaterialTexture(uint32_t(texture_type), textureLayer.array);
+                    shader->setUniform(MaterialTextureArrays::getLayerUniformName(texture_type), float(textureLayer.layer));
+                }
+            }
+            else
+            {
+                for (auto const& [texture_type, texture] : base->getTextureMap())
+                {
+                    bindMaterialTexture(uint32_t(texture_type), texture);
+                }
+            }
 
-            auto model = glm::translate(glm::mat4(1.0f), transform.getPosition()) *
-                         glm::mat4_cast(glm::inverse(transform.getOrientation())) * 
-                         glm::inverse(camera.camera.getProjection());
+            // Set uniforms based on the data in the material
+            for (auto& [uniform_name, value] : base->getBoolMap())
+            {
+                shader->setUniform(uniform_name, value);
+            }
 
-            auto view       = getCamera().getView();
-            auto projection = getCamera().getProjection();
+            for (auto& [uniform_name, value] : base->getFloatMap())
+            {
+                shader->setUniform(uniform_name, value);
+            }
 
-            m_debugMeshShader->bind();
-            m_debugMeshShader->setUniform("g_mvp", projection * view * model);
+            for (auto& [uniform_name, value] : base->getVec3Map())
+            {
+                shader->setUniform(uniform_name, value);
+            }
+        }
 
-            m_debugCameraFrustumMesh->bind();
-            m_debugCameraFrustumMesh->render();
+        if (material->isInstance())
+        {
+            for (auto& o : std::static_pointer_cast<MaterialInstance>(material)->getOverrides())
+            {
+                setOverride(o, o.value);
+            }
         }
 
-        glEnable(GL_BLEND);
+        m_boundMaterialShader = shader.get();
+        m_boundMaterial       = material.get();
     }
 
-    void RenderingSystem::renderDebugCameraFrustumMesh(Entity entity)
+    void RenderingSystem::bindMaterialTexture(uint32_t unit, const ref<Texture>& texture)
     {
+        if (m_boundMaterialTextures[unit] == texture->getRendererID()) return;
 
+        texture->bind(unit);
+        m_boundMaterialTextures[unit] = texture->getRendererID();
     }
 
-    void RenderingSystem::renderDebugPhysicsColliders(Scene* scene)
+    void RenderingSystem::resetBoundMaterial()
     {
-        MG_PROFILE_ZONE_SCOPED;
-        MG_PROFILE_GL_ZONE("RenderingSystem::renderDebugPhysicsColliders");
+        m_boundMaterialShader = nullptr;
+        m_boundMaterial       = nullptr;
 
-        glDisable(GL_BLEND);
-        
-        glEnable(GL_POLYGON_OFFSET_FILL);
-        glPolygonOffset(-1.0, -1.0);
+        std::fill(std::begin(m_boundMaterialTextures), std::end(m_boundMaterialTextures), 0);
+    }
 
-        Entity selectedEntity = SelectionManager::getSelectedEntity();
+    uint64_t RenderingSystem::getMaterialKeywordsMask(const Material* material) const
+    {
+        return material->getKeywordsMask() | (material->getTextureLayers().empty() ? 0 : m_materialTextureArraysKeyword);
+    }
 
-        if (selectedEntity)
+    std::vector<Shader*> RenderingSystem::getMaterialShaders() const
+    {
+        // Empty until onInit has created the shaders
+        if (!m_oit)
         {
-            if (selectedEntity.hasComponent<BoxCollider3DComponent>()) 
-            {
-                auto& bc3d = selectedEntity.getComponent<BoxCollider3DComponent>();
+            return {};
+        }
 
-                auto model       = glm::translate(glm::mat4(1.0f), selectedEntity.getPosition() + bc3d.offset) *
-                                   glm::mat4_cast(selectedEntity.getOrientation()) * 
-                                   glm::scale(glm::mat4(1.0f), selectedEntity.getScale() * bc3d.halfExtent);
-                auto& view       = getCamera().getView();
-                auto& projection = getCamera().getProjection();
+        return { m_forwardAmbient.get(),     m_forwardDirectional.get(),     m_forwardPoint.get(), m_forwardSpot.get(),
+                 m_shadowMapGenerator.get(), m_omniShadowMapGenerator.get(), m_blendingShader.get(),
+                 m_enviroMappingShader.get(), m_wireframeShader.get(), m_gbufferShader.get(), m_oit->getAccumulationShader().get() };
+    }
 
-                m_debugMeshShader->bind();
-                m_debugMeshShader->setUniform("g_mvp", projection * view * model);
-                m_debugMeshShader->setUniform("color", s_PhysicsCollidersColor);
+    std::vector<std::string> RenderingSystem::getMaterialKeywords() const
+    {
+        uint64_t keywordsMask = 0;
+        for (auto shader : getMaterialShaders())
+        {
+            keywordsMask |= shader->getDeclaredKeywordsMask();
+        }
 
-                m_physicsColliderBox->bind();
-                m_physicsColliderBox->render();
-            }
-            else if (selectedEntity.hasComponent<CapsuleColliderComponent>())
-            {
-                auto& cc = selectedEntity.getComponent<CapsuleColliderComponent>();
+        // Enabled by the renderer for the materials with the texture layers
+        keywordsMask &= ~m_materialTextureArraysKeyword;
 
-                auto scale             = selectedEntity.getScale();
-                auto maxScaleComponent = glm::vec3(glm::max(scale.x, scale.z));
-                auto model             = glm::translate(glm::mat4(1.0f), selectedEntity.getPosition() + cc.offset) *
-                                         glm::mat4_cast(selectedEntity.getOrientation()) *
-                                         glm::scale(glm::mat4(1.0f), maxScaleComponent * 2.0f * glm::vec3(cc.radius, cc.halfHeight, cc.radius));
-                auto& view             = getCamera().getView();
-                auto& projection       = getCamera().getProjection();
+        return Shader::getKeywordsNames(keywordsMask);
+    }
 
-                m_debugMeshShader->bind();
-                m_debugMeshShader->setUniform("g_mvp", projection * view * model);
-                m_debugMeshShader->setUniform("color", s_PhysicsCollidersColor);
+    void RenderingSystem::requestMaterialVariants(const Material& material)
+    {
+        MG_PROFILE_ZONE_SCOPED;
 
-                m_physicsColliderCapsule->bind();
-                m_physicsColliderCapsule->render();
-            }
-            else if (selectedEntity.hasComponent<SphereColliderComponent>())
+        for (auto shader : getMaterialShaders())
+        {
+            if (shader->hasKeywords())
             {
-                auto& sc = selectedEntity.getComponent<SphereColliderComponent>();
-
-                auto scale             = selectedEntity.getScale();
-                auto maxScaleComponent = glm::vec3(glm::max(scale.x, glm::max(scale.y, scale.z)));
-                auto model             = glm::translate(glm::mat4(1.0f), selectedEntity.getPosition() + sc.offset) *
-                                         glm::mat4_cast(selectedEntity.getOrientation()) *
-                                         glm::scale(glm::mat4(1.0f), maxScaleComponent * sc.radius);
-                auto& view             = getCamera().getView();
-                auto& projection       = getCamera().getProjection();
-
-                m_debugMeshShader->bind();
-                m_debugMeshShader->setUniform("g_mvp", projection * view * model);
-                m_debugMeshShader->setUniform("color", s_PhysicsCollidersColor);
-
-                m_physicsColliderSphere->bind();
-                m_physicsColliderSphere->render();
+                shader->getVariant(getMaterialKeywordsMask(&material));
             }
         }
-
-        glDisable(GL_POLYGON_OFFSET_FILL);
-        glEnable(GL_BLEND);
     }
 
-    void RenderingSystem::renderLightBillboards(Scene* scene)
+    void RenderingSystem::renderEnviroMapping()
     {
-        MG_BEGIN_GL_MARKER("Draw light billboards");
+        MG_PROFILE_ZONE_SCOPED;
+        MG_PROFILE_GL_ZONE("RenderingSystem::renderEnviroMapping");
 
-        glEnable(GL_BLEND);
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-        m_billboardSpriteEditorShader->bind();
-        m_billboardSpriteEditorShader->setUniform("half_quad_width_vs", 0.5f);
+        // The materials pick the refraction with the ENVIRO_REFRACTION keyword
+        m_enviroMappingShader->bind();
 
-        // Directional Lights
+        if (m_skybox != nullptr)
+        {
+            m_skybox->bindSkyboxTexture();
+            renderEntitiesInQueue(m_enviroMappingShader, m_enviroStaticQueue);
+        }
+
+        // Dynamic entities reflect the nearest probe and fall back to the skybox when they are out of reach of all probes
+        for (auto& entity : m_enviroDynamicQueue)
         {
-            auto view = m_activeScene->getEntitiesWithComponent<DirectionalLightComponent, TransformComponent>();
+            auto position = entity.getComponent<TransformComponent>().getPosition();
 
-            m_dirLightSpriteTexture->bind(0);
-            for (auto& e : view)
+            if (!m_reflectionProbes->bindNearestProbe(position, 0))
             {
-                auto [light, transform] = view.get(e);
-                m_billboardSpriteEditorShader->updateGlobalUniforms(transform);
-                m_billboardSpriteEditorShader->setUniform("position", transform.getPosition());
-                m_billboardSpriteEditorShader->setUniform("color", light.color);
-                glDrawArrays(GL_POINTS, 0, 1);
+                if (m_skybox == nullptr) continue;
+
+                m_skybox->bindSkyboxTexture();
             }
+
+            resetBoundMaterial();
+            renderEntity(m_enviroMappingShader, entity, true);
         }
+    }
 
-        // Point Lights
+    void RenderingSystem::renderImposters()
+    {
+        if (m_imposterQueue.empty()) return;
+
+        MG_PROFILE_ZONE_SCOPED;
+        MG_PROFILE_GL_ZONE("RenderingSystem::renderImposters");
+
+        // The meshes seen for the first time are baked here, the baking restores the bound GBuffer
+        for (auto& entity : m_imposterQueue)
         {
-            auto view = m_activeScene->getEntitiesWithComponent<PointLightComponent, TransformComponent>();
+            auto& smc = entity.getComponent<StaticMeshComponent>();
+            auto& tc  = entity.getComponent<TransformComponent>();
 
-            m_pointLightSpriteTexture->bind(0);
-            for (auto& e : view)
-            {
-                auto [light, transform] = view.get(e);
-                m_billboardSpriteEditorShader->updateGlobalUniforms(transform);
-                m_billboardSpriteEditorShader->setUniform("position", transform.getPosition());
-                m_billboardSpriteEditorShader->setUniform("color", light.color);
-                glDrawArrays(GL_POINTS, 0, 1);
-            }
+            m_imposters->addInstance(smc.mesh, smc.materials, tc.getWorldMatrix());
         }
 
-        // Spot Lights
+        m_imposters->render(getCamera().getProjection() * getCamera().getView(), m_cameraPosition);
+    }
+
+    void RenderingSystem::renderCrowds()
+    {
+        if (m_crowdQueue.empty()) return;
+
+        MG_PROFILE_ZONE_SCOPED;
+        MG_PROFILE_GL_ZONE("RenderingSystem::renderCrowds");
+
+        for (auto& entity : m_crowdQueue)
         {
-            auto view = m_activeScene->getEntitiesWithComponent<SpotLightComponent, TransformComponent>();
+            auto& cc = entity.getComponent<CrowdComponent>();
+            auto& tc = entity.getComponent<TransformComponent>();
 
-            m_spotLightSpriteTexture->bind(0);
-            for (auto& e : view)
-            {
-                auto [light, transform] = view.get(e);
-                m_billboardSpriteEditorShader->updateGlobalUniforms(transform);
-                m_billboardSpriteEditorShader->setUniform("position", transform.getPosition());
-                m_billboardSpriteEditorShader->setUniform("color", light.color);
-                glDrawArrays(GL_POINTS, 0, 1);
-            }
+            m_crowds->addInstance(cc.animation, tc.getWorldMatrix(), cc.clip, cc.timeOffset, cc.speed);
         }
 
-        // Cameras
+        resetBoundMaterial();
+        m_crowds->render(m_crowdsTime, [this](ref<Shader>& shader, const ref<Material>& material)
         {
-            auto view = m_activeScene->getEntitiesWithComponent<CameraComponent, TransformComponent>();
+            bindMaterial(shader, material);
+        });
+    }
 
-            m_cameraSpriteTexture->bind(0);
-            m_billboardSpriteEditorShader->setUniform("color", glm::vec3(1.0f));
+    void RenderingSystem::renderFoliage()
+    {
+        MG_PROFILE_ZONE_SCOPED;
+        MG_PROFILE_GL_ZONE("RenderingSystem::renderFoliage");
 
-            for (auto& e : view)
-            {
-                auto& transform = view.get<TransformComponent>(e);
-                m_billboardSpriteEditorShader->updateGlobalUniforms(transform);
-                m_billboardSpriteEditorShader->setUniform("position", transform.getPosition());
-                glDrawArrays(GL_POINTS, 0, 1);
-            }
-        }
+        resetBoundMaterial();
+        m_foliage->render([this](ref<Shader>& shader, const ref<Material>& material)
+        {
+            bindMaterial(shader, material);
+        });
+    }
 
-        glDisable(GL_BLEND);
-        MG_END_GL_MARKER;
+    void RenderingSystem::renderTerrain()
+    {
+        MG_PROFILE_ZONE_SCOPED;
+        MG_PROFILE_GL_ZONE("RenderingSystem::renderTerrain");
+
+        resetBoundMaterial();
+        m_terrain->render([this](ref<Shader>& shader, const ref<Material>& material)
+        {
+            bindMaterial(shader, material);
+        });
     }
 
-    void RenderingSystem::renderEntitiesInQueue(ref<Shader>& shader, std::vector<Entity>& queue)
+    void RenderingSystem::renderReflectionProbes()
     {
         MG_PROFILE_ZONE_SCOPED;
-        MG_PROFILE_GL_ZONE("RenderingSystem::renderOpaque");
+        MG_PROFILE_GL_ZONE("RenderingSystem::renderReflectionProbes");
 
-        for (auto& entity : queue)
+        MG_GPU_PASS(m_gpuProfiler.get(), "Reflection Probes");
+
+        // Faces are rendered unlit: the probes only have to give a plausible surrounding to the reflections
+        m_reflectionProbes->update(m_activeScene, m_cameraPosition, [this](Camera& faceCamera, const glm::vec3& faceCameraPosition)
         {
-            auto& smc  = entity.getComponent<StaticMeshComponent>();
-            auto& tc   = entity.getComponent<TransformComponent>();
-            auto& mesh = smc.mesh;
+            auto* camera         = m_camera;
+            auto  cameraPosition = m_cameraPosition;
 
-            mesh->bind();
-            shader->bind();
-            shader->updateGlobalUniforms(tc);
+            // Global uniforms are read from the active camera
+            m_camera         = &faceCamera;
+            m_cameraPosition = faceCameraPosition;
 
-            auto& submeshes = mesh->getSubmeshes();
-            for (uint32_t submeshIndex = 0; submeshIndex < submeshes.size(); ++submeshIndex)
-            {
-                auto materialIndex = submeshes[submeshIndex].materialIndex;
-                MG_CORE_ASSERT(materialIndex < smc.materials.size());
+            glDisable(GL_BLEND);
+            glEnable(GL_DEPTH_TEST);
+            glDepthMask(GL_TRUE);
 
-                auto& material = smc.materials[materialIndex];
-                if (material)
-                {
-                    for (auto const& [texture_type, texture] : material->getTextureMap())
-                    {
-                        texture->bind(uint32_t(texture_type));
-                    }
+            // The probes see all of the layers and aren't culled by the views
+            m_blendingShader->bind();
+            resetBoundMaterial();
+            for (uint32_t i = 0; i < m_renderables.size(); ++i)
+            {
+                if (m_renderableQueues[i] == &m_opaqueQueue) renderEntity(m_blendingShader, m_renderables[i]);
+            }
+            renderStaticBatches(m_blendingShader, m_allStaticBatches);
 
-                    // Set uniforms based on the data in the material
-                    for (auto& [uniform_name, value] : material->getBoolMap())
-                    {
-                        shader->setUniform(uniform_name, value);
-                    }
+            if (m_skybox != nullptr)
+            {
+                m_skybox->render(faceCamera.getProjection(), faceCamera.getView());
 
-                    for (auto& [uniform_name, value] : material->getFloatMap())
-                    {
-                        shader->setUniform(uniform_name, value);
-                    }
+                m_enviroMappingShader->bind();
 
-                    for (auto& [uniform_name, value] : material->getVec3Map())
-                    {
-                        shader->setUniform(uniform_name, value);
-                    }
+                m_skybox->bindSkyboxTexture();
+                resetBoundMaterial();
+                for (uint32_t i = 0; i < m_renderables.size(); ++i)
+                {
+                    if (m_renderableQueues[i] == &m_enviroStaticQueue) renderEntity(m_enviroMappingShader, m_renderables[i]);
                 }
-                mesh->render(submeshIndex);
             }
-        }
+
+            m_camera         = camera;
+            m_cameraPosition = cameraPosition;
+        });
     }
 
     void RenderingSystem::renderLightsForward(Scene* scene)
@@ -1112,6 +2240,7 @@ namespace mango
         /* Directional Lights */
         {
             MG_PROFILE_ZONE_NAMED_N(dirLightsZone, "Forward Directional Lights", true);
+            MG_GPU_PASS(m_gpuProfiler.get(), "Forward Directional Lights");
 
             auto view = scene->getEntitiesWithComponent<DirectionalLightComponent, TransformComponent>();
             for(auto entity : view)
@@ -1122,6 +2251,8 @@ namespace mango
 
                 if(shadowInfo.getCastsShadows())
                 {
+                    MG_GPU_PASS(m_gpuProfiler.get(), "Directional Shadow Map");
+
                     m_shadowMapGenerator->bind();
 
                     m_dirShadowMap->bind();
@@ -1131,8 +2262,7 @@ namespace mango
                     m_shadowMapGenerator->setUniform("s_light_matrix", lightMatrix);
 
                     glCullFace(GL_FRONT);
-                    renderEntitiesInQueue(m_shadowMapGenerator, m_opaqueQueue);
-                    renderEntitiesInQueue(m_shadowMapGenerator, m_enviroStaticQueue);
+                    renderEntitiesInQueue(m_shadowMapGenerator, m_shadowCastersQueue);
                     glCullFace(GL_BACK);
                 }
 
@@ -1155,6 +2285,7 @@ namespace mango
         /* Point Lights */
         {
             MG_PROFILE_ZONE_NAMED_N(dirLightsZone, "Forward Point Lights", true);
+            MG_GPU_PASS(m_gpuProfiler.get(), "Forward Point Lights");
 
             auto view = scene->getEntitiesWithComponent<PointLightComponent, TransformComponent>();
             for (auto entity : view)
@@ -1166,6 +2297,8 @@ namespace mango
 
                 if (shadowInfo.getCastsShadows())
                 {
+                    MG_GPU_PASS(m_gpuProfiler.get(), "Point Shadow Map");
+
                     m_omniShadowMapGenerator->bind();
 
                     m_omniShadowMap->bind();
@@ -1183,8 +2316,7 @@ namespace mango
                     m_omniShadowMapGenerator->setUniform("s_far_plane",      100.0f);
 
                     glCullFace(GL_FRONT);
-                    renderEntitiesInQueue(m_omniShadowMapGenerator, m_opaqueQueue);
-                    renderEntitiesInQueue(m_omniShadowMapGenerator, m_enviroStaticQueue);
+                    renderEntitiesInQueue(m_omniShadowMapGenerator, m_shadowCastersQueue);
                     glCullFace(GL_BACK);
                 }
 
@@ -1210,6 +2342,7 @@ namespace mango
         /* Spot Lights */
         {
             MG_PROFILE_ZONE_NAMED_N(dirLightsZone, "Forward Spot Lights", true);
+            MG_GPU_PASS(m_gpuProfiler.get(), "Forward Spot Lights");
 
             auto view = scene->getEntitiesWithComponent<SpotLightComponent, TransformComponent>();
             for (auto entity : view)
@@ -1221,6 +2354,8 @@ namespace mango
 
                 if (shadowInfo.getCastsShadows())
                 {
+                    MG_GPU_PASS(m_gpuProfiler.get(), "Spot Shadow Map");
+
                     m_shadowMapGenerator->bind();
 
                     m_spotShadowMap->bind();
@@ -1230,8 +2365,7 @@ namespace mango
                     m_shadowMapGenerator->setUniform("s_light_matrix", lightMatrix);
 
                     glCullFace(GL_FRONT);
-                    renderEntitiesInQueue(m_shadowMapGenerator, m_opaqueQueue);
-                    renderEntitiesInQueue(m_shadowMapGenerator, m_enviroStaticQueue);
+                    renderEntitiesInQueue(m_shadowMapGenerator, m_shadowCastersQueue);
                     glCullFace(GL_BACK);
                 }
 
@@ -1267,6 +2401,7 @@ namespace mango
         {
             MG_PROFILE_ZONE_NAMED_N(dirLightsZone, "Deferred Directional Lights", true);
             MG_PROFILE_GL_ZONE("Deferred Directional Lights");
+            MG_GPU_PASS(m_gpuProfiler.get(), "Deferred Directional Lights");
 
             auto view = scene->getEntitiesWithComponent<DirectionalLightComponent, TransformComponent>();
             for (auto entity : view)
@@ -1278,6 +2413,8 @@ namespace mango
 
                 if (shadowInfo.getCastsShadows())
                 {
+                    MG_GPU_PASS(m_gpuProfiler.get(), "Directional Shadow Map");
+
                     glEnable(GL_DEPTH_TEST);
                     glDepthMask(GL_TRUE);
 
@@ -1289,8 +2426,7 @@ namespace mango
                     m_shadowMapGenerator->setUniform("s_light_matrix", lightMatrix);
 
                     glCullFace(GL_FRONT);
-                    renderEntitiesInQueue(m_shadowMapGenerator, m_opaqueQueue);
-                    renderEntitiesInQueue(m_shadowMapGenerator, m_enviroStaticQueue);
+                    renderEntitiesInQueue(m_shadowMapGenerator, m_shadowCastersQueue);
                     glCullFace(GL_BACK);
 
                     glDepthMask(GL_FALSE);
@@ -1318,6 +2454,7 @@ namespace mango
         {   
             MG_PROFILE_ZONE_NAMED_N(pointLightsZone, "Deferred Point Lights", true);
             MG_PROFILE_GL_ZONE("Deferred Point Lights");
+            MG_GPU_PASS(m_gpuProfiler.get(), "Deferred Point Lights");
 
             auto view = scene->getEntitiesWithComponent<PointLightComponent, TransformComponent>();
             for (auto entity : view)
@@ -1328,6 +2465,8 @@ namespace mango
 
                 if (shadowInfo.getCastsShadows())
                 {
+                    MG_GPU_PASS(m_gpuProfiler.get(), "Point Shadow Map");
+
                     glEnable(GL_DEPTH_TEST);
                     glDepthMask(GL_TRUE);
 
@@ -1349,8 +2488,7 @@ namespace mango
                     m_omniShadowMapGenerator->setUniform("s_far_plane", 100.0f);
 
                     glCullFace(GL_FRONT);
-                    renderEntitiesInQueue(m_omniShadowMapGenerator, m_opaqueQueue);
-                    renderEntitiesInQueue(m_omniShadowMapGenerator, m_enviroStaticQueue);
+                    renderEntitiesInQueue(m_omniShadowMapGenerator, m_shadowCastersQueue);
                     glCullFace(GL_BACK);
 
                     glDepthMask(GL_FALSE);
@@ -1418,6 +2556,7 @@ namespace mango
         {
             MG_PROFILE_ZONE_NAMED_N(spotLightsZone, "Deferred Spot Lights", true);
             MG_PROFILE_GL_ZONE("Deferred Spot Lights");
+            MG_GPU_PASS(m_gpuProfiler.get(), "Deferred Spot Lights");
 
             auto view = scene->getEntitiesWithComponent<SpotLightComponent, TransformComponent>();
             for (auto entity : view)
@@ -1429,6 +2568,8 @@ namespace mango
 
                 if (shadowInfo.getCastsShadows())
                 {
+                    MG_GPU_PASS(m_gpuProfiler.get(), "Spot Shadow Map");
+
                     glEnable(GL_DEPTH_TEST);
                     glDepthMask(GL_TRUE);
 
@@ -1441,8 +2582,7 @@ namespace mango
                     m_shadowMapGenerator->setUniform("s_light_matrix", lightMatrix);
 
                     glCullFace(GL_FRONT);
-                    renderEntitiesInQueue(m_shadowMapGenerator, m_opaqueQueue);
-                    renderEntitiesInQueue(m_shadowMapGenerator, m_enviroStaticQueue);
+                    renderEntitiesInQueue(m_shadowMapGenerator, m_shadowCastersQueue);
                     glCullFace(GL_BACK);
 
                     glDepthMask(GL_FALSE);
@@ -1514,18 +2654,66 @@ namespace mango
         glDisable(GL_STENCIL_TEST);
     }
 
+    void RenderingSystem::renderTransparent()
+    {
+        MG_PROFILE_ZONE_SCOPED;
+        MG_PROFILE_GL_ZONE("RenderingSystem::renderTransparent");
+
+        if (!m_oitQueue.empty())
+        {
+            MG_GPU_PASS(m_gpuProfiler.get(), "Transparent OIT");
+
+            auto accumulationShader = m_oit->getAccumulationShader();
+
+            m_oit->beginAccumulation(m_mainRenderTarget);
+            accumulationShader->bind();
+            renderEntitiesInQueue(accumulationShader, m_oitQueue);
+            m_oit->endAccumulation();
+
+            m_oit->composite(m_mainRenderTarget);
+        }
+
+        if (!m_alphaQueue.empty())
+        {
+            MG_GPU_PASS(m_gpuProfiler.get(), "Transparent Sorted");
+
+            /* Sort transparent objects back to front */
+            sortAlpha();
+
+            glEnable(GL_BLEND);
+            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+            glDisable(GL_CULL_FACE);
+            m_blendingShader->bind();
+            renderEntitiesInQueue(m_blendingShader, m_alphaQueue);
+            glEnable(GL_CULL_FACE);
+        }
+    }
+
     void RenderingSystem::sortAlpha()
     {
         MG_PROFILE_ZONE_SCOPED;
 
-        std::sort(m_alphaQueue.begin(), m_alphaQueue.end(), 
-                  [this](Entity & obj1, Entity & obj2)
-                  {
-                     const auto pos1 = obj1.getComponent<TransformComponent>().getLocalPosition();
-                     const auto pos2 = obj2.getComponent<TransformComponent>().getLocalPosition();
+        // Compute the view depth of every entity once, instead of in every comparison
+        const auto& view = getCamera().getView();
+
+        m_alphaDepthKeys.resize(m_alphaQueue.size());
+        for (uint32_t i = 0; i < m_alphaQueue.size(); ++i)
+        {
+            const auto position = m_alphaQueue[i].getComponent<TransformComponent>().getPosition();
+
+            // View space z is negative in front of the camera, so the ascending order is back to front
+            m_alphaDepthKeys[i] = view[0][2] * position.x + view[1][2] * position.y + view[2][2] * position.z + view[3][2];
+        }
+
+        auto& order = m_alphaSorter.sort(m_alphaDepthKeys);
+
+        m_sortedAlphaQueue.clear();
+        for (auto index : order)
+        {
+            m_sortedAlphaQueue.push_back(m_alphaQueue[index]);
+        }
 
-                     return glm::length(m_cameraPosition - pos1) >= glm::length(m_cameraPosition - pos2);
-                  });
+        std::swap(m_alphaQueue, m_sortedAlphaQueue);
     }
 
     void RenderingSystem::addEntityToRenderQueue(Entity entity, Material::RenderQueue renderQueue)
@@ -1566,6 +2754,12 @@ namespace mango
                 {
                     m_alphaQueue.erase(entityIterator);
                 }
+
+                entityIterator = std::find(m_oitQueue.begin(), m_oitQueue.end(), entity);
+                if (entityIterator != m_oitQueue.end())
+                {
+                    m_oitQueue.erase(entityIterator);
+                }
                 break;
             case Material::RenderQueue::RQ_ENVIRO_MAPPING_STATIC:
                 entityIterator = std::find(m_enviroStaticQueue.begin(), m_enviroStaticQueue.end(), entity);
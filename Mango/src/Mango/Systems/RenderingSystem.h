@@ -1,22 +1,38 @@
 ﻿#pragma once
 #include "Mango/Core/System.h"
+#include "Mango/Core/Timer.h"
+#include "Mango/Events/AssetEvents.h"
 #include "Mango/Events/EntityEvents.h"
 #include "Mango/Events/SceneEvents.h"
+#include "Mango/Profiling/RenderStats.h"
 #include "Mango/Rendering/AnimatedMesh.h"
+#include "Mango/Rendering/GPUUploads.h"
 #include "Mango/Rendering/Skybox.h"
 #include "Mango/Scene/Entity.h"
+#include "Mango/Utils/RadixSort.h"
 
 namespace mango
 {
     class Skybox;
     class PostprocessEffect;
+    class PostprocessStack;
     class RenderTarget;
     class Shader;
     class BloomPS;
     class Picking;
     class JFAOutline;
     class SSAO;
+    class WeightedBlendedOIT;
+    class ReflectionProbes;
+    class StaticBatches;
+    class MaterialTextureArrays;
+    class Imposters;
+    class Crowds;
+    class Foliage;
+    class Terrain;
     class DeferredRendering;
+    class DynamicResolution;
+    class GPUProfiler;
     class StaticMeshComponent;
     class TransformComponent;
     class Camera;
@@ -31,10 +47,23 @@ namespace mango
         std::string rendererName  = "";
         std::string driverVersion = "";
         std::string glslVersion   = "";
+
+        // Counters of the last finished frame (empty if MG_ENABLE_RENDER_STATS is not defined)
+        RenderFrameStats frame = {};
     };
 
     using DebugView = std::pair<std::string, ref<Texture>>;
 
+    // Camera rendered into a part of the output
+    struct RenderView
+    {
+        Camera *  camera           = nullptr;
+        glm::vec3 position         = {};
+        glm::vec4 viewport         = { 0.0f, 0.0f, 1.0f, 1.0f }; // normalized x, y, width, height of the output
+        uint32_t  layerMask        = 0xFFFFFFFF;
+        bool      drawEditorGizmos = false;                     // light volumes, colliders, billboards
+    };
+
     class RenderingSystem : public System
     {
     public:
@@ -50,6 +79,7 @@ namespace mango
         void receive(const ComponentReplacedEvent<StaticMeshComponent>& event);
         void receive(const ComponentRemovedEvent<StaticMeshComponent> & event);*/
         void receive(const ActiveSceneChangedEvent                       & event);
+        void receive(const MeshLoadedEvent                               & event);
 
         void setSkybox(const ref<Skybox> & skybox);
         void resize(unsigned width, unsigned height);
@@ -62,18 +92,39 @@ namespace mango
 
         void setRenderingMode(RenderingMode mode, Camera* editorCamera = nullptr, const glm::vec3& editorCameraPosition = glm::vec3(0.0f));
 
+        // Render on demand (renderer.renderOnDemand, editor only): the scene is rendered only after something requested a redraw
+        // or the camera has changed, otherwise the last image in the offscreen texture is kept
+        void requestRedraw();
+
+        // True if render on demand is active and no redraw is pending
+        bool isIdle() const;
+
         Camera& getCamera() const;
         glm::vec3 getCameraPosition() const { return m_cameraPosition; }
 
-        RendererStatistics getStatistics() const { return m_statistics; }
+        RendererStatistics getStatistics() const;
         glm::uvec2 getMainFramebufferSize() const { return m_mainFramebufferSize; }
 
+        // Current scale of the scene render targets relative to the output size
+        float getRenderScale() const;
+
+        // GPU timings of the render passes
+        GPUProfiler* getGPUProfiler() const { return m_gpuProfiler.get(); }
+
         void      addDebugTexture    (const std::string& viewName, const ref<Texture>& texture);
         DebugView getDebugView       (const std::string& viewName) const;
         void      setCurrentDebugView(const std::string& viewName);
         DebugView getCurrentDebugView() const { return m_currentDebugView; }
         auto      getDebugViewsMap   () const { return m_debugViews; }
 
+        ref<PostprocessStack> getPostprocessStack() const { return m_postprocessStack; }
+
+        // Keywords that the materials can enable, declared by the shaders that draw the meshes with the materials
+        std::vector<std::string> getMaterialKeywords() const;
+
+        // Requests the links of the variants that draw the material, they are linked once the driver completes them
+        void requestMaterialVariants(const Material& material);
+
     public:
         glm::vec3 sceneAmbientColor{};
 
@@ -87,6 +138,7 @@ namespace mango
         inline static bool         s_VisualizeCamera           = true;
         inline static bool         s_VisualizePhysicsColliders = true;
         inline static ShadingMode  s_ShadingMode               = ShadingMode::SHADED;
+        inline static Material::TransparencyMode s_TransparencyMode = Material::TransparencyMode::SORTED; // used by the materials with the DEFAULT mode
         inline static unsigned int s_DebugWindowWidth          = 0;
 
         inline static glm::vec3 s_PhysicsCollidersColor = glm::vec3(0.247f, 0.629f, 0.208f);
@@ -94,12 +146,28 @@ namespace mango
     private:
         static void initRenderingStates();
 
+        bool isRenderOnDemandActive() const;
+
         static void beginForwardRendering();
         static void endForwardRendering();
 
         void bindMainRenderTarget();
 
-        void applyPostprocess(ref<PostprocessEffect>& effect, ref<RenderTarget>* src, ref<RenderTarget>* dst);
+        void beginSceneRendering();
+        void applyPostprocess();
+
+        // View-independent work done once per frame: render queue selection and world bounds of the renderables
+        void gatherRenderables();
+        void cullRenderables();
+        void buildRenderQueues (uint32_t viewIndex);
+        void cullMeshlets      (uint32_t viewIndex);
+        void requestTextureMips(uint32_t viewIndex); // of the streamed textures (see TextureStreaming)
+        void updateStaticBatches();
+        void updateMaterialTextureArrays();
+
+        RenderView createCameraView(Entity cameraEntity);
+        glm::vec2  getViewportSize (const RenderView& view) const;
+        void       renderView      (const RenderView& view, uint32_t viewIndex);
 
         void renderForward (Scene* scene);
         void renderDeferred(Scene* scene);
@@ -108,11 +176,28 @@ namespace mango
         void renderDebugCameraFrustumMesh(Entity entity);
         void renderDebugPhysicsColliders (Scene* scene);
         void renderLightBillboards       (Scene* scene);
+        void renderDebugDraw();
 
         void renderEntitiesInQueue(ref<Shader>& shader, std::vector<Entity>& queue);
+        void renderEntity         (ref<Shader>& shader, Entity entity, bool useMeshletCulling = false);
+        void renderStaticBatches  (ref<Shader>& shader, const std::vector<uint32_t>& batches);
+        void bindMaterial         (ref<Shader>& shader, const ref<Material>& material);
+        void bindMaterialTexture  (uint32_t unit, const ref<Texture>& texture);
+        void resetBoundMaterial();
+
+        // Keywords of the variant the material is drawn with
+        uint64_t getMaterialKeywordsMask(const Material* material) const;
+        std::vector<Shader*> getMaterialShaders() const;
+        void renderEnviroMapping();
+        void renderImposters();
+        void renderCrowds();
+        void renderFoliage();
+        void renderTerrain();
+        void renderReflectionProbes();
 
         void renderLightsForward(Scene* scene);
         void renderLightsDeferred(Scene* scene);
+        void renderTransparent();
 
         void sortAlpha();
         void addEntityToRenderQueue     (Entity entity, Material::RenderQueue renderQueue);
@@ -127,8 +212,79 @@ namespace mango
 
         std::vector<Entity> m_opaqueQueue;
         std::vector<Entity> m_alphaQueue;
+        std::vector<Entity> m_oitQueue;
         std::vector<Entity> m_enviroStaticQueue;
         std::vector<Entity> m_enviroDynamicQueue;
+        std::vector<Entity> m_shadowCastersQueue; // not frustum culled, the casters may be outside of the view
+        std::vector<Entity> m_imposterQueue;      // distant opaque entities drawn as billboards
+        std::vector<Entity> m_crowdQueue;         // frustum culled characters with CrowdComponent
+
+        static const uint32_t MAX_VIEWS = 32; // a bit per view in the visibility masks
+
+        std::vector<RenderView> m_views;
+        RenderView              m_currentView;
+
+        // Renderables of the frame in the structure of arrays layout, so the culling loops can be vectorized
+        std::vector<Entity>               m_renderables;
+        std::vector<std::vector<Entity>*> m_renderableQueues;
+        std::vector<uint32_t>             m_renderableLayers;
+        std::vector<float>                m_boundsX;
+        std::vector<float>                m_boundsY;
+        std::vector<float>                m_boundsZ;
+        std::vector<float>                m_boundsRadius;
+        std::vector<float>                m_imposterDistancesSq; // max float for the entities without an imposter
+        std::vector<const Material*>      m_renderableMaterials; // parent of the material, the opaque queue is sorted by them
+        std::vector<float>                m_uvDensities;         // world space texture coordinate units per unit
+        std::vector<uint32_t>             m_opaqueIndices;
+        std::vector<uint32_t>             m_visibleViewsMasks; // bit i is set if the renderable is visible in the view i
+        std::vector<uint32_t>             m_cullResults;
+        glm::vec4                         m_frustumPlanes[MAX_VIEWS][6]; // normalized world space planes of the views
+
+        // Meshlets of the opaque and environment mapped meshes that survived the culling of the current view
+        struct MeshletDraws
+        {
+            uint32_t firstCommand  = 0;
+            uint32_t commandsCount = 0;
+            uint32_t indicesCount  = 0;
+        };
+
+        struct MeshletCullingJob
+        {
+            Mesh*                                    mesh  = nullptr;
+            glm::mat4                                model = glm::mat4(1.0f);
+            entt::entity                             entity;
+            std::vector<DrawElementsIndirectCommand> commands;
+            std::vector<MeshletDraws>                submeshDraws; // commands are relative to the job
+            uint32_t                                 visibleCount = 0;
+            uint32_t                                 culledCount  = 0;
+        };
+
+        std::vector<MeshletCullingJob>             m_meshletCullingJobs; // reused between the frames, so the commands keep their memory
+        std::unordered_map<entt::entity, uint32_t> m_meshletDrawsOffsets; // entity -> draws of its first submesh
+        std::vector<MeshletDraws>                  m_meshletDraws;
+        std::vector<DrawElementsIndirectCommand>   m_meshletCommands;
+        GLuint                                     m_meshletCommandsBuffer = 0; // used when the staging ring is full
+        GPUUploads::Allocation                     m_meshletCommandsRange;
+
+        // Batches of the static entities, they are drawn together with the opaque queue and the shadow casters
+        Scene*                m_staticBatchesScene = nullptr;
+        std::vector<uint32_t> m_visibleStaticBatches;
+        std::vector<uint32_t> m_shadowCasterStaticBatches;
+        std::vector<uint32_t> m_allStaticBatches; // the probes see all of the layers
+
+        // Last material set by bindMaterial, its textures and uniforms stay bound until resetBoundMaterial
+        Shader*   m_boundMaterialShader = nullptr;
+        Material* m_boundMaterial       = nullptr;
+        GLuint    m_boundMaterialTextures[uint32_t(Material::TextureType::DISPLACEMENT) + 1] = {};
+
+        // The material textures are grouped into the texture arrays when the game starts (see MaterialTextureArrays)
+        Scene*   m_materialTextureArraysScene   = nullptr;
+        uint64_t m_materialTextureArraysKeyword = 0;
+
+        // Back to front sorting of m_alphaQueue
+        std::vector<float>  m_alphaDepthKeys;
+        std::vector<Entity> m_sortedAlphaQueue;
+        RadixSort           m_alphaSorter;
 
         ref<Shader> m_forwardAmbient;
         ref<Shader> m_forwardDirectional;
@@ -139,35 +295,38 @@ namespace mango
         ref<Shader> m_blendingShader;
         ref<Shader> m_enviroMappingShader;
         ref<Shader> m_debugRendering;
+        ref<Shader> m_debugDepthRendering;
         ref<Shader> m_wireframeShader;
-        ref<Shader> m_billboardSpriteEditorShader;
 
         ref<Shader> m_gbufferShader;
         ref<Shader> m_deferredDirectional;
         ref<Shader> m_deferredPoint;
         ref<Shader> m_deferredSpot;
 
-        ref<Shader> m_debugMeshShader;
         ref<Shader> m_nullShader;
         ref<Mesh>   m_lightBoundingSphere;
         ref<Mesh>   m_lightBoundingCone;
 
-        ref<Mesh> m_physicsColliderBox;
-        ref<Mesh> m_physicsColliderSphere;
-        ref<Mesh> m_physicsColliderCapsule;
-        ref<Mesh> m_debugSpotLightMesh;
-        ref<Mesh> m_debugDirLightMesh;
-        ref<Mesh> m_debugCameraFrustumMesh;
-
-        ref<PostprocessEffect> m_hdrFilter;
-        ref<PostprocessEffect> m_fxaaFilter;
+        ref<PostprocessStack>  m_postprocessStack;
+        ref<DynamicResolution> m_dynamicResolution;
+        ref<GPUProfiler>       m_gpuProfiler;
+        uint32_t               m_sceneTimingSamplesCount = 0; // of the last update of the dynamic resolution
         ref<DeferredRendering> m_deferredRendering;
         ref<BloomPS>           m_bloomFilter;
         ref<SSAO>              m_ssao;
+        ref<WeightedBlendedOIT> m_oit;
+        ref<ReflectionProbes>  m_reflectionProbes;
+        ref<StaticBatches>     m_staticBatches;
+        ref<MaterialTextureArrays> m_materialTextureArrays;
+        ref<Imposters>         m_imposters;
+        ref<Crowds>            m_crowds;
+        ref<Foliage>           m_foliage;
+        ref<Terrain>           m_terrain;
         ref<Picking>           m_picking;
         ref<JFAOutline>        m_jfaOutline;
 
         ref<RenderTarget> m_mainRenderTarget;
+        ref<RenderTarget> m_outputRenderTarget; // composited views when rendering to the offscreen texture
         ref<RenderTarget> m_helperRenderTarget;
         ref<RenderTarget> m_dirShadowMap;
         ref<RenderTarget> m_spotShadowMap;
@@ -183,6 +342,10 @@ namespace mango
 
         RendererStatistics m_statistics = {};
 
+        float m_crowdsTime = 0.0f; // seconds, drives the clips of all of the crowds
+
+        Timer m_shaderReloadTimer; // the shader files are checked for changes once per second
+
         glm::vec3     m_cameraPosition = {};
 
         Camera * m_camera      = nullptr;
@@ -190,5 +353,11 @@ namespace mango
         Window * m_mainWindow  = nullptr;
 
         bool m_outputToOffscreenTexture = false;
+
+        static const uint32_t REDRAW_FRAMES_COUNT = 6;
+
+        uint32_t  m_redrawFramesCount      = REDRAW_FRAMES_COUNT;
+        glm::mat4 m_lastRenderedView       = glm::mat4(1.0f);
+        glm::mat4 m_lastRenderedProjection = glm::mat4(1.0f);
     };
 }
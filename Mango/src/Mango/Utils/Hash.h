@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstdint>
+#include <cstring>
 #include <string>
 
 namespace mango
@@ -7,12 +9,12 @@ namespace mango
     /**
      * Based on http://isthe.com/chongo/tech/comp/fnv/
      */
-    constexpr uint32_t fnvHash1a32(const char* key, uint32_t len) 
+    constexpr uint32_t fnvHash1a32(const char* key, uint64_t len) 
     {
         const char* p = key;
         uint32_t h = 2166136261u;
 
-        for (int i = 0; i < len; i++)
+        for (uint64_t i = 0; i < len; i++)
         {
             h = (h ^ p[i]) * 16777619u;
         }
@@ -23,12 +25,12 @@ namespace mango
     /**
      * Based on http://isthe.com/chongo/tech/comp/fnv/
      */
-    constexpr uint64_t fnvHash1a64(const char* key, uint32_t len)
+    constexpr uint64_t fnvHash1a64(const char* key, uint64_t len)
     {
         const char* p = key;
         uint64_t h = 14695981039346656037ull;
 
-        for (int i = 0; i < len; i++)
+        for (uint64_t i = 0; i < len; i++)
         {
             h = (h ^ p[i]) * 1099511628211ull;
         }
@@ -50,7 +52,7 @@ namespace mango
             hash = fnvHash1a32(s, strlen(s));
         }
 
-        StringHash32(const char* s, uint32_t len)
+        StringHash32(const char* s, uint64_t len)
         {
             hash = fnvHash1a32(s, len);
         }
@@ -74,7 +76,7 @@ namespace mango
             hash = fnvHash1a64(s, strlen(s));
         }
 
-        constexpr StringHash64(const char* s, uint32_t len)
+        constexpr StringHash64(const char* s, uint64_t len)
         {
             hash = fnvHash1a64(s, len);
         }
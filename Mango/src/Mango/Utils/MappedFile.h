@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+
+namespace mango
+{
+    /**
+     * Read only view of a whole file mapped into the address space, the pages are read in by the OS on the first access.
+     * The view is page aligned and stays valid until the file is closed.
+     */
+    class MappedFile
+    {
+    public:
+        MappedFile() = default;
+        ~MappedFile() { close(); }
+
+        MappedFile           (const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        bool open (const std::filesystem::path & filepath);
+        void close();
+
+        const uint8_t* getData() const { return m_data; }
+        uint64_t       getSize() const { return m_size; }
+        bool           isOpen () const { return m_data != nullptr; }
+
+    private:
+        const uint8_t* m_data = nullptr;
+        uint64_t       m_size = 0;
+
+#ifdef _WIN32
+        void* m_file    = nullptr;
+        void* m_mapping = nullptr;
+#endif
+    };
+}
@@ -0,0 +1,70 @@
+#include "mgpch.h"
+
+#include "RadixSort.h"
+
+namespace mango
+{
+    const std::vector<uint32_t> & RadixSort::sort(const std::vector<float> & keys)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+
+        const uint32_t count = uint32_t(keys.size());
+
+        m_items    .resize(count);
+        m_tempItems.resize(count);
+        m_indices  .resize(count);
+
+        // Build the histograms of all passes at once
+        uint32_t histograms[PASSES_COUNT][BUCKETS_COUNT] = {};
+
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            uint32_t key = floatToSortableKey(keys[i]);
+            m_items[i]   = (uint64_t(key) << 32) | i;
+
+            for (uint32_t pass = 0; pass < PASSES_COUNT; ++pass)
+            {
+                ++histograms[pass][(key >> (pass * RADIX_BITS)) & (BUCKETS_COUNT - 1)];
+            }
+        }
+
+        for (uint32_t pass = 0; pass < PASSES_COUNT; ++pass)
+        {
+            // Exclusive prefix sum gives the first output slot of every bucket
+            uint32_t offset = 0;
+            for (auto & bucket : histograms[pass])
+            {
+                uint32_t bucketSize = bucket;
+                bucket  = offset;
+                offset += bucketSize;
+            }
+
+            const uint32_t shift = 32 + pass * RADIX_BITS;
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                uint32_t digit = uint32_t(m_items[i] >> shift) & (BUCKETS_COUNT - 1);
+                m_tempItems[histograms[pass][digit]++] = m_items[i];
+            }
+
+            std::swap(m_items, m_tempItems);
+        }
+
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            m_indices[i] = uint32_t(m_items[i]);
+        }
+
+        return m_indices;
+    }
+
+    uint32_t RadixSort::floatToSortableKey(float value)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+
+        // Negative floats: flip all bits (reverses their order), positive floats: flip the sign bit only
+        uint32_t mask = (bits & 0x80000000u) ? 0xFFFFFFFFu : 0x80000000u;
+
+        return bits ^ mask;
+    }
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace mango
+{
+    /**
+     * LSD radix sort of float keys (3 passes of 11 bits), O(n) and stable.
+     * Internal buffers are kept between the calls, so sorting every frame doesn't allocate.
+     */
+    class RadixSort
+    {
+    public:
+        // Returns indices of the keys in ascending order of the keys
+        const std::vector<uint32_t> & sort(const std::vector<float> & keys);
+
+        const std::vector<uint32_t> & getIndices() const { return m_indices; }
+
+    private:
+        static uint32_t floatToSortableKey(float value);
+
+    private:
+        static const uint32_t RADIX_BITS    = 11;
+        static const uint32_t BUCKETS_COUNT = 1 << RADIX_BITS;
+        static const uint32_t PASSES_COUNT  = 3;
+
+        std::vector<uint64_t> m_items;     // (sortable key << 32) | index
+        std::vector<uint64_t> m_tempItems;
+        std::vector<uint32_t> m_indices;
+    };
+}
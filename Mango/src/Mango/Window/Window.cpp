@@ -159,6 +159,12 @@ namespace mango
         MG_PROFILE_GL_COLLECT;
     }
 
+    void Window::waitEvents(double timeout)
+    {
+        MG_PROFILE_ZONE_SCOPED;
+        glfwWaitEventsTimeout(timeout);
+    }
+
     int Window::isCloseRequested()
     {
         return glfwWindowShouldClose(m_window);
@@ -25,6 +25,9 @@ namespace mango
         int  isCloseRequested();
         void endFrame();
 
+        // Blocks until an event arrives or the timeout (in seconds) passes
+        void waitEvents(double timeout);
+
         int                           getWidth();
         int                           getHeight();
         glm::vec2                     getCenter();
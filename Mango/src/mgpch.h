@@ -22,4 +22,5 @@
 #include "Mango/Events/Event.h"
 #include "Mango/Math/Math.h"
 #include "Mango/Profiling/Instrumentation.h"
+#include "Mango/Profiling/RenderStats.h"
 #include "Mango/Scene/Components.h"
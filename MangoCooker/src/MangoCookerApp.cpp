@@ -0,0 +1,64 @@
+#include "Mango/Assets/TextureCooker.h"
+#include "Mango/Core/Log.h"
+#include "Mango/Rendering/Meshlets.h"
+
+#include "cxxopts.hpp"
+
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+
+/*
+ * Headless cooking of the assets, so it can be a build step: no window and no GL context are created.
+ * Usage: MangoCooker <directory> [--bc7] [--force], or MangoCooker --self-test to check the block encoders and the meshlet culling (run by ctest)
+ */
+int main(int argc, char** argv)
+{
+    cxxopts::Options options("MangoCooker", "Cooks the textures of a directory into the block compressed DDS files with the whole mip chains");
+
+    options.add_options()
+        ("d,directory", "Directory of the textures, with its subdirectories", cxxopts::value<std::string>())
+        ("bc7",         "BC7 for the color textures instead of BC1 and BC3", cxxopts::value<bool>()->default_value("false")->implicit_value("true"))
+        ("f,force",     "Cook also the textures that are up to date",        cxxopts::value<bool>()->default_value("false")->implicit_value("true"))
+        ("self-test",   "Check the block encoders and the meshlet culling",  cxxopts::value<bool>()->default_value("false")->implicit_value("true"))
+        ("h,help",      "Print the usage");
+
+    options.parse_positional({ "directory" });
+    options.positional_help("<directory>");
+
+    auto optResult = options.parse(argc, argv);
+
+    if (optResult.count("help") || (!optResult.count("directory") && !optResult["self-test"].as<bool>()))
+    {
+        std::cout << options.help() << std::endl;
+        return optResult.count("help") ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    mango::Log::init();
+
+    if (optResult["self-test"].as<bool>())
+    {
+        bool passed = mango::TextureCooker::selfTest();
+        passed     &= mango::Meshlets::selfTest();
+        MG_CORE_INFO("MangoCooker: the self test has {}.", passed ? "passed" : "failed");
+
+        return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    std::filesystem::path directory = optResult["directory"].as<std::string>();
+    if (!std::filesystem::is_directory(directory))
+    {
+        MG_CORE_ERROR("MangoCooker: {} is not a directory.", directory.string());
+        return EXIT_FAILURE;
+    }
+
+    mango::TextureCooker::Options cookerOptions;
+    cookerOptions.useBC7 = optResult["bc7"].as<bool>();
+    cookerOptions.force  = optResult["force"].as<bool>();
+
+    auto statistics = mango::TextureCooker::cookDirectory(directory, cookerOptions);
+
+    MG_CORE_INFO("MangoCooker: {} textures cooked, {} up to date, {} failed.", statistics.cookedCount, statistics.upToDateCount, statistics.failedCount);
+
+    return statistics.failedCount == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -6,7 +6,11 @@
 
 #include "Mango/ImGui/ImGuiUtils.h"
 #include "Mango/Math/Math.h"
+#include "Mango/Profiling/GPUProfiler.h"
+#include "Mango/Rendering/GPUUploads.h"
 #include "Mango/Project/ProjectSerializer.h"
+#include "Mango/Rendering/PostprocessStack.h"
+#include "Mango/Rendering/TextureStreaming.h"
 #include "Mango/Scene/SceneSerializer.h"
 #include "Mango/Scene/SelectionManager.h"
 #include "Mango/Systems/PhysicsSystem.h"
@@ -108,7 +112,8 @@ namespace mango
         m_editorCamera.setPosition(glm::vec3(0.0f, 4.0f, 30.0f));
 
         Services::renderer()->setOutputToOffscreenTexture(true);
-        Services::application()->getWindow()->setVSync(false);
+        CVarSystem::get()->setIntCVar("renderer.shaderHotReload", 1); // the games don't watch the shader files
+        Services::application()->getWindow()->setVSync(true); // the redraws of the simulation don't go over the refresh rate
         Services::application()->getImGuiSystem()->setDefaultIniSettingsFile("imgui.ini");
 
         Services::eventBus()->subscribe<GamepadConnectedEvent>([](const GamepadConnectedEvent& event)
@@ -149,6 +154,12 @@ namespace mango
 
     void EditorSystem::onUpdate(float dt)
     {
+        // Render on demand: the simulation changes the scene every frame, otherwise any input might change it
+        if (SceneState::Edit != m_sceneState || hasViewportRelevantInput())
+        {
+            Services::renderer()->requestRedraw();
+        }
+
         if (SceneState::Edit == m_sceneState || SceneState::Simulate == m_sceneState)
         {
             if (!m_editorCamera.isUsing())
@@ -246,6 +257,34 @@ namespace mango
         }
     }
     
+    bool EditorSystem::hasViewportRelevantInput() const
+    {
+        const ImGuiIO& io = ImGui::GetIO();
+
+        // Mouse movement matters only over the viewport (hovering the entities), clicks and keys may change anything
+        if (m_viewportHovered && (io.MouseDelta.x != 0.0f || io.MouseDelta.y != 0.0f))
+        {
+            return true;
+        }
+
+        if (io.MouseWheel != 0.0f || ImGui::IsAnyItemActive() || io.InputQueueCharacters.Size > 0)
+        {
+            return true;
+        }
+
+        for (bool isMouseDown : io.MouseDown)
+        {
+            if (isMouseDown) return true;
+        }
+
+        for (int key = ImGuiKey_NamedKey_BEGIN; key < ImGuiKey_NamedKey_END; ++key)
+        {
+            if (ImGui::IsKeyDown(ImGuiKey(key))) return true;
+        }
+
+        return false;
+    }
+
     void EditorSystem::onGui()
     {
         if (m_isMangoHubOpen) onGuiMangoHub();
@@ -516,6 +555,9 @@ namespace mango
     {
         if (SceneState::Simulate == m_sceneState) onSceneStop();
 
+        // The game-start steps (e.g. the static batches and the physics bodies) need the loaded meshes, not their placeholders
+        AssetManager::waitForAsyncLoads();
+
         m_sceneState = SceneState::Play;
 
         m_activeScene = Scene::copy(m_editorScene);
@@ -528,6 +570,9 @@ namespace mango
     {
         if (SceneState::Play == m_sceneState) onSceneStop();
 
+        // The game-start steps (e.g. the static batches and the physics bodies) need the loaded meshes, not their placeholders
+        AssetManager::waitForAsyncLoads();
+
         m_sceneState = SceneState::Simulate;
 
         m_activeScene = Scene::copy(m_editorScene);
@@ -860,6 +905,116 @@ namespace mango
                         stats.driverVersion.c_str(),
                         stats.glslVersion.c_str());
             ImGui::Text("Frame Rate: %.3f ms/frame (%.1f FPS)", Services::application()->getFramerate(), 1000.0f / Services::application()->getFramerate());
+            ImGui::Text("Render Scale: %.2f", Services::renderer()->getRenderScale());
+
+            // GPU timings
+            auto gpuProfiler = Services::renderer()->getGPUProfiler();
+            auto frameTiming = gpuProfiler->getFrameTiming();
+            ImGui::Text("GPU Frame: %.3f ms (avg %.3f ms, max %.3f ms)", frameTiming.lastMs, frameTiming.averageMs, frameTiming.maxMs);
+
+            if (ImGui::BeginTable("GPUPasses", 4, ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV))
+            {
+                ImGui::TableSetupColumn("Pass", ImGuiTableColumnFlags_WidthStretch);
+                ImGui::TableSetupColumn("Last [ms]");
+                ImGui::TableSetupColumn("Avg [ms]");
+                ImGui::TableSetupColumn("Max [ms]");
+                ImGui::TableHeadersRow();
+
+                for (auto& pass : gpuProfiler->getPassTimings())
+                {
+                    ImGui::TableNextRow();
+                    ImGui::TableSetColumnIndex(0);
+                    ImGui::SetCursorPosX(ImGui::GetCursorPosX() + pass.depth * ImGui::GetStyle().IndentSpacing);
+                    ImGui::Text("%s", pass.name.c_str());
+
+                    ImGui::TableSetColumnIndex(1); ImGui::Text("%.3f", pass.lastMs);
+                    ImGui::TableSetColumnIndex(2); ImGui::Text("%.3f", pass.averageMs);
+                    ImGui::TableSetColumnIndex(3); ImGui::Text("%.3f", pass.maxMs);
+                }
+                ImGui::EndTable();
+            }
+
+            // Render counters
+            if (ImGui::CollapsingHeader("Render Counters", ImGuiTreeNodeFlags_DefaultOpen))
+            {
+#ifdef MG_ENABLE_RENDER_STATS
+                auto& frame = stats.frame;
+
+                m_drawCallsHistory      .add(float(frame.total.drawCalls));
+                m_trianglesHistory      .add(float(frame.total.triangles));
+                m_bindsHistory          .add(float(frame.total.programBinds + frame.total.vaoBinds + frame.total.textureBinds));
+                m_uniformCallsHistory   .add(float(frame.total.uniformCalls));
+                m_uploadedBytesHistory  .add(float(frame.total.bytesUploaded) / 1024.0f);
+                m_visibleEntitiesHistory.add(float(frame.visibleEntities));
+
+                auto plotHistory = [](const char* label, const CounterHistory& history, const char* overlay)
+                {
+                    ImGui::PlotLines(label, history.samples, std::size(history.samples), history.offset, overlay, 0.0f, FLT_MAX, ImVec2(0.0f, 40.0f));
+                };
+
+                char overlay[64];
+                snprintf(overlay, sizeof(overlay), "%u (%u instances)", frame.total.drawCalls, frame.total.instances);
+                plotHistory("Draw Calls", m_drawCallsHistory, overlay);
+
+                snprintf(overlay, sizeof(overlay), "%llu (%llu vertices)", (unsigned long long)frame.total.triangles, (unsigned long long)frame.total.vertices);
+                plotHistory("Triangles", m_trianglesHistory, overlay);
+
+                snprintf(overlay, sizeof(overlay), "program: %u, vao: %u, texture: %u", frame.total.programBinds, frame.total.vaoBinds, frame.total.textureBinds);
+                plotHistory("Binds", m_bindsHistory, overlay);
+
+                snprintf(overlay, sizeof(overlay), "%u", frame.total.uniformCalls);
+                plotHistory("Uniform Calls", m_uniformCallsHistory, overlay);
+
+                snprintf(overlay, sizeof(overlay), "%.1f KB", float(frame.total.bytesUploaded) / 1024.0f);
+                plotHistory("Uploaded", m_uploadedBytesHistory, overlay);
+
+                snprintf(overlay, sizeof(overlay), "visible: %u, culled: %u", frame.visibleEntities, frame.culledEntities);
+                plotHistory("Entities", m_visibleEntitiesHistory, overlay);
+
+                ImGui::Text("Meshlets: visible: %u, culled: %u", frame.visibleMeshlets, frame.culledMeshlets);
+
+                auto& staging = GPUUploads::getStatistics();
+                ImGui::Text("Staging: %.1f KB in %u uploads (%u direct), in flight: %.1f KB, stalls: %u (%.2f ms)",
+                            float(staging.stagedBytes) / 1024.0f, staging.uploadsCount, staging.directUploads,
+                            float(staging.inFlightBytes) / 1024.0f, staging.stallsCount, staging.stallsMs);
+
+                auto& streaming = TextureStreaming::getStatistics();
+                ImGui::Text("Texture Streaming: %u textures (%u loading), resident: %.1f / %.1f MB, mips in: %u, evicted: %u",
+                            streaming.texturesCount, streaming.loadingCount,
+                            float(streaming.residentBytes) / (1024.0f * 1024.0f), float(streaming.budgetBytes) / (1024.0f * 1024.0f),
+                            streaming.streamedInMips, streaming.evictedMips);
+
+                if (ImGui::BeginTable("RenderCounters", 7, ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV))
+                {
+                    ImGui::TableSetupColumn("Pass", ImGuiTableColumnFlags_WidthStretch);
+                    ImGui::TableSetupColumn("Draws");
+                    ImGui::TableSetupColumn("Triangles");
+                    ImGui::TableSetupColumn("Programs");
+                    ImGui::TableSetupColumn("VAOs");
+                    ImGui::TableSetupColumn("Textures");
+                    ImGui::TableSetupColumn("Uniforms");
+                    ImGui::TableHeadersRow();
+
+                    for (auto& pass : frame.passes)
+                    {
+                        ImGui::TableNextRow();
+                        ImGui::TableSetColumnIndex(0);
+                        ImGui::SetCursorPosX(ImGui::GetCursorPosX() + pass.depth * ImGui::GetStyle().IndentSpacing);
+                        ImGui::Text("%s", pass.name.c_str());
+
+                        ImGui::TableSetColumnIndex(1); ImGui::Text("%u",   pass.counters.drawCalls);
+                        ImGui::TableSetColumnIndex(2); ImGui::Text("%llu", (unsigned long long)pass.counters.triangles);
+                        ImGui::TableSetColumnIndex(3); ImGui::Text("%u",   pass.counters.programBinds);
+                        ImGui::TableSetColumnIndex(4); ImGui::Text("%u",   pass.counters.vaoBinds);
+                        ImGui::TableSetColumnIndex(5); ImGui::Text("%u",   pass.counters.textureBinds);
+                        ImGui::TableSetColumnIndex(6); ImGui::Text("%u",   pass.counters.uniformCalls);
+                    }
+                    ImGui::EndTable();
+                }
+#else
+                ImGui::TextDisabled("Configure with MG_ENABLE_RENDER_STATS=ON to collect the render counters.");
+#endif
+            }
         }
         ImGui::End(); // Stats
     }
@@ -893,6 +1048,27 @@ namespace mango
                 ImGui::EndCombo();
             }
 
+            // Transparency mode of the materials that don't override it
+            const  char* transparencyModeItems[]      = { "Sorted", "Order Independent" };
+            static auto  transparencyModeCurrentIndex = (int)RenderingSystem::s_TransparencyMode - 1;
+
+            if (ImGui::BeginCombo("Transparency", transparencyModeItems[transparencyModeCurrentIndex]))
+            {
+                for (int n = 0; n < std::size(transparencyModeItems); ++n)
+                {
+                    const bool isSelected = (transparencyModeCurrentIndex == n);
+                    if (ImGui::Selectable(transparencyModeItems[n], isSelected))
+                    {
+                        transparencyModeCurrentIndex = n;
+                        RenderingSystem::s_TransparencyMode = (Material::TransparencyMode)(transparencyModeCurrentIndex + 1);
+                    }
+
+                    // Set the initial focus when opening the combo (scrolling + keyboard navigation focus)
+                    if (isSelected) ImGui::SetItemDefaultFocus();
+                }
+                ImGui::EndCombo();
+            }
+
             // Debug Views
             auto debugViews                                       = Services::renderer()->getDebugViewsMap();
             auto [currentDebugViewName, currentDebugViewTexture ] = Services::renderer()->getCurrentDebugView();
@@ -917,6 +1093,41 @@ namespace mango
             ImGui::Checkbox  ("Outline Use Single Axis Method", &Services::renderer()->outlineUseSeparableAxisMethod);
             ImGui::ColorEdit3("Outline Color",                  &Services::renderer()->outlineColor[0]);
             ImGui::DragFloat ("Outline Width",                  &Services::renderer()->outlineWidth, 1.0f, 1.0f, 500.0f);
+
+            // Postprocess stack
+            if (ImGui::CollapsingHeader("Postprocess"))
+            {
+                auto postprocessStack = Services::renderer()->getPostprocessStack();
+                auto settings         = postprocessStack->getSettings();
+                bool changed          = false;
+
+                const char* toneMappingItems[] = { "Exponential", "Reinhard", "ACES" };
+                int         toneMappingIndex   = (int)settings.toneMapping.operation;
+
+                const uint32_t minBlurIterations = 1;
+                const uint32_t maxBlurIterations = 20;
+
+                changed |= ImGui::Checkbox  ("Bloom",                &settings.bloom.enabled);
+                changed |= ImGui::DragFloat ("Bloom Threshold",      &settings.bloom.threshold, 0.01f, 0.0f, 10.0f);
+                changed |= ImGui::DragFloat ("Bloom Intensity",      &settings.bloom.intensity, 0.01f, 0.0f, 10.0f);
+                changed |= ImGui::DragScalar("Bloom Blur Iterations", ImGuiDataType_U32, &settings.bloom.blurIterations, 0.1f, &minBlurIterations, &maxBlurIterations);
+                changed |= ImGui::Checkbox  ("Exposure",             &settings.exposure.enabled);
+                changed |= ImGui::DragFloat ("Exposure Value",       &settings.exposure.exposure, 0.01f, 0.0f, 20.0f);
+                changed |= ImGui::Checkbox  ("Tone Mapping",         &settings.toneMapping.enabled);
+                changed |= ImGui::Combo     ("Tone Mapping Operator", &toneMappingIndex, toneMappingItems, IM_ARRAYSIZE(toneMappingItems));
+                changed |= ImGui::Checkbox  ("Color Grading",        &settings.colorGrading.enabled);
+                changed |= ImGui::DragFloat ("Contrast",             &settings.colorGrading.contrast,   0.01f, 0.0f, 2.0f);
+                changed |= ImGui::DragFloat ("Saturation",           &settings.colorGrading.saturation, 0.01f, 0.0f, 2.0f);
+                changed |= ImGui::ColorEdit3("Color Filter",         &settings.colorGrading.colorFilter[0]);
+                changed |= ImGui::DragFloat ("Gamma",                &settings.gamma, 0.01f, 1.0f, 3.0f);
+                changed |= ImGui::Checkbox  ("FXAA",                 &settings.fxaa.enabled);
+
+                if (changed)
+                {
+                    settings.toneMapping.operation = (ToneMappingOperator)toneMappingIndex;
+                    postprocessStack->setSettings(settings);
+                }
+            }
         }
         ImGui::End();
     }
@@ -65,9 +65,25 @@ namespace mango
 
         void moveLights(float dt);
 
+        // Input that may change the rendered scene (see renderer.renderOnDemand)
+        bool hasViewportRelevantInput() const;
+
     private:
         void onReceiveSceneLoadEvent(const RequestSceneLoadEvent& event);
 
+    private:
+        struct CounterHistory
+        {
+            float    samples[120] = {};
+            uint32_t offset       = 0; // index of the oldest sample
+
+            void add(float value)
+            {
+                samples[offset] = value;
+                offset          = (offset + 1) % std::size(samples);
+            }
+        };
+
     private:
         std::filesystem::path  m_editorScenePath;
         ref<Scene> m_activeScene;
@@ -101,6 +117,13 @@ namespace mango
 
         EditorCamera m_editorCamera;
 
+        CounterHistory m_drawCallsHistory;
+        CounterHistory m_trianglesHistory;
+        CounterHistory m_bindsHistory;
+        CounterHistory m_uniformCallsHistory;
+        CounterHistory m_uploadedBytesHistory;
+        CounterHistory m_visibleEntitiesHistory;
+
         bool m_isMangoHubOpen = false;
     };
 }
\ No newline at end of file
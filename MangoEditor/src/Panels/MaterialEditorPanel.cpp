@@ -5,7 +5,9 @@
 
 #include "Mango/Core/Assertions.h"
 #include "Mango/Core/AssetManager.h"
+#include "Mango/Core/Services.h"
 #include "Mango/Systems/ImGuiSystem.h"
+#include "Mango/Systems/RenderingSystem.h"
 
 #include <imgui.h>
 #include <misc/cpp/imgui_stdlib.h>
@@ -84,8 +86,49 @@ namespace mango
             }
 
             ImGui::Text("Shader:   %s", "tbd");
+
+            // The instances share everything with the parent but the overridden parameters
+            auto instance = materialToEdit->isInstance() ? std::static_pointer_cast<MaterialInstance>(materialToEdit) : nullptr;
+            if (instance)
+            {
+                ImGui::Text("Parent:   %s", instance->getParent()->name.c_str());
+            }
+
+            if (ImGui::Button("Create Instance", { ImGui::GetContentRegionAvail().x, 0 }))
+            {
+                auto parentName = instance ? instance->getParent()->name : materialToEdit->name;
+
+                uint32_t    index = 1;
+                std::string instanceName;
+                do
+                {
+                    instanceName = parentName + " Instance " + std::to_string(index++);
+                } while (AssetManager::getMaterial(instanceName));
+
+                materialToEdit = AssetManager::createMaterialInstance(instanceName, materialToEdit);
+                instance       = std::static_pointer_cast<MaterialInstance>(materialToEdit);
+            }
             ImGui::Separator();
 
+            // The overridden parameters of an instance can go back to the values of the parent
+            auto parameterName = [&instance](const std::string& name)
+            {
+                ImGui::TableNextColumn();
+
+                if (instance && instance->isOverridden(name))
+                {
+                    ImGui::PushID(name.c_str());
+                    if (ImGui::SmallButton("X"))
+                    {
+                        instance->removeOverride(name);
+                    }
+                    ImGui::PopID();
+                    ImGui::SameLine();
+                }
+
+                ImGui::Text(name.c_str());
+            };
+
             if (ImGui::BeginTable("Textures", 2, ImGuiTableFlags_SizingStretchSame))
             {
                 // Render Queue
@@ -139,11 +182,61 @@ namespace mango
                     ImGui::EndCombo();
                 }
 
+                // Transparency Mode
+                ImGui::TableNextColumn();
+                ImGui::Text("Transparency");
+
+                ImGui::TableNextColumn();
+                const char* transparencyModeItems[]      = { "Default", "Sorted", "Order Independent" };
+                auto        transparencyModeCurrentIndex = (int)materialToEdit->getTransparencyMode();
+
+                if (ImGui::BeginCombo("##transparency_mode", transparencyModeItems[transparencyModeCurrentIndex]))
+                {
+                    for (int n = 0; n < std::size(transparencyModeItems); ++n)
+                    {
+                        const bool isSelected = (transparencyModeCurrentIndex == n);
+                        if (ImGui::Selectable(transparencyModeItems[n], isSelected))
+                        {
+                            materialToEdit->setTransparencyMode((Material::TransparencyMode)n);
+                        }
+
+                        // Set the initial focus when opening the combo (scrolling + keyboard navigation focus)
+                        if (isSelected) ImGui::SetItemDefaultFocus();
+                    }
+                    ImGui::EndCombo();
+                }
+
+                // Shader Keywords, only the ones declared by the shaders of the materials, e.g. ENVIRO_REFRACTION
+                ImGui::TableNextColumn();
+                ImGui::Text("Keywords");
+
+                ImGui::TableNextColumn();
+                ImGui::SetNextItemWidth(-1);
+
+                std::string enabledKeywords;
+                for (auto& keyword : materialToEdit->getKeywords())
+                {
+                    enabledKeywords += (enabledKeywords.empty() ? "" : " ") + keyword;
+                }
+
+                if (ImGui::BeginCombo("##keywords", enabledKeywords.empty() ? "None" : enabledKeywords.c_str()))
+                {
+                    for (auto& keyword : Services::renderer()->getMaterialKeywords())
+                    {
+                        bool isEnabled = materialToEdit->hasKeyword(keyword);
+                        if (ImGui::Selectable(keyword.c_str(), isEnabled, ImGuiSelectableFlags_DontClosePopups))
+                        {
+                            materialToEdit->setKeyword(keyword, !isEnabled);
+                        }
+                    }
+                    ImGui::EndCombo();
+                }
+
                 ImGui::EndTable();
             }
 
             float previewSize = ImGui::GetFontSize() * 5.0f;
-            if (ImGui::CollapsingHeader("Textures", ImGuiTreeNodeFlags_DefaultOpen))
+            if (ImGui::CollapsingHeader(instance ? "Textures (of the parent)###Textures" : "Textures", ImGuiTreeNodeFlags_DefaultOpen))
             {
                 if (ImGui::BeginTable("Textures", 2, ImGuiTableFlags_SizingFixedFit))
                 {
@@ -210,15 +303,19 @@ namespace mango
             {
                 if (ImGui::BeginTable("Floats", 2, ImGuiTableFlags_SizingStretchSame))
                 {
-                    for (auto& [name, value] : materialToEdit->getFloatMap())
+                    for (auto& [name, parentValue] : materialToEdit->getFloatMap())
                     {
-                        ImGui::TableNextColumn();
-                        ImGui::Text(name.c_str());
+                        parameterName(name);
 
                         ImGui::TableNextColumn();
                         ImGui::SetNextItemWidth(-1);
                         ImGui::PushID(name.c_str());
-                        ImGui::DragFloat("##", &value);
+
+                        float value = materialToEdit->getFloat(name);
+                        if (ImGui::DragFloat("##", &value))
+                        {
+                            materialToEdit->addFloat(name, value);
+                        }
                         ImGui::PopID();
                     }
                     ImGui::EndTable();
@@ -229,15 +326,19 @@ namespace mango
             {
                 if (ImGui::BeginTable("Vec3s", 2, ImGuiTableFlags_SizingStretchSame))
                 {
-                    for (auto& [name, value] : materialToEdit->getVec3Map())
+                    for (auto& [name, parentValue] : materialToEdit->getVec3Map())
                     {
-                        ImGui::TableNextColumn();
-                        ImGui::Text(name.c_str());
+                        parameterName(name);
 
                         ImGui::TableNextColumn();
                         ImGui::SetNextItemWidth(-1);
                         ImGui::PushID(name.c_str());
-                        ImGui::DragFloat3("##", &value[0]);
+
+                        glm::vec3 value = materialToEdit->getVector3(name);
+                        if (ImGui::DragFloat3("##", &value[0]))
+                        {
+                            materialToEdit->addVector3(name, value);
+                        }
                         ImGui::PopID();
                     }
                     ImGui::EndTable();
@@ -248,15 +349,19 @@ namespace mango
             {
                 if (ImGui::BeginTable("Bools", 2, ImGuiTableFlags_SizingStretchSame))
                 {
-                    for (auto& [name, value] : materialToEdit->getBoolMap())
+                    for (auto& [name, parentValue] : materialToEdit->getBoolMap())
                     {
-                        ImGui::TableNextColumn();
-                        ImGui::Text(name.c_str());
+                        parameterName(name);
 
                         ImGui::TableNextColumn();
                         ImGui::SetNextItemWidth(-1);
                         ImGui::PushID(name.c_str());
-                        ImGui::Checkbox("##", &value);
+
+                        bool value = materialToEdit->getBool(name);
+                        if (ImGui::Checkbox("##", &value))
+                        {
+                            materialToEdit->addBool(name, value);
+                        }
                         ImGui::PopID();
                     }
                     ImGui::EndTable();
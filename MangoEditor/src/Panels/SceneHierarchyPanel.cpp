@@ -7,6 +7,8 @@
 #include "Mango/Core/VFI.h"
 #include "Mango/ImGui/ImGuiUtils.h"
 #include "Mango/Project/Project.h"
+#include "Mango/Rendering/Foliage.h"
+#include "Mango/Rendering/Terrain.h"
 #include "Mango/Scene/Components.h"
 #include "Mango/Scene/SelectionManager.h"
 #include "Mango/Systems/ImGuiSystem.h"
@@ -175,6 +177,17 @@ namespace mango
             }
         }
 
+        if (ImGui::MenuItem("Reflection Probe"))
+        {
+            auto newEntity = m_scene->createEntity("Reflection Probe");
+            newEntity.addComponent<ReflectionProbeComponent>();
+
+            if (m_selectedEntity)
+            {
+                m_selectedEntity.addChild(newEntity);
+            }
+        }
+
         if (ImGui::MenuItem("Delete", nullptr, nullptr, !isClickedEmptySpace))
         {
             action = EcmAction::Delete;
@@ -376,6 +389,27 @@ namespace mango
         }
     }
 
+    // Combo with a checkbox per each of the 32 layers
+    static bool drawLayerMask(const char* label, uint32_t& mask)
+    {
+        bool changed = false;
+
+        std::string preview = mask == 0xFFFFFFFF ? "Everything" : (mask == 0 ? "Nothing" : std::format("0x{:08X}", mask));
+        if (ImGui::Utils::TableBeginCombo(label, preview.c_str()))
+        {
+            if (ImGui::Selectable("Everything", false, ImGuiSelectableFlags_DontClosePopups)) { mask = 0xFFFFFFFF; changed = true; }
+            if (ImGui::Selectable("Nothing",    false, ImGuiSelectableFlags_DontClosePopups)) { mask = 0;          changed = true; }
+
+            for (uint32_t layer = 0; layer < 32; ++layer)
+            {
+                changed |= ImGui::CheckboxFlags(std::format("Layer {}", layer).c_str(), &mask, 1u << layer);
+            }
+            ImGui::EndCombo();
+        }
+
+        return changed;
+    }
+
     void SceneHierarchyPanel::drawComponents(Entity entity)
     {
         if (entity.hasComponent<TagComponent>())
@@ -436,6 +470,12 @@ namespace mango
             displayAddComponentEntry<BoxCollider3DComponent>("Box Collider 3D");
             displayAddComponentEntry<CapsuleColliderComponent>("Capsule Collider 3D");
             displayAddComponentEntry<SphereColliderComponent>("Sphere Collider");
+            displayAddComponentEntry<ReflectionProbeComponent>("Reflection Probe");
+            displayAddComponentEntry<LayerComponent>("Layer");
+            displayAddComponentEntry<ImposterComponent>("Imposter");
+            displayAddComponentEntry<CrowdComponent>("Crowd");
+            displayAddComponentEntry<FoliageComponent>("Foliage");
+            displayAddComponentEntry<TerrainComponent>("Terrain");
 
             ImGui::EndPopup();
         }
@@ -611,6 +651,9 @@ namespace mango
             auto& camera = component.camera;
 
             ImGui::Utils::TableCheckbox("Primary", &component.isPrimary);
+            ImGui::Utils::TableCheckbox("Additional View", &component.isAdditionalView);
+            ImGui::Utils::TableDragFloat4("Viewport", &component.viewport[0], 0.01f, 0.0f, 1.0f, "%.2f", ImGuiSliderFlags_AlwaysClamp);
+            drawLayerMask("Layer Mask", component.layerMask);
 
             const char* projectionTypeStrings[] = { "Perspective", "Orthographic" };
             const char* currentProjectionTypeString = projectionTypeStrings[int(camera.getProjectionType())];
@@ -728,6 +771,8 @@ namespace mango
                 }
             });
 
+            ImGui::Utils::TableCheckbox("Static", &component.isStatic);
+
             const ImGuiTreeNodeFlags treeNodeFlags = ImGuiTreeNodeFlags_DefaultOpen    |
                                                      ImGuiTreeNodeFlags_Framed         |
                                                      ImGuiTreeNodeFlags_FramePadding   |
@@ -862,6 +907,227 @@ namespace mango
             ImGui::Utils::TableDragFloat3("Offset", &component.offset[0], 0.01f);
             ImGui::Utils::TableDragFloat ("Radius", &component.radius,    0.01f);
         });
+
+        drawComponent<ReflectionProbeComponent>("REFLECTION PROBE", entity, [](auto& component)
+        {
+            ImGui::Utils::TableDragFloat("Radius", &component.radius, 0.1f, 0.0f, FLT_MAX, "%.2f", ImGuiSliderFlags_AlwaysClamp);
+
+            const int resolutions[] = { 64, 128, 256, 512 };
+            std::string currentResolution = std::to_string(component.resolution);
+            if (ImGui::Utils::TableBeginCombo("Resolution", currentResolution.c_str()))
+            {
+                for (int resolution : resolutions)
+                {
+                    bool isSelected = component.resolution == resolution;
+                    if (ImGui::Selectable(std::to_string(resolution).c_str(), isSelected))
+                    {
+                        component.resolution = resolution;
+                    }
+
+                    if (isSelected)
+                    {
+                        ImGui::SetItemDefaultFocus();
+                    }
+                }
+                ImGui::EndCombo();
+            }
+
+            ImGui::Utils::TableDragFloat("Near Plane", &component.nearPlane, 0.01f, 0.001f, FLT_MAX, "%.3f", ImGuiSliderFlags_AlwaysClamp);
+            ImGui::Utils::TableDragFloat("Far Plane",  &component.farPlane,  0.1f,  0.01f,  FLT_MAX, "%.2f", ImGuiSliderFlags_AlwaysClamp);
+        });
+
+        drawComponent<LayerComponent>("LAYER", entity, [](auto& component)
+        {
+            drawLayerMask("Layers", component.layers);
+        });
+
+        drawComponent<ImposterComponent>("IMPOSTER", entity, [](auto& component)
+        {
+            ImGui::Utils::TableDragFloat("Distance", &component.distance, 0.5f, 0.0f, FLT_MAX, "%.2f", ImGuiSliderFlags_AlwaysClamp);
+        });
+
+        drawComponent<CrowdComponent>("CROWD", entity, [](auto& component)
+        {
+            std::string animationLabel = component.animation ? component.animation->getFilename() : "NULL";
+
+            if (ImGui::Utils::TableButton("Animation", animationLabel.c_str(), {-1, 0}))
+            {
+                ImGui::OpenPopup("vertex_animation_select_popup");
+            }
+
+            // The skinned model is dropped from the content browser and baked on the first use
+            if (ImGui::BeginDragDropTarget())
+            {
+                if (const ImGuiPayload* payload = ImGui::AcceptDragDropPayload(MG_DRAG_PAYLOAD_CB_ITEM))
+                {
+                    const auto* path = (const wchar_t*)payload->Data;
+
+                    component.animation = AssetManager::createVertexAnimationFromFile(std::filesystem::path(path).string());
+                    component.clip      = 0;
+                }
+                ImGui::EndDragDropTarget();
+            }
+
+            if (ImGui::BeginPopup("vertex_animation_select_popup"))
+            {
+                for (auto& [name, animation] : AssetManager::getVertexAnimationList())
+                {
+                    if (ImGui::Selectable(name.c_str()))
+                    {
+                        component.animation = animation;
+                        component.clip      = 0;
+                    }
+                }
+                ImGui::EndPopup();
+            }
+
+            if (component.animation)
+            {
+                auto& clips = component.animation->getClips();
+                component.clip = glm::min(component.clip, uint32_t(clips.size()) - 1);
+
+                if (ImGui::Utils::TableBeginCombo("Clip", clips[component.clip].name.c_str()))
+                {
+                    for (uint32_t i = 0; i < clips.size(); ++i)
+                    {
+                        bool isSelected = component.clip == i;
+
+                        ImGui::PushID(i);
+                        if (ImGui::Selectable(clips[i].name.c_str(), isSelected))
+                        {
+                            component.clip = i;
+                        }
+
+                        if (isSelected)
+                        {
+                            ImGui::SetItemDefaultFocus();
+                        }
+                        ImGui::PopID();
+                    }
+                    ImGui::EndCombo();
+                }
+            }
+
+            ImGui::Utils::TableDragFloat("Time Offset", &component.timeOffset, 0.01f, 0.0f, FLT_MAX, "%.2f", ImGuiSliderFlags_AlwaysClamp);
+            ImGui::Utils::TableDragFloat("Speed",       &component.speed,      0.01f, 0.0f, FLT_MAX, "%.2f", ImGuiSliderFlags_AlwaysClamp);
+        });
+
+        drawComponent<FoliageComponent>("FOLIAGE", entity, [](auto& component)
+        {
+            std::string meshLabel = component.mesh ? component.mesh->getName() : "NULL";
+
+            if (ImGui::Utils::TableButton("Mesh", meshLabel.c_str(), {-1, 0}))
+            {
+                ImGui::OpenPopup("foliage_mesh_select_popup");
+            }
+
+            if (ImGui::BeginPopup("foliage_mesh_select_popup"))
+            {
+                for (auto& [name, staticMesh] : AssetManager::getStaticMeshList())
+                {
+                    if (ImGui::Selectable(name.c_str()))
+                    {
+                        component.mesh      = staticMesh;
+                        component.materials = staticMesh->getMaterials();
+                    }
+                }
+                ImGui::EndPopup();
+            }
+
+            static int32_t selectedMaterialIndex = -1;
+
+            for (uint32_t i = 0; i < component.materials.size(); ++i)
+            {
+                std::string materialLabel = component.materials[i] ? component.materials[i]->name : "NULL";
+
+                ImGui::PushID(i);
+                if (ImGui::Utils::TableButton(std::format("[Material {}]", i).c_str(), materialLabel.c_str(), {-1, 0}))
+                {
+                    ImGui::OpenPopup("foliage_material_select_popup");
+                    selectedMaterialIndex = i;
+                }
+
+                if (selectedMaterialIndex == int32_t(i) && ImGui::BeginPopup("foliage_material_select_popup"))
+                {
+                    for (auto& [name, material] : AssetManager::getMaterialList())
+                    {
+                        if (ImGui::Selectable(name.c_str()))
+                        {
+                            component.materials[i] = material;
+                        }
+                    }
+                    ImGui::EndPopup();
+                }
+                ImGui::PopID();
+            }
+
+            ImGui::Utils::TableDragFloat2("Extents",     &component.extents[0],    0.1f,  0.0f, FLT_MAX, "%.2f", ImGuiSliderFlags_AlwaysClamp);
+            ImGui::Utils::TableDragUint  ("Count",       &component.count,         10.0f, 0,    Foliage::MAX_INSTANCES, "%u", ImGuiSliderFlags_AlwaysClamp);
+            ImGui::Utils::TableDragUint  ("Seed",        &component.seed);
+            ImGui::Utils::TableDragFloat ("Cell Size",   &component.cellSize,      0.1f,  1.0f, FLT_MAX, "%.2f", ImGuiSliderFlags_AlwaysClamp);
+            ImGui::Utils::TableDragFloat2("Scale Range", &component.scaleRange[0], 0.01f, 0.0f, FLT_MAX, "%.2f", ImGuiSliderFlags_AlwaysClamp);
+            ImGui::Utils::TableDragFloat ("Fade Start",  &component.fadeStart,     0.5f,  0.0f, FLT_MAX, "%.2f", ImGuiSliderFlags_AlwaysClamp);
+            ImGui::Utils::TableDragFloat ("Fade End",    &component.fadeEnd,       0.5f,  0.0f, FLT_MAX, "%.2f", ImGuiSliderFlags_AlwaysClamp);
+        });
+
+        drawComponent<TerrainComponent>("TERRAIN", entity, [](auto& component)
+        {
+            std::string heightmapLabel = component.heightmap ? component.heightmap->getFilename() : "NULL";
+
+            if (ImGui::Utils::TableButton("Heightmap", heightmapLabel.c_str(), {-1, 0}))
+            {
+                ImGui::OpenPopup("terrain_heightmap_select_popup");
+            }
+
+            // The heightmap image is dropped from the content browser and cooked on the first use
+            if (ImGui::BeginDragDropTarget())
+            {
+                if (const ImGuiPayload* payload = ImGui::AcceptDragDropPayload(MG_DRAG_PAYLOAD_CB_ITEM))
+                {
+                    const auto* path = (const wchar_t*)payload->Data;
+
+                    component.heightmap = AssetManager::createTerrainHeightmapFromFile(std::filesystem::path(path).string());
+                }
+                ImGui::EndDragDropTarget();
+            }
+
+            if (ImGui::BeginPopup("terrain_heightmap_select_popup"))
+            {
+                for (auto& [name, heightmap] : AssetManager::getTerrainHeightmapList())
+                {
+                    if (ImGui::Selectable(name.c_str()))
+                    {
+                        component.heightmap = heightmap;
+                    }
+                }
+                ImGui::EndPopup();
+            }
+
+            std::string materialLabel = component.material ? component.material->name : "NULL";
+
+            if (ImGui::Utils::TableButton("Material", materialLabel.c_str(), {-1, 0}))
+            {
+                ImGui::OpenPopup("terrain_material_select_popup");
+            }
+
+            if (ImGui::BeginPopup("terrain_material_select_popup"))
+            {
+                for (auto& [name, material] : AssetManager::getMaterialList())
+                {
+                    if (ImGui::Selectable(name.c_str()))
+                    {
+                        component.material = material;
+                    }
+                }
+                ImGui::EndPopup();
+            }
+
+            ImGui::Utils::TableDragFloat("Size",           &component.size,          1.0f, 1.0f,   FLT_MAX, "%.1f", ImGuiSliderFlags_AlwaysClamp);
+            ImGui::Utils::TableDragFloat("Height",         &component.height,        0.5f, 0.0f,   FLT_MAX, "%.1f", ImGuiSliderFlags_AlwaysClamp);
+            ImGui::Utils::TableDragUint ("LOD Levels",     &component.lodLevels,     0.1f, 1,      Terrain::MAX_LOD_LEVELS, "%u", ImGuiSliderFlags_AlwaysClamp);
+            ImGui::Utils::TableDragFloat("LOD Distance",   &component.lodDistance,   0.5f, 1.0f,   FLT_MAX, "%.1f", ImGuiSliderFlags_AlwaysClamp);
+            ImGui::Utils::TableDragFloat("Texture Tiling", &component.textureTiling, 0.1f, 0.001f, FLT_MAX, "%.2f", ImGuiSliderFlags_AlwaysClamp);
+        });
     }
 
 }
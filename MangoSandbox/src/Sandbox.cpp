@@ -41,6 +41,11 @@ void Sandbox::onInit()
     m_camera2.setLocalPosition(0, 4, -30);
     m_camera2.setLocalOrientation({ 0, 1, 0 }, glm::radians(180.0f));
 
+    // The second camera is shown as picture-in-picture
+    auto& cc2 = m_camera2.getComponent<CameraComponent>();
+    cc2.isAdditionalView = true;
+    cc2.viewport         = { 0.73f, 0.02f, 0.25f, 0.25f };
+
     m_freeCameraController = createRef<FreeCameraController>();
 
     auto font = AssetManager::createFont("Droid48", "fonts/Roboto-Regular.ttf", 48.0f);
@@ -137,11 +142,16 @@ void Sandbox::onInit()
     wall2.setLocalScale(5.0f);
     wall2.setLocalPosition(-5, 2.0, -9);
 
-    auto grass = m_mainScene->createEntity();
-    grass.addComponent<StaticMeshComponent>(wallMesh);
-    grass.getComponent<StaticMeshComponent>().materials[0] = grassMaterial;
-    grass.setLocalScale(2.5f);
-    grass.setLocalPosition(-5, 1.2, 9);
+    auto grass = m_mainScene->createEntity("Grass");
+    auto& fc = grass.addComponent<FoliageComponent>(wallMesh);
+    fc.materials[0] = grassMaterial;
+    fc.extents      = glm::vec2(12.0f);
+    fc.count        = 20000;
+    fc.cellSize     = 6.0f;
+    fc.scaleRange   = glm::vec2(1.5f, 2.5f);
+    fc.fadeStart    = 40.0f;
+    fc.fadeEnd      = 60.0f;
+    grass.setLocalPosition(-5, 0, 9);
 
     auto window1 = m_mainScene->createEntity();
     window1.addComponent<StaticMeshComponent>(wallMesh);
@@ -305,17 +315,20 @@ void Sandbox::onUpdate(float dt)
     if (Input::getKeyUp(KeyCode::P) || Input::getGamepadButtonDown(GamepadID::PAD_1, GamepadButton::RIGHT_BUMPER))
     {
         isCamera1Primary = !isCamera1Primary;
-        
-        if (isCamera1Primary)
-        {
-            m_camera1.getComponent<CameraComponent>().isPrimary = true;
-            m_camera2.getComponent<CameraComponent>().isPrimary = false;
-        }
-        else
-        {
-            m_camera1.getComponent<CameraComponent>().isPrimary = false;
-            m_camera2.getComponent<CameraComponent>().isPrimary = true;
-        }
+
+        auto& cc1 = m_camera1.getComponent<CameraComponent>();
+        auto& cc2 = m_camera2.getComponent<CameraComponent>();
+
+        // Swap the full screen and the picture-in-picture views
+        std::swap(cc1.isPrimary,        cc2.isPrimary);
+        std::swap(cc1.isAdditionalView, cc2.isAdditionalView);
+        std::swap(cc1.viewport,         cc2.viewport);
+    }
+
+    if (Input::getKeyUp(KeyCode::O))
+    {
+        auto& cc = (isCamera1Primary ? m_camera2 : m_camera1).getComponent<CameraComponent>();
+        cc.isAdditionalView = !cc.isAdditionalView;
     }
 
     m_freeCameraController->onUpdate(dt);